@@ -5,6 +5,9 @@
 #include <QDir>
 #include <QFile>
 #include <QDataStream>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <QSet>
 
 #include "packagedatabase.h"
 #include "packageinfo.h"
@@ -44,6 +47,42 @@ public:
 };
 
 
+// throws
+static void finalizePackage(PackageInfo *pkg, const QDir &pkgDir, bool installed)
+{
+    if (pkg->id() != pkgDir.dirName()) {
+        throw Exception("an info.yaml for packages must be in a directory that has"
+                        " the same name as the package's id: found id '%1' in directory '%2'")
+            .arg(pkg->id(), pkgDir.path());
+    }
+
+    if (!installed) {
+        pkg->setBuiltIn(true);
+        return;
+    }
+
+    QFile f(pkgDir.absoluteFilePath(u".installation-report.yaml"_s));
+    if (!f.open(QFile::ReadOnly))
+        throw Exception(f, "failed to open the installation report");
+
+    auto report = std::make_unique<InstallationReport>(pkg->id());
+    try {
+        report->deserialize(&f);
+    } catch (const Exception &e) {
+        throw Exception("Failed to deserialize the installation report %1: %2")
+                .arg(f.fileName()).arg(e.errorString());
+    }
+
+    pkg->setInstallationReport(report.release());
+    pkg->setBaseDir(pkgDir.path());
+}
+
+static QString manifestPathInDir(const QDir &baseDir, const QString &pkgDirName)
+{
+    return QDir(baseDir.absoluteFilePath(pkgDirName)).absoluteFilePath(u"info.yaml"_s);
+}
+
+
 PackageDatabase::PackageDatabase(const QStringList &builtInPackagesDirs,
                                  const QString &installedPackagesDir, const QString &installedPackagesMountPoint)
     : m_builtInPackagesDirs(builtInPackagesDirs)
@@ -85,6 +124,17 @@ void PackageDatabase::enableSaveToCache()
     m_saveToCache = true;
 }
 
+// In incremental mode, the package database keeps a journal of the state of every package
+// directory it has loaded. It also watches all the package directories for changes and emits
+// packageDirectoriesChanged() (rate limited) whenever it detects one. Calling rescan()
+// afterwards will only re-parse the manifests of packages that were added or changed.
+void PackageDatabase::enableIncrementalUpdates()
+{
+    if (m_parsed)
+        qCWarning(LogSystem) << "PackageDatabase cannot enable incremental updates after the initial load";
+    m_incrementalUpdates = true;
+}
+
 bool PackageDatabase::builtInHasRemovableUpdate(PackageInfo *packageInfo) const
 {
     if (!packageInfo || packageInfo->isBuiltIn() || !m_installedPackages.contains(packageInfo))
@@ -126,8 +176,7 @@ QStringList PackageDatabase::findManifestsInDir(const QDir &manifestDir, bool sc
             if (!scanningBuiltInApps && !pkgDir.exists(u".installation-report.yaml"_s))
                 throw Exception("found a non-built-in package without an installation report");
 
-            QString manifestPath = pkgDir.absoluteFilePath(u"info.yaml"_s);
-            files << manifestPath;
+            files << manifestPathInDir(baseDir, pkgDirName);
 
         } catch (const Exception &e) {
             qCDebug(LogSystem) << "Ignoring package" << pkgDirName << ":" << e.what();
@@ -150,7 +199,8 @@ void PackageDatabase::parse(PackageLocations packageLocations)
         }
         m_parsedPackageLocations = Builtin | Installed;
     } else {
-        AbstractConfigCache::Options cacheOptions = AbstractConfigCache::IgnoreBroken;
+        AbstractConfigCache::Options cacheOptions = AbstractConfigCache::IgnoreBroken
+            | AbstractConfigCache::CheckFingerprints;
         if (!m_loadFromCache)
             cacheOptions |= AbstractConfigCache::ClearCache;
         if (!m_loadFromCache && !m_saveToCache)
@@ -176,15 +226,12 @@ void PackageDatabase::parse(PackageLocations packageLocations)
                     continue;
                 }
 
-                if (pkg->id() != pkgDir.dirName()) {
-                    throw Exception("an info.yaml for packages must be in a directory that has"
-                                    " the same name as the package's id: found id '%1' in directory '%2'")
-                        .arg(pkg->id(), pkgDir.path());
-                }
-                pkg->setBuiltIn(true);
+                finalizePackage(pkg.get(), pkgDir, false);
+                addToJournal(manifestFile, pkg.get(), Builtin);
                 m_builtInPackages.append(pkg.release());
             }
             m_parsedPackageLocations |= Builtin;
+            updateWatcher();
         }
         if ((packageLocations & Installed) && !(m_parsedPackageLocations & Installed)) {
             if (m_installedPackagesDir.isEmpty()) {
@@ -241,7 +288,8 @@ void PackageDatabase::parseInstalled()
 
     QStringList manifestFiles = findManifestsInDir(m_installedPackagesDir, false);
 
-    AbstractConfigCache::Options cacheOptions = AbstractConfigCache::IgnoreBroken;
+    AbstractConfigCache::Options cacheOptions = AbstractConfigCache::IgnoreBroken
+            | AbstractConfigCache::CheckFingerprints;
     if (!m_loadFromCache)
         cacheOptions |= AbstractConfigCache::ClearCache;
     if (!m_loadFromCache && !m_saveToCache)
@@ -264,26 +312,8 @@ void PackageDatabase::parseInstalled()
                 continue;
             }
 
-            if (pkg->id() != pkgDir.dirName()) {
-                throw Exception("an info.yaml for packages must be in a directory that has"
-                                " the same name as the package's id: found id '%1' in directory '%2'")
-                    .arg(pkg->id(), pkgDir.path());
-            }
-
-            QFile f(pkgDir.absoluteFilePath(u".installation-report.yaml"_s));
-            if (!f.open(QFile::ReadOnly))
-                throw Exception(f, "failed to open the installation report");
-
-            auto report = std::make_unique<InstallationReport>(pkg->id());
-            try {
-                report->deserialize(&f);
-            } catch (const Exception &e) {
-                throw Exception("Failed to deserialize the installation report %1: %2")
-                        .arg(f.fileName()).arg(e.errorString());
-            }
-
-            pkg->setInstallationReport(report.release());
-            pkg->setBaseDir(pkgDir.path());
+            finalizePackage(pkg.get(), pkgDir, true);
+            addToJournal(manifestFile, pkg.get(), Installed);
             m_installedPackages.append(pkg.release());
 
         } catch (const Exception &e) {
@@ -292,17 +322,211 @@ void PackageDatabase::parseInstalled()
         }
     }
     m_parsedPackageLocations |= Installed;
+    updateWatcher();
 }
 
 void PackageDatabase::addPackageInfo(PackageInfo *package)
 {
     m_installedPackages.append(package);
+
+    if (m_incrementalUpdates && !m_installedPackagesDir.isEmpty()) {
+        addToJournal(manifestPathInDir(m_installedPackagesDir, package->id()), package, Installed);
+        updateWatcher();
+    }
 }
 
 void PackageDatabase::removePackageInfo(PackageInfo *package)
 {
-    if (m_installedPackages.removeAll(package))
+    if (m_installedPackages.removeAll(package)) {
+        if (m_incrementalUpdates) {
+            for (auto it = m_journal.begin(); it != m_journal.end(); ) {
+                if (it->packageInfo == package)
+                    it = m_journal.erase(it);
+                else
+                    ++it;
+            }
+            updateWatcher();
+        }
         delete package;
+    }
+}
+
+PackageDatabase::PackageDirState PackageDatabase::PackageDirState::fromManifest(const QString &manifestPath,
+                                                                                bool installed)
+{
+    PackageDirState state;
+    const QFileInfo manifestInfo(manifestPath);
+    if (manifestInfo.exists()) {
+        state.manifestSize = manifestInfo.size();
+        state.manifestModified = manifestInfo.lastModified().toMSecsSinceEpoch();
+    }
+    if (installed) {
+        const QFileInfo reportInfo(manifestInfo.dir(), u".installation-report.yaml"_s);
+        state.reportModified = reportInfo.lastModified().toMSecsSinceEpoch();
+    }
+    return state;
+}
+
+PackageInfo *PackageDatabase::loadPackage(const QString &manifestPath, PackageLocation location) noexcept(false)
+{
+    std::unique_ptr<PackageInfo> pkg(PackageInfo::fromManifest(manifestPath));
+    if (!pkg)
+        throw Exception("%1 is not a valid manifest YAML file").arg(manifestPath);
+    finalizePackage(pkg.get(), QFileInfo(manifestPath).dir(), location == Installed);
+    return pkg.release();
+}
+
+void PackageDatabase::addToJournal(const QString &manifestPath, PackageInfo *packageInfo,
+                                   PackageLocation location)
+{
+    if (!m_incrementalUpdates)
+        return;
+
+    JournalEntry &entry = m_journal[manifestPath];
+    entry.packageInfo = packageInfo;
+    entry.location = location;
+    entry.state = PackageDirState::fromManifest(manifestPath, location == Installed);
+}
+
+void PackageDatabase::updateWatcher()
+{
+    if (!m_incrementalUpdates)
+        return;
+
+    if (!m_watcher) {
+        m_rescanTimer = new QTimer(this);
+        m_rescanTimer->setSingleShot(true);
+        // package installations and system updates touch a lot of files in quick succession
+        m_rescanTimer->setInterval(500);
+        connect(m_rescanTimer, &QTimer::timeout, this, &PackageDatabase::packageDirectoriesChanged);
+
+        m_watcher = new QFileSystemWatcher(this);
+        connect(m_watcher, &QFileSystemWatcher::directoryChanged, m_rescanTimer, qOverload<>(&QTimer::start));
+        connect(m_watcher, &QFileSystemWatcher::fileChanged, m_rescanTimer, qOverload<>(&QTimer::start));
+    }
+
+    // the base dirs are watched for added and removed packages, while the manifests themselves
+    // are watched for in-place changes
+    QSet<QString> paths;
+    if (m_parsedPackageLocations & Builtin) {
+        for (const QString &dir : std::as_const(m_builtInPackagesDirs))
+            paths.insert(QDir(dir).absolutePath());
+    }
+    if ((m_parsedPackageLocations & Installed) && !m_installedPackagesDir.isEmpty())
+        paths.insert(QDir(m_installedPackagesDir).absolutePath());
+    for (auto it = m_journal.cbegin(); it != m_journal.cend(); ++it)
+        paths.insert(it.key());
+
+    const QStringList watched = m_watcher->files() + m_watcher->directories();
+    QStringList toRemove;
+    for (const QString &path : watched) {
+        if (!paths.remove(path))
+            toRemove << path;
+    }
+    if (!toRemove.isEmpty())
+        m_watcher->removePaths(toRemove);
+    if (!paths.isEmpty())
+        m_watcher->addPaths(paths.values());
+}
+
+bool PackageDatabase::rescan(const QStringList &skipPackageIds)
+{
+    if (!m_incrementalUpdates || !m_parsed || !m_singlePackagePath.isEmpty())
+        return true;
+
+    // listing the directories is cheap compared to parsing the manifests
+    QHash<QString, PackageLocation> manifestsOnDisk;
+    if (m_parsedPackageLocations & Builtin) {
+        for (const QString &dir : std::as_const(m_builtInPackagesDirs)) {
+            const auto manifests = findManifestsInDir(dir, true);
+            for (const auto &manifest : manifests)
+                manifestsOnDisk.insert(manifest, Builtin);
+        }
+    }
+    if ((m_parsedPackageLocations & Installed) && !m_installedPackagesDir.isEmpty()) {
+        const auto manifests = findManifestsInDir(m_installedPackagesDir, false);
+        for (const auto &manifest : manifests)
+            manifestsOnDisk.insert(manifest, Installed);
+    }
+
+    bool skippedChanges = false;
+
+    // removed packages
+    const QStringList journalPaths = m_journal.keys();
+    for (const QString &manifestPath : journalPaths) {
+        if (manifestsOnDisk.contains(manifestPath))
+            continue;
+        PackageInfo *pi = m_journal.value(manifestPath).packageInfo;
+        if (skipPackageIds.contains(pi->id())) {
+            skippedChanges = true;
+            continue;
+        }
+        qCDebug(LogSystem) << "Package" << pi->id() << "was removed from" << pi->baseDir().path();
+
+        m_journal.remove(manifestPath);
+        emit packageInfoAboutToBeRemoved(pi);
+        if (!m_builtInPackages.removeOne(pi))
+            m_installedPackages.removeOne(pi);
+        delete pi;
+    }
+
+    // added and changed packages
+    for (auto it = manifestsOnDisk.cbegin(); it != manifestsOnDisk.cend(); ++it) {
+        const QString &manifestPath = it.key();
+        const PackageLocation location = it.value();
+        const auto state = PackageDirState::fromManifest(manifestPath, location == Installed);
+
+        auto jit = m_journal.find(manifestPath);
+        if ((jit != m_journal.end()) && (jit->state == state))
+            continue;
+
+        const QString pkgId = QFileInfo(manifestPath).dir().dirName();
+        if (skipPackageIds.contains(pkgId)) {
+            skippedChanges = true;
+            continue;
+        }
+
+        try {
+            std::unique_ptr<PackageInfo> pkg(loadPackage(manifestPath, location));
+
+            if (jit == m_journal.end()) {
+                // the same checks as in PackageManager::registerPackages(): only an installed
+                // package is allowed to share its id with a built-in one (as an update)
+                auto &packages = (location == Builtin) ? m_builtInPackages : m_installedPackages;
+                for (const auto *other : std::as_const(packages)) {
+                    if (other->id() == pkg->id())
+                        throw Exception("found another package with the same id at %1").arg(other->manifestPath());
+                }
+                if (location == Builtin) {
+                    for (const auto *other : std::as_const(m_installedPackages)) {
+                        if (other->id() == pkg->id())
+                            throw Exception("found an installed package with the same id at %1").arg(other->manifestPath());
+                    }
+                }
+                qCDebug(LogSystem) << "Package" << pkgId << "was added at" << pkg->baseDir().path();
+
+                m_journal.insert(manifestPath, { pkg.get(), location, state });
+                packages.append(pkg.get());
+                emit packageInfoAdded(pkg.release());
+            } else {
+                qCDebug(LogSystem) << "Package" << pkgId << "was changed at" << pkg->baseDir().path();
+
+                PackageInfo *oldPi = jit->packageInfo;
+                auto &packages = (jit->location == Builtin) ? m_builtInPackages : m_installedPackages;
+                packages.replace(packages.indexOf(oldPi), pkg.get());
+                jit->packageInfo = pkg.get();
+                jit->state = state;
+                emit packageInfoChanged(oldPi, pkg.release());
+                delete oldPi;
+            }
+        } catch (const Exception &e) {
+            qCWarning(LogSystem) << "Ignoring changes to package" << pkgId << "at" << manifestPath
+                                 << ":" << e.what();
+        }
+    }
+
+    updateWatcher();
+    return !skippedChanges;
 }
 
 QVector<PackageInfo *> PackageDatabase::installedPackages() const
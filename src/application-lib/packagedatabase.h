@@ -8,9 +8,13 @@
 #include <QtAppManCommon/global.h>
 #include <QtCore/QVector>
 #include <QtCore/QString>
+#include <QtCore/QHash>
 
 #include <QtAppManApplication/packageinfo.h>
 
+QT_FORWARD_DECLARE_CLASS(QFileSystemWatcher)
+QT_FORWARD_DECLARE_CLASS(QTimer)
+
 QT_BEGIN_NAMESPACE_AM
 
 class PackageInfo;
@@ -34,6 +38,7 @@ public:
 
     void enableLoadFromCache();
     void enableSaveToCache();
+    void enableIncrementalUpdates();
 
     void parse(PackageLocations packageLocations = All);
 
@@ -46,9 +51,18 @@ public:
     void addPackageInfo(PackageInfo *package);
     void removePackageInfo(PackageInfo *package);
 
+    // incremental updates: returns false, if changes to any of the skipped packages were found
+    bool rescan(const QStringList &skipPackageIds = { });
+
 Q_SIGNALS:
     void installedPackagesParsed();
 
+    // incremental updates
+    void packageDirectoriesChanged();
+    void packageInfoAdded(QtAM::PackageInfo *packageInfo);
+    void packageInfoChanged(QtAM::PackageInfo *oldPackageInfo, QtAM::PackageInfo *newPackageInfo);
+    void packageInfoAboutToBeRemoved(QtAM::PackageInfo *packageInfo);
+
 private:
     Q_DISABLE_COPY_MOVE(PackageDatabase)
 
@@ -56,8 +70,35 @@ private:
     QStringList findManifestsInDir(const QDir &manifestDir, bool scanningBuiltInApps);
     void parseInstalled();
 
+    struct PackageDirState
+    {
+        qint64 manifestSize = -1;
+        qint64 manifestModified = 0;
+        qint64 reportModified = 0;
+
+        bool operator==(const PackageDirState &other) const
+        {
+            return manifestSize == other.manifestSize && manifestModified == other.manifestModified
+                   && reportModified == other.reportModified;
+        }
+        bool operator!=(const PackageDirState &other) const { return !operator==(other); }
+
+        static PackageDirState fromManifest(const QString &manifestPath, bool installed);
+    };
+    struct JournalEntry
+    {
+        PackageInfo *packageInfo = nullptr;
+        PackageLocation location = None;
+        PackageDirState state;
+    };
+
+    PackageInfo *loadPackage(const QString &manifestPath, PackageLocation location) noexcept(false);
+    void addToJournal(const QString &manifestPath, PackageInfo *packageInfo, PackageLocation location);
+    void updateWatcher();
+
     bool m_loadFromCache = false;
     bool m_saveToCache = false;
+    bool m_incrementalUpdates = false;
     bool m_parsed = false;
     QStringList m_builtInPackagesDirs;
     QString m_installedPackagesDir;
@@ -69,6 +110,10 @@ private:
     QVector<PackageInfo *> m_builtInPackages;
     QVector<PackageInfo *> m_installedPackages;
 
+    // incremental updates
+    QHash<QString, JournalEntry> m_journal; // manifest path -> state when last parsed
+    QFileSystemWatcher *m_watcher = nullptr;
+    QTimer *m_rescanTimer = nullptr;
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(PackageDatabase::PackageLocations)
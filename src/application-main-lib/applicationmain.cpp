@@ -7,6 +7,7 @@
 #include <QDBusConnectionInterface>
 #include <QDBusInterface>
 #include <QThread>
+#include <qplatformdefs.h>
 
 #include <QtAppManCommon/exception.h>
 #include <QtAppManCommon/logging.h>
@@ -250,14 +251,30 @@ void ApplicationMain::setup()
 
 void ApplicationMain::loadConfiguration(const QByteArray &configYaml) noexcept(false)
 {
-    try {
-        QVector<QVariant> docs = YamlParser::parseAllDocuments(configYaml.isEmpty() ? qgetenv("AM_CONFIG")
-                                                                                    : configYaml);
-        if (docs.size() == 1)
-            m_configuration = docs.first().toMap();
-    } catch (const Exception &e) {
-        throw Exception("Runtime launcher could not parse the YAML configuration coming from the "
-                        "application manager: %1").arg(e.errorString());
+    bool configFdOk = false;
+    const int configFd = configYaml.isEmpty() ? qEnvironmentVariableIntValue("AM_CONFIG_FD", &configFdOk) : -1;
+
+    if (configFdOk && (configFd >= 0)) {
+        // we do not want to pass this on to our own child processes
+        qunsetenv("AM_CONFIG_FD");
+        try {
+            m_configuration = variantMapFromCborFileDescriptor(configFd);
+            QT_CLOSE(configFd);
+        } catch (const Exception &e) {
+            QT_CLOSE(configFd);
+            throw Exception("Runtime launcher could not read the CBOR configuration coming from the "
+                            "application manager: %1").arg(e.errorString());
+        }
+    } else {
+        try {
+            QVector<QVariant> docs = YamlParser::parseAllDocuments(configYaml.isEmpty() ? qgetenv("AM_CONFIG")
+                                                                                        : configYaml);
+            if (docs.size() == 1)
+                m_configuration = docs.first().toMap();
+        } catch (const Exception &e) {
+            throw Exception("Runtime launcher could not parse the YAML configuration coming from the "
+                            "application manager: %1").arg(e.errorString());
+        }
     }
 
     m_baseDir = m_configuration.value(u"baseDir"_s).toString() + u'/';
@@ -269,6 +286,11 @@ void ApplicationMain::loadConfiguration(const QByteArray &configYaml) noexcept(f
     m_loggingRules = variantToStringList(loggingConfig.value(u"rules"_s));
     m_useAMConsoleLogger = loggingConfig.value(u"useAMConsoleLogger"_s);
     m_dltLongMessageBehavior = loggingConfig.value(u"dltLongMessageBehavior"_s).toString();
+    const QVariantMap asyncOutputConfig = loggingConfig.value(u"asyncOutput"_s).toMap();
+    if (asyncOutputConfig.value(u"enabled"_s).toBool()) {
+        Logging::setAsyncOutput(true, asyncOutputConfig.value(u"queueSize"_s, 1024).toInt(),
+                                asyncOutputConfig.value(u"overflowPolicy"_s).toString());
+    }
 
     QVariantMap dbusConfig = m_configuration.value(u"dbus"_s).toMap();
     m_dbusAddressP2P = dbusConfig.value(u"p2p"_s).toString();
@@ -407,7 +429,9 @@ void ApplicationMain::connectDBusInterfaces(bool isRuntimeLauncher) noexcept(fal
         }
 
         if (!connect(m_dbusRuntimeInterface, &IoQtApplicationManagerRuntimeInterfaceInterface::startApplication,
-                     this, &ApplicationMain::startApplication)) {
+                     this, &ApplicationMain::startApplication)
+                || !connect(m_dbusRuntimeInterface, &IoQtApplicationManagerRuntimeInterfaceInterface::preloadApplication,
+                            this, &ApplicationMain::preloadApplication)) {
             throw Exception("could not connect the RuntimeInterface signals via D-Bus: %1")
                       .arg(m_dbusRuntimeInterface->lastError().name());
         }
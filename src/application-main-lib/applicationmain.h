@@ -99,6 +99,8 @@ public:
     Q_SIGNAL void startApplication(const QString &baseDir, const QString &qmlFile, const QString &document,
                                    const QString &mimeType, const QVariantMap &runtimeParams,
                                    const QVariantMap systemProperties);
+    Q_SIGNAL void preloadApplication(const QString &baseDir, const QString &qmlFile,
+                                     const QVariantMap &application);
 
     // DBus NotificationInterface
     Q_SIGNAL void notificationClosed(uint id, uint reason);
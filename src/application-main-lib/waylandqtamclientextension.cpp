@@ -9,14 +9,19 @@
 #include <QGuiApplication>
 #include <QEvent>
 #include <QExposeEvent>
+#include <QDataStream>
+#include <QCborValue>
+#include <QCborMap>
 #include <qpa/qplatformnativeinterface.h>
 
 #include <QtAppManCommon/logging.h>
 
+#include <utility>
+
 QT_BEGIN_NAMESPACE_AM
 
 WaylandQtAMClientExtension::WaylandQtAMClientExtension()
-    : QWaylandClientExtensionTemplate(1)
+    : QWaylandClientExtensionTemplate(3)
 {
     qApp->installEventFilter(this);
 }
@@ -41,14 +46,15 @@ bool WaylandQtAMClientExtension::eventFilter(QObject *o, QEvent *e)
                     (QGuiApplication::platformNativeInterface()->nativeResourceForWindow("surface", window));
                 if (surface) {
                     m_windowToSurface.insert(window, surface);
-                    const QVariantMap wp = windowProperties(window);
-                    for (auto it = wp.cbegin(); it != wp.cend(); ++it)
-                        sendPropertyToServer(surface, it.key(), it.value());
+                    // everything cached so far is sent in one go: this supersedes anything pending
+                    m_pendingProperties.remove(window);
+                    sendPropertiesToServer(surface, windowProperties(window));
                 }
                 // pointers can be reused, so we have to remove the old mappings
                 connect(window, &QObject::destroyed, this, [this, window]() {
                     m_windowToSurface.remove(window);
                     m_windowProperties.remove(window);
+                    m_pendingProperties.remove(window);
                 });
             }
         }
@@ -64,30 +70,70 @@ QVariantMap WaylandQtAMClientExtension::windowProperties(QWindow *window) const
     return m_windowProperties.value(window);
 }
 
-void WaylandQtAMClientExtension::sendPropertyToServer(struct ::wl_surface *surface, const QString &name,
-                                                      const QVariant &value)
+void WaylandQtAMClientExtension::scheduleSendToServer(QWindow *window, const QVariantMap &properties)
 {
-    if (int(qtam_extension::version()) != QWaylandClientExtension::version()) {
-        qCWarning(LogWayland) << "Unsupported qtam_extension version:" << qtam_extension::version();
+    m_pendingProperties[window].insert(properties);
+
+    // all changes within this event loop iteration are coalesced into a single request
+    if (!m_sendScheduled) {
+        m_sendScheduled = true;
+        QMetaObject::invokeMethod(this, &WaylandQtAMClientExtension::sendPendingPropertiesToServer,
+                                  Qt::QueuedConnection);
+    }
+}
+
+void WaylandQtAMClientExtension::sendPendingPropertiesToServer()
+{
+    m_sendScheduled = false;
+    const auto pending = std::exchange(m_pendingProperties, { });
+
+    for (auto it = pending.cbegin(); it != pending.cend(); ++it) {
+        // a window that got hidden in the meantime re-sends its full cache on the next expose
+        if (auto surface = m_windowToSurface.value(it.key()))
+            sendPropertiesToServer(surface, it.value());
+    }
+}
+
+void WaylandQtAMClientExtension::sendPropertiesToServer(struct ::wl_surface *surface, const QVariantMap &properties)
+{
+    if (properties.isEmpty())
+        return;
+
+    const auto version = qtam_extension::version();
+
+    if (version >= 3) {
+        qCDebug(LogWayland) << "window properties: client send:" << surface << properties;
+        set_window_properties(surface, QCborValue::fromVariant(properties).toCbor());
         return;
     }
-    QByteArray data;
-    QDataStream ds(&data, QDataStream::WriteOnly);
-    ds << value;
 
-    qCDebug(LogWayland) << "window property: client send:" << surface << name << value;
-    set_window_property(surface, name, data);
+    for (auto it = properties.cbegin(); it != properties.cend(); ++it) {
+        QByteArray data;
+
+        switch (version) {
+        case 1: {
+            QDataStream ds(&data, QDataStream::WriteOnly);
+            ds << it.value();
+            break;
+        }
+        case 2:
+            data = QCborValue::fromVariant(it.value()).toCbor();
+            break;
+        default:
+            qCWarning(LogWayland) << "Unsupported qtam_extension version:" << version;
+            return;
+        }
+
+        qCDebug(LogWayland) << "window property: client send:" << surface << it.key() << it.value();
+        set_window_property(surface, it.key(), data);
+    }
 }
 
 bool WaylandQtAMClientExtension::setWindowProperty(QWindow *window, const QString &name, const QVariant &value)
 {
     if (setWindowPropertyHelper(window, name, value) && m_windowToSurface.contains(window)) {
-        auto surface = static_cast<struct ::wl_surface *>
-                       (QGuiApplication::platformNativeInterface()->nativeResourceForWindow("surface", window));
-        if (surface) {
-            sendPropertyToServer(surface, name, value);
-            return true;
-        }
+        scheduleSendToServer(window, { { name, value } });
+        return true;
     }
     return false;
 }
@@ -115,22 +161,46 @@ void WaylandQtAMClientExtension::clearWindowPropertyCache(QWindow *window)
 void WaylandQtAMClientExtension::qtam_extension_window_property_changed(wl_surface *surface, const QString &name,
                                                                         wl_array *value)
 {
-    if (int(qtam_extension::version()) != QWaylandClientExtension::version()) {
-        qCWarning(LogWayland) << "Unsupported qtam_extension version:" << qtam_extension::version();
-        return;
-    }
-
     if (QWindow *window = m_windowToSurface.key(surface)) {
         const auto data = QByteArray::fromRawData(static_cast<const char *>(value->data), qsizetype(value->size));
-        QDataStream ds(data);
         QVariant variantValue;
-        ds >> variantValue;
+
+        switch (qtam_extension::version()) {
+        case 1: {
+            QDataStream ds(data);
+            ds >> variantValue;
+            break;
+        }
+        case 2:
+            variantValue = QCborValue::fromCbor(data).toVariant();
+            break;
+        default:
+            qCWarning(LogWayland) << "Unsupported qtam_extension version:" << qtam_extension::version();
+            return;
+        }
 
         qCDebug(LogWayland) << "window property: client receive" << window << name << variantValue;
         setWindowPropertyHelper(window, name, variantValue);
     }
 }
 
+void WaylandQtAMClientExtension::qtam_extension_window_properties_changed(wl_surface *surface, wl_array *properties)
+{
+    if (QWindow *window = m_windowToSurface.key(surface)) {
+        const auto data = QByteArray::fromRawData(static_cast<const char *>(properties->data), qsizetype(properties->size));
+        const QCborValue cbor = QCborValue::fromCbor(data);
+        if (!cbor.isMap()) {
+            qCWarning(LogWayland) << "Received invalid window properties for" << window;
+            return;
+        }
+        const QVariantMap variantMap = cbor.toMap().toVariantMap();
+
+        qCDebug(LogWayland) << "window properties: client receive" << window << variantMap;
+        for (auto it = variantMap.cbegin(); it != variantMap.cend(); ++it)
+            setWindowPropertyHelper(window, it.key(), it.value());
+    }
+}
+
 QT_END_NAMESPACE_AM
 
 #include "moc_waylandqtamclientextension_p.cpp"
@@ -48,11 +48,17 @@ protected:
 
 private:
     bool setWindowPropertyHelper(QWindow *window, const QString &name, const QVariant &value);
-    void sendPropertyToServer(::wl_surface *surface, const QString &name, const QVariant &value);
+    void scheduleSendToServer(QWindow *window, const QVariantMap &properties);
+    void sendPendingPropertiesToServer();
+    void sendPropertiesToServer(::wl_surface *surface, const QVariantMap &properties);
     void qtam_extension_window_property_changed(wl_surface *surface, const QString &name, wl_array *value) override;
+    void qtam_extension_window_properties_changed(wl_surface *surface, wl_array *properties) override;
 
     QMap<QWindow *, QVariantMap> m_windowProperties;    // AXIVION Line Qt-QMapWithPointerKey: cleared on destroyed signal
     QMap<QWindow *, ::wl_surface *> m_windowToSurface;  // AXIVION Line Qt-QMapWithPointerKey: cleared on destroyed signal
+    // changes not yet sent to the server, flushed once per event loop iteration
+    QMap<QWindow *, QVariantMap> m_pendingProperties;   // AXIVION Line Qt-QMapWithPointerKey: cleared on destroyed signal
+    bool m_sendScheduled = false;
 };
 
 QT_END_NAMESPACE_AM
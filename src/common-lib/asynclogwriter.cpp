@@ -0,0 +1,265 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QtCore/qmath.h>
+
+#include "asynclogwriter.h"
+
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <sys/uio.h>
+#include <unistd.h>
+
+using namespace std::chrono_literals;
+
+QT_BEGIN_NAMESPACE_AM
+
+// The ring is a bounded MPMC queue as described by Dmitry Vyukov: each slot carries a sequence
+// number, which tells producers and the consumer whether the slot is free for position n
+// (sequence == n), or whether it holds the record for position n (sequence == n + 1).
+
+static constexpr int MaxBatchSize = 64;  // number of iovecs per writev() call
+static constexpr qsizetype MaxRecycledCapacity = 4096; // don't hold on to huge buffers
+
+static void writeFully(int fd, struct iovec *iov, int iovcnt)
+{
+    while (iovcnt > 0) {
+        ssize_t written = ::writev(fd, iov, iovcnt);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            return; // nothing we can do about it: we cannot log an error here
+        }
+        while ((iovcnt > 0) && (size_t(written) >= iov->iov_len)) {
+            written -= ssize_t(iov->iov_len);
+            ++iov;
+            --iovcnt;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = static_cast<char *>(iov->iov_base) + written;
+            iov->iov_len -= size_t(written);
+        }
+    }
+}
+
+AsyncLogWriter::AsyncLogWriter(int fd, int queueSize, OverflowPolicy overflowPolicy)
+    : m_fd(fd)
+    , m_overflowPolicy(overflowPolicy)
+    , m_mask(qNextPowerOfTwo(quint32(qBound(2, queueSize, 1 << 20) - 1)) - 1)
+    , m_slots(new Slot[m_mask + 1])
+{
+    for (quint64 i = 0; i <= m_mask; ++i)
+        m_slots[i].sequence.store(i, std::memory_order_relaxed);
+
+    m_thread = std::thread([this]() { run(); });
+}
+
+AsyncLogWriter::~AsyncLogWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_wakeUp.notify_one();
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+int AsyncLogWriter::queueSize() const
+{
+    return int(m_mask + 1);
+}
+
+AsyncLogWriter::OverflowPolicy AsyncLogWriter::overflowPolicy() const
+{
+    return m_overflowPolicy;
+}
+
+quint64 AsyncLogWriter::droppedCount() const
+{
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+void AsyncLogWriter::post(QByteArray &record)
+{
+    quint64 pos = m_enqueuePos.load(std::memory_order_relaxed);
+    Slot *slot;
+
+    while (true) {
+        slot = &m_slots[pos & m_mask];
+        const quint64 seq = slot->sequence.load(std::memory_order_acquire);
+        const qint64 diff = qint64(seq) - qint64(pos);
+
+        if (diff == 0) {
+            if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        } else if (diff < 0) {
+            // the ring is full
+            wakeWriter();
+            if (m_overflowPolicy == Drop) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            {
+                // the writer notifies us after handing back slots: the counter is incremented
+                // before re-checking, so that either we see the free slot or it sees us waiting
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_blockedProducers.fetch_add(1, std::memory_order_seq_cst);
+                m_spaceAvailable.wait_for(lock, 100ms, [this]() { return !isFull(); }); // timeout: safety net
+                m_blockedProducers.fetch_sub(1, std::memory_order_relaxed);
+            }
+            pos = m_enqueuePos.load(std::memory_order_relaxed);
+        } else {
+            pos = m_enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->data.swap(record);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+
+    wakeWriter();
+}
+
+bool AsyncLogWriter::isEmpty() const
+{
+    const quint64 pos = m_dequeuePos.load(std::memory_order_acquire);
+    return m_slots[pos & m_mask].sequence.load(std::memory_order_acquire) != (pos + 1);
+}
+
+bool AsyncLogWriter::isFull() const
+{
+    const quint64 pos = m_enqueuePos.load(std::memory_order_acquire);
+    const quint64 seq = m_slots[pos & m_mask].sequence.load(std::memory_order_acquire);
+    return (qint64(seq) - qint64(pos)) < 0;
+}
+
+void AsyncLogWriter::wakeWriter()
+{
+    // producers only pay for the mutex, if the writer is actually waiting
+    if (m_writerSleeping.load(std::memory_order_seq_cst)
+            && m_writerSleeping.exchange(false, std::memory_order_seq_cst)) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_wakeUp.notify_one();
+    }
+}
+
+void AsyncLogWriter::wakeBlockedProducers()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_blockedProducers.load(std::memory_order_seq_cst)) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_spaceAvailable.notify_all();
+    }
+}
+
+qsizetype AsyncLogWriter::writeBatch()
+{
+    struct iovec iov[MaxBatchSize + 1];
+    int iovcnt = 0;
+    char droppedMsg[128];
+
+    const quint64 dropped = m_dropped.load(std::memory_order_relaxed);
+    if (dropped != m_droppedReported) {
+        int len = std::snprintf(droppedMsg, sizeof(droppedMsg),
+                                "[... %llu log message(s) dropped: the asynchronous output queue was full ...]\n",
+                                static_cast<unsigned long long>(dropped - m_droppedReported));
+        if (len > 0) {
+            iov[iovcnt].iov_base = droppedMsg;
+            iov[iovcnt].iov_len = size_t(qMin(len, int(sizeof(droppedMsg)) - 1));
+            ++iovcnt;
+        }
+        m_droppedReported = dropped;
+    }
+
+    const quint64 startPos = m_dequeuePos.load(std::memory_order_relaxed);
+    quint64 pos = startPos;
+
+    while ((pos - startPos) < MaxBatchSize) {
+        Slot &slot = m_slots[pos & m_mask];
+        if (slot.sequence.load(std::memory_order_acquire) != (pos + 1))
+            break;
+        iov[iovcnt].iov_base = const_cast<char *>(slot.data.constData());
+        iov[iovcnt].iov_len = size_t(slot.data.size());
+        ++iovcnt;
+        ++pos;
+    }
+
+    if (iovcnt)
+        writeFully(m_fd, iov, iovcnt);
+
+    // hand the slots back to the producers
+    for (quint64 p = startPos; p != pos; ++p) {
+        Slot &slot = m_slots[p & m_mask];
+        if (slot.data.capacity() > MaxRecycledCapacity)
+            slot.data = QByteArray();
+        else
+            slot.data.resize(0);
+        slot.sequence.store(p + m_mask + 1, std::memory_order_release);
+    }
+    m_dequeuePos.store(pos, std::memory_order_release);
+
+    if (pos != startPos)
+        wakeBlockedProducers();
+
+    return qsizetype(pos - startPos);
+}
+
+void AsyncLogWriter::run()
+{
+    while (true) {
+        if (writeBatch())
+            continue;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_quit)
+            break;
+        m_writerSleeping.store(true, std::memory_order_seq_cst);
+        if (isEmpty() && (m_dropped.load(std::memory_order_relaxed) == m_droppedReported))
+            m_wakeUp.wait_for(lock, 100ms); // the timeout is just a safety net
+        m_writerSleeping.store(false, std::memory_order_seq_cst);
+    }
+
+    while (writeBatch())
+        ;
+}
+
+void AsyncLogWriter::flush(int timeoutMSec)
+{
+    // Only the writer thread ever touches the slots it hands back, so we must not write the
+    // records ourselves while it is alive: just wait until it is past everything that has been
+    // posted up to now. If it is stuck (e.g. in writev()), the records stay queued and can still
+    // be written by emergencyFlush() from the crash handler.
+    const quint64 target = m_enqueuePos.load(std::memory_order_acquire);
+
+    for (int i = 0; i < timeoutMSec; ++i) {
+        if (qint64(m_dequeuePos.load(std::memory_order_acquire) - target) >= 0)
+            return;
+        wakeWriter();
+        ::usleep(1000);
+    }
+}
+
+void AsyncLogWriter::emergencyFlush()
+{
+    // We might be in a signal handler, interrupting a thread that holds m_mutex, or even the
+    // writer thread itself: neither wake the writer nor wait for it.
+    // Records the writer is currently working on might get written twice.
+    writePending();
+}
+
+void AsyncLogWriter::writePending()
+{
+    quint64 pos = m_dequeuePos.load(std::memory_order_acquire);
+    while (true) {
+        Slot &slot = m_slots[pos & m_mask];
+        if (slot.sequence.load(std::memory_order_acquire) != (pos + 1))
+            break;
+        struct iovec iov { const_cast<char *>(slot.data.constData()), size_t(slot.data.size()) };
+        writeFully(m_fd, &iov, 1);
+        ++pos;
+    }
+}
+
+QT_END_NAMESPACE_AM
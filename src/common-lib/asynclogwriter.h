@@ -0,0 +1,89 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef ASYNCLOGWRITER_H
+#define ASYNCLOGWRITER_H
+
+#include <QtCore/QByteArray>
+#include <QtAppManCommon/global.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+QT_BEGIN_NAMESPACE_AM
+
+// Decouples writing pre-formatted log records to a file descriptor from the threads that produce
+// them: records are appended to a bounded, lock-free multi-producer/single-consumer ring and a
+// dedicated writer thread batches them via writev().
+// This is only available on Unix platforms.
+class AsyncLogWriter
+{
+public:
+    enum OverflowPolicy {
+        Drop,  // the record is dropped and counted (the count is reported in the output)
+        Block, // the producer waits until there is room in the ring again
+    };
+
+    AsyncLogWriter(int fd, int queueSize, OverflowPolicy overflowPolicy);
+    ~AsyncLogWriter(); // writes all pending records and stops the writer thread
+
+    int queueSize() const;
+    OverflowPolicy overflowPolicy() const;
+
+    // Queues the formatted record for writing. The buffer is swapped with a previously used one,
+    // so that the caller can reuse its capacity without re-allocating.
+    void post(QByteArray &record);
+
+    // Waits for at most timeoutMSec for the writer thread to write all records that have been
+    // posted before this call.
+    void flush(int timeoutMSec);
+
+    // Writes all pending records directly from the calling thread, without taking any locks or
+    // waiting for the writer thread. Only uses async-signal-safe functions, so that it can be
+    // called from the crash handler.
+    void emergencyFlush();
+
+    quint64 droppedCount() const;
+
+private:
+    struct Slot
+    {
+        std::atomic<quint64> sequence;
+        QByteArray data;
+    };
+
+    bool isEmpty() const;
+    bool isFull() const;
+    void wakeWriter();
+    void wakeBlockedProducers();
+    void writePending();
+    void run();
+    qsizetype writeBatch();
+
+    const int m_fd;
+    const OverflowPolicy m_overflowPolicy;
+    const quint64 m_mask;
+    std::unique_ptr<Slot[]> m_slots;
+
+    alignas(64) std::atomic<quint64> m_enqueuePos { 0 };
+    alignas(64) std::atomic<quint64> m_dequeuePos { 0 };
+    alignas(64) std::atomic<quint64> m_dropped { 0 };
+    quint64 m_droppedReported = 0; // only accessed by the writer
+
+    std::atomic<bool> m_writerSleeping { false };
+    std::atomic<int> m_blockedProducers { 0 };
+    std::atomic<bool> m_quit { false };
+    std::mutex m_mutex;
+    std::condition_variable m_wakeUp;
+    std::condition_variable m_spaceAvailable;
+    std::thread m_thread;
+
+    Q_DISABLE_COPY_MOVE(AsyncLogWriter)
+};
+
+QT_END_NAMESPACE_AM
+
+#endif // ASYNCLOGWRITER_H
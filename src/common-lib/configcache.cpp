@@ -5,12 +5,16 @@
 #include <QDebug>
 #include <QFile>
 #include <QFileInfo>
+#include <QSaveFile>
 #include <QStandardPaths>
 #include <QDataStream>
 #include <QCryptographicHash>
 #include <QElapsedTimer>
 #include <QBuffer>
 #include <QtConcurrent/QtConcurrent>
+#if defined(Q_OS_UNIX)
+#  include <sys/stat.h>
+#endif
 
 #include "configcache.h"
 #include "configcache_p.h"
@@ -25,37 +29,49 @@ constexpr int AM_PARALLEL_THRESHOLD = 1;
 
 QT_BEGIN_NAMESPACE_AM
 
+QDataStream &operator>>(QDataStream &ds, ConfigCacheFingerprint &fp)
+{
+    ds >> fp.m_size >> fp.m_mtime >> fp.m_ctime >> fp.m_inode;
+    return ds;
+}
+
+QDataStream &operator<<(QDataStream &ds, const ConfigCacheFingerprint &fp)
+{
+    ds << fp.m_size << fp.m_mtime << fp.m_ctime << fp.m_inode;
+    return ds;
+}
+
 QDataStream &operator>>(QDataStream &ds, ConfigCacheEntry &ce)
 {
-    bool contentValid = false;
-    ds >> ce.m_filePath >> ce.m_checksum >> contentValid;
+    ds >> ce.m_filePath >> ce.m_checksum >> ce.m_fingerprint;
     ce.m_rawContent.clear();
-    ce.m_content = contentValid ? reinterpret_cast<void *>(-1) : nullptr;
+    ce.m_cachedContent = { };
+    ce.m_content = nullptr;
     return ds;
 }
 
 QDataStream &operator<<(QDataStream &ds, const ConfigCacheEntry &ce)
 {
-    ds << ce.m_filePath << ce.m_checksum << static_cast<bool>(ce.m_content);
+    ds << ce.m_filePath << ce.m_checksum << ce.m_fingerprint;
     return ds;
 }
 
 QDataStream &operator>>(QDataStream &ds, CacheHeader &ch)
 {
-    ds >> ch.m_magic >> ch.m_version >> ch.m_typeId >> ch.m_typeVersion >> ch.m_baseName >> ch.m_entries;
+    ds >> ch.m_magic >> ch.m_version >> ch.m_typeId >> ch.m_typeVersion >> ch.m_entries >> ch.m_tableSize;
     return ds;
 }
 
 QDataStream &operator<<(QDataStream &ds, const CacheHeader &ch)
 {
-    ds << ch.m_magic << ch.m_version << ch.m_typeId << ch.m_typeVersion << ch.m_baseName << ch.m_entries;
+    ds << ch.m_magic << ch.m_version << ch.m_typeId << ch.m_typeVersion << ch.m_entries << ch.m_tableSize;
     return ds;
 }
 
 QDebug operator<<(QDebug dbg, const ConfigCacheEntry &ce)
 {
     dbg << "CacheEntry {\n  " << ce.m_filePath << "\n  " << ce.m_checksum.toHex() << "\n  valid:"
-        << (ce.m_content ? "yes" : "no") << ce.m_content
+        << (ce.hasContent() ? "yes" : "no") << ce.m_content
         << "\n}\n";
     return dbg;
 }
@@ -67,16 +83,46 @@ static quint32 makeTypeId(std::array<char, 4> typeIdStr)
            | (quint32(typeIdStr[2]) << 16) | (quint32(typeIdStr[3]) << 24);
 }
 
-bool CacheHeader::isValid(const QString &baseName, quint32 typeId, quint32 typeVersion) const
+bool CacheHeader::isValid(quint32 typeId, quint32 typeVersion) const
 {
     return m_magic == Magic
            && m_version == Version
            && m_typeId == typeId
            && m_typeVersion == typeVersion
-           && m_baseName == baseName
            && m_entries < 1000;
 }
 
+ConfigCacheFingerprint ConfigCacheFingerprint::fromFile(const QString &filePath)
+{
+    ConfigCacheFingerprint fp;
+
+    // resources do not have any meaningful meta-data: always fall back to hashing
+    if (filePath.startsWith(u':'))
+        return fp;
+
+#if defined(Q_OS_UNIX)
+    struct stat st;
+    if (::stat(QFile::encodeName(filePath).constData(), &st) == 0) {
+        fp.m_size = qint64(st.st_size);
+#  if defined(Q_OS_DARWIN)
+        fp.m_mtime = qint64(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+        fp.m_ctime = qint64(st.st_ctimespec.tv_sec) * 1000000000 + st.st_ctimespec.tv_nsec;
+#  else
+        fp.m_mtime = qint64(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+        fp.m_ctime = qint64(st.st_ctim.tv_sec) * 1000000000 + st.st_ctim.tv_nsec;
+#  endif
+        fp.m_inode = quint64(st.st_ino);
+    }
+#else
+    QFileInfo fi(filePath);
+    if (fi.exists()) {
+        fp.m_size = fi.size();
+        fp.m_mtime = fi.lastModified().toMSecsSinceEpoch() * 1000000;
+    }
+#endif
+    return fp;
+}
+
 
 AbstractConfigCache::AbstractConfigCache(const QStringList &configFiles, const QString &cacheBaseName,
                                          std::array<char, 4> typeId, quint32 version, Options options)
@@ -98,6 +144,28 @@ AbstractConfigCache::~AbstractConfigCache()
 void *AbstractConfigCache::takeMergedResult() const
 {
     Q_ASSERT(d->options & MergedResult);
+    if (!d->mergedContent && !d->cachedMergedContent.isEmpty()) {
+        auto *that = const_cast<AbstractConfigCache *>(this);
+        try {
+            d->mergedContent = that->loadFromCacheData(d->cachedMergedContent);
+        } catch (const Exception &e) {
+            qCWarning(LogCache) << "Failed to read merged cache content:" << e.what()
+                                << "- falling back to parsing the source files";
+            that->invalidateCacheFile();
+
+            for (const ConfigCacheEntry &ce : std::as_const(d->cache)) {
+                if (void *content = that->loadFromSourceFile(ce.m_filePath)) {
+                    if (!d->mergedContent) {
+                        d->mergedContent = content;
+                    } else {
+                        that->merge(d->mergedContent, content);
+                        that->destruct(content);
+                    }
+                }
+            }
+        }
+        d->cachedMergedContent = { };
+    }
     void *result = d->mergedContent;
     d->mergedContent = nullptr;
     return result;
@@ -107,8 +175,23 @@ void *AbstractConfigCache::takeResult(int index) const
 {
     Q_ASSERT(!(d->options & MergedResult));
     void *result = nullptr;
-    if (index >= 0 && index < d->cache.size())
-        std::swap(result, d->cache[index].m_content);
+    if (index >= 0 && index < d->cache.size()) {
+        ConfigCacheEntry &ce = d->cache[index];
+        if (!ce.m_content && !ce.m_cachedContent.isEmpty()) {
+            auto *that = const_cast<AbstractConfigCache *>(this);
+            const QByteArrayView cachedContent = std::exchange(ce.m_cachedContent, { });
+            try {
+                ce.m_content = that->loadFromCacheData(cachedContent);
+            } catch (const Exception &e) {
+                // the file on disk is fine, only its cached copy is broken: do not drop it
+                qCWarning(LogCache) << "Failed to read cache content for" << ce.m_filePath << ":" << e.what()
+                                    << "- falling back to parsing the source file";
+                that->invalidateCacheFile();
+                ce.m_content = that->loadFromSourceFile(ce.m_filePath);
+            }
+        }
+        std::swap(result, ce.m_content);
+    }
     return result;
 }
 
@@ -117,6 +200,63 @@ void *AbstractConfigCache::takeResult(const QString &rawFile) const
     return takeResult(d->cacheIndex.value(rawFile, -1));
 }
 
+void *AbstractConfigCache::loadFromCacheData(QByteArrayView data)
+{
+    QDataStream ds(QByteArray::fromRawData(data.constData(), data.size()));
+    void *content = loadFromCache(ds);
+    if (ds.status() != QDataStream::Ok) {
+        destruct(content);
+        throw Exception("failed to read cache content (%1)").arg(ds.status());
+    }
+    return content;
+}
+
+void *AbstractConfigCache::parseSourceContent(QByteArray &content, const QString &filePath)
+{
+    try {
+        QBuffer buffer(&content);
+        buffer.open(QIODevice::ReadOnly);
+        return loadFromSource(&buffer, filePath);
+    } catch (const Exception &e) {
+        if (!d->options.testFlag(IgnoreBroken))
+            throw Exception("Could not parse file '%1': %2").arg(filePath).arg(e.errorString());
+
+        qCWarning(LogCache, "Could not parse file '%s': %s (file will be ignored)",
+                  qPrintable(filePath), qPrintable(e.errorString()));
+        return nullptr;
+    }
+}
+
+void *AbstractConfigCache::loadFromSourceFile(const QString &filePath)
+{
+    QByteArray content;
+    try {
+        QFile file(filePath);
+        if (!file.open(QIODevice::ReadOnly))
+            throw Exception(file, "failed to open file for reading");
+        content = file.readAll();
+        preProcessSourceContent(content, filePath);
+    } catch (const Exception &e) {
+        if (!d->options.testFlag(IgnoreBroken))
+            throw;
+        qCWarning(LogCache) << "Could not read file" << filePath << ":" << e.what() << "(file will be ignored)";
+        return nullptr;
+    }
+    return parseSourceContent(content, filePath);
+}
+
+void AbstractConfigCache::invalidateCacheFile()
+{
+    if (d->options.testFlag(NoCache))
+        return;
+
+    // Even a cache written by parse() might contain the broken data, since contents that were
+    // not decoded are copied verbatim. Other processes might have the file mapped: unlinking it
+    // is safe, truncating it is not.
+    if (!QFile::remove(cacheFilePath()))
+        qCWarning(LogCache) << "Failed to remove the broken cache file" << cacheFilePath();
+}
+
 void AbstractConfigCache::parse()
 {
     clear();
@@ -140,50 +280,85 @@ void AbstractConfigCache::parse()
         rawFilePaths << path;
     }
 
-    QFile cacheFile(cacheFilePath());
+    const QString cacheFileName = cacheFilePath();
 
     QAtomicInt cacheIsValid = false;
     QAtomicInt cacheIsComplete = false;
+    QAtomicInt cacheNeedsUpdate = false;
 
     QVector<ConfigCacheEntry> cache;
     void *mergedContent = nullptr;
 
-    qCDebug(LogCache) << d->cacheBaseName << "cache file:" << cacheFile.fileName();
+    qCDebug(LogCache) << d->cacheBaseName << "cache file:" << cacheFileName;
     qCDebug(LogCache) << d->cacheBaseName << "read cache:" << ((d->options & (ClearCache | NoCache)) ? "no" : "yes")
                       << "/ write cache:" << ((d->options & NoCache) ? "no" : "yes");
     qCDebug(LogCache) << d->cacheBaseName << "reading:" << qPrintable(rawFilePaths.join(u", "_s));
 
     if (!d->options.testFlag(NoCache) && !d->options.testFlag(ClearCache)) {
-        if (cacheFile.open(QFile::ReadOnly)) {
+        auto cacheFile = std::make_unique<QFile>(cacheFileName);
+        if (cacheFile->open(QFile::ReadOnly)) {
             try {
-                QDataStream ds(&cacheFile);
+                // the mapping stays valid after closing the file, as long as the QFile is alive
+                const qint64 cacheFileSize = cacheFile->size();
+                if (uchar *mapped = (cacheFileSize > 0) ? cacheFile->map(0, cacheFileSize) : nullptr) {
+                    d->cacheData = QByteArray::fromRawData(reinterpret_cast<const char *>(mapped),
+                                                           cacheFileSize);
+                    cacheFile->close();
+                    d->mappedCacheFile = std::move(cacheFile);
+                } else {
+                    d->cacheData = cacheFile->readAll();
+                    cacheFile->close();
+                }
+
+                QDataStream ds(d->cacheData);
                 CacheHeader cacheHeader;
                 ds >> cacheHeader;
 
                 if (ds.status() != QDataStream::Ok)
                     throw Exception("failed to read cache header");
-                if (!cacheHeader.isValid(d->cacheBaseName, d->typeId, d->typeVersion))
+                if (!cacheHeader.isValid(d->typeId, d->typeVersion))
                     throw Exception("failed to parse cache header");
 
-                cache.resize(int(cacheHeader.m_entries));
-                for (int i = 0; i < int(cacheHeader.m_entries); ++i) {
-                    ConfigCacheEntry &ce = cache[i];
-                    ds >> ce;
-                    if (ce.m_content)
-                        ce.m_content = loadFromCache(ds);
-                }
-                if (d->options & MergedResult) {
-                    bool hasMerged = false;
-                    ds >> hasMerged;
-                    if (hasMerged)
-                        mergedContent = loadFromCache(ds);
+                const qsizetype contentOffset = qsizetype(CacheHeader::Size) + qsizetype(cacheHeader.m_tableSize);
+                if (contentOffset > d->cacheData.size())
+                    throw Exception("cache file is truncated");
+                const QByteArrayView allContent = QByteArrayView(d->cacheData).sliced(contentOffset);
+
+                auto contentView = [&allContent](quint64 offset, quint64 size) -> QByteArrayView {
+                    if (!size)
+                        return { };
+                    if ((offset > quint64(allContent.size())) || (size > (quint64(allContent.size()) - offset)))
+                        throw Exception("cache file is truncated");
+                    return allContent.sliced(qsizetype(offset), qsizetype(size));
+                };
+
+                QString baseName;
+                ds >> baseName;
+                if (baseName != d->cacheBaseName)
+                    throw Exception("failed to parse cache header");
 
-                    if (!mergedContent)
-                        throw Exception("failed to read merged cache content");
+                // only the table is deserialized here: the actual contents are decoded on demand
+                cache.resize(int(cacheHeader.m_entries));
+                for (ConfigCacheEntry &ce : cache) {
+                    quint64 offset = 0;
+                    quint64 size = 0;
+                    ds >> ce >> offset >> size;
+                    ce.m_cachedContent = contentView(offset, size);
                 }
+                quint64 mergedOffset = 0;
+                quint64 mergedSize = 0;
+                ds >> mergedOffset >> mergedSize;
 
                 if (ds.status() != QDataStream::Ok)
                     throw Exception("failed to read cache content (%1)").arg(ds.status());
+                if (ds.device()->pos() != contentOffset)
+                    throw Exception("failed to read cache content (table size mismatch)");
+
+                if (d->options & MergedResult) {
+                    d->cachedMergedContent = contentView(mergedOffset, mergedSize);
+                    if (d->cachedMergedContent.isEmpty())
+                        throw Exception("failed to read merged cache content");
+                }
 
                 cacheIsValid = true;
 
@@ -197,7 +372,7 @@ void AbstractConfigCache::parse()
                     for (int i = 0; i < rawFilePaths.count(); ++i) {
                         const ConfigCacheEntry &ce = cache.at(i);
 
-                        if ((rawFilePaths.at(i) != ce.m_filePath) || !ce.m_content)
+                        if ((rawFilePaths.at(i) != ce.m_filePath) || !ce.hasContent())
                             cacheIsComplete = false;
                     }
                 }
@@ -205,42 +380,41 @@ void AbstractConfigCache::parse()
 
             } catch (const Exception &e) {
                 qWarning(LogCache) << "Failed to read cache:" << e.what();
+
+                cache.clear();
+                d->cachedMergedContent = { };
+                d->cacheData.clear();
+                d->mappedCacheFile.reset();
             }
-            cacheFile.close();
         }
     } else if (d->options.testFlag(ClearCache)) {
-        cacheFile.remove();
+        QFile::remove(cacheFileName);
     }
 
     qCDebug(LogCache) << d->cacheBaseName << "valid:" << (cacheIsValid ? "yes" : "no")
                       << "/ complete:" << (cacheIsComplete ? "yes" : "no");
 
     if (!cacheIsComplete) {
-        // we need to pick the parts we can re-use
+        // we need to pick the parts we can re-use, using the cache's table keyed by file path
+        QHash<QString, int> cachedIndex;
+        cachedIndex.reserve(cache.size());
+        for (int i = 0; i < cache.size(); ++i) {
+            if (cache.at(i).hasContent())
+                cachedIndex.insert(cache.at(i).m_filePath, i);
+        }
 
         QVector<ConfigCacheEntry> newCache(rawFilePaths.size());
 
-        // we are iterating over n^2 entries in the worst case scenario -- we could reduce it to n
-        // by using a QHash or QMap, but that doesn't come for free either: especially given the
-        // low number of processed entries (well under 100 for app manifests; around a couple for
-        // config files)
         for (int i = 0; i < rawFilePaths.size(); ++i) {
             const QString &rawFilePath = rawFilePaths.at(i);
             ConfigCacheEntry &ce = newCache[i];
 
             // if we already got this file in the cache, then use the entry
-            bool found = false;
-            for (const auto &c : std::as_const(cache)) {
-                if ((c.m_filePath == rawFilePath) && c.m_content) {
-                    ce = c;
-                    found = true;
-                    qCDebug(LogCache) << d->cacheBaseName << "found cache entry for" << c.m_filePath;
-                    break;
-                }
-            }
-
-            // if it's not yet cached, then add it to the list
-            if (!found) {
+            if (int cachedPos = cachedIndex.value(rawFilePath, -1); cachedPos >= 0) {
+                ce = cache.at(cachedPos);
+                qCDebug(LogCache) << d->cacheBaseName << "found cache entry for" << ce.m_filePath;
+            } else {
+                // if it's not yet cached, then add it to the list
                 ce.m_filePath = rawFilePath;
                 qCDebug(LogCache) << d->cacheBaseName << "missing cache entry for" << rawFilePath;
             }
@@ -248,9 +422,21 @@ void AbstractConfigCache::parse()
         cache = newCache;
     }
 
+    const bool checkFingerprints = d->options.testFlag(CheckFingerprints);
+
     // reads a single config file and calculates its hash - defined as lambda to be usable
     // both via QtConcurrent and via std:for_each
-    auto readConfigFile = [&cacheIsComplete, this](ConfigCacheEntry &ce) {
+    auto readConfigFile = [&cacheIsComplete, &cacheNeedsUpdate, checkFingerprints, this](ConfigCacheEntry &ce) {
+        // the cheap check first: if the file's meta-data did not change, we can skip hashing
+        const auto fingerprint = ConfigCacheFingerprint::fromFile(ce.m_filePath);
+        const bool fingerprintMatches = fingerprint.isValid() && (fingerprint == ce.m_fingerprint);
+
+        if (checkFingerprints && fingerprintMatches && ce.hasContent()) {
+            ce.m_checksumMatches = true;
+            return;
+        }
+        ce.m_fingerprint = fingerprint;
+
         QFile file(ce.m_filePath);
         if (!file.open(QIODevice::ReadOnly))
             throw Exception("Failed to open file '%1' for reading.\n").arg(file.fileName());
@@ -265,12 +451,16 @@ void AbstractConfigCache::parse()
         ce.m_checksumMatches = (checksum == ce.m_checksum);
         ce.m_checksum = checksum;
         if (!ce.m_checksumMatches) {
-            if (ce.m_content) {
+            if (ce.hasContent()) {
                 qWarning(LogCache) << "Failed to read Cache: cached file checksums do not match";
                 destruct(ce.m_content);
                 ce.m_content = nullptr;
+                ce.m_cachedContent = { };
             }
             cacheIsComplete = false;
+        } else if (fingerprint.isValid() && !fingerprintMatches) {
+            // same content, but different meta-data: update the cache to skip the hashing next time
+            cacheNeedsUpdate = true;
         }
     };
 
@@ -286,32 +476,30 @@ void AbstractConfigCache::parse()
 
     if (!cacheIsComplete) {
         // we have read a partial cache or none at all - parse what's not cached yet
-        if (d->options & MergedResult) {
-            destruct(mergedContent);
-            mergedContent = nullptr;
-        }
+        if (d->options & MergedResult)
+            d->cachedMergedContent = { };
 
         QAtomicInt count;
 
         auto parseConfigFile = [this, &count](ConfigCacheEntry &ce) {
-            if (ce.m_content)
+            if (ce.hasContent()) {
+                // merging needs the actual content, so we cannot defer decoding the cache anymore
+                if (!ce.m_content && (d->options & MergedResult)) {
+                    const QByteArrayView cachedContent = std::exchange(ce.m_cachedContent, { });
+                    try {
+                        ce.m_content = loadFromCacheData(cachedContent);
+                    } catch (const Exception &e) {
+                        // the cache is rewritten below, using the freshly parsed content
+                        qCWarning(LogCache) << "Failed to read cache content for" << ce.m_filePath
+                                            << ":" << e.what() << "- falling back to parsing the source file";
+                        ce.m_content = loadFromSourceFile(ce.m_filePath);
+                    }
+                }
                 return;
+            }
 
             ++count;
-            try {
-                QBuffer buffer(&ce.m_rawContent);
-                buffer.open(QIODevice::ReadOnly);
-                ce.m_content = loadFromSource(&buffer, ce.m_filePath);
-            } catch (const Exception &e) {
-                if (d->options.testFlag(IgnoreBroken)) {
-                    qCWarning(LogCache, "Could not parse file '%s': %s (file will be ignored)",
-                              qPrintable(ce.m_filePath), qPrintable(e.errorString()));
-                    ce.m_content = nullptr;
-                } else {
-                    throw Exception("Could not parse file '%1': %2")
-                        .arg(ce.m_filePath).arg(e.errorString());
-                }
-            }
+            ce.m_content = parseSourceContent(ce.m_rawContent, ce.m_filePath);
         };
 
         // these can throw
@@ -335,49 +523,101 @@ void AbstractConfigCache::parse()
 
         qCDebug(LogCache) << d->cacheBaseName << "parsing" << count.loadAcquire()
                           << "file(s) finished after" << (timer.nsecsElapsed() / 1000) << "usec";
+    }
 
-        if (!d->options.testFlag(NoCache)) {
-            // everything is parsed now, so we can write a new cache file
-
-            try {
-                QFile newCacheFile(cacheFile.fileName());
-                if (!newCacheFile.open(QFile::WriteOnly | QFile::Truncate))
-                    throw Exception(cacheFile, "failed to open file for writing");
-
-                QDataStream ds(&newCacheFile);
-                CacheHeader cacheHeader;
-                cacheHeader.m_baseName = d->cacheBaseName;
-                cacheHeader.m_typeId = d->typeId;
-                cacheHeader.m_typeVersion = d->typeVersion;
-                cacheHeader.m_entries = quint32(cache.size());
-                ds << cacheHeader;
-
-                for (const ConfigCacheEntry &ce : std::as_const(cache)) {
-                    ds << ce;
-                    // qCDebug(LogCache) << "SAVING" << ce << ce.content;
-                    if (ce.m_content)
-                        saveToCache(ds, ce.m_content);
-                }
-
-                if (d->options & MergedResult) {
-                    ds << bool(mergedContent);
-                    if (mergedContent)
-                        saveToCache(ds, mergedContent);
+    if ((!cacheIsComplete || cacheNeedsUpdate) && !d->options.testFlag(NoCache)) {
+        // everything is parsed now, so we can write a new cache file
+
+        try {
+            // serialize the table and the contents separately, since the table needs to
+            // reference the contents via offsets. Contents that have not been decoded yet are
+            // copied verbatim from the old cache.
+            QByteArray tableData;
+            QByteArray contentData;
+            QVector<QPair<quint64, quint64>> cachedContentLocations(cache.size());
+            QPair<quint64, quint64> cachedMergedContentLocation;
+
+            {
+                QDataStream tds(&tableData, QIODevice::WriteOnly);
+                QDataStream cds(&contentData, QIODevice::WriteOnly);
+
+                auto writeContent = [&tds, &cds, this](const void *content, QByteArrayView cached) {
+                    const auto offset = quint64(cds.device()->pos());
+                    if (content)
+                        saveToCache(cds, content);
+                    else if (!cached.isEmpty())
+                        cds.writeRawData(cached.constData(), int(cached.size()));
+                    const auto size = quint64(cds.device()->pos()) - offset;
+                    tds << offset << size;
+                    return qMakePair(offset, size);
+                };
+
+                tds << d->cacheBaseName;
+                for (int i = 0; i < cache.size(); ++i) {
+                    const ConfigCacheEntry &ce = cache.at(i);
+                    tds << ce;
+                    cachedContentLocations[i] = writeContent(ce.m_content, ce.m_cachedContent);
                 }
+                cachedMergedContentLocation = writeContent(mergedContent, d->cachedMergedContent);
 
-                if (ds.status() != QDataStream::Ok)
+                if ((tds.status() != QDataStream::Ok) || (cds.status() != QDataStream::Ok))
                     throw Exception("error writing content");
+            }
 
-                d->cacheWasWritten = true;
-            } catch (const Exception &e) {
-                qCWarning(LogCache) << "Failed to write Cache:" << e.what();
+            CacheHeader cacheHeader;
+            cacheHeader.m_typeId = d->typeId;
+            cacheHeader.m_typeVersion = d->typeVersion;
+            cacheHeader.m_entries = quint32(cache.size());
+            cacheHeader.m_tableSize = quint32(tableData.size());
+
+            QByteArray newCacheData;
+            newCacheData.reserve(qsizetype(CacheHeader::Size) + tableData.size() + contentData.size());
+            {
+                QDataStream hds(&newCacheData, QIODevice::WriteOnly);
+                hds << cacheHeader;
+            }
+            Q_ASSERT(newCacheData.size() == qsizetype(CacheHeader::Size));
+            newCacheData.append(tableData).append(contentData);
+
+            // we are about to overwrite the (mapped) cache file: all contents that have not been
+            // decoded yet need to point into the new data first
+            const QByteArrayView allContent = QByteArrayView(newCacheData).sliced(qsizetype(CacheHeader::Size)
+                                                                                  + tableData.size());
+            for (int i = 0; i < cache.size(); ++i) {
+                ConfigCacheEntry &ce = cache[i];
+                if (!ce.m_cachedContent.isEmpty()) {
+                    ce.m_cachedContent = allContent.sliced(qsizetype(cachedContentLocations.at(i).first),
+                                                           qsizetype(cachedContentLocations.at(i).second));
+                }
+            }
+            if (!d->cachedMergedContent.isEmpty()) {
+                d->cachedMergedContent = allContent.sliced(qsizetype(cachedMergedContentLocation.first),
+                                                           qsizetype(cachedMergedContentLocation.second));
             }
-            qCDebug(LogCache) << d->cacheBaseName << "writing the cache finished after"
-                              << (timer.nsecsElapsed() / 1000) << "usec";
+            d->cacheData = newCacheData;
+            d->mappedCacheFile.reset();
+
+            // other processes might have the old cache file mapped: truncating it in place would
+            // get them killed by SIGBUS, so the new file is atomically renamed over the old one
+            QSaveFile newCacheFile(cacheFileName);
+            if (!newCacheFile.open(QFile::WriteOnly))
+                throw Exception(newCacheFile, "failed to open file for writing");
+            if (newCacheFile.write(newCacheData) != newCacheData.size())
+                throw Exception(newCacheFile, "error writing content");
+            if (!newCacheFile.commit())
+                throw Exception(newCacheFile, "failed to replace the old cache file");
+
+            d->cacheWasWritten = true;
+        } catch (const Exception &e) {
+            qCWarning(LogCache) << "Failed to write Cache:" << e.what();
         }
+        qCDebug(LogCache) << d->cacheBaseName << "writing the cache finished after"
+                          << (timer.nsecsElapsed() / 1000) << "usec";
     }
 
     d->cache = cache;
+    for (int i = 0; i < d->rawFiles.size(); ++i)
+        d->cacheIndex.insert(d->rawFiles.at(i), i);
     if (d->options & MergedResult)
         d->mergedContent = mergedContent;
 
@@ -393,6 +633,9 @@ void AbstractConfigCache::clear()
     d->cacheIndex.clear();
     destruct(d->mergedContent);
     d->mergedContent = nullptr;
+    d->cachedMergedContent = { };
+    d->cacheData.clear();
+    d->mappedCacheFile.reset();
     d->cacheWasRead = false;
     d->cacheWasWritten = false;
 }
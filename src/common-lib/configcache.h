@@ -13,6 +13,7 @@
 #include <QtCore/QStringList>
 #include <QtCore/QVariant>
 #include <QtCore/QIODevice>
+#include <QtCore/QByteArrayView>
 #include <QtAppManCommon/global.h>
 
 QT_BEGIN_NAMESPACE_AM
@@ -37,6 +38,10 @@ public:
         NoCache       = 0x2,
         ClearCache    = 0x4,
         IgnoreBroken  = 0x8,
+        // Skip re-hashing files whose size, modification time and inode did not change since the
+        // cache was written. Only safe, if preProcessSourceContent() does not depend on anything
+        // other than the file's content (e.g. environment variables).
+        CheckFingerprints = 0x10,
     };
     Q_DECLARE_FLAGS(Options, Option)
 
@@ -69,6 +74,11 @@ protected:
 private:
     Q_DISABLE_COPY_MOVE(AbstractConfigCache)
 
+    void *loadFromCacheData(QByteArrayView data);
+    void *parseSourceContent(QByteArray &content, const QString &filePath);
+    void *loadFromSourceFile(const QString &filePath);
+    void invalidateCacheFile();
+
     ConfigCachePrivate *d;
 };
 
@@ -5,32 +5,68 @@
 #ifndef CONFIGCACHE_P_H
 #define CONFIGCACHE_P_H
 
+#include <memory>
+
+#include <QtCore/QByteArrayView>
+#include <QtCore/QFile>
+#include <QtCore/QHash>
 #include "configcache.h"
 
 QT_BEGIN_NAMESPACE_AM
 
+// a cheap "has this file changed" check, which is done before the more expensive hashing
+struct ConfigCacheFingerprint
+{
+    qint64 m_size = -1;
+    qint64 m_mtime = 0; // nsecs since epoch (msecs precision on non-Unix)
+    qint64 m_ctime = 0; // nsecs since epoch (Unix only)
+    quint64 m_inode = 0;
+
+    bool isValid() const { return m_size >= 0; }
+    bool operator==(const ConfigCacheFingerprint &other) const
+    {
+        return m_size == other.m_size && m_mtime == other.m_mtime
+               && m_ctime == other.m_ctime && m_inode == other.m_inode;
+    }
+    bool operator!=(const ConfigCacheFingerprint &other) const { return !operator==(other); }
+
+    static ConfigCacheFingerprint fromFile(const QString &filePath);
+};
+
 struct ConfigCacheEntry
 {
     QString m_filePath;    // abs. file path
     QByteArray m_checksum; // sha1 (fast and sufficient for this use-case)
+    ConfigCacheFingerprint m_fingerprint;
     QByteArray m_rawContent;  // raw YAML m_content
+    QByteArrayView m_cachedContent; // serialized content in the (mapped) cache file, decoded on demand
     void *m_content = nullptr;  // parsed YAML content
     bool m_checksumMatches = false;
+
+    bool hasContent() const { return m_content || !m_cachedContent.isEmpty(); }
 };
 
+// The cache file layout is:
+//   - a fixed size CacheHeader
+//   - the entry table (m_tableSize bytes): the cache base name, followed by one record per
+//     file (path, checksum, fingerprint, offset and size of its serialized content) and the
+//     offset and size of the merged content
+//   - the serialized contents: offsets in the table are relative to the end of the table
+// This way the file can be mapped into memory and the contents can be deserialized lazily.
 struct CacheHeader
 {
     enum { Magic = 0x23d39366, // dd if=/dev/random bs=4 count=1 status=none | xxd -p
-           Version = 3 | (QT_VERSION_MAJOR << 24) };
+           Version = 4 | (QT_VERSION_MAJOR << 24),
+           Size = 6 * sizeof(quint32) };
 
     quint32 m_magic = Magic;
     quint32 m_version = Version;
     quint32 m_typeId = 0;
     quint32 m_typeVersion = 0;
-    QString m_baseName;
     quint32 m_entries = 0;
+    quint32 m_tableSize = 0;
 
-    bool isValid(const QString &baseName, quint32 typeId = 0, quint32 typeVersion = 0) const;
+    bool isValid(quint32 typeId = 0, quint32 typeVersion = 0) const;
 };
 
 class ConfigCachePrivate
@@ -42,8 +78,11 @@ public:
     QStringList rawFiles;
     QString cacheBaseName;
     QVector<ConfigCacheEntry> cache;
-    QMap<QString, int> cacheIndex;
+    QHash<QString, int> cacheIndex;
     void *mergedContent = nullptr;
+    QByteArrayView cachedMergedContent;
+    std::unique_ptr<QFile> mappedCacheFile; // keeps the mmap'ed cache file alive
+    QByteArray cacheData; // the complete cache file: either mapped, read or freshly written
     bool cacheWasRead = false;
     bool cacheWasWritten = false;
 };
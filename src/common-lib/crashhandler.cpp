@@ -577,6 +577,9 @@ static void crashHandler(const char *why, int stackFramesToIgnore)
     UnixSignalHandler::instance()->resetToDefault({ SIGFPE, SIGSEGV, SIGILL, SIGBUS,
                                                     SIGPIPE, SIGABRT, SIGINT, SIGQUIT, SIGSYS });
 
+    // get the log output that is still queued up out of the way, before printing the crash info
+    Logging::flushAsyncOutput();
+
     logCrashInfo(Console, why, stackFramesToIgnore);
 
     if (chg()->waitForGdbAttach > 0) {
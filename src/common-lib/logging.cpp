@@ -18,6 +18,13 @@
 
 #include <cstdio>
 
+#if defined(Q_OS_UNIX)
+#  include <atomic>
+#  include <memory>
+#  include <unistd.h>
+#  include "asynclogwriter.h"
+#endif
+
 #if defined(Q_OS_WINDOWS)
 #  include <windows.h>
 #elif defined(Q_OS_ANDROID)
@@ -38,6 +45,8 @@
 #  define QDLT_REGISTER_CONTEXT_ON_FIRST_USE(a)
 #endif
 
+using namespace Qt::StringLiterals;
+
 QT_BEGIN_NAMESPACE_AM
 
 #if QT_CONFIG(am_dltlogging)
@@ -169,6 +178,50 @@ struct LoggingGlobal
     QMutex deferredMessagesMutex;
     std::vector<DeferredMessage> deferredMessages;
 
+#if defined(Q_OS_UNIX)
+    // If set, the formatted console output is written by a dedicated thread, so that threads
+    // which log (e.g. the GUI or render thread) never block on a slow stderr.
+    // The pointer is only ever changed from the main thread during setup and teardown. Any
+    // thread using the writer registers itself in asyncLogWriterUsers, so that the writer is
+    // not destroyed while still in use.
+    std::unique_ptr<AsyncLogWriter> asyncLogWriterStorage;
+    std::atomic<AsyncLogWriter *> asyncLogWriter { nullptr };
+    std::atomic<int> asyncLogWriterUsers { 0 };
+
+    AsyncLogWriter *acquireAsyncLogWriter()
+    {
+        // seq_cst: either destroyAsyncLogWriter() sees our registration, or we see its nullptr
+        asyncLogWriterUsers.fetch_add(1, std::memory_order_seq_cst);
+        if (AsyncLogWriter *writer = asyncLogWriter.load(std::memory_order_seq_cst))
+            return writer;
+        asyncLogWriterUsers.fetch_sub(1, std::memory_order_release);
+        return nullptr;
+    }
+
+    void releaseAsyncLogWriter()
+    {
+        asyncLogWriterUsers.fetch_sub(1, std::memory_order_release);
+    }
+
+    void destroyAsyncLogWriter()
+    {
+        if (!asyncLogWriterStorage)
+            return;
+        asyncLogWriter.store(nullptr, std::memory_order_seq_cst);
+
+        // wait for in-flight users, but do not hang forever (e.g. at exit, when other threads
+        // might never be scheduled again): leaking the writer is the lesser evil in this case
+        for (int i = 0; asyncLogWriterUsers.load(std::memory_order_acquire); ++i) {
+            if (i == 1000) {
+                (void) asyncLogWriterStorage.release();
+                return;
+            }
+            QThread::usleep(1000);
+        }
+        asyncLogWriterStorage.reset(); // this will write out everything that is still queued
+    }
+#endif
+
     // As multiple threads may log at the same time, we need to decouple the output
     // buffers:
 
@@ -378,6 +431,18 @@ static void colorLogToStderr(QtMsgType msgType, const QMessageLogContext &contex
         return;
 #endif
     }
+#if defined(Q_OS_UNIX)
+    if (AsyncLogWriter *writer = lg()->acquireAsyncLogWriter()) {
+        // the buffer gets swapped with an empty one, so we don't need to copy
+        writer->post(logBuffer);
+
+        // make sure that a fatal message is visible before the process gets aborted
+        if (Q_UNLIKELY(msgType == QtFatalMsg))
+            writer->flush(1000);
+        lg()->releaseAsyncLogWriter();
+        return;
+    }
+#endif
     fputs(logBuffer.constData(), stderr);
 }
 
@@ -439,6 +504,10 @@ LoggingGlobal::~LoggingGlobal()
     // we are dead now, so make sure that anyone logging after this point will not crash the program
     if (defaultQtHandler)
         qInstallMessageHandler(defaultQtHandler);
+
+#if defined(Q_OS_UNIX)
+    destroyAsyncLogWriter();
+#endif
 }
 
 QStringList Logging::filterRules()
@@ -495,6 +564,63 @@ void Logging::completeSetup()
     }
 }
 
+bool Logging::isAsyncOutputEnabled()
+{
+#if defined(Q_OS_UNIX)
+    return lg()->asyncLogWriterStorage != nullptr;
+#else
+    return false;
+#endif
+}
+
+int Logging::asyncOutputQueueSize()
+{
+#if defined(Q_OS_UNIX)
+    if (const auto &writer = lg()->asyncLogWriterStorage)
+        return writer->queueSize();
+#endif
+    return 0;
+}
+
+QString Logging::asyncOutputOverflowPolicy()
+{
+#if defined(Q_OS_UNIX)
+    if (const auto &writer = lg()->asyncLogWriterStorage)
+        return (writer->overflowPolicy() == AsyncLogWriter::Block) ? u"block"_s : u"drop"_s;
+#endif
+    return { };
+}
+
+void Logging::setAsyncOutput(bool enabled, int queueSize, const QString &overflowPolicy)
+{
+#if defined(Q_OS_UNIX)
+    // the writer thread needs to be stopped first, as the new one would interleave its output
+    lg()->destroyAsyncLogWriter();
+    if (enabled && !lg()->noCustomLogging) {
+        const auto policy = (overflowPolicy == u"block") ? AsyncLogWriter::Block : AsyncLogWriter::Drop;
+        lg()->asyncLogWriterStorage = std::make_unique<AsyncLogWriter>(STDERR_FILENO, queueSize, policy);
+        lg()->asyncLogWriter.store(lg()->asyncLogWriterStorage.get(), std::memory_order_seq_cst);
+    }
+#else
+    Q_UNUSED(enabled)
+    Q_UNUSED(queueSize)
+    Q_UNUSED(overflowPolicy)
+#endif
+}
+
+void Logging::flushAsyncOutput()
+{
+#if defined(Q_OS_UNIX)
+    // this is called from the crash handler: no locks and no waiting for the writer thread
+    if (lg.exists()) {
+        if (AsyncLogWriter *writer = lg()->acquireAsyncLogWriter()) {
+            writer->emergencyFlush();
+            lg()->releaseAsyncLogWriter();
+        }
+    }
+#endif
+}
+
 QByteArray Logging::applicationId()
 {
     return lg()->applicationId;
@@ -55,6 +55,14 @@ public:
     static bool hasDeferredMessages();
     static void completeSetup();
 
+    // asynchronous console output (Unix only)
+    static bool isAsyncOutputEnabled();
+    static int asyncOutputQueueSize();
+    static QString asyncOutputOverflowPolicy();
+    static void setAsyncOutput(bool enabled, int queueSize = 1024,
+                               const QString &overflowPolicy = QString()); // "drop" (default) or "block"
+    static void flushAsyncOutput(); // async-signal-safe: only meant for the crash handler
+
     static QByteArray applicationId();
     static void setApplicationId(const QByteArray &appId);
 
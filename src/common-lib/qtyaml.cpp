@@ -6,7 +6,6 @@
 #include <charconv>
 
 #include <QVariant>
-#include <QRegularExpression>
 #include <QDebug>
 #include <QtNumeric>
 #include <QFileInfo>
@@ -36,52 +35,52 @@ enum ValueIndex {
 
 struct StaticMapping
 {
-    QString text;
+    QByteArrayView text;
     ValueIndex index = ValueNull;
 };
 
 static const StaticMapping staticMappings[] = { // keep this sorted for bsearch !!
-    { u".INF"_s,  ValueInf },
-    { u".Inf"_s,  ValueInf },
-    { u".NAN"_s,  ValueNaN },
-    { u".NaN"_s,  ValueNaN },
-    { u".inf"_s,  ValueInf },
-    { u".nan"_s,  ValueNaN },
-    { u"FALSE"_s, ValueFalse },
-    { u"False"_s, ValueFalse },
-    { u"N"_s,     ValueFalse },
-    { u"NO"_s,    ValueFalse },
-    { u"NULL"_s,  ValueNull },
-    { u"No"_s,    ValueFalse },
-    { u"Null"_s,  ValueNull },
-    { u"OFF"_s,   ValueFalse },
-    { u"Off"_s,   ValueFalse },
-    { u"ON"_s,    ValueTrue },
-    { u"On"_s,    ValueTrue },
-    { u"TRUE"_s,  ValueTrue },
-    { u"True"_s,  ValueTrue },
-    { u"Y"_s,     ValueTrue },
-    { u"YES"_s,   ValueTrue },
-    { u"Yes"_s,   ValueTrue },
-    { u"false"_s, ValueFalse },
-    { u"n"_s,     ValueFalse },
-    { u"no"_s,    ValueFalse },
-    { u"null"_s,  ValueNull },
-    { u"off"_s,   ValueFalse },
-    { u"on"_s,    ValueTrue },
-    { u"true"_s,  ValueTrue },
-    { u"y"_s,     ValueTrue },
-    { u"yes"_s,   ValueTrue },
-    { u"~"_s,     ValueNull }
+    { ".INF",  ValueInf },
+    { ".Inf",  ValueInf },
+    { ".NAN",  ValueNaN },
+    { ".NaN",  ValueNaN },
+    { ".inf",  ValueInf },
+    { ".nan",  ValueNaN },
+    { "FALSE", ValueFalse },
+    { "False", ValueFalse },
+    { "N",     ValueFalse },
+    { "NO",    ValueFalse },
+    { "NULL",  ValueNull },
+    { "No",    ValueFalse },
+    { "Null",  ValueNull },
+    { "OFF",   ValueFalse },
+    { "Off",   ValueFalse },
+    { "ON",    ValueTrue },
+    { "On",    ValueTrue },
+    { "TRUE",  ValueTrue },
+    { "True",  ValueTrue },
+    { "Y",     ValueTrue },
+    { "YES",   ValueTrue },
+    { "Yes",   ValueTrue },
+    { "false", ValueFalse },
+    { "n",     ValueFalse },
+    { "no",    ValueFalse },
+    { "null",  ValueNull },
+    { "off",   ValueFalse },
+    { "on",    ValueTrue },
+    { "true",  ValueTrue },
+    { "y",     ValueTrue },
+    { "yes",   ValueTrue },
+    { "~",     ValueNull }
 };
 
 
-static inline StaticMapping *findStaticMapping(const QString &str)
+static inline StaticMapping *findStaticMapping(QByteArrayView str)
 {
-    static const QString firstCharStaticMappings = u".FNOTYfnoty~"_s;
-    const QChar firstChar = str.isEmpty() ? QChar(0) : str.at(0);
+    static const QByteArrayView firstCharStaticMappings = ".FNOTYfnoty~";
+    const char firstChar = str.isEmpty() ? char(0) : str.at(0);
 
-    if (firstCharStaticMappings.contains(firstChar)) { // cheap check to avoid expensive bsearch
+    if (firstChar && firstCharStaticMappings.contains(firstChar)) { // cheap check to avoid expensive bsearch
         StaticMapping key { str, ValueNull };
         auto found = bsearch(&key,
                              staticMappings,
@@ -96,6 +95,120 @@ static inline StaticMapping *findStaticMapping(const QString &str)
     return nullptr;
 };
 
+static inline int digitValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    else if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    else if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return 99;
+}
+
+// A single pass parser for the YAML 1.1 number formats, which is equivalent to matching against
+// these regular expressions and then converting via QString::toLongLong() or toDouble():
+//   decimal:      [-+]?(0|[1-9][0-9_]*)
+//   float:        [-+]?([0-9][0-9_]*)?\.[0-9.]*([eE][-+][0-9]+)?
+//   hexadecimal:  [-+]?0x[0-9a-fA-F_]+
+//   binary:       [-+]?0b[0-1_]+
+//   octal:        [-+]?0[0-7_]+
+// Returns an invalid QVariant, if str is not a number (or if it is out of range).
+static QVariant parseNumber(QByteArrayView str)
+{
+    const qsizetype len = str.size();
+    qsizetype pos = 0;
+    bool negative = false;
+
+    if ((pos < len) && ((str.at(pos) == '+') || (str.at(pos) == '-')))
+        negative = (str.at(pos++) == '-');
+    if (pos == len)
+        return { };
+
+    int base = 10;
+    qsizetype digitsBegin = pos;
+
+    if ((str.at(pos) == '0') && (pos + 1 < len) && ((str.at(pos + 1) == 'x') || (str.at(pos + 1) == 'b'))) {
+        base = (str.at(pos + 1) == 'x') ? 16 : 2;
+        digitsBegin = pos + 2;
+        if (digitsBegin == len)
+            return { };
+        for (qsizetype i = digitsBegin; i < len; ++i) {
+            if ((str.at(i) != '_') && (digitValue(str.at(i)) >= base))
+                return { };
+        }
+    } else {
+        qsizetype i = pos;
+        while ((i < len) && ((str.at(i) >= '0' && str.at(i) <= '9') || ((i > pos) && (str.at(i) == '_'))))
+            ++i;
+
+        if ((i < len) && (str.at(i) == '.')) {
+            // the fractional part and the optional exponent
+            for (++i; (i < len) && ((str.at(i) >= '0' && str.at(i) <= '9') || (str.at(i) == '.')); ++i)
+                ;
+            if ((i < len) && ((str.at(i) == 'e') || (str.at(i) == 'E'))) {
+                if ((++i == len) || ((str.at(i) != '+') && (str.at(i) != '-')))
+                    return { };
+                if (++i == len)
+                    return { };
+                for ( ; (i < len) && (str.at(i) >= '0' && str.at(i) <= '9'); ++i)
+                    ;
+            }
+            if (i != len)
+                return { };
+
+            bool ok = false;
+            double d = 0;
+            if (str.contains('_')) {
+                QByteArray stripped = str.toByteArray();
+                d = stripped.replace('_', QByteArrayView()).toDouble(&ok);
+            } else {
+                d = str.toDouble(&ok);
+            }
+            return ok ? QVariant(d) : QVariant { };
+        }
+        if ((i != len) || (i == pos))
+            return { };
+
+        if ((str.at(pos) == '0') && (len - pos > 1)) {
+            base = 8;
+            for (qsizetype j = pos + 1; j < len; ++j) {
+                if ((str.at(j) != '_') && (str.at(j) > '7'))
+                    return { };
+            }
+        }
+    }
+
+    quint64 magnitude = 0;
+    int digitCount = 0;
+    for (qsizetype i = digitsBegin; i < len; ++i) {
+        if (str.at(i) == '_')
+            continue;
+        const auto digit = quint64(digitValue(str.at(i)));
+        if (magnitude > (std::numeric_limits<quint64>::max() - digit) / quint64(base))
+            return { }; // overflow
+        magnitude = magnitude * quint64(base) + digit;
+        ++digitCount;
+    }
+    if (!digitCount)
+        return { };
+
+    qint64 s64;
+    if (!negative && (magnitude <= quint64(std::numeric_limits<qint64>::max())))
+        s64 = qint64(magnitude);
+    else if (negative && (magnitude <= quint64(std::numeric_limits<qint64>::max()) + 1))
+        s64 = qint64(0 - magnitude);
+    else if (!negative)
+        return QVariant(magnitude);
+    else
+        return { };
+
+    // this mirrors the historic behavior: everything up to INT_MAX is reported as an int
+    if (s64 <= std::numeric_limits<qint32>::max())
+        return QVariant(qint32(s64));
+    return QVariant(s64);
+}
+
 
 static inline void yerr(int result) noexcept(false)
 {
@@ -165,13 +278,14 @@ static void emitYaml(yaml_emitter_t *e, const QVariant &value, YamlStyle style)
             const QString &key = it.key();
             // We could just quote everything, but this would break backwards compatibility
             // inside the AM itself (e.g. HMAC calculations for installation-report.yaml)
-            bool needsQuoting = key.isEmpty() || findStaticMapping(key);
+            const QByteArray utf8Key = key.toUtf8();
+            bool needsQuoting = utf8Key.isEmpty() || findStaticMapping(utf8Key);
             if (!needsQuoting) {
-                char16_t firstChar = key.at(0).unicode();
-                needsQuoting = ((firstChar >= u'0' && firstChar <= u'9')
-                                || firstChar == u'+' || firstChar == u'-' || firstChar == u'.');
+                char firstChar = utf8Key.at(0);
+                needsQuoting = ((firstChar >= '0' && firstChar <= '9')
+                                || firstChar == '+' || firstChar == '-' || firstChar == '.');
             }
-            emitYamlScalar(e, key.toUtf8(), needsQuoting);
+            emitYamlScalar(e, utf8Key, needsQuoting);
             emitYaml(e, it.value(), style);
         }
 
@@ -488,11 +602,9 @@ QVariant YamlParser::parseScalar()
     if (!isScalar())
         throw YamlParserException(this, "Cannot parse non-scalar as scalar");
 
-    QString scalar = parseString();
-
     if (d->event.data.scalar.style == YAML_SINGLE_QUOTED_SCALAR_STYLE
         || d->event.data.scalar.style == YAML_DOUBLE_QUOTED_SCALAR_STYLE) {
-        return scalar;
+        return parseString();
     }
 
     static const QVariant staticValues[] = {
@@ -503,70 +615,25 @@ QVariant YamlParser::parseScalar()
         QVariant(qInf()),              // ValueInf
     };
 
+    // classify the scalar directly on libyaml's UTF-8 buffer: a QString is only created, if the
+    // scalar really is a string
+    const QByteArrayView scalar(reinterpret_cast<const char *>(d->event.data.scalar.value),
+                                qsizetype(d->event.data.scalar.length));
+
     if (scalar.isEmpty())
         return staticValues[ValueNull];
 
     if (auto sm = findStaticMapping(scalar))
         return staticValues[sm->index];
 
-    char16_t firstChar = scalar.at(0).unicode();
-    if ((firstChar >= u'0' && firstChar <= u'9')   // cheap check to avoid expensive regexps
-            || firstChar == u'+' || firstChar == u'-' || firstChar == u'.') {
-        // We are using QRegularExpressions in multiple threads here, although the class is not
-        // marked thread-safe. We are relying on the const match() function to behave thread-safe
-        // which it does. There's an autotest (tst_yaml / parallel) to make sure we catch changes
-        // in the internal implementation in the future.
-        // The easiest way would be to deep-copy the objects into TLS instances, but
-        // QRegularExpression is lacking such a functionality. Creating all the objects from
-        // scratch in every thread is expensive though, so we count on match() being thread-safe.
-        static const QRegularExpression numberRegExps[] = {
-            QRegularExpression(u"\\A[-+]?(0|[1-9][0-9_]*)\\z"_s), // decimal
-            QRegularExpression(u"\\A[-+]?([0-9][0-9_]*)?\\.[0-9.]*([eE][-+][0-9]+)?\\z"_s), // float
-            QRegularExpression(u"\\A[-+]?0x[0-9a-fA-F_]+\\z"_s),  // hexadecimal
-            QRegularExpression(u"\\A[-+]?0b[0-1_]+\\z"_s),        // binary
-            QRegularExpression(u"\\A[-+]?0[0-7_]+\\z"_s),         // octal
-        };
-        for (size_t numberIndex = 0; numberIndex < (sizeof(numberRegExps) / sizeof(*numberRegExps)); ++numberIndex) {
-            if (numberRegExps[numberIndex].match(scalar).hasMatch()) {
-                bool ok = false;
-                QVariant val;
-
-                // YAML allows _ as a grouping separator
-                if (scalar.contains(u'_'))
-                    scalar = scalar.replace(u'_', u""_s);
-
-                if (numberIndex == 1) {
-                    val = scalar.toDouble(&ok);
-                } else {
-                    int base = 10;
-
-                    switch (numberIndex) {
-                    case 0: base = 10; break;
-                    case 2: base = 16; break;
-                    case 3: base = 2; scalar.replace(u"0b"_s, u""_s); break; // Qt chokes on 0b
-                    case 4: base = 8; break;
-                    }
-
-                    qint64 s64 = scalar.toLongLong(&ok, base);
-                    if (ok && (s64 <= std::numeric_limits<qint32>::max())) {
-                        val = qint32(s64);
-                    } else if (ok) {
-                        val = s64;
-                    } else {
-                        quint64 u64 = scalar.toULongLong(&ok, base);
-
-                        if (ok && (u64 <= std::numeric_limits<quint32>::max()))
-                            val = quint32(u64);
-                        else if (ok)
-                            val = u64;
-                    }
-                }
-                if (ok)
-                    return val;
-            }
-        }
+    const char firstChar = scalar.at(0);
+    if ((firstChar >= '0' && firstChar <= '9')   // cheap check to avoid the number parser
+            || firstChar == '+' || firstChar == '-' || firstChar == '.') {
+        QVariant number = parseNumber(scalar);
+        if (number.isValid())
+            return number;
     }
-    return scalar;
+    return parseString();
 }
 
 bool YamlParser::isMap() const
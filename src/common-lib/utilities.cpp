@@ -12,6 +12,9 @@
 #include <QPluginLoader>
 #include <QQmlContext>
 #include <QQmlEngine>
+#include <QCborValue>
+#include <QCborMap>
+#include <QScopeGuard>
 #include <qplatformdefs.h>
 
 #include "utilities.h"
@@ -21,6 +24,11 @@
 
 #if defined(Q_OS_UNIX)
 #  include <unistd.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#endif
+#if defined(Q_OS_LINUX)
+#  include <fcntl.h>
 #endif
 #if defined(Q_OS_WIN)
 #  include <windows.h>
@@ -350,6 +358,69 @@ void validateIdForFilesystemUsage(const QString &id)  noexcept(false)
         throw Exception(Error::Parse, "must not consist of only white-space characters");
 }
 
+int createSealedMemfd(const char *name, const QByteArray &data) noexcept(false)
+{
+#if defined(Q_OS_LINUX)
+    int fd = ::memfd_create(name, MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0)
+        throw Exception(errno, "could not create memfd %1").arg(name);
+
+    const char *ptr = data.constData();
+    qsizetype todo = data.size();
+    while (todo > 0) {
+        auto written = QT_WRITE(fd, ptr, size_t(todo));
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            int err = errno;
+            QT_CLOSE(fd);
+            throw Exception(err, "could not write to memfd %1").arg(name);
+        }
+        ptr += written;
+        todo -= written;
+    }
+    if (::fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) != 0) {
+        int err = errno;
+        QT_CLOSE(fd);
+        throw Exception(err, "could not seal memfd %1").arg(name);
+    }
+    return fd;
+#else
+    Q_UNUSED(data)
+    throw Exception("memfds are not supported on this platform (%1)").arg(name);
+#endif
+}
+
+QVariantMap variantMapFromCborFileDescriptor(int fd) noexcept(false)
+{
+#if defined(Q_OS_UNIX)
+    QT_STATBUF statBuf;
+    if (QT_FSTAT(fd, &statBuf) != 0)
+        throw Exception(errno, "could not stat file descriptor %1").arg(fd);
+    const auto size = size_t(statBuf.st_size);
+    if (!size)
+        return { };
+
+    void *map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED)
+        throw Exception(errno, "could not map file descriptor %1").arg(fd);
+
+    auto unmap = qScopeGuard([=]() { ::munmap(map, size); });
+
+    QCborParserError parseError;
+    const QCborValue cbor = QCborValue::fromCbor(QByteArray::fromRawData(static_cast<const char *>(map),
+                                                                         qsizetype(size)), &parseError);
+    if (parseError.error != QCborError::NoError)
+        throw Exception("could not decode the CBOR data: %1").arg(parseError.errorString());
+    if (!cbor.isMap())
+        throw Exception("the CBOR data is not a map");
+    return cbor.toMap().toVariantMap();
+#else
+    Q_UNUSED(fd)
+    throw Exception("mapping file descriptors is not supported on this platform");
+#endif
+}
+
 QT_END_NAMESPACE_AM
 
 #if QT_VERSION < QT_VERSION_CHECK(6, 6, 0)
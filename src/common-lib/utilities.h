@@ -128,6 +128,12 @@ void closeAndClearFileDescriptors(QVector<int> &fdList);
 // make sure that the given id can be used as a filename
 void validateIdForFilesystemUsage(const QString &id) noexcept(false);
 
+// Linux only: store data in a sealed, read-only memfd (created with close-on-exec)
+int createSealedMemfd(const char *name, const QByteArray &data) noexcept(false);
+
+// map the file descriptor and decode its CBOR encoded contents
+QVariantMap variantMapFromCborFileDescriptor(int fd) noexcept(false);
+
 QT_END_NAMESPACE_AM
 
 
@@ -95,17 +95,27 @@ DBusDaemonProcess::~DBusDaemonProcess()
 
 void DBusDaemonProcess::start() noexcept(false)
 {
-    static const int timeout = 10000 * int(timeoutFactor());
+    launch()->waitForBusAddress();
+}
 
+DBusDaemonProcess *DBusDaemonProcess::launch()
+{
     qunsetenv("DBUS_SESSION_BUS_ADDRESS");
 
     auto dbusDaemon = new DBusDaemonProcess(qApp);
     dbusDaemon->QProcess::start(QIODevice::ReadOnly);
-    if (!dbusDaemon->waitForStarted(timeout) || !dbusDaemon->waitForReadyRead(timeout)) {
+    return dbusDaemon;
+}
+
+void DBusDaemonProcess::waitForBusAddress() noexcept(false)
+{
+    static const int timeout = 10000 * int(timeoutFactor());
+
+    if (!waitForStarted(timeout) || !waitForReadyRead(timeout)) {
         throw Exception("could not start a dbus-daemon process (%1): %2")
-                .arg(dbusDaemon->program(), dbusDaemon->errorString());
+                .arg(program(), errorString());
     }
-    QByteArray busAddress = dbusDaemon->readAllStandardOutput().trimmed();
+    QByteArray busAddress = readAllStandardOutput().trimmed();
 
     qputenv("DBUS_SESSION_BUS_ADDRESS", busAddress);
     qCInfo(LogDBus, "NOTICE: running on private D-Bus session bus to avoid conflicts:");
@@ -18,6 +18,10 @@ public:
     ~DBusDaemonProcess() override;
 
     static void start() noexcept(false);
+
+    // split version of start(), so that the daemon can boot while the System UI is set up
+    static DBusDaemonProcess *launch();
+    void waitForBusAddress() noexcept(false);
 };
 
 QT_END_NAMESPACE_AM
@@ -10,6 +10,7 @@
 #include <QDBusMessage>
 #include <QDBusContext>
 #include <QDBusAbstractAdaptor>
+#include <QDBusReply>
 #include <QMetaMethod>
 #include <algorithm>
 
@@ -28,6 +29,8 @@ DBusPolicy *DBusPolicy::s_instance = nullptr;
 DBusPolicy::~DBusPolicy()
 {
     Q_ASSERT(s_instance == this);
+    for (const auto &watch : std::as_const(m_nameOwnerWatches))
+        QObject::disconnect(watch);
     s_instance = nullptr;
 }
 
@@ -116,19 +119,31 @@ bool DBusPolicy::check(const QDBusAbstractAdaptor *dbusAdaptor, const QByteArray
         return true;
 
     try {
-        uint pid = uint(-1);
+        PeerCredentials &peer = peerCredentials(dbusContext);
 
         if (!ip->m_capabilities.isEmpty()) {
             if (!m_capabilitiesForApplicationId || !m_applicationIdsForPid)
                 return false;
 
-            pid = dbusContext->connection().interface()->servicePid(dbusContext->message().service());
+            QStringList unassignedCaps;
+            if (!peer.m_applicationId) {
+                const QStringList apps = m_applicationIdsForPid(peerPid(dbusContext, peer));
+                if (apps.size() > 1)
+                    throw Exception("multiple apps per pid are not supported");
+                const QString appId = !apps.isEmpty() ? apps.constFirst() : QString();
+                QStringList caps = m_capabilitiesForApplicationId(appId);
+                caps.sort();
 
-            const QStringList apps = m_applicationIdsForPid(pid);
-            if (apps.size() > 1)
-                throw Exception("multiple apps per pid are not supported");
-            const QString appId = !apps.isEmpty() ? apps.constFirst() : QString();
-            const QStringList appCaps = m_capabilitiesForApplicationId(appId);
+                // A quick-launcher process is connected before it gets an application assigned,
+                // so only remember the capabilities once the pid has been identified.
+                if (appId.isEmpty()) {
+                    unassignedCaps = caps;
+                } else {
+                    peer.m_applicationId = appId;
+                    peer.m_capabilities = caps;
+                }
+            }
+            const QStringList &appCaps = peer.m_applicationId ? peer.m_capabilities : unassignedCaps;
             bool match = false;
             for (const QString &cap : ip->m_capabilities)
                 match = match && std::binary_search(appCaps.cbegin(), appCaps.cend(), cap);
@@ -137,19 +152,20 @@ bool DBusPolicy::check(const QDBusAbstractAdaptor *dbusAdaptor, const QByteArray
         }
         if (!ip->m_executables.isEmpty()) {
 #  if defined(Q_OS_LINUX)
-            if (pid == uint(-1))
-                pid = dbusContext->connection().interface()->servicePid(dbusContext->message().service());
-            QString executable = QFileInfo(u"/proc/"_s + QString::number(pid) + u"/exe"_s).symLinkTarget();
-            if (executable.isEmpty())
+            if (peer.m_executable.isEmpty()) {
+                const uint pid = peerPid(dbusContext, peer);
+                peer.m_executable = QFileInfo(u"/proc/"_s + QString::number(pid) + u"/exe"_s).symLinkTarget();
+            }
+            if (peer.m_executable.isEmpty())
                 throw Exception("cannot get executable");
-            if (std::binary_search(ip->m_executables.cbegin(), ip->m_executables.cend(), executable))
+            if (std::binary_search(ip->m_executables.cbegin(), ip->m_executables.cend(), peer.m_executable))
                 throw Exception("executable blocked");
 #  else
             throw Exception("the executables policy is not supported on this platform");
 #  endif // defined(Q_OS_LINUX)
         }
         if (!ip->m_uids.isEmpty()) {
-            uint uid = dbusContext->connection().interface()->serviceUid(dbusContext->message().service());
+            const uint uid = peerUid(dbusContext, peer);
             if (std::binary_search(ip->m_uids.cbegin(), ip->m_uids.cend(), uid))
                 throw Exception("uid blocked");
         }
@@ -164,4 +180,102 @@ bool DBusPolicy::check(const QDBusAbstractAdaptor *dbusAdaptor, const QByteArray
 
 }
 
+quint64 DBusPolicy::credentialCacheHits() const
+{
+    return m_cacheHits;
+}
+
+quint64 DBusPolicy::credentialCacheMisses() const
+{
+    return m_cacheMisses;
+}
+
+qsizetype DBusPolicy::credentialCacheSize() const
+{
+    return m_credentialCache.size();
+}
+
+void DBusPolicy::clearCredentialCache()
+{
+    m_credentialCache.clear();
+}
+
+// The pid of a peer stays the same, but the capabilities of its application can change when
+// the package gets updated or removed. The next check() will then look them up again.
+
+void DBusPolicy::invalidateApplication(const QString &applicationId)
+{
+    for (auto &peer : m_credentialCache) {
+        if (peer.m_applicationId && (*peer.m_applicationId == applicationId)) {
+            peer.m_applicationId.reset();
+            peer.m_capabilities.clear();
+        }
+    }
+}
+
+// The credentials of a D-Bus peer cannot change while it is connected: the bus daemon never
+// re-uses unique names, so we can cache them until the name is released (NameOwnerChanged).
+// Peer-to-peer connections have no unique name and are always resolved on the fly.
+
+DBusPolicy::PeerCredentials &DBusPolicy::peerCredentials(const QDBusContext *dbusContext)
+{
+    const QString service = dbusContext->message().service();
+    if (!service.startsWith(u':')) {
+        m_uncachedCredentials = { };
+        return m_uncachedCredentials;
+    }
+
+    const QDBusConnection connection = dbusContext->connection();
+    const QString key = connection.name() + u'\n' + service;
+    auto it = m_credentialCache.find(key);
+    if (it == m_credentialCache.end()) {
+        watchNameOwnerChanges(connection);
+        it = m_credentialCache.insert(key, { });
+    }
+    return *it;
+}
+
+uint DBusPolicy::peerPid(const QDBusContext *dbusContext, PeerCredentials &peer)
+{
+    if (peer.m_pid) {
+        ++m_cacheHits;
+        return *peer.m_pid;
+    }
+    ++m_cacheMisses;
+    const QDBusReply<uint> reply = dbusContext->connection().interface()->servicePid(dbusContext->message().service());
+    if (reply.isValid())
+        peer.m_pid = reply.value();
+    return reply.value();
+}
+
+uint DBusPolicy::peerUid(const QDBusContext *dbusContext, PeerCredentials &peer)
+{
+    if (peer.m_uid) {
+        ++m_cacheHits;
+        return *peer.m_uid;
+    }
+    ++m_cacheMisses;
+    const QDBusReply<uint> reply = dbusContext->connection().interface()->serviceUid(dbusContext->message().service());
+    if (reply.isValid())
+        peer.m_uid = reply.value();
+    return reply.value();
+}
+
+void DBusPolicy::watchNameOwnerChanges(const QDBusConnection &connection)
+{
+    const QString connectionName = connection.name();
+    if (m_nameOwnerWatches.contains(connectionName))
+        return;
+    auto *iface = connection.interface();
+    if (!iface)
+        return;
+
+    m_nameOwnerWatches.insert(connectionName, QObject::connect(iface, &QDBusConnectionInterface::serviceOwnerChanged,
+                                                               iface, [this, connectionName](const QString &name,
+                                                                       const QString &, const QString &newOwner) {
+        if (newOwner.isEmpty() && name.startsWith(u':'))
+            m_credentialCache.remove(connectionName + u'\n' + name);
+    }));
+}
+
 QT_END_NAMESPACE_AM
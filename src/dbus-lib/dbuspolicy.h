@@ -7,12 +7,17 @@
 #define DBUSPOLICY_H
 
 #include <functional>
+#include <optional>
 
 #include <QtAppManCommon/global.h>
 #include <QtCore/QVariantMap>
 #include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QObject>
 
 QT_FORWARD_DECLARE_CLASS(QDBusAbstractAdaptor)
+QT_FORWARD_DECLARE_CLASS(QDBusConnection)
+QT_FORWARD_DECLARE_CLASS(QDBusContext)
 
 QT_BEGIN_NAMESPACE_AM
 
@@ -27,11 +32,30 @@ public:
     bool add(const QDBusAbstractAdaptor *dbusAdaptor, const QVariantMap &yamlFragment);
     bool check(const QDBusAbstractAdaptor *dbusAdaptor, const QByteArray &function);
 
+    quint64 credentialCacheHits() const;
+    quint64 credentialCacheMisses() const;
+    qsizetype credentialCacheSize() const;
+    void clearCredentialCache();
+    void invalidateApplication(const QString &applicationId);
+
 private:
     Q_DISABLE_COPY_MOVE(DBusPolicy)
     DBusPolicy() = default;
     static DBusPolicy *s_instance;
 
+    struct PeerCredentials
+    {
+        std::optional<uint> m_pid;
+        std::optional<uint> m_uid;
+        QString m_executable;
+        std::optional<QString> m_applicationId;
+        QStringList m_capabilities; // sorted
+    };
+    PeerCredentials &peerCredentials(const QDBusContext *dbusContext);
+    uint peerPid(const QDBusContext *dbusContext, PeerCredentials &peer);
+    uint peerUid(const QDBusContext *dbusContext, PeerCredentials &peer);
+    void watchNameOwnerChanges(const QDBusConnection &connection);
+
     std::function<QStringList(qint64)> m_applicationIdsForPid;
     std::function<QStringList(const QString &)> m_capabilitiesForApplicationId;
 
@@ -42,6 +66,13 @@ private:
         QStringList m_capabilities;
     };
     QHash<const QDBusAbstractAdaptor *, QMap<QByteArray, DBusPolicyEntry>> m_policies;
+
+    // keyed by connection name + '\n' + unique bus name of the caller
+    QHash<QString, PeerCredentials> m_credentialCache;
+    PeerCredentials m_uncachedCredentials;
+    QHash<QString, QMetaObject::Connection> m_nameOwnerWatches;
+    quint64 m_cacheHits = 0;
+    quint64 m_cacheMisses = 0;
 };
 
 QT_END_NAMESPACE_AM
@@ -5,14 +5,125 @@
 
 #include "intent.h"
 #include "utilities.h"
+#include "logging.h"
 
 #include <QRegularExpression>
 #include <QVariant>
 #include <QLocale>
+#include <QSet>
 
 QT_BEGIN_NAMESPACE_AM
 
 
+// The parameterMatch rules are compiled once, when the intent is registered: this way matching
+// incoming requests (especially broadcasts, which are checked against every candidate intent)
+// doesn't need to re-create the regular expressions and re-convert the lists over and over again.
+class Intent::ParameterMatcher
+{
+public:
+    explicit ParameterMatcher(const QVariantMap &parameterMatch);
+    bool match(const QVariantMap &parameters) const;
+
+private:
+    enum class RuleType { RegExp, List, Value };
+
+    struct Rule
+    {
+        QString name;
+        RuleType type = RuleType::Value;
+        QRegularExpression regexp;
+        QSet<QString> stringValues;  // the string entries of a list
+        QVariantList otherValues;    // all non-string entries of a list
+        QVariant value;
+    };
+    QVector<Rule> m_rules;
+};
+
+Intent::ParameterMatcher::ParameterMatcher(const QVariantMap &parameterMatch)
+{
+    m_rules.reserve(parameterMatch.size());
+
+    for (auto it = parameterMatch.cbegin(); it != parameterMatch.cend(); ++it) {
+        Rule rule;
+        rule.name = it.key();
+        const QVariant &requiredValue = it.value();
+
+        switch (requiredValue.metaType().id()) {
+        case QMetaType::QString:
+            rule.type = RuleType::RegExp;
+            rule.regexp.setPattern(requiredValue.toString());
+            if (!rule.regexp.isValid()) {
+                qCWarning(LogIntents) << "Invalid regular expression" << rule.regexp.pattern()
+                                      << "in parameterMatch for parameter" << rule.name << ":"
+                                      << rule.regexp.errorString();
+            } else {
+                rule.regexp.optimize();
+            }
+            break;
+        case QMetaType::QVariantList: {
+            rule.type = RuleType::List;
+            const QVariantList rvlist = requiredValue.toList();
+            for (const QVariant &rv : rvlist) {
+                // a QString can never compare equal to a QVariant of a different type, so string
+                // entries can be looked up directly
+                if (rv.metaType().id() == QMetaType::QString)
+                    rule.stringValues.insert(rv.toString());
+                else
+                    rule.otherValues.append(rv);
+            }
+            break;
+        }
+        default:
+            rule.type = RuleType::Value;
+            rule.value = requiredValue;
+            break;
+        }
+        m_rules.append(rule);
+    }
+}
+
+bool Intent::ParameterMatcher::match(const QVariantMap &parameters) const
+{
+    for (const Rule &rule : m_rules) {
+        auto pit = parameters.find(rule.name);
+        if (pit == parameters.cend())
+            return false;
+
+        const QVariant &actualValue = pit.value();
+
+        switch (rule.type) {
+        case RuleType::RegExp: {
+            auto match = rule.regexp.match(actualValue.toString());
+            if (!match.hasMatch())
+                return false;
+            break;
+        }
+        case RuleType::List: {
+            bool foundMatch = false;
+            if (actualValue.metaType().id() == QMetaType::QString) {
+                foundMatch = rule.stringValues.contains(actualValue.toString());
+            } else {
+                for (const QVariant &rv : rule.otherValues) {
+                    if (actualValue.canConvert(rv.metaType()) && actualValue == rv) {
+                        foundMatch = true;
+                        break;
+                    }
+                }
+            }
+            if (!foundMatch)
+                return false;
+            break;
+        }
+        case RuleType::Value:
+            if (rule.value != actualValue)
+                return false;
+            break;
+        }
+    }
+    return true;
+}
+
+
 /*!
     \qmltype IntentObject
     \inqmlmodule QtApplicationManager.SystemUI
@@ -176,13 +287,26 @@ Intent::Intent(const QString &id, const QString &packageId, const QString &appli
     , m_icon(icon)
     , m_handleOnlyWhenRunning(handleOnlyWhenRunning)
 {
+    if (!m_parameterMatch.isEmpty())
+        m_parameterMatcher = std::make_shared<const ParameterMatcher>(m_parameterMatch);
 }
 
 Intent *Intent::copy() const
 {
-    return new Intent(m_intentId, m_packageId, m_applicationId, m_requiredCapabilities,
-                      m_visibility, m_parameterMatch, m_names, m_descriptions, m_icon,
-                      m_categories, m_handleOnlyWhenRunning);
+    auto intent = new Intent();
+    intent->m_intentId = m_intentId;
+    intent->m_visibility = m_visibility;
+    intent->m_requiredCapabilities = m_requiredCapabilities;
+    intent->m_parameterMatch = m_parameterMatch;
+    intent->m_parameterMatcher = m_parameterMatcher; // no need to compile again
+    intent->m_packageId = m_packageId;
+    intent->m_applicationId = m_applicationId;
+    intent->m_names = m_names;
+    intent->m_descriptions = m_descriptions;
+    intent->m_categories = m_categories;
+    intent->m_icon = m_icon;
+    intent->m_handleOnlyWhenRunning = m_handleOnlyWhenRunning;
+    return intent;
 }
 
 QString Intent::intentId() const
@@ -217,44 +341,7 @@ QString Intent::applicationId() const
 
 bool Intent::checkParameterMatch(const QVariantMap &parameters) const
 {
-    for (auto rit = m_parameterMatch.cbegin(); rit != m_parameterMatch.cend(); ++rit) {
-        const QString &paramName = rit.key();
-        auto pit = parameters.find(paramName);
-        if (pit == parameters.cend())
-            return false;
-
-        const QVariant requiredValue = rit.value();
-        const QVariant actualValue = pit.value();
-
-        switch (requiredValue.metaType().id()) {
-        case QMetaType::QString: {
-            QRegularExpression regexp(requiredValue.toString());
-            auto match = regexp.match(actualValue.toString());
-            if (!match.hasMatch())
-                return false;
-            break;
-        }
-        case QMetaType::QVariantList: {
-            bool foundMatch = false;
-            const QVariantList rvlist = requiredValue.toList();
-            for (const QVariant &rv2 : rvlist) {
-                if (actualValue.canConvert(rv2.metaType()) && actualValue == rv2) {
-                    foundMatch = true;
-                    break;
-                }
-            }
-            if (!foundMatch)
-                return false;
-            break;
-        }
-        default: {
-            if (requiredValue != actualValue)
-                return false;
-            break;
-        }
-        }
-    }
-    return true;
+    return !m_parameterMatcher || m_parameterMatcher->match(parameters);
 }
 
 QUrl Intent::icon() const
@@ -13,6 +13,8 @@
 #include <QtCore/QVariantMap>
 #include <QtAppManCommon/global.h>
 
+#include <memory>
+
 QT_BEGIN_NAMESPACE_AM
 
 class Intent : public QObject
@@ -71,10 +73,14 @@ private:
 
     Intent *copy() const; // needed during long-lived disambiguation requests
 
+    class ParameterMatcher;
+
     QString m_intentId;
     Visibility m_visibility = Public;
     QStringList m_requiredCapabilities;
     QVariantMap m_parameterMatch;
+    // compiled from m_parameterMatch once and shared with all copies
+    std::shared_ptr<const ParameterMatcher> m_parameterMatcher;
 
     QString m_packageId;
     QString m_applicationId;
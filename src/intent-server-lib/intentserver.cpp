@@ -256,6 +256,7 @@ Intent *IntentServer::addIntent(const QString &id, const QString &packageId,
 
     beginInsertRows(QModelIndex(), rowCount(), rowCount());
     m_intents << intent;
+    m_intentsById[id] << intent;
     endInsertRows();
 
     emit countChanged();
@@ -278,6 +279,12 @@ void IntentServer::removeIntent(Intent *intent)
     emit intentAboutToBeRemoved(intent);
     beginRemoveRows(QModelIndex(), int(index), int(index));
     m_intents.removeAt(index);
+    auto idIt = m_intentsById.find(intent->intentId());
+    if (idIt != m_intentsById.end()) {
+        idIt->removeOne(intent);
+        if (idIt->isEmpty())
+            m_intentsById.erase(idIt);
+    }
     endRemoveRows();
 
     emit countChanged();
@@ -439,12 +446,12 @@ Intent *IntentServer::intent(int index) const
 Intent *IntentServer::applicationIntent(const QString &intentId, const QString &applicationId,
                              const QVariantMap &parameters) const
 {
-    auto it = std::find_if(m_intents.cbegin(), m_intents.cend(),
-                           [intentId, applicationId, parameters](Intent *intent) -> bool {
-        return (intent->applicationId() == applicationId) && (intent->intentId() == intentId)
-                && intent->checkParameterMatch(parameters);
+    const auto intents = m_intentsById.value(intentId);
+    auto it = std::find_if(intents.cbegin(), intents.cend(),
+                           [&applicationId, &parameters](Intent *intent) -> bool {
+        return (intent->applicationId() == applicationId) && intent->checkParameterMatch(parameters);
     });
-    return (it != m_intents.cend()) ? *it : nullptr;
+    return (it != intents.cend()) ? *it : nullptr;
 }
 
 /*! \qmlmethod IntentObject IntentServer::packageIntent(string intentId, string packageId, var parameters)
@@ -457,12 +464,12 @@ Intent *IntentServer::applicationIntent(const QString &intentId, const QString &
 Intent *IntentServer::packageIntent(const QString &intentId, const QString &packageId,
                                     const QVariantMap &parameters) const
 {
-    auto it = std::find_if(m_intents.cbegin(), m_intents.cend(),
-                           [intentId, packageId, parameters](Intent *intent) -> bool {
-        return (intent->packageId() == packageId) && (intent->intentId() == intentId)
-                && intent->checkParameterMatch(parameters);
+    const auto intents = m_intentsById.value(intentId);
+    auto it = std::find_if(intents.cbegin(), intents.cend(),
+                           [&packageId, &parameters](Intent *intent) -> bool {
+        return (intent->packageId() == packageId) && intent->checkParameterMatch(parameters);
     });
-    return (it != m_intents.cend()) ? *it : nullptr;
+    return (it != intents.cend()) ? *it : nullptr;
 }
 
 /*! \qmlmethod IntentObject IntentServer::packageIntent(string intentId, string packageId, string applicationId, var parameters)
@@ -475,12 +482,13 @@ Intent *IntentServer::packageIntent(const QString &intentId, const QString &pack
 Intent *IntentServer::packageIntent(const QString &intentId, const QString &packageId,
                                     const QString &applicationId, const QVariantMap &parameters) const
 {
-    auto it = std::find_if(m_intents.cbegin(), m_intents.cend(),
-                           [intentId, packageId, applicationId, parameters](Intent *intent) -> bool {
+    const auto intents = m_intentsById.value(intentId);
+    auto it = std::find_if(intents.cbegin(), intents.cend(),
+                           [&packageId, &applicationId, &parameters](Intent *intent) -> bool {
         return (intent->packageId() == packageId) && (intent->applicationId() == applicationId)
-                && (intent->intentId() == intentId) && intent->checkParameterMatch(parameters);
+                && intent->checkParameterMatch(parameters);
     });
-    return (it != m_intents.cend()) ? *it : nullptr;
+    return (it != intents.cend()) ? *it : nullptr;
 }
 
 /*! \qmlmethod int IntentServer::indexOfIntent(string intentId, string applicationId, var parameters)
@@ -796,7 +804,7 @@ IntentServerRequest *IntentServer::requestToSystem(const QString &requestingAppl
     QVector<Intent *> intents;
     bool broadcast = (applicationId == u":broadcast:");
     if (applicationId.isEmpty() || broadcast) {
-        intents = filterByIntentId(m_intents, intentId, parameters);
+        intents = filterByIntentId(m_intentsById.value(intentId), intentId, parameters);
     } else {
         if (Intent *intent = this->applicationIntent(intentId, applicationId, parameters))
             intents << intent;
@@ -127,6 +127,7 @@ private:
     int m_sentToAppTimeout = 0;
 
     QVector<Intent *> m_intents;
+    QHash<QString, QVector<Intent *>> m_intentsById; // intentId -> intents, in m_intents order
     bool m_aboutToBeRemoved = false;
 
     IntentServerSystemInterface *m_systemInterface;
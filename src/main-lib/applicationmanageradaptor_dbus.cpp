@@ -17,6 +17,8 @@
 #include "logging.h"
 #include "intentclient.h"
 #include "intentclientrequest.h"
+#include "dbus-utilities.h"
+#include "watchdog.h"
 
 using namespace Qt::StringLiterals;
 
@@ -336,3 +338,20 @@ void ApplicationManagerAdaptor::broadcastIntentRequestAs(const QString &requesti
 
     IntentClient::instance()->requestToSystem(reqAppId, intentId, u":broadcast:"_s, parameters);
 }
+
+QVariantMap ApplicationManagerAdaptor::eventLoopProfile()
+{
+    QT_AM_AUTHENTICATE_DBUS(QVariantMap)
+    return convertToDBusVariant(Watchdog::instance()->eventLoopProfile()).toMap();
+}
+
+QVariantMap ApplicationManagerAdaptor::credentialCacheStatistics()
+{
+    QT_AM_AUTHENTICATE_DBUS(QVariantMap)
+    const auto *policy = DBusPolicy::instance();
+    return QVariantMap {
+        { u"hits"_s, policy->credentialCacheHits() },
+        { u"misses"_s, policy->credentialCacheMisses() },
+        { u"size"_s, qint64(policy->credentialCacheSize()) },
+    };
+}
@@ -472,7 +472,7 @@ void ConfigurationPrivate::saveToCache(QDataStream &ds, const ConfigurationData
 
 quint32 ConfigurationPrivate::dataStreamVersion()
 {
-    return 18;
+    return 23;
 }
 
 void ConfigurationPrivate::serialize(QDataStream &ds, ConfigurationData &cd, bool write)
@@ -500,13 +500,22 @@ void ConfigurationPrivate::serialize(QDataStream &ds, ConfigurationData &cd, boo
         & cd.logging.rules
         & cd.logging.messagePattern
         & cd.logging.useAMConsoleLogger
+        & cd.logging.asyncOutput.enabled
+        & cd.logging.asyncOutput.queueSize
+        & cd.logging.asyncOutput.overflowPolicy
         & cd.installer.caCertificates
+        & cd.installer.maximumConcurrentInstallations
+        & cd.installer.downloadRateLimit
+        & cd.installer.diskWriteRateLimit
         & cd.dbus.policies
         & cd.dbus.registrations
         & cd.quicklaunch.idleLoad
         & cd.quicklaunch.runtimesPerContainer
         & cd.quicklaunch.failedStartLimit
         & cd.quicklaunch.failedStartLimitIntervalSec
+        & cd.quicklaunch.adaptivePoolSize
+        & cd.quicklaunch.memoryBudget
+        & cd.quicklaunch.preloadApplications
         & cd.ui.style
         & cd.ui.mainQml
         & cd.ui.resources
@@ -524,6 +533,7 @@ void ConfigurationPrivate::serialize(QDataStream &ds, ConfigurationData &cd, boo
         & cd.applications.installationDir
         & cd.applications.documentDir
         & cd.applications.installationDirMountPoint
+        & cd.applications.watchPackageDirectories
         & cd.crashAction.printBacktrace
         & cd.crashAction.printQmlStack
         & cd.crashAction.waitForGdbAttach
@@ -585,13 +595,22 @@ void ConfigurationPrivate::merge(const ConfigurationData &from, ConfigurationDat
     MERGE_FIELD(logging.rules);
     MERGE_FIELD(logging.messagePattern);
     MERGE_FIELD(logging.useAMConsoleLogger);
+    MERGE_FIELD(logging.asyncOutput.enabled);
+    MERGE_FIELD(logging.asyncOutput.queueSize);
+    MERGE_FIELD(logging.asyncOutput.overflowPolicy);
     MERGE_FIELD(installer.caCertificates);
+    MERGE_FIELD(installer.maximumConcurrentInstallations);
+    MERGE_FIELD(installer.downloadRateLimit);
+    MERGE_FIELD(installer.diskWriteRateLimit);
     MERGE_FIELD(dbus.policies);
     MERGE_FIELD(dbus.registrations);
     MERGE_FIELD(quicklaunch.idleLoad);
     MERGE_FIELD(quicklaunch.runtimesPerContainer);
     MERGE_FIELD(quicklaunch.failedStartLimit);
     MERGE_FIELD(quicklaunch.failedStartLimitIntervalSec);
+    MERGE_FIELD(quicklaunch.adaptivePoolSize);
+    MERGE_FIELD(quicklaunch.memoryBudget);
+    MERGE_FIELD(quicklaunch.preloadApplications);
     MERGE_FIELD(ui.style);
     MERGE_FIELD(ui.mainQml);
     MERGE_FIELD(ui.resources);
@@ -609,6 +628,7 @@ void ConfigurationPrivate::merge(const ConfigurationData &from, ConfigurationDat
     MERGE_FIELD(applications.installationDir);
     MERGE_FIELD(applications.documentDir);
     MERGE_FIELD(applications.installationDirMountPoint);
+    MERGE_FIELD(applications.watchPackageDirectories);
     MERGE_FIELD(crashAction.printBacktrace);
     MERGE_FIELD(crashAction.printQmlStack);
     MERGE_FIELD(crashAction.waitForGdbAttach);
@@ -744,6 +764,23 @@ void ConfigurationPrivate::loadFromSource(QIODevice *source, const QString &file
                           cd.logging.useAMConsoleLogger = yp.parseScalar();
                           if (cd.logging.useAMConsoleLogger.typeId() != QMetaType::Bool)
                               cd.logging.useAMConsoleLogger.clear();  } },
+                     { "asyncOutput", false, YamlParser::Map, [&]() {
+                          yp.parseFields({
+                              { "enabled", false, YamlParser::Scalar, [&]() {
+                                   cd.logging.asyncOutput.enabled = yp.parseBool(); } },
+                              { "queueSize", false, YamlParser::Scalar, [&]() {
+                                   cd.logging.asyncOutput.queueSize = yp.parseInt(2); } },
+                              { "overflowPolicy", false, YamlParser::Scalar, [&]() {
+                                   static const QStringList validValues {
+                                       u"drop"_s, u"block"_s
+                                   };
+                                   QString s = yp.parseString().trimmed();
+                                   if (!s.isEmpty() && !validValues.contains(s)) {
+                                       throw YamlParserException(&yp, "asyncOutput.overflowPolicy needs to be one of %1").arg(validValues);
+                                   }
+                                   cd.logging.asyncOutput.overflowPolicy = s;
+                               } }
+                          }); } },
                      { "dlt", false, YamlParser::Map, [&]() {
                           yp.parseFields({
                               { "id", false, YamlParser::Scalar, [&]() {
@@ -769,6 +806,12 @@ void ConfigurationPrivate::loadFromSource(QIODevice *source, const QString &file
                           (void) yp.parseBool(); } },
                      { "caCertificates", false, YamlParser::Scalar | YamlParser::List, [&]() {
                           cd.installer.caCertificates = yp.parseStringOrStringList(); } },
+                     { "maximumConcurrentInstallations", false, YamlParser::Scalar, [&]() {
+                          cd.installer.maximumConcurrentInstallations = yp.parseInt(1); } },
+                     { "downloadRateLimit", false, YamlParser::Scalar, [&]() {
+                          cd.installer.downloadRateLimit = yp.parseInt(0); } },
+                     { "diskWriteRateLimit", false, YamlParser::Scalar, [&]() {
+                          cd.installer.diskWriteRateLimit = yp.parseInt(0); } },
                  }); } },
             { "quicklaunch", false, YamlParser::Map, [&]() {
                  yp.parseFields({
@@ -821,6 +864,12 @@ void ConfigurationPrivate::loadFromSource(QIODevice *source, const QString &file
                           cd.quicklaunch.failedStartLimit = yp.parseInt(0); } },
                      { "failedStartLimitIntervalSec", false, YamlParser::Scalar, [&]() {
                           cd.quicklaunch.failedStartLimitIntervalSec = yp.parseDurationAsSec(u"s"); } },
+                     { "adaptivePoolSize", false, YamlParser::Scalar, [&]() {
+                          cd.quicklaunch.adaptivePoolSize = yp.parseBool(); } },
+                     { "memoryBudget", false, YamlParser::Scalar, [&]() {
+                          cd.quicklaunch.memoryBudget = yp.parseInt(0); } },
+                     { "preloadApplications", false, YamlParser::Scalar, [&]() {
+                          cd.quicklaunch.preloadApplications = yp.parseBool(); } },
                  }); } },
             { "ui", false, YamlParser::Map, [&]() {
                  yp.parseFields({
@@ -860,6 +909,8 @@ void ConfigurationPrivate::loadFromSource(QIODevice *source, const QString &file
                           cd.applications.documentDir = yp.parseString(); } },
                      { "installationDirMountPoint", false, YamlParser::Scalar | YamlParser::Scalar, [&]() {
                           cd.applications.installationDirMountPoint = yp.parseString(); } },
+                     { "watchPackageDirectories", false, YamlParser::Scalar, [&]() {
+                          cd.applications.watchPackageDirectories = yp.parseBool(); } },
                  }); } },
             { "flags", false, YamlParser::Map, [&]() {
                  yp.parseFields({
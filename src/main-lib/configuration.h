@@ -58,10 +58,18 @@ struct ConfigurationData
         QStringList rules;
         QString messagePattern;
         QVariant useAMConsoleLogger; // true / false / invalid
+        struct {
+            bool enabled = false;
+            int queueSize = 1024;
+            QString overflowPolicy; // drop / block
+        } asyncOutput;
     } logging;
 
     struct {
         QStringList caCertificates;
+        int maximumConcurrentInstallations = 1;
+        int downloadRateLimit = 0; // bytes/sec per task, 0 means unlimited
+        int diskWriteRateLimit = 0; // bytes/sec per task, 0 means unlimited
     } installer;
 
     struct {
@@ -74,6 +82,9 @@ struct ConfigurationData
         QMap<std::pair<QString, QString>, int> runtimesPerContainer;
         int failedStartLimit = 5;
         std::chrono::seconds failedStartLimitIntervalSec { 10 };
+        bool adaptivePoolSize = false;
+        int memoryBudget = 0; // MiB
+        bool preloadApplications = false;
     } quicklaunch;
 
     struct Ui {
@@ -95,6 +106,7 @@ struct ConfigurationData
         QString installationDir;
         QString documentDir;
         QString installationDirMountPoint;
+        bool watchPackageDirectories = false;
     } applications; // TODO: rename to package?
 
     struct {
@@ -92,6 +92,7 @@
 #include "crashhandler.h"
 #include "qmllogger.h"
 #include "startuptimer.h"
+#include "startuptaskgraph.h"
 #include "unixsignalhandler.h"
 
 // monitor-lib
@@ -207,48 +208,95 @@ void Main::setup(const Configuration *cfg) noexcept(false)
         Logging::setDltLongMessageBehavior(cfg->yaml.logging.dlt.longMessageBehavior);
         Logging::registerUnregisteredDltContexts();
     }
+    Logging::setAsyncOutput(cfg->yaml.logging.asyncOutput.enabled,
+                            cfg->yaml.logging.asyncOutput.queueSize,
+                            cfg->yaml.logging.asyncOutput.overflowPolicy);
     setupLogging(cfg->verbose(), cfg->yaml.logging.rules, cfg->yaml.logging.messagePattern,
                  cfg->yaml.logging.useAMConsoleLogger);
 
     if (!cfg->isWatchdogDisabled())
         setupWatchdog(cfg->yaml.watchdog);
 
-    registerResources(cfg->yaml.ui.resources);
-
     setupOpenGL(cfg->yaml.ui.opengl);
     setupIconTheme(cfg->yaml.ui.iconThemeSearchPaths, cfg->yaml.ui.iconThemeName);
 
-    loadStartupPlugins(cfg->yaml.plugins.startup);
-    parseSystemProperties(cfg->yaml.systemProperties);
-
-    setMainQmlFile(cfg->yaml.ui.mainQml);
-    setupSingleOrMultiProcess(cfg);
-    setupRuntimesAndContainers(cfg);
-
-    loadPackageDatabase(cfg);
+    // Main-thread tasks run in the order they are added here, but the tasks that do not touch
+    // any QObject owned by the main thread are run concurrently on a thread pool.
+    StartupTaskGraph graph;
 
-    setupSingletons(cfg);
-    setupQuickLauncher(cfg);
-    setupIntents(cfg);
+    graph.add("session D-Bus launch", StartupTaskGraph::MainThread, { }, [this, cfg]() {
+        launchPrivateSessionBus(cfg);
+    });
+    graph.add("resource registration", StartupTaskGraph::MainThread, { }, [this, cfg]() {
+        registerResources(cfg->yaml.ui.resources);
+    });
+    graph.add("startup-plugin load", StartupTaskGraph::MainThread, { }, [this, cfg]() {
+        loadStartupPlugins(cfg->yaml.plugins.startup);
+        parseSystemProperties(cfg->yaml.systemProperties);
+    });
+    graph.add("process mode selection", StartupTaskGraph::MainThread, { }, [this, cfg]() {
+        setMainQmlFile(cfg->yaml.ui.mainQml);
+        setupSingleOrMultiProcess(cfg);
+    });
+    graph.add("runtime registration", StartupTaskGraph::MainThread,
+              { "startup-plugin load", "process mode selection" }, [this, cfg]() {
+        setupRuntimesAndContainers(cfg);
+    });
 
-    registerPackages();
+    // The built-in package dirs can be qrc paths, which are only available after the resources
+    // and the startup plugins have been loaded. The mount-point watcher has to be created in the
+    // main thread, as it is shared globally.
+    graph.add("package database loading",
+              cfg->yaml.applications.installationDirMountPoint.isEmpty() ? StartupTaskGraph::AnyThread
+                                                                         : StartupTaskGraph::MainThread,
+              { "resource registration", "startup-plugin load" }, [this, cfg]() {
+        loadPackageDatabase(cfg);
+    });
 
-    if (cfg->yaml.applications.installationDir.isEmpty())
-        StartupTimer::instance()->checkpoint("skipping installer");
-    else
-        setupInstaller(cfg);
+    graph.add("QML engine instantiation", StartupTaskGraph::MainThread, { "resource registration" }, [this, cfg]() {
+        setLibraryPaths(libraryPaths() + cfg->yaml.ui.pluginPaths);
+        setupQmlEngine(cfg->yaml.ui.importPaths, cfg->yaml.ui.style);
 
-    setLibraryPaths(libraryPaths() + cfg->yaml.ui.pluginPaths);
-    setupQmlEngine(cfg->yaml.ui.importPaths, cfg->yaml.ui.style);
+        // For development only: set an icon, so you know which window is the AM
+        if (!isRunningOnEmbedded() && !cfg->yaml.ui.windowIcon.isEmpty())
+            QGuiApplication::setWindowIcon(QIcon(cfg->yaml.ui.windowIcon));
+    });
 
-    // For development only: set an icon, so you know which window is the AM
-    if (!isRunningOnEmbedded() && !cfg->yaml.ui.windowIcon.isEmpty())
-        QGuiApplication::setWindowIcon(QIcon(cfg->yaml.ui.windowIcon));
+    graph.add("singleton instantiation", StartupTaskGraph::MainThread,
+              { "package database loading", "runtime registration" }, [this, cfg]() {
+        checkPackageRuntimes();
+        setupSingletons(cfg);
+    });
+    graph.add("quick-launcher setup", StartupTaskGraph::MainThread, { "singleton instantiation" }, [this, cfg]() {
+        setupQuickLauncher(cfg);
+    });
+    graph.add("IntentServer instantiation", StartupTaskGraph::MainThread, { "singleton instantiation" }, [this, cfg]() {
+        setupIntents(cfg);
+    });
+    graph.add("package registration", StartupTaskGraph::MainThread,
+              { "quick-launcher setup", "IntentServer instantiation" }, [this]() {
+        registerPackages();
+    });
+    graph.add("installer setup", StartupTaskGraph::MainThread, { "package registration" }, [this, cfg]() {
+        if (cfg->yaml.applications.installationDir.isEmpty())
+            StartupTimer::instance()->checkpoint("skipping installer");
+        else
+            setupInstaller(cfg);
+    });
 
-    setupWindowManager(cfg);
-    setupDBus(cfg);
+    graph.add("WindowManager instantiation", StartupTaskGraph::MainThread,
+              { "QML engine instantiation", "singleton instantiation" }, [this, cfg]() {
+        setupWindowManager(cfg);
+    });
+    graph.add("D-Bus registration", StartupTaskGraph::MainThread,
+              { "WindowManager instantiation", "installer setup", "session D-Bus launch" }, [this, cfg]() {
+        setupDBus(cfg);
+    });
+    graph.add("instance info file creation", StartupTaskGraph::MainThread, { "D-Bus registration" }, [this, cfg]() {
+        createInstanceInfoFile(cfg->yaml.instanceId);
+    });
 
-    createInstanceInfoFile(cfg->yaml.instanceId);
+    graph.run();
 
     m_showFullscreen = cfg->yaml.ui.fullscreen;
     m_loadDummyData = cfg->yaml.ui.loadDummyData;
@@ -344,7 +392,6 @@ void Main::registerResources(const QStringList &resources) const
             qCWarning(LogSystem).noquote() << e.errorString();
         }
     }
-    StartupTimer::instance()->checkpoint("after resource registration");
 }
 
 void Main::loadStartupPlugins(const QStringList &startupPluginPaths) noexcept(false)
@@ -360,7 +407,6 @@ void Main::loadStartupPlugins(const QStringList &startupPluginPaths) noexcept(fa
     }
 
     m_startupPlugins = loadPlugins<StartupInterface>("startup", systemStartupPluginPaths + startupPluginPaths);
-    StartupTimer::instance()->checkpoint("after startup-plugin load");
 }
 
 void Main::parseSystemProperties(const QVariantMap &rawSystemProperties)
@@ -481,8 +527,6 @@ void Main::setupRuntimesAndContainers(const Configuration *cfg)
     }
 
     RuntimeFactory::instance()->setConfiguration(cfg->yaml.runtimes.configurations);
-
-    StartupTimer::instance()->checkpoint("after runtime registration");
 }
 
 void Main::loadPackageDatabase(const Configuration *cfg) noexcept(false)
@@ -496,9 +540,18 @@ void Main::loadPackageDatabase(const Configuration *cfg) noexcept(false)
         if (!cfg->clearCache() && !cfg->noCache())
             m_packageDatabase->enableLoadFromCache();
         m_packageDatabase->enableSaveToCache();
+        if (cfg->yaml.applications.watchPackageDirectories)
+            m_packageDatabase->enableIncrementalUpdates();
     }
     m_packageDatabase->parse();
 
+    // this might have been called on a startup worker thread
+    if (m_packageDatabase->thread() != thread())
+        m_packageDatabase->moveToThread(thread());
+}
+
+void Main::checkPackageRuntimes()
+{
     const QVector<PackageInfo *> allPackages =
             m_packageDatabase->builtInPackages()
             + m_packageDatabase->installedPackages();
@@ -512,8 +565,6 @@ void Main::loadPackageDatabase(const Configuration *cfg) noexcept(false)
                 qCWarning(LogSystem) << "Application" << app->id() << "uses an unknown runtime:" << app->runtimeName();
         }
     }
-
-    StartupTimer::instance()->checkpoint("after package database loading");
 }
 
 void Main::setupIntents(const Configuration *cfg)
@@ -524,7 +575,6 @@ void Main::setupIntents(const Configuration *cfg)
         cfg->yaml.intents.timeouts.startApplication.count(),
         cfg->yaml.intents.timeouts.replyFromApplication.count(),
         cfg->yaml.intents.timeouts.replyFromSystem.count());
-    StartupTimer::instance()->checkpoint("after IntentServer instantiation");
 }
 
 void Main::setupSingletons(const Configuration *cfg) noexcept(false)
@@ -552,8 +602,10 @@ void Main::setupQuickLauncher(const Configuration *cfg)
         m_quickLauncher = QuickLauncher::createInstance(cfg->yaml.quicklaunch.runtimesPerContainer,
                                                         cfg->yaml.quicklaunch.idleLoad,
                                                         cfg->yaml.quicklaunch.failedStartLimit,
-                                                        cfg->yaml.quicklaunch.failedStartLimitIntervalSec.count());
-        StartupTimer::instance()->checkpoint("after quick-launcher setup");
+                                                        cfg->yaml.quicklaunch.failedStartLimitIntervalSec.count(),
+                                                        cfg->yaml.quicklaunch.adaptivePoolSize,
+                                                        quint64(cfg->yaml.quicklaunch.memoryBudget) * 1024 * 1024,
+                                                        cfg->yaml.quicklaunch.preloadApplications);
     } else {
         qCDebug(LogSystem) << "Not setting up the quick-launch pool (runtimesPerContainer is 0)";
     }
@@ -602,9 +654,11 @@ void Main::setupInstaller(const Configuration *cfg) noexcept(false)
         m_packageManager->setCACertificates(caCertificateList);
     }
 
-    m_packageManager->enableInstaller();
+    m_packageManager->setMaximumConcurrentInstallations(cfg->yaml.installer.maximumConcurrentInstallations);
+    m_packageManager->setInstallationThroughputLimits(cfg->yaml.installer.downloadRateLimit,
+                                                      cfg->yaml.installer.diskWriteRateLimit);
 
-    StartupTimer::instance()->checkpoint("after installer setup");
+    m_packageManager->enableInstaller();
 #else
     Q_UNUSED(cfg)
 #endif // QT_CONFIG(am_installer)
@@ -628,7 +682,6 @@ void Main::registerPackages()
         StartupTimer::instance()->checkpoint("after package registration (delayed)");
     } else {
         m_packageManager->registerPackages();
-        StartupTimer::instance()->checkpoint("after package registration");
     }
 }
 
@@ -648,8 +701,6 @@ void Main::setupQmlEngine(const QStringList &importPaths, const QString &quickCo
     new QmlLogger(m_engine);
     m_engine->setOutputWarningsToStandardError(false);
     m_engine->setImportPathList(m_engine->importPathList() + importPaths);
-
-    StartupTimer::instance()->checkpoint("after QML engine instantiation");
 }
 
 void Main::setupWindowManager(const Configuration *cfg)
@@ -940,6 +991,43 @@ void Main::showWindow()
     }
 }
 
+#if defined(QT_DBUS_LIB) && QT_CONFIG(am_external_dbus_interfaces)
+static QString dbusNameForInterface(const Configuration *cfg, const QString &interfaceName)
+{
+    auto iit = cfg->yaml.dbus.registrations.constFind(interfaceName);
+    return (iit != cfg->yaml.dbus.registrations.cend()) ? iit->toString() : cfg->dbus();
+}
+#endif
+
+/*! \internal
+    Launches a private dbus-daemon session instance, if all interfaces are set to "auto".
+    This is done early, so that the daemon can start up while the rest of the System UI is being
+    set up. setupDBus() will then wait for the daemon to report its bus address.
+*/
+void Main::launchPrivateSessionBus(const Configuration *cfg)
+{
+#if defined(QT_DBUS_LIB) && QT_CONFIG(am_external_dbus_interfaces)
+    static const QMetaObject *metaObjects[] = {
+        &PackageManager::staticMetaObject,
+        &WindowManager::staticMetaObject,
+        &NotificationManager::staticMetaObject,
+        &ApplicationManager::staticMetaObject,
+    };
+
+    for (const QMetaObject *mo : metaObjects) {
+        int idx = mo->indexOfClassInfo("D-Bus Interface");
+        if (idx < 0)
+            return; // setupDBus() will complain
+        if (dbusNameForInterface(cfg, QString::fromLatin1(mo->classInfo(idx).value())) != u"auto")
+            return;
+    }
+
+    m_privateSessionBus = DBusDaemonProcess::launch();
+#else
+    Q_UNUSED(cfg)
+#endif
+}
+
 void Main::setupDBus(const Configuration *cfg)
 {
 #if defined(QT_DBUS_LIB) && QT_CONFIG(am_external_dbus_interfaces)
@@ -948,6 +1036,13 @@ void Main::setupDBus(const Configuration *cfg)
     DBusPolicy::createInstance([](qint64 pid) { return ApplicationManager::instance()->identifyAllApplications(pid); },
                                [](const QString &appId) { return ApplicationManager::instance()->capabilities(appId); });
 
+    // the credential cache remembers the capabilities of identified applications
+    auto invalidateCapabilities = [](const QString &appId) { DBusPolicy::instance()->invalidateApplication(appId); };
+    connect(m_applicationManager, &ApplicationManager::applicationChanged,
+            m_applicationManager, invalidateCapabilities);
+    connect(m_applicationManager, &ApplicationManager::applicationAboutToBeRemoved,
+            m_applicationManager, invalidateCapabilities);
+
     // <0> DBusContextAdaptor instance
     // <1> D-Bus name (extracted from callback function busForInterface)
     // <2> D-Bus service
@@ -963,8 +1058,7 @@ void Main::setupDBus(const Configuration *cfg)
                     .arg(QString::fromLatin1(adaptor->parent()->metaObject()->className()));
         }
         QString interfaceName = QString::fromLatin1(adaptor->parent()->metaObject()->classInfo(idx).value());
-        auto iit = cfg->yaml.dbus.registrations.constFind(interfaceName);
-        QString bus = (iit != cfg->yaml.dbus.registrations.cend()) ? iit->toString() : cfg->dbus();
+        QString bus = dbusNameForInterface(cfg, interfaceName);
 
         ifaces.emplace_back(adaptor, bus, service, path, interfaceName);
     };
@@ -992,10 +1086,11 @@ void Main::setupDBus(const Configuration *cfg)
             noneOnly = false;
     }
 
-    // start a private dbus-daemon session instance if all interfaces are set to "auto"
+    // a private dbus-daemon session instance has been launched, if all interfaces are set to "auto"
     if (Q_UNLIKELY(autoOnly)) {
         try {
-            DBusDaemonProcess::start();
+            Q_ASSERT(m_privateSessionBus);
+            m_privateSessionBus->waitForBusAddress();
             StartupTimer::instance()->checkpoint("after starting session D-Bus");
         } catch (const Exception &e) {
 #  if defined(Q_OS_LINUX)
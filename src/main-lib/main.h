@@ -50,6 +50,7 @@ class QuickLauncher;
 class SystemMonitor;
 class Configuration;
 class DBusContextAdaptor;
+class DBusDaemonProcess;
 
 
 class Main : public MainBase, protected SharedMain
@@ -89,11 +90,13 @@ protected:
     void registerResources(const QStringList &resources) const;
     void loadStartupPlugins(const QStringList &startupPluginPaths) noexcept(false);
     void parseSystemProperties(const QVariantMap &rawSystemProperties);
+    void launchPrivateSessionBus(const Configuration *cfg);
     void setupDBus(const Configuration *cfg);
     void setMainQmlFile(const QString &mainQml) noexcept(false);
     void setupSingleOrMultiProcess(const Configuration *cfg) noexcept(false);
     void setupRuntimesAndContainers(const Configuration *cfg);
     void loadPackageDatabase(const Configuration *cfg) noexcept(false);
+    void checkPackageRuntimes();
     void setupIntents(const Configuration *cfg) noexcept(false);
     void setupSingletons(const Configuration *cfg) noexcept(false);
     void setupQuickLauncher(const Configuration *cfg);
@@ -147,6 +150,7 @@ private:
     QDBusServer *m_p2pServer = nullptr;
     QHash<QString, DBusContextAdaptor *> m_p2pAdaptors;
     bool m_p2pFailed = false;
+    DBusDaemonProcess *m_privateSessionBus = nullptr;
 };
 
 Q_DECLARE_OPERATORS_FOR_FLAGS(Main::InitFlags)
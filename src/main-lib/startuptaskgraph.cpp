@@ -0,0 +1,111 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <algorithm>
+#include <utility>
+#include <QCoreApplication>
+#include <QThread>
+
+#include "exception.h"
+#include "startuptimer.h"
+#include "startuptaskgraph.h"
+
+using namespace Qt::StringLiterals;
+
+
+QT_BEGIN_NAMESPACE_AM
+
+StartupTaskGraph::StartupTaskGraph()
+{
+    m_threadPool.setObjectName(u"QtAM::StartupTaskGraph"_s);
+}
+
+StartupTaskGraph::~StartupTaskGraph()
+{
+    m_threadPool.waitForDone();
+}
+
+void StartupTaskGraph::add(const char *name, Affinity affinity, const QList<const char *> &dependencies,
+                           const std::function<void()> &function) noexcept(false)
+{
+    Task task { name, affinity, { }, function };
+
+    // dependencies have to be added first, which also guarantees that the graph is acyclic
+    for (const char *dependency : dependencies) {
+        auto it = std::find_if(m_tasks.cbegin(), m_tasks.cend(), [dependency](const Task &t) {
+            return t.name == dependency;
+        });
+        if (it == m_tasks.cend()) {
+            throw Exception("startup task '%1' depends on the unknown task '%2'")
+                .arg(name).arg(dependency);
+        }
+        task.dependencies << size_t(it - m_tasks.cbegin());
+    }
+    m_tasks.push_back(task);
+}
+
+void StartupTaskGraph::run() noexcept(false)
+{
+    Q_ASSERT(QThread::currentThread() == qApp->thread());
+
+    QMutexLocker locker(&m_mutex);
+
+    forever {
+        Task *mainThreadTask = nullptr;
+        bool running = false;
+
+        for (Task &task : m_tasks) {
+            if (task.state == Task::Running) {
+                running = true;
+            } else if ((task.state == Task::Pending) && !m_error && isReady(task)) {
+                if (task.affinity == AnyThread) {
+                    task.state = Task::Running;
+                    running = true;
+                    m_threadPool.start([this, &task]() { execute(task); });
+                } else if (!mainThreadTask) {
+                    mainThreadTask = &task;
+                }
+            }
+        }
+
+        if (mainThreadTask) {
+            mainThreadTask->state = Task::Running;
+            locker.unlock();
+            execute(*mainThreadTask);
+            locker.relock();
+        } else if (running) {
+            m_taskFinished.wait(&m_mutex);
+        } else {
+            break;
+        }
+    }
+
+    if (m_error)
+        std::rethrow_exception(std::exchange(m_error, nullptr));
+}
+
+bool StartupTaskGraph::isReady(const Task &task) const
+{
+    return std::all_of(task.dependencies.cbegin(), task.dependencies.cend(), [this](size_t index) {
+        return m_tasks.at(index).state == Task::Done;
+    });
+}
+
+void StartupTaskGraph::execute(Task &task)
+{
+    std::exception_ptr error;
+    try {
+        task.function();
+        StartupTimer::instance()->checkpoint(QByteArray("after " + task.name).constData());
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    QMutexLocker locker(&m_mutex);
+    task.state = Task::Done;
+    if (error && !m_error)
+        m_error = error;
+    m_taskFinished.wakeAll();
+}
+
+QT_END_NAMESPACE_AM
@@ -0,0 +1,64 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef STARTUPTASKGRAPH_H
+#define STARTUPTASKGRAPH_H
+
+#include <exception>
+#include <functional>
+#include <vector>
+
+#include <QtAppManCommon/global.h>
+#include <QtCore/QByteArray>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QThreadPool>
+#include <QtCore/QWaitCondition>
+
+QT_BEGIN_NAMESPACE_AM
+
+// The System UI bootstrap as a graph of named tasks with declared dependencies.
+// MainThread tasks are run in the order they were added, as soon as all their dependencies are
+// done. AnyThread tasks are started on a private thread pool as soon as they are ready, so they
+// run concurrently to the main thread. Every finished task is recorded in the StartupTimer.
+
+class StartupTaskGraph
+{
+public:
+    enum Affinity {
+        MainThread,
+        AnyThread,
+    };
+
+    StartupTaskGraph();
+    ~StartupTaskGraph();
+
+    void add(const char *name, Affinity affinity, const QList<const char *> &dependencies,
+             const std::function<void()> &function) noexcept(false);
+    void run() noexcept(false);
+
+private:
+    struct Task
+    {
+        QByteArray name;
+        Affinity affinity;
+        QList<size_t> dependencies;
+        std::function<void()> function;
+        enum { Pending, Running, Done } state = Pending;
+    };
+
+    bool isReady(const Task &task) const;
+    void execute(Task &task);
+
+    std::vector<Task> m_tasks;
+    QThreadPool m_threadPool;
+    QMutex m_mutex;
+    QWaitCondition m_taskFinished;
+    std::exception_ptr m_error;
+
+    Q_DISABLE_COPY_MOVE(StartupTaskGraph)
+};
+
+QT_END_NAMESPACE_AM
+
+#endif // STARTUPTASKGRAPH_H
@@ -53,5 +53,20 @@ void WindowManagerAdaptor::setSlowAnimations(bool slow)
 bool WindowManagerAdaptor::makeScreenshot(const QString &filename, const QString &selector)
 {
     QT_AM_AUTHENTICATE_DBUS(bool)
-    return WindowManager::instance()->makeScreenshot(filename, selector);
+
+    // only reply once all the files have actually been written
+    QDBusContext *dbusContext = DBusContextAdaptor::dbusContextFor(this);
+    auto dbusMsg = dbusContext->message();
+    auto dbusName = dbusContext->connection().name();
+
+    // the callback might already be called from within makeScreenshot(), if all grabs failed
+    dbusContext->setDelayedReply(true);
+
+    bool scheduled = WindowManager::instance()->makeScreenshot(filename, selector, { },
+                                                               [dbusMsg, dbusName](bool success, const QStringList &) {
+        QDBusConnection(dbusName).send(dbusMsg.createReply(success));
+    });
+    if (!scheduled)
+        QDBusConnection(dbusName).send(dbusMsg.createReply(false));
+    return { };
 }
@@ -111,6 +111,14 @@ bool AbstractRuntime::attachApplicationToQuickLauncher(Application *app)
     return false;
 }
 
+// A hint for quick-launchers, that \a app is likely to be attached next. Runtimes supporting this
+// can prepare for it (e.g. by compiling the app's code), but must not actually start it.
+bool AbstractRuntime::preloadApplication(Application *app)
+{
+    Q_UNUSED(app)
+    return false;
+}
+
 Am::RunState AbstractRuntime::state() const
 {
     return m_state;
@@ -72,6 +72,7 @@ public:
 
     virtual bool isQuickLauncher() const;
     virtual bool attachApplicationToQuickLauncher(Application *app);
+    virtual bool preloadApplication(Application *app);
 
     Am::RunState state() const;
 
@@ -45,6 +45,7 @@
 #include "package.h"
 #include "packagemanager.h"
 
+#include <algorithm>
 #include <memory>
 
 using namespace Qt::StringLiterals;
@@ -369,6 +370,94 @@ ApplicationManagerPrivate::~ApplicationManagerPrivate()
     qDeleteAll(apps);
 }
 
+static QString schemeFromMimeType(const QString &mimeType)
+{
+    auto pos = mimeType.indexOf(u'/');
+    if ((pos > 0) && (QStringView(mimeType).left(pos) == u"x-scheme-handler"))
+        return mimeType.mid(pos + 1);
+    return { };
+}
+
+void ApplicationManagerPrivate::addToIndices(Application *app)
+{
+    appsById.insert(app->id(), app);
+
+    const auto mimeTypes = app->supportedMimeTypes();
+    for (const QString &mimeType : mimeTypes) {
+        mimeTypeHandlers[mimeType].append(app);
+        const QString scheme = schemeFromMimeType(mimeType);
+        if (!scheme.isEmpty())
+            schemeHandlers[scheme].append(app);
+    }
+    updateRuntimeIndex(app);
+}
+
+void ApplicationManagerPrivate::removeFromIndices(Application *app)
+{
+    auto removeFromMultiIndex = [app](auto &index, const auto &key) {
+        auto it = index.find(key);
+        if (it != index.end()) {
+            it->removeAll(app);
+            if (it->isEmpty())
+                index.erase(it);
+        }
+    };
+
+    if (appsById.value(app->id()) == app)
+        appsById.remove(app->id());
+
+    const auto mimeTypes = app->supportedMimeTypes();
+    for (const QString &mimeType : mimeTypes) {
+        removeFromMultiIndex(mimeTypeHandlers, mimeType);
+        const QString scheme = schemeFromMimeType(mimeType);
+        if (!scheme.isEmpty())
+            removeFromMultiIndex(schemeHandlers, scheme);
+    }
+
+    const auto entry = runtimeIndexEntries.take(app);
+    if (entry.pid)
+        removeFromMultiIndex(appsByProcessId, entry.pid);
+    if (!entry.securityToken.isEmpty() && (appsBySecurityToken.value(entry.securityToken) == app))
+        appsBySecurityToken.remove(entry.securityToken);
+    appsWithPendingProcessId.remove(app);
+}
+
+void ApplicationManagerPrivate::updateRuntimeIndex(Application *app)
+{
+    const AbstractRuntime *rt = app->currentRuntime();
+    const qint64 pid = rt ? rt->applicationProcessId() : 0;
+    const QByteArray securityToken = rt ? rt->securityToken() : QByteArray();
+
+    RuntimeIndexEntry &entry = runtimeIndexEntries[app];
+
+    if (entry.pid != pid) {
+        if (entry.pid) {
+            auto it = appsByProcessId.find(entry.pid);
+            if (it != appsByProcessId.end()) {
+                it->removeAll(app);
+                if (it->isEmpty())
+                    appsByProcessId.erase(it);
+            }
+        }
+        if (pid)
+            appsByProcessId[pid].append(app);
+        entry.pid = pid;
+    }
+    if (entry.securityToken != securityToken) {
+        if (!entry.securityToken.isEmpty() && (appsBySecurityToken.value(entry.securityToken) == app))
+            appsBySecurityToken.remove(entry.securityToken);
+        if (!securityToken.isEmpty())
+            appsBySecurityToken.insert(securityToken, app);
+        entry.securityToken = securityToken;
+    }
+
+    // the container might only know the PID after the runtime has been attached
+    if (rt && !pid)
+        appsWithPendingProcessId.insert(app);
+    else
+        appsWithPendingProcessId.remove(app);
+}
+
 ApplicationManager *ApplicationManager::s_instance = nullptr;
 
 ApplicationManager *ApplicationManager::createInstance(bool singleProcess)
@@ -502,27 +591,39 @@ QVector<Application *> ApplicationManager::applications() const
 
 Application *ApplicationManager::fromId(const QString &id) const
 {
-    for (Application *app : std::as_const(d->apps)) {
-        if (app->id() == id)
-            return app;
-    }
-    return nullptr;
+    return d->appsById.value(id);
 }
 
 QVector<Application *> ApplicationManager::fromProcessId(qint64 pid) const
 {
     QVector<Application *> apps;
 
+    // catch up on runtimes that did not have a PID yet when they were last indexed
+    if (!d->appsWithPendingProcessId.isEmpty()) {
+        const auto pending = d->appsWithPendingProcessId;
+        for (Application *app : pending)
+            d->updateRuntimeIndex(app);
+    }
+
     // pid could be an indirect child (e.g. when started via gdbserver)
     qint64 appmanPid = QCoreApplication::applicationPid();
 
     int level = 0;
     while ((pid > 1) && (pid != appmanPid) && (level < 5)) {
-        for (Application *app : std::as_const(d->apps)) {
-            if (apps.contains(app))
-                continue;
-            if (app->currentRuntime() && (app->currentRuntime()->applicationProcessId() == pid))
-                apps.append(app);
+        auto it = d->appsByProcessId.constFind(pid);
+        if (it != d->appsByProcessId.cend()) {
+            QVector<Application *> levelApps;
+            for (Application *app : *it) {
+                if (!apps.contains(app))
+                    levelApps.append(app);
+            }
+            // keep the model order within each level, as multiple apps can share a container
+            if (levelApps.size() > 1) {
+                std::sort(levelApps.begin(), levelApps.end(), [this](Application *a1, Application *a2) {
+                    return d->apps.indexOf(a1) < d->apps.indexOf(a2);
+                });
+            }
+            apps.append(levelApps);
         }
         pid = getParentPid(pid);
         ++level;
@@ -535,41 +636,17 @@ Application *ApplicationManager::fromSecurityToken(const QByteArray &securityTok
     if (securityToken.size() != AbstractRuntime::SecurityTokenSize)
         return nullptr;
 
-    for (Application *app : std::as_const(d->apps)) {
-        if (app->currentRuntime() && app->currentRuntime()->securityToken() == securityToken)
-            return app;
-    }
-    return nullptr;
+    return d->appsBySecurityToken.value(securityToken);
 }
 
 QVector<Application *> ApplicationManager::schemeHandlers(const QString &scheme) const
 {
-    QVector<Application *> handlers;
-
-    for (Application *app : std::as_const(d->apps)) {
-        const auto mimeTypes = app->supportedMimeTypes();
-        for (const QString &mime : mimeTypes) {
-            auto pos = mime.indexOf(u'/');
-
-            if ((pos > 0)
-                    && (mime.left(pos) == u"x-scheme-handler")
-                    && (mime.mid(pos + 1) == scheme)) {
-                handlers << app;
-            }
-        }
-    }
-    return handlers;
+    return d->schemeHandlers.value(scheme);
 }
 
 QVector<Application *> ApplicationManager::mimeTypeHandlers(const QString &mimeType) const
 {
-    QVector<Application *> handlers;
-
-    for (Application *app : std::as_const(d->apps)) {
-        if (app->supportedMimeTypes().contains(mimeType))
-            handlers << app;
-    }
-    return handlers;
+    return d->mimeTypeHandlers.value(mimeType);
 }
 
 QVariantMap ApplicationManager::get(Application *app) const
@@ -589,15 +666,9 @@ void ApplicationManager::registerMimeTypes()
     QSet<QString> schemes;
     schemes << u"file"_s << u"http"_s << u"https"_s;
 
-    for (Application *app : std::as_const(d->apps)) {
-        const auto mimeTypes = app->supportedMimeTypes();
-        for (const QString &mime : mimeTypes) {
-            auto pos = mime.indexOf(u'/');
+    for (auto it = d->schemeHandlers.cbegin(); it != d->schemeHandlers.cend(); ++it)
+        schemes << it.key();
 
-            if ((pos > 0) && (mime.left(pos) == u"x-scheme-handler"))
-                schemes << mime.mid(pos + 1);
-        }
-    }
     QSet<QString> registerSchemes = schemes;
     registerSchemes.subtract(d->registeredMimeSchemes);
     QSet<QString> unregisterSchemes = d->registeredMimeSchemes;
@@ -754,7 +825,7 @@ bool ApplicationManager::startApplicationInternal(const QString &appId, const QS
                 } else {
                     // check quicklaunch pool
                     QPair<AbstractContainer *, AbstractRuntime *> quickLaunch =
-                            QuickLauncher::instance()->take(containerId, app->info()->runtimeName());
+                            QuickLauncher::instance()->take(containerId, app->info()->runtimeName(), app->id());
                     container = quickLaunch.first;
                     runtime = quickLaunch.second;
 
@@ -1404,11 +1475,8 @@ Application *ApplicationManager::application(const QString &id) const
 */
 int ApplicationManager::indexOfApplication(const QString &id) const
 {
-    for (int i = 0; i < d->apps.size(); ++i) {
-        if (d->apps.at(i)->id() == id)
-            return i;
-    }
-    return -1;
+    Application *app = fromId(id);
+    return app ? int(d->apps.indexOf(app)) : -1;
 }
 
 /*!
@@ -1460,11 +1528,9 @@ void ApplicationManager::addApplication(ApplicationInfo *appInfo, Package *packa
 {
     // check for id clashes outside of the package (the scanner made sure the package itself is
     // consistent and doesn't have duplicates already)
-    for (Application *checkApp : std::as_const(d->apps)) {
-        if ((checkApp->id() == appInfo->id()) && (checkApp->package() != package)) {
-            throw Exception("found an application with the same id in package %1")
-                .arg(checkApp->packageInfo()->id());
-        }
+    if (Application *checkApp = fromId(appInfo->id()); checkApp && (checkApp->package() != package)) {
+        throw Exception("found an application with the same id in package %1")
+            .arg(checkApp->packageInfo()->id());
     }
 
     auto app = new Application(appInfo, package);
@@ -1490,9 +1556,18 @@ void ApplicationManager::addApplication(ApplicationInfo *appInfo, Package *packa
             this, [this, app]() {
         emitDataChanged(app);
     });
+    connect(app, &Application::runtimeChanged,
+            this, [this, app]() {
+        d->updateRuntimeIndex(app);
+    });
+    connect(app, &Application::runStateChanged,
+            this, [this, app]() {
+        d->updateRuntimeIndex(app);
+    });
 
     beginInsertRows(QModelIndex(), int(d->apps.count()), int(d->apps.count()));
     d->apps << app;
+    d->addToIndices(app);
 
     endInsertRows();
 
@@ -1529,6 +1604,7 @@ void ApplicationManager::removeApplication(ApplicationInfo *appInfo, Package *pa
 
     beginRemoveRows(QModelIndex(), index, index);
     auto app = d->apps.takeAt(index);
+    d->removeFromIndices(app);
 
     endRemoveRows();
 
@@ -27,6 +27,26 @@ public:
     QVector<Application *> apps;
     bool aboutToBeRemoved = false;
 
+    // lookup indices for the hot paths (IPC identification, D-Bus policy checks, openUrl)
+    QHash<QString, Application *> appsById;
+    QHash<QString, QVector<Application *>> mimeTypeHandlers;
+    QHash<QString, QVector<Application *>> schemeHandlers;
+
+    // these depend on the current runtime and are updated on runtime changes
+    struct RuntimeIndexEntry
+    {
+        qint64 pid = 0;
+        QByteArray securityToken;
+    };
+    QHash<Application *, RuntimeIndexEntry> runtimeIndexEntries;
+    QHash<qint64, QVector<Application *>> appsByProcessId;
+    QHash<QByteArray, Application *> appsBySecurityToken;
+    QSet<Application *> appsWithPendingProcessId; // have a runtime, but no PID yet
+
+    void addToIndices(Application *app);
+    void removeFromIndices(Application *app);
+    void updateRuntimeIndex(Application *app);
+
     QString currentLocale;
     QHash<int, QByteArray> roleNames;
 
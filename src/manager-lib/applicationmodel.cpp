@@ -3,6 +3,9 @@
 // Copyright (C) 2018 Pelagicore AG
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
 
+#include <algorithm>
+#include <utility>
+#include <vector>
 #include <QQmlEngine>
 #include <QQmlInfo>
 #include <QJSEngine>
@@ -36,6 +39,19 @@
     \note If you require a model with all applications, with no filtering whatsoever, you should
     use the ApplicationManager directly, as it has better performance.
 
+    Filtering and sorting can either be done via JavaScript callbacks (see filterFunction and
+    sortFunction), or declaratively via filterRoles and sortRoles. The declarative variants are
+    evaluated natively and their results are cached per application, so they should be preferred
+    for larger numbers of applications. They are also kept up-to-date automatically: whenever one
+    of the roles they depend on changes for an application, only this application is re-evaluated.
+
+    \qml
+    ApplicationModel {
+        filterRoles: ({ categories: "games", isBlocked: false })
+        sortRoles: [ "-isRunning", "name" ]
+    }
+    \endqml
+
     The following code snippet displays all the icons of non-aliased applications in a list:
 
     \qml
@@ -98,6 +114,53 @@
     \l {ApplicationModel::invalidate()}{invalidate()}.
 */
 
+/*!
+    \qmlproperty object ApplicationModel::filterRoles
+    \since 6.9
+
+    A declarative filter that is evaluated natively for each application in the ApplicationManager
+    source model. The keys of this map are \l {ApplicationManager Roles}{role names}, while the
+    values are the values that the respective roles need to have for an application to be included
+    in this model. All keys need to match.
+
+    \list
+    \li If the value is a list, the role has to match any of the values in this list.
+    \li If the role itself is a list (e.g. \c categories or \c capabilities), it has to contain
+        the value.
+    \endlist
+
+    \qml
+    filterRoles: ({ categories: [ "games", "media" ], isRunning: true })
+    \endqml
+
+    Contrary to the filterFunction, this filter is automatically reevaluated for an application
+    whenever one of the referenced roles changes. Both filters can be combined: an application needs
+    to be accepted by both of them to be included.
+
+    Unknown role names are ignored with a warning. The default is an empty map, which does not
+    filter at all.
+*/
+
+/*!
+    \qmlproperty list<string> ApplicationModel::sortRoles
+    \since 6.9
+
+    A declarative, multi-key sort order that is evaluated natively. Each entry is the name of one
+    of the \l {ApplicationManager Roles}{roles}: applications are compared by the first role,
+    then by the second one if the first ones are equal, and so on. Prefix a role name with \c{-}
+    to sort in descending order. Strings are compared in a locale aware way.
+
+    \qml
+    sortRoles: [ "-isRunning", "name" ]
+    \endqml
+
+    Contrary to the sortFunction, an application is automatically re-sorted whenever one of the
+    referenced roles changes. If set, this property takes precedence over the sortFunction.
+
+    Unknown role names are ignored with a warning. The default is an empty list, which does not
+    sort at all.
+*/
+
 
 QT_BEGIN_NAMESPACE_AM
 
@@ -108,14 +171,166 @@ public:
     QJSEngine *m_engine = nullptr;
     QJSValue m_filterFunction;
     QJSValue m_sortFunction;
+
+    // the declarative filter and sort specification, resolved to source model roles
+    QVariantMap m_filterRoles;
+    QStringList m_sortRoles;
+    struct Filter {
+        int role;
+        QVariantList acceptedValues;
+    };
+    QList<Filter> m_filters;
+    struct SortKey {
+        int role;
+        bool descending;
+    };
+    QList<SortKey> m_sortKeys;
+
+    // the evaluated specification, indexed by source row
+    struct RowCache {
+        bool valid = false;
+        bool accepted = true;
+        QVariantList sortValues;
+    };
+    std::vector<RowCache> m_rowCache;
+    QList<int> m_resortCandidates;
+
+    bool hasSpecification() const { return !m_filters.isEmpty() || !m_sortKeys.isEmpty(); }
+    bool dependsOn(const QList<int> &roles, bool sortOnly) const;
+    const RowCache &rowCache(const QAbstractItemModel *model, int sourceRow);
+    static bool matches(const QVariant &value, const QVariantList &acceptedValues);
+    static int compare(const QVariant &left, const QVariant &right);
 };
 
+bool ApplicationModelPrivate::dependsOn(const QList<int> &roles, bool sortOnly) const
+{
+    if (roles.isEmpty())
+        return true;
+    for (const auto &sortKey : m_sortKeys) {
+        if (roles.contains(sortKey.role))
+            return true;
+    }
+    if (!sortOnly) {
+        for (const auto &filter : m_filters) {
+            if (roles.contains(filter.role))
+                return true;
+        }
+    }
+    return false;
+}
+
+const ApplicationModelPrivate::RowCache &ApplicationModelPrivate::rowCache(const QAbstractItemModel *model,
+                                                                           int sourceRow)
+{
+    if (size_t(sourceRow) >= m_rowCache.size())
+        m_rowCache.resize(size_t(qMax(sourceRow + 1, model->rowCount())));
+
+    RowCache &rc = m_rowCache[size_t(sourceRow)];
+    if (!rc.valid) {
+        const QModelIndex idx = model->index(sourceRow, 0);
+
+        rc.accepted = std::all_of(m_filters.cbegin(), m_filters.cend(), [&idx](const Filter &filter) {
+            return matches(idx.data(filter.role), filter.acceptedValues);
+        });
+        rc.sortValues.clear();
+        rc.sortValues.reserve(m_sortKeys.size());
+        for (const auto &sortKey : std::as_const(m_sortKeys))
+            rc.sortValues << idx.data(sortKey.role);
+        rc.valid = true;
+    }
+    return rc;
+}
+
+bool ApplicationModelPrivate::matches(const QVariant &value, const QVariantList &acceptedValues)
+{
+    const bool isList = (value.metaType() == QMetaType::fromType<QStringList>())
+                        || (value.metaType() == QMetaType::fromType<QVariantList>());
+    const QVariantList values = isList ? value.toList() : QVariantList { value };
+
+    for (const auto &v : values) {
+        for (const auto &accepted : acceptedValues) {
+            if (compare(v, accepted) == 0)
+                return true;
+        }
+    }
+    return false;
+}
+
+int ApplicationModelPrivate::compare(const QVariant &left, const QVariant &right)
+{
+    if ((left.metaType() == QMetaType::fromType<QString>())
+            && (right.metaType() == QMetaType::fromType<QString>())) {
+        return left.toString().localeAwareCompare(right.toString());
+    }
+    const auto order = QVariant::compare(left, right);
+    if (order == QPartialOrdering::Less)
+        return -1;
+    else if (order == QPartialOrdering::Greater)
+        return 1;
+    else if (order == QPartialOrdering::Equivalent)
+        return 0;
+    // unordered, e.g. different types: compare the string representations as a last resort
+    return left.toString().compare(right.toString());
+}
+
 
 ApplicationModel::ApplicationModel(QObject *parent)
     : QSortFilterProxyModel(parent)
     , d(new ApplicationModelPrivate())
 {
-    setSourceModel(ApplicationManager::instance());
+    auto *am = ApplicationManager::instance();
+
+    // These need to be connected before setting the source model: the cache has to be up-to-date,
+    // before QSortFilterProxyModel reacts to these signals
+    auto clearCache = [this]() { d->m_rowCache.clear(); };
+    connect(am, &QAbstractItemModel::rowsAboutToBeInserted, this, clearCache);
+    connect(am, &QAbstractItemModel::rowsInserted, this, clearCache);
+    connect(am, &QAbstractItemModel::rowsAboutToBeRemoved, this, clearCache);
+    connect(am, &QAbstractItemModel::rowsRemoved, this, clearCache);
+    connect(am, &QAbstractItemModel::rowsMoved, this, clearCache);
+    connect(am, &QAbstractItemModel::layoutChanged, this, clearCache);
+    connect(am, &QAbstractItemModel::modelReset, this, clearCache);
+
+    connect(am, &QAbstractItemModel::dataChanged,
+            this, [this](const QModelIndex &topLeft, const QModelIndex &bottomRight, const QList<int> &roles) {
+        if (!d->hasSpecification() || !d->dependsOn(roles, false))
+            return;
+
+        // QSortFilterProxyModel re-filters the changed rows on its own, but it only re-sorts them if
+        // the sortRole is part of the changed roles
+        const bool resort = d->dependsOn(roles, true) && !roles.isEmpty() && !roles.contains(sortRole());
+
+        for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+            if (size_t(row) < d->m_rowCache.size())
+                d->m_rowCache[size_t(row)].valid = false;
+            if (resort)
+                d->m_resortCandidates << row;
+        }
+    });
+
+    setSourceModel(am);
+
+    connect(am, &QAbstractItemModel::dataChanged, this, [this]() {
+        // we're now after QSortFilterProxyModel's own dataChanged handling
+        if (d->m_resortCandidates.isEmpty())
+            return;
+
+        const auto candidates = std::exchange(d->m_resortCandidates, { });
+        for (int sourceRow : candidates) {
+            const QModelIndex proxyIndex = QSortFilterProxyModel::mapFromSource(sourceModel()->index(sourceRow, 0));
+            if (!proxyIndex.isValid())
+                continue;
+            const int row = proxyIndex.row();
+            const QModelIndex sourceIndex = sourceModel()->index(sourceRow, 0);
+
+            // only do a full resort, if the changed row is not in order anymore
+            if (((row > 0) && lessThan(sourceIndex, QSortFilterProxyModel::mapToSource(index(row - 1, 0))))
+                    || ((row < rowCount() - 1) && lessThan(QSortFilterProxyModel::mapToSource(index(row + 1, 0)), sourceIndex))) {
+                QSortFilterProxyModel::invalidate();
+                break;
+            }
+        }
+    });
 
     connect(this, &QAbstractItemModel::rowsInserted, this, &ApplicationModel::countChanged);
     connect(this, &QAbstractItemModel::rowsRemoved, this, &ApplicationModel::countChanged);
@@ -137,6 +352,9 @@ bool ApplicationModel::filterAcceptsRow(int source_row, const QModelIndex &sourc
 {
     Q_UNUSED(source_parent)
 
+    if (!d->m_filters.isEmpty() && !d->rowCache(sourceModel(), source_row).accepted)
+        return false;
+
     if (!d->m_engine) {
         d->m_engine = qjsEngine(this);
         if (!d->m_engine)
@@ -154,6 +372,17 @@ bool ApplicationModel::filterAcceptsRow(int source_row, const QModelIndex &sourc
 
 bool ApplicationModel::lessThan(const QModelIndex &source_left, const QModelIndex &source_right) const
 {
+    if (!d->m_sortKeys.isEmpty()) {
+        const auto &left = d->rowCache(sourceModel(), source_left.row()).sortValues;
+        const auto &right = d->rowCache(sourceModel(), source_right.row()).sortValues;
+
+        for (qsizetype i = 0; i < d->m_sortKeys.size(); ++i) {
+            if (int cmp = ApplicationModelPrivate::compare(left.at(i), right.at(i)))
+                return d->m_sortKeys.at(i).descending ? (cmp > 0) : (cmp < 0);
+        }
+        return source_left.row() < source_right.row(); // stable
+    }
+
     if (!d->m_engine) {
         d->m_engine = qjsEngine(this);
         if (!d->m_engine)
@@ -208,6 +437,67 @@ void ApplicationModel::setSortFunction(const QJSValue &callback)
     }
 }
 
+QVariantMap ApplicationModel::filterRoles() const
+{
+    return d->m_filterRoles;
+}
+
+void ApplicationModel::setFilterRoles(const QVariantMap &filterRoles)
+{
+    if (filterRoles == d->m_filterRoles)
+        return;
+
+    d->m_filterRoles = filterRoles;
+    d->m_filters.clear();
+
+    const auto roleNames = sourceModel()->roleNames();
+    for (auto it = filterRoles.cbegin(); it != filterRoles.cend(); ++it) {
+        const int role = roleNames.key(it.key().toLatin1(), -1);
+        if (role < 0) {
+            qmlWarning(this) << "ApplicationModel::filterRoles: ignoring the unknown role" << it.key();
+            continue;
+        }
+        const QVariant value = it.value();
+        d->m_filters.append({ role, value.metaType() == QMetaType::fromType<QVariantList>()
+                                        ? value.toList() : QVariantList { value } });
+    }
+    d->m_rowCache.clear();
+
+    emit filterRolesChanged();
+    invalidateFilter();
+}
+
+QStringList ApplicationModel::sortRoles() const
+{
+    return d->m_sortRoles;
+}
+
+void ApplicationModel::setSortRoles(const QStringList &sortRoles)
+{
+    if (sortRoles == d->m_sortRoles)
+        return;
+
+    d->m_sortRoles = sortRoles;
+    d->m_sortKeys.clear();
+
+    const auto roleNames = sourceModel()->roleNames();
+    for (const QString &sortRole : sortRoles) {
+        const bool descending = sortRole.startsWith(u'-');
+        const QString name = descending ? sortRole.mid(1) : sortRole;
+        const int role = roleNames.key(name.toLatin1(), -1);
+        if (role < 0) {
+            qmlWarning(this) << "ApplicationModel::sortRoles: ignoring the unknown role" << name;
+            continue;
+        }
+        d->m_sortKeys.append({ role, descending });
+    }
+    d->m_rowCache.clear();
+
+    emit sortRolesChanged();
+    invalidate();
+    sort(0);
+}
+
 /*!
     \qmlmethod int ApplicationModel::indexOfApplication(string id)
 
@@ -261,6 +551,7 @@ int ApplicationModel::mapFromSource(int sourceIndex) const
 */
 void ApplicationModel::invalidate()
 {
+    d->m_rowCache.clear();
     QSortFilterProxyModel::invalidate();
 }
 
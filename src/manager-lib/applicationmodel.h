@@ -7,6 +7,8 @@
 #define APPLICATIONMODEL_H
 
 #include <QtCore/QSortFilterProxyModel>
+#include <QtCore/QStringList>
+#include <QtCore/QVariantMap>
 #include <QtQml/QJSValue>
 #include <QtQml/QQmlParserStatus>
 #include <QtAppManCommon/global.h>
@@ -25,6 +27,8 @@ class ApplicationModel : public QSortFilterProxyModel, public QQmlParserStatus
     Q_PROPERTY(int count READ count NOTIFY countChanged FINAL)
     Q_PROPERTY(QJSValue filterFunction READ filterFunction WRITE setFilterFunction NOTIFY filterFunctionChanged FINAL)
     Q_PROPERTY(QJSValue sortFunction READ sortFunction WRITE setSortFunction NOTIFY sortFunctionChanged FINAL)
+    Q_PROPERTY(QVariantMap filterRoles READ filterRoles WRITE setFilterRoles NOTIFY filterRolesChanged FINAL)
+    Q_PROPERTY(QStringList sortRoles READ sortRoles WRITE setSortRoles NOTIFY sortRolesChanged FINAL)
 
 public:
     ApplicationModel(QObject *parent = nullptr);
@@ -38,6 +42,12 @@ public:
     QJSValue sortFunction() const;
     void setSortFunction(const QJSValue &callback);
 
+    QVariantMap filterRoles() const;
+    void setFilterRoles(const QVariantMap &filterRoles);
+
+    QStringList sortRoles() const;
+    void setSortRoles(const QStringList &sortRoles);
+
     Q_INVOKABLE int indexOfApplication(const QString &id) const;
     Q_INVOKABLE int indexOfApplication(QtAM::Application *application) const;
     Q_INVOKABLE int mapToSource(int ourIndex) const;
@@ -58,6 +68,8 @@ Q_SIGNALS:
     void countChanged();
     void filterFunctionChanged();
     void sortFunctionChanged();
+    void filterRolesChanged();
+    void sortRolesChanged();
 
 private:
     ApplicationModelPrivate *d;
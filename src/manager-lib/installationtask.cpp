@@ -123,6 +123,12 @@ bool InstallationTask::cancel()
     return true;
 }
 
+void InstallationTask::setThroughputLimits(qint64 downloadRateLimit, qint64 diskWriteRateLimit)
+{
+    m_downloadRateLimit = downloadRateLimit;
+    m_diskWriteRateLimit = diskWriteRateLimit;
+}
+
 void InstallationTask::acknowledge()
 {
     QMutexLocker locker(&m_mutex);
@@ -150,6 +156,8 @@ void InstallationTask::execute()
             throw Exception(Error::Canceled, "canceled");
 
         m_extractor = new PackageExtractor(m_sourceUrl, QDir(extractionDir.path()));
+        m_extractor->setDownloadRateLimit(m_downloadRateLimit);
+        m_extractor->setDiskWriteRateLimit(m_diskWriteRateLimit);
         locker.unlock();
 
         connect(m_extractor, &PackageExtractor::progress, this, &AsynchronousTask::progress);
@@ -297,9 +305,11 @@ void InstallationTask::checkExtractedFile(const QString &file) noexcept(false)
         // we're not interested in any other files from here on...
         m_extractor->setFileExtractedCallback(nullptr);
 
+        // multiple installation tasks might be extracting in parallel, so checking and claiming
+        // the package id has to be done in one step
         bool doubleInstallation = false;
         QMetaObject::invokeMethod(PackageManager::instance(), [this, &doubleInstallation]() {
-            doubleInstallation = PackageManager::instance()->isPackageInstallationActive(m_packageId);
+            doubleInstallation = !PackageManager::instance()->claimPackageInstallation(m_packageId, this);
         }, Qt::BlockingQueuedConnection);
         if (doubleInstallation)
             throw Exception(Error::Package, "Cannot install the same package %1 multiple times in parallel").arg(m_packageId);
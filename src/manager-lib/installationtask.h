@@ -37,6 +37,9 @@ public:
     void acknowledge();
     bool cancel() override;
 
+    // per-task budgets in bytes per second (0 means unlimited)
+    void setThroughputLimits(qint64 downloadRateLimit, qint64 diskWriteRateLimit);
+
 Q_SIGNALS:
     void finishedPackageExtraction();
 
@@ -53,6 +56,8 @@ private:
     QString m_installationPath;
     QString m_documentPath;
     QUrl m_sourceUrl;
+    qint64 m_downloadRateLimit = 0;
+    qint64 m_diskWriteRateLimit = 0;
     bool m_foundInfo = false;
     bool m_foundIcon = false;
     QString m_iconFileName;
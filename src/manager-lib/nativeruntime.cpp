@@ -14,6 +14,7 @@
 #include <QUuid>
 #include <QLibraryInfo>
 #include <QStringBuilder>
+#include <QCborValue>
 #include <QDBusConnection>
 #include "dbuscontextadaptor.h"
 
@@ -28,6 +29,8 @@
 #include "notificationmanager.h"
 #include "dbus-utilities.h"
 #include "processtitle.h"
+#include "processcontainer.h"
+#include "exception.h"
 
 #include "runtimeinterface_adaptor.h"
 #include "applicationinterface_adaptor.h"
@@ -145,6 +148,7 @@ bool NativeRuntime::attachApplicationToQuickLauncher(Application *app)
         return false;
 
     m_isQuickLauncher = false;
+    m_preloadApp.clear();
     m_app = app;
     m_app->setCurrentRuntime(this);
 
@@ -164,6 +168,22 @@ bool NativeRuntime::attachApplicationToQuickLauncher(Application *app)
     return ret;
 }
 
+bool NativeRuntime::preloadApplication(Application *app)
+{
+    if (!app || !isQuickLauncher() || !m_startedViaLauncher)
+        return false;
+    // the launcher cannot unload what it preloaded, so it is bound to the first application
+    if (m_preloadApp)
+        return (app == m_preloadApp);
+
+    m_preloadApp = app;
+
+    // if the launcher has not finished its initialization yet, the hint is sent afterwards
+    if (m_connectedToApplicationInterface)
+        preloadApplicationViaLauncher();
+    return true;
+}
+
 bool NativeRuntime::initialize()
 {
     if (m_startedViaLauncher) {
@@ -278,6 +298,14 @@ bool NativeRuntime::start()
         { u"useAMConsoleLogger"_s, Logging::useAMConsoleLogger() }
     };
 
+    if (Logging::isAsyncOutputEnabled()) {
+        loggingConfig.insert(u"asyncOutput"_s, QVariantMap {
+            { u"enabled"_s, true },
+            { u"queueSize"_s, Logging::asyncOutputQueueSize() },
+            { u"overflowPolicy"_s, Logging::asyncOutputOverflowPolicy() }
+        });
+    }
+
     if (Logging::isDltAvailable()) {
         loggingConfig.insert(u"dlt"_s, Logging::isDltEnabled());
         if (Logging::isDltEnabled())
@@ -332,10 +360,30 @@ bool NativeRuntime::start()
         { u"QT_QPA_PLATFORM"_s, u"wayland"_s },
         { u"QT_IM_MODULE"_s, QString() },     // Applications should use wayland text input
         { u"QT_SCALE_FACTOR"_s, QString() },  // do not scale wayland clients
-        { u"AM_CONFIG"_s, QString::fromUtf8(QtYaml::yamlFromVariantDocuments({ config })) },
         { u"QT_WAYLAND_SHELL_INTEGRATION"_s, u"xdg-shell"_s},
     };
 
+    // Passing the configuration as a sealed CBOR memfd saves the YAML serialization here and the
+    // YAML parsing in the application. This needs a container that can pass on file descriptors.
+    bool configPassedViaFd = false;
+#if defined(Q_OS_LINUX)
+    auto processContainer = qobject_cast<ProcessContainer *>(m_container);
+    if (processContainer && (configuration().value(u"configurationHandoff"_s).toString() == u"memfd")) {
+        try {
+            int fd = createSealedMemfd("am-config", QCborValue::fromVariant(config).toCbor());
+            processContainer->addInheritedFileDescriptor(fd);
+            env.insert(u"AM_CONFIG_FD"_s, QString::number(fd));
+            env.insert(u"AM_CONFIG"_s, QString());
+            configPassedViaFd = true;
+        } catch (const Exception &e) {
+            qCWarning(LogSystem) << "Could not pass the configuration via a memfd, falling back to"
+                                    " AM_CONFIG:" << e.what();
+        }
+    }
+#endif
+    if (!configPassedViaFd)
+        env.insert(u"AM_CONFIG"_s, QString::fromUtf8(QtYaml::yamlFromVariantDocuments({ config })));
+
     for (const auto *var : {
          "AM_STARTUP_TIMER", "AM_NO_CUSTOM_LOGGING", "AM_NO_CRASH_HANDLER", "AM_FORCE_COLOR_OUTPUT",
          "AM_TIMEOUT_FACTOR", "QT_MESSAGE_PATTERN", "ASAN_OPTIONS", "LSAN_OPTIONS", "TSAN_OPTIONS" }) {
@@ -495,6 +543,8 @@ void NativeRuntime::applicationFinishedInitialization()
             startApplicationViaLauncher();
 
         setState(Am::Running);
+    } else if (m_preloadApp) {
+        preloadApplicationViaLauncher();
     }
 }
 
@@ -513,6 +563,23 @@ bool NativeRuntime::startApplicationViaLauncher()
     return true;
 }
 
+bool NativeRuntime::preloadApplicationViaLauncher()
+{
+    if (!m_startedViaLauncher || !m_isQuickLauncher || !m_dbusRuntimeInterface->isRegistered() || !m_preloadApp)
+        return false;
+
+    QString baseDir = m_container->mapHostPathToContainer(m_preloadApp->codeDir());
+    QString pathInContainer = m_container->mapHostPathToContainer(m_preloadApp->info()->absoluteCodeFilePath());
+
+    qCDebug(LogQuickLaunch) << "Asking quick-launcher" << applicationProcessId() << "to preload"
+                            << m_preloadApp->id();
+
+    emit m_dbusRuntimeInterface->generatedAdaptor<RuntimeInterfaceAdaptor>()
+        ->preloadApplication(baseDir, pathInContainer,
+                             convertToDBusVariant(m_preloadApp->info()->toVariantMap()).toMap());
+    return true;
+}
+
 qint64 NativeRuntime::applicationProcessId() const
 {
     return m_process ? m_process->processId() : 0;
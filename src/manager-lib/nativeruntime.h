@@ -10,6 +10,7 @@
 
 #include <QtCore/QtPlugin>
 #include <QtCore/QVector>
+#include <QtCore/QPointer>
 
 #include <QtAppManManager/abstractruntime.h>
 #include <QtAppManManager/abstractcontainer.h>
@@ -50,6 +51,7 @@ public:
 
     bool isQuickLauncher() const override;
     bool attachApplicationToQuickLauncher(Application *app) override;
+    bool preloadApplication(Application *app) override;
 
     qint64 applicationProcessId() const override;
     void openDocument(const QString &document, const QString &mimeType) override;
@@ -87,12 +89,14 @@ private:
     void shutdown(int exitCode, Am::ExitStatus status);
     QDBusServer *applicationInterfaceServer() const;
     bool startApplicationViaLauncher();
+    bool preloadApplicationViaLauncher();
 
     bool m_isQuickLauncher;
     bool m_startedViaLauncher;
 
     QString m_document;
     QString m_mimeType;
+    QPointer<Application> m_preloadApp;
     bool m_connectedToApplicationInterface = false;
     bool m_dbusConnection = false;
     QString m_dbusConnectionName;
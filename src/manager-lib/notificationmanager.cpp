@@ -8,6 +8,9 @@
 #include <QTimer>
 #include <QMetaObject>
 #include <QScopedValueRollback>
+#include <QSet>
+#include <algorithm>
+#include <utility>
 
 #include "global.h"
 #include "logging.h"
@@ -35,6 +38,12 @@ using namespace Qt::StringLiterals;
 
     Each item in this model corresponds to an active notification.
 
+    In order to cope with a high rate of notification requests, all model changes are collected and
+    applied once per event loop iteration: added, changed and removed notifications are each
+    reported via as few model signals as possible. This also means that a notification that has
+    been dismissed or closed will only be removed from the model, once the event loop is entered
+    again. See also maximumCount.
+
     \target NotificationManager Roles
 
     The following roles are available in this model - also take a look at the
@@ -250,6 +259,7 @@ struct NotificationData
     QDateTime updated;
 
     QTimer *timer = nullptr;
+    bool closing = false; // closed, but not yet removed from the model
 };
 
 enum CloseReason
@@ -267,23 +277,41 @@ public:
     {
         qDeleteAll(notifications);
         notifications.clear();
+        qDeleteAll(pendingInserts);
+        pendingInserts.clear();
     }
 
     int findNotificationById(uint id) const
     {
-        for (int i = 0; i < notifications.count(); ++i) {
-            if (notifications.at(i)->id == id)
-                return i;
+        if (rowIndexDirty) {
+            rowById.clear();
+            rowById.reserve(notifications.size());
+            for (int i = 0; i < notifications.count(); ++i)
+                rowById.insert(notifications.at(i)->id, i);
+            rowIndexDirty = false;
         }
-        return -1;
+        int i = rowById.value(id, -1);
+        return ((i >= 0) && !notifications.at(i)->closing) ? i : -1;
     }
 
     void closeNotification(uint id, CloseReason reason);
+    void scheduleFlush();
+    void flush();
+    void evict();
 
     NotificationManager *q = nullptr;
     QHash<int, QByteArray> roleNames;
     QList<NotificationData *> notifications;
+    mutable QHash<uint, int> rowById;
+    mutable bool rowIndexDirty = false;
     bool aboutToBeRemoved = false;
+    int maximumCount = 0;
+
+    // model changes that are applied in one go by flush()
+    QList<NotificationData *> pendingInserts;
+    QSet<NotificationData *> pendingChanges;
+    int pendingRemovals = 0;
+    bool flushScheduled = false;
 };
 
 NotificationManager *NotificationManager::s_instance = nullptr;
@@ -429,6 +457,33 @@ QHash<int, QByteArray> NotificationManager::roleNames() const
     return d->roleNames;
 }
 
+/*!
+    \qmlproperty int NotificationManager::maximumCount
+
+    Limits the number of notifications in the model. If a new notification would exceed this limit,
+    the oldest non-sticky notifications (the ones with a timeout) are closed early, as if their
+    timeout had expired. Sticky notifications are never closed automatically, so the limit may
+    still be exceeded if there are more sticky notifications than that.
+
+    This protects the System UI from applications that flood it with notifications.
+
+    The default value is \c 0, which means that the number of notifications is not limited.
+*/
+int NotificationManager::maximumCount() const
+{
+    return d->maximumCount;
+}
+
+void NotificationManager::setMaximumCount(int maximumCount)
+{
+    maximumCount = qMax(0, maximumCount);
+    if (maximumCount != d->maximumCount) {
+        d->maximumCount = maximumCount;
+        emit maximumCountChanged();
+        d->scheduleFlush();
+    }
+}
+
 /*!
     \qmlproperty int NotificationManager::count
     \readonly
@@ -620,15 +675,8 @@ uint NotificationManager::showNotification(const QString &app_name, uint replace
     n->timeout = qMax(0, timeout);
     n->extended = convertFromDBusVariant(hints.value(u"x-pelagicore-extended"_s)).toMap();
 
-    if (replaces_id == 0) { // new notification
-        // we need to delay the model update until the client has a valid id
-        QMetaObject::invokeMethod(this, [this, n, timeout]() {
-                    notifyHelper(n, false, timeout);
-                }, Qt::QueuedConnection);
-        return n->id;
-    } else {
-        return notifyHelper(n, true, timeout);
-    }
+    // the model update is delayed until the next flush(), so the client has a valid id by then
+    return notifyHelper(n, replaces_id != 0, timeout);
 }
 
 uint NotificationManager::notifyHelper(NotificationData *n, bool replaces, int timeout)
@@ -636,20 +684,11 @@ uint NotificationManager::notifyHelper(NotificationData *n, bool replaces, int t
     uint id = n->id;
     Q_ASSERT(id);
 
-    if (replaces) {
-        QModelIndex idx = index(int(d->notifications.indexOf(n)), 0);
-        emit dataChanged(idx, idx);
-        static const auto nChanged = QMetaMethod::fromSignal(&NotificationManager::notificationChanged);
-        if (isSignalConnected(nChanged)) {
-            // we could do better here and actually find out which fields changed...
-            emit notificationChanged(n->id, QStringList());
-        }
-    } else {
-        beginInsertRows(QModelIndex(), rowCount(), rowCount());
-        d->notifications << n;
-        endInsertRows();
-        emit notificationAdded(n->id);
-    }
+    if (replaces)
+        d->pendingChanges.insert(n);
+    else
+        d->pendingInserts << n;
+    d->scheduleFlush();
 
     if (timeout > 0) {
         delete n->timer;
@@ -690,14 +729,139 @@ void NotificationManagerPrivate::closeNotification(uint id, CloseReason reason)
 
     emit q->notificationAboutToBeRemoved(id);
 
-    q->beginRemoveRows(QModelIndex(), i, i);
-    auto n = notifications.takeAt(i);
-    q->endRemoveRows();
+    // the actual removal from the model is done in flush()
+    notifications.at(i)->closing = true;
+    ++pendingRemovals;
+    scheduleFlush();
 
     emit q->internalSignals.notificationClosed(id, uint(reason));
+}
+
+void NotificationManagerPrivate::scheduleFlush()
+{
+    if (!flushScheduled) {
+        flushScheduled = true;
+        QMetaObject::invokeMethod(q, [this]() { flush(); }, Qt::QueuedConnection);
+    }
+}
+
+void NotificationManagerPrivate::flush()
+{
+    flushScheduled = false;
 
-    qCDebug(LogNotifications) << "Deleting notification with id:" << id;
-    delete n;
+    if (maximumCount)
+        evict();
+
+    // removals: back to front, one signal per contiguous range of rows
+    if (pendingRemovals) {
+        for (int last = int(notifications.size()) - 1; last >= 0; ) {
+            if (!notifications.at(last)->closing) {
+                --last;
+                continue;
+            }
+            int first = last;
+            while ((first > 0) && notifications.at(first - 1)->closing)
+                --first;
+
+            q->beginRemoveRows(QModelIndex(), first, last);
+            const auto removed = notifications.mid(first, last - first + 1);
+            notifications.remove(first, last - first + 1);
+            rowIndexDirty = true;
+            q->endRemoveRows();
+
+            for (auto *n : removed) {
+                qCDebug(LogNotifications) << "Deleting notification with id:" << n->id;
+                pendingChanges.remove(n);
+                delete n;
+            }
+            last = first - 1;
+        }
+        pendingRemovals = 0;
+    }
+
+    // changes: one signal per contiguous range of rows
+    if (!pendingChanges.isEmpty()) {
+        QList<int> rows;
+        rows.reserve(pendingChanges.size());
+        for (const auto *n : std::as_const(pendingChanges)) {
+            int row = findNotificationById(n->id);
+            if (row >= 0)
+                rows << row;
+        }
+        pendingChanges.clear();
+        std::sort(rows.begin(), rows.end());
+
+        for (qsizetype i = 0; i < rows.size(); ) {
+            qsizetype j = i;
+            while ((j + 1 < rows.size()) && (rows.at(j + 1) == rows.at(j) + 1))
+                ++j;
+            emit q->dataChanged(q->index(rows.at(i), 0), q->index(rows.at(j), 0));
+            i = j + 1;
+        }
+
+        static const auto nChanged = QMetaMethod::fromSignal(&NotificationManager::notificationChanged);
+        if (q->isSignalConnected(nChanged)) {
+            for (int row : std::as_const(rows)) {
+                // we could do better here and actually find out which fields changed...
+                emit q->notificationChanged(notifications.at(row)->id, QStringList());
+            }
+        }
+    }
+
+    // insertions: always at the end
+    if (!pendingInserts.isEmpty()) {
+        const auto inserts = std::exchange(pendingInserts, { });
+        const int first = int(notifications.size());
+
+        q->beginInsertRows(QModelIndex(), first, first + int(inserts.size()) - 1);
+        notifications.append(inserts);
+        if (!rowIndexDirty) {
+            for (int i = first; i < notifications.size(); ++i)
+                rowById.insert(notifications.at(i)->id, i);
+        }
+        q->endInsertRows();
+
+        for (const auto *n : inserts)
+            emit q->notificationAdded(n->id);
+    }
+}
+
+void NotificationManagerPrivate::evict()
+{
+    int excess = int(notifications.size()) - pendingRemovals + int(pendingInserts.size()) - maximumCount;
+    if (excess <= 0)
+        return;
+
+    // the oldest non-sticky notifications go first: they are due to expire anyway
+    QList<uint> evictedIds;
+    for (const auto *n : std::as_const(notifications)) {
+        if (excess <= evictedIds.size())
+            break;
+        if (!n->closing && (n->timeout > 0))
+            evictedIds << n->id;
+    }
+    for (const uint id : std::as_const(evictedIds))
+        closeNotification(id, TimeoutExpired);
+    excess -= int(evictedIds.size());
+
+    // new notifications that were never part of the model can just be dropped
+    for (auto it = pendingInserts.begin(); (excess > 0) && (it != pendingInserts.end()); ) {
+        NotificationData *n = *it;
+        if (n->timeout > 0) {
+            qCDebug(LogNotifications) << "Dropping new notification with id:" << n->id
+                                      << "(maximumCount exceeded)";
+            it = pendingInserts.erase(it);
+            emit q->internalSignals.notificationClosed(n->id, uint(TimeoutExpired));
+            delete n;
+            --excess;
+        } else {
+            ++it;
+        }
+    }
+    if (!evictedIds.isEmpty()) {
+        qCDebug(LogNotifications) << "Evicted" << evictedIds.size()
+                                  << "notifications (maximumCount exceeded)";
+    }
 }
 
 QT_END_NAMESPACE_AM
@@ -34,6 +34,7 @@ class NotificationManager : public QAbstractListModel
     Q_OBJECT
     Q_CLASSINFO("D-Bus Interface", "org.freedesktop.Notifications")
     Q_PROPERTY(int count READ count NOTIFY countChanged FINAL)
+    Q_PROPERTY(int maximumCount READ maximumCount WRITE setMaximumCount NOTIFY maximumCountChanged FINAL)
 
 public:
     ~NotificationManager() override;
@@ -46,6 +47,8 @@ public:
     QHash<int, QByteArray> roleNames() const override;
 
     int count() const;
+    int maximumCount() const;
+    void setMaximumCount(int maximumCount);
     Q_INVOKABLE QVariantMap get(int index) const;
     Q_INVOKABLE QVariantMap notification(uint id) const;
     Q_INVOKABLE int indexOfNotification(uint id) const;
@@ -63,6 +66,7 @@ public:
 
 Q_SIGNALS:
     void countChanged();
+    void maximumCountChanged();
     void notificationAdded(uint id);
     void notificationAboutToBeRemoved(uint id);
     void notificationChanged(uint id, const QStringList &rolesChanged);
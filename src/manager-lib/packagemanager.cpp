@@ -8,6 +8,7 @@
 #include <QVersionNumber>
 #include <QCoreApplication>
 #include <QScopedValueRollback>
+#include <QTimer>
 #include "packagemanager.h"
 #include "packagedatabase.h"
 #include "packagemanager_p.h"
@@ -15,6 +16,7 @@
 #include "applicationinfo.h"
 #include "intentinfo.h"
 #include "package.h"
+#include "application.h"
 #include "logging.h"
 #include "installationreport.h"
 #include "exception.h"
@@ -39,6 +41,7 @@
 #endif
 
 #include <memory>
+#include <algorithm>
 
 using namespace Qt::StringLiterals;
 
@@ -368,6 +371,9 @@ void PackageManager::registerPackages()
     // something might have been queued already before the cleanup had finished
     triggerExecuteNextTask();
 #endif
+
+    if (d->rescanPending)
+        rescanPackageDatabase();
 }
 
 Package *PackageManager::registerPackage(PackageInfo *packageInfo, PackageInfo *updatedPackageInfo,
@@ -451,6 +457,122 @@ void PackageManager::unregisterApplicationsAndIntentsOfPackage(Package *package)
     }
 }
 
+void PackageManager::rescanPackageDatabase()
+{
+    // we cannot apply any changes before the initial registration is done and while the installer
+    // is busy with the installation directory: we will try again as soon as this changes
+    bool busy = !d->cleanupBrokenInstallationsDone;
+#if QT_CONFIG(am_installer)
+    busy = busy || !d->allTasks().isEmpty();
+#endif
+    if (busy) {
+        d->rescanPending = true;
+        return;
+    }
+    d->rescanPending = false;
+
+    // packages that are in use cannot be swapped out under the running applications
+    QStringList skipPackageIds;
+    for (const Package *package : std::as_const(d->packages)) {
+        bool inUse = package->isBlocked() || (package->state() != Package::Installed);
+        const auto apps = package->applications();
+        for (const Application *app : apps)
+            inUse = inUse || (app->runState() != Am::NotRunning);
+        if (inUse)
+            skipPackageIds << package->id();
+    }
+
+    if (!d->database->rescan(skipPackageIds) && !d->rescanRetryScheduled) {
+        qCDebug(LogSystem) << "Deferring package database changes for packages in use:" << skipPackageIds;
+
+        d->rescanRetryScheduled = true;
+        QTimer::singleShot(5000, this, [this]() {
+            d->rescanRetryScheduled = false;
+            rescanPackageDatabase();
+        });
+    }
+}
+
+void PackageManager::addPackageFromDatabase(PackageInfo *packageInfo)
+{
+    Package *package = fromId(packageInfo->id());
+
+    if (!package) {
+        package = new Package(packageInfo, Package::Installed);
+        QQmlEngine::setObjectOwnership(package, QQmlEngine::CppOwnership);
+
+        beginInsertRows(QModelIndex(), int(d->packages.count()), int(d->packages.count()));
+        d->packages << package;
+        endInsertRows();
+
+        qCDebug(LogSystem).nospace().noquote() << " + package: " << package->id() << " [at: "
+                                               << QDir().relativeFilePath(package->info()->baseDir().path()) << "]";
+
+        emit packageAdded(package->id());
+        registerApplicationsAndIntentsOfPackage(package);
+    } else {
+        // the database only allows installed updates to built-in packages to clash
+        Q_ASSERT(package->isBuiltIn() && !package->updatedInfo());
+
+        unregisterApplicationsAndIntentsOfPackage(package);
+        package->setUpdatedInfo(packageInfo);
+        registerApplicationsAndIntentsOfPackage(package);
+        emitDataChanged(package);
+    }
+}
+
+void PackageManager::changePackageFromDatabase(PackageInfo *oldPackageInfo, PackageInfo *newPackageInfo)
+{
+    Package *package = fromId(oldPackageInfo->id());
+    if (!package)
+        return;
+
+    unregisterApplicationsAndIntentsOfPackage(package);
+    if (package->baseInfo() == oldPackageInfo)
+        package->setBaseInfo(newPackageInfo);
+    else if (package->updatedInfo() == oldPackageInfo)
+        package->setUpdatedInfo(newPackageInfo);
+    registerApplicationsAndIntentsOfPackage(package);
+    emitDataChanged(package);
+}
+
+void PackageManager::removePackageFromDatabase(PackageInfo *packageInfo)
+{
+    Package *package = fromId(packageInfo->id());
+    if (!package)
+        return;
+
+    if ((package->updatedInfo() == packageInfo)
+            || ((package->baseInfo() == packageInfo) && package->updatedInfo())) {
+        // either the update to a built-in package vanished, or the built-in package itself: in
+        // the latter case, the update takes over
+        unregisterApplicationsAndIntentsOfPackage(package);
+        PackageInfo *updatedInfo = package->setUpdatedInfo(nullptr);
+        if (package->baseInfo() == packageInfo)
+            package->setBaseInfo(updatedInfo);
+        registerApplicationsAndIntentsOfPackage(package);
+        emitDataChanged(package);
+
+    } else if (package->baseInfo() == packageInfo) {
+        unregisterApplicationsAndIntentsOfPackage(package);
+
+        qsizetype row = d->packages.indexOf(package);
+        if (row >= 0) {
+            if (d->aboutToBeRemoved) {
+                qCFatal(LogSystem) << "PackageManager was instructed to remove packages recursively";
+                return;
+            }
+            QScopedValueRollback<bool> rollback(d->aboutToBeRemoved, true);
+
+            emit packageAboutToBeRemoved(package->id());
+            beginRemoveRows(QModelIndex(), int(row), int(row));
+            d->packages.removeAt(row);
+            endRemoveRows();
+        }
+        delete package;
+    }
+}
+
 QVector<Package *> PackageManager::packages() const
 {
     return d->packages;
@@ -481,6 +603,15 @@ PackageManager::PackageManager(PackageDatabase *packageDatabase,
     d->database = packageDatabase;
     d->installationPath = packageDatabase->installedPackagesDir();
     d->documentPath = documentPath;
+
+    connect(packageDatabase, &PackageDatabase::packageDirectoriesChanged,
+            this, &PackageManager::rescanPackageDatabase);
+    connect(packageDatabase, &PackageDatabase::packageInfoAdded,
+            this, &PackageManager::addPackageFromDatabase);
+    connect(packageDatabase, &PackageDatabase::packageInfoChanged,
+            this, &PackageManager::changePackageFromDatabase);
+    connect(packageDatabase, &PackageDatabase::packageInfoAboutToBeRemoved,
+            this, &PackageManager::removePackageFromDatabase);
 }
 
 PackageManager::~PackageManager()
@@ -751,6 +882,25 @@ void PackageManager::setCACertificates(const QByteArrayList &chainOfTrust)
     d->chainOfTrust = chainOfTrust;
 }
 
+int PackageManager::maximumConcurrentInstallations() const
+{
+    return d->maximumConcurrentInstallations;
+}
+
+void PackageManager::setMaximumConcurrentInstallations(int maximum)
+{
+    d->maximumConcurrentInstallations = std::max(1, maximum);
+#if QT_CONFIG(am_installer)
+    triggerExecuteNextTask();
+#endif
+}
+
+void PackageManager::setInstallationThroughputLimits(qint64 downloadRateLimit, qint64 diskWriteRateLimit)
+{
+    d->downloadRateLimit = std::max(qint64(0), downloadRateLimit);
+    d->diskWriteRateLimit = std::max(qint64(0), diskWriteRateLimit);
+}
+
 static QVariantMap locationMap(const QString &path)
 {
     QString cpath = QFileInfo(path).canonicalPath();
@@ -834,6 +984,8 @@ QVariantMap PackageManager::documentLocation() const
 bool PackageManager::isPackageInstallationActive(const QString &packageId) const
 {
 #if QT_CONFIG(am_installer)
+    if (d->claimedPackageIds.contains(packageId))
+        return true;
     for (const auto *t : std::as_const(d->installationTaskList)) {
         if (t->packageId() == packageId)
             return true;
@@ -1028,8 +1180,11 @@ QString PackageManager::startPackageInstallation(const QUrl &sourceUrl)
     AM_TRACE(LogInstaller, sourceUrl)
 
 #if QT_CONFIG(am_installer)
-    if (d->enableInstaller)
-        return enqueueTask(new InstallationTask(d->installationPath, d->documentPath, sourceUrl));
+    if (d->enableInstaller) {
+        auto task = new InstallationTask(d->installationPath, d->documentPath, sourceUrl);
+        task->setThroughputLimits(d->downloadRateLimit, d->diskWriteRateLimit);
+        return enqueueTask(task);
+    }
 #endif
     return QString();
 }
@@ -1226,10 +1381,12 @@ bool PackageManager::cancelTask(const QString &taskId)
             }
         }
 
-        // the active task and async tasks might be in a state where cancellation is not possible,
+        // the active tasks and async tasks might be in a state where cancellation is not possible,
         // so we have to ask them nicely
-        if (d->activeTask && d->activeTask->id() == taskId)
-            return d->activeTask->cancel();
+        for (AsynchronousTask *task : std::as_const(d->activeTasks)) {
+            if (task->id() == taskId)
+                return task->cancel();
+        }
 
         for (AsynchronousTask *task : std::as_const(d->installationTaskList)) {
             if (task->id() == taskId)
@@ -1266,9 +1423,20 @@ void PackageManager::triggerExecuteNextTask()
 void PackageManager::executeNextTask()
 {
 #if QT_CONFIG(am_installer)
-    if (!d->cleanupBrokenInstallationsDone || d->activeTask || d->incomingTaskList.isEmpty())
+    if (!d->cleanupBrokenInstallationsDone || d->incomingTaskList.isEmpty())
         return;
 
+    // Up to maximumConcurrentInstallations installation tasks can download and extract in
+    // parallel, while all other tasks still need exclusive access. The final installation steps
+    // are serialized by the InstallationTasks themselves.
+    const bool isInstallation = qobject_cast<InstallationTask *>(d->incomingTaskList.constFirst());
+    if (!d->activeTasks.isEmpty()) {
+        if (!isInstallation || !qobject_cast<InstallationTask *>(d->activeTasks.constFirst())
+                || (d->activeTasks.size() >= d->maximumConcurrentInstallations)) {
+            return;
+        }
+    }
+
     AsynchronousTask *task = d->incomingTaskList.takeFirst();
 
     if (task->state() == AsynchronousTask::Failed) {
@@ -1308,12 +1476,16 @@ void PackageManager::executeNextTask()
             emit taskFinished(task->id());
         }
 
-        if (d->activeTask == task)
-            d->activeTask = nullptr;
+        d->activeTasks.removeOne(task);
         d->installationTaskList.removeOne(task);
+        if (d->claimedPackageIds.value(task->packageId()) == task)
+            d->claimedPackageIds.remove(task->packageId());
 
         delete task;
         triggerExecuteNextTask();
+
+        if (d->rescanPending)
+            rescanPackageDatabase();
     });
 
     if (qobject_cast<InstallationTask *>(task)) {
@@ -1324,17 +1496,20 @@ void PackageManager::executeNextTask()
             // we can now start the next download in parallel - the InstallationTask will take care
             // of serializing the final installation steps on its own as soon as it gets the
             // required acknowledge (or cancel).
-            if (d->activeTask == task)
-                d->activeTask = nullptr;
+            d->activeTasks.removeOne(task);
             d->installationTaskList.append(task);
             triggerExecuteNextTask();
         });
     }
 
 
-    d->activeTask = task;
+    d->activeTasks.append(task);
     task->setState(AsynchronousTask::Executing);
     task->start();
+
+    // fill up the remaining parallel installation slots
+    if (isInstallation && !d->incomingTaskList.isEmpty())
+        triggerExecuteNextTask();
 #else
     Q_ASSERT_X(false, "PackageManager::executeNextTask", "Installer is disabled");
 #endif
@@ -1351,6 +1526,19 @@ void PackageManager::handleFailure(AsynchronousTask *task)
 #endif
 }
 
+bool PackageManager::claimPackageInstallation(const QString &packageId, AsynchronousTask *task)
+{
+#if QT_CONFIG(am_installer)
+    if (isPackageInstallationActive(packageId))
+        return false;
+    d->claimedPackageIds.insert(packageId, task);
+#else
+    Q_UNUSED(packageId)
+    Q_UNUSED(task)
+#endif
+    return true;
+}
+
 Package *PackageManager::startingPackageInstallation(PackageInfo *info)
 {
     // ownership of info is transferred to PackageManager
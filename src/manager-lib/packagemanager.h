@@ -102,6 +102,9 @@ public:
     void setHardwareId(const QString &hwId);
     QString architecture() const;
     void setCACertificates(const QByteArrayList &chainOfTrust);
+    int maximumConcurrentInstallations() const;
+    void setMaximumConcurrentInstallations(int maximum);
+    void setInstallationThroughputLimits(qint64 downloadRateLimit, qint64 diskWriteRateLimit);
 
     void cleanupBrokenInstallations() noexcept(false);
 
@@ -158,6 +161,7 @@ Q_SIGNALS:
     Q_SCRIPTABLE void taskBlockingUntilInstallationAcknowledge(const QString &taskId);
 
 protected:
+    bool claimPackageInstallation(const QString &packageId, AsynchronousTask *task);
     Package *startingPackageInstallation(PackageInfo *info);
     bool startingPackageRemoval(const QString &id);
     bool finishedPackageInstall(const QString &id);
@@ -175,6 +179,10 @@ private:
                              bool currentlyBeingInstalled = false);
     void registerApplicationsAndIntentsOfPackage(Package *package);
     void unregisterApplicationsAndIntentsOfPackage(Package *package);
+    void rescanPackageDatabase();
+    void addPackageFromDatabase(PackageInfo *packageInfo);
+    void changePackageFromDatabase(PackageInfo *oldPackageInfo, PackageInfo *newPackageInfo);
+    void removePackageFromDatabase(PackageInfo *packageInfo);
     static void registerQmlTypes();
     QByteArrayList caCertificates() const;
 
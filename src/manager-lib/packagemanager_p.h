@@ -9,6 +9,7 @@
 #include <QMutex>
 #include <QList>
 #include <QSet>
+#include <QHash>
 #include <QThread>
 
 #include <QtAppManManager/packagemanager.h>
@@ -43,18 +44,27 @@ public:
     QByteArrayList chainOfTrust;
     bool cleanupBrokenInstallationsDone = false;
 
+    // incremental package database updates
+    bool rescanPending = false;
+    bool rescanRetryScheduled = false;
+
 #if QT_CONFIG(am_installer)
     QList<AsynchronousTask *> incomingTaskList;     // incoming queue
     QList<AsynchronousTask *> installationTaskList; // installation jobs in state >= AwaitingAcknowledge
-    AsynchronousTask *activeTask = nullptr;         // currently active
+    QList<AsynchronousTask *> activeTasks;          // currently downloading/extracting or removing
+    QHash<QString, AsynchronousTask *> claimedPackageIds; // installations past the info.yaml check
+
+    int maximumConcurrentInstallations = 1;
+    qint64 downloadRateLimit = 0;
+    qint64 diskWriteRateLimit = 0;
 
     QList<AsynchronousTask *> allTasks() const
     {
         QList<AsynchronousTask *> all = incomingTaskList;
         if (!installationTaskList.isEmpty())
             all += installationTaskList;
-        if (activeTask)
-            all += activeTask;
+        if (!activeTasks.isEmpty())
+            all += activeTasks;
         return all;
     }
 #endif
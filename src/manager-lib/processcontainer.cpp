@@ -47,6 +47,12 @@ HostProcess::HostProcess()
                 ::close(fd);
             }
         }
+        // these fds are close-on-exec in the parent, so they don't leak into other children
+        for (int fd : std::as_const(m_inheritedFds)) {
+            int flags = fcntl(fd, F_GETFD);
+            if (flags >= 0)
+                fcntl(fd, F_SETFD, flags & ~FD_CLOEXEC);
+        }
     });
 #endif
 }
@@ -54,6 +60,7 @@ HostProcess::HostProcess()
 HostProcess::~HostProcess()
 {
     closeAndClearFileDescriptors(m_stdioRedirections);
+    closeAndClearFileDescriptors(m_inheritedFds);
     m_process->disconnect(this);
     delete m_process;
 }
@@ -82,6 +89,7 @@ void HostProcess::start(const QString &program, const QStringList &arguments)
     // now it's time to close our fds, since we don't need them anymore (plus we would block
     // the tty where they originated from)
     closeAndClearFileDescriptors(m_stdioRedirections);
+    closeAndClearFileDescriptors(m_inheritedFds);
 }
 
 void HostProcess::setWorkingDirectory(const QString &dir)
@@ -133,6 +141,13 @@ void HostProcess::setStdioRedirections(QVector<int> &&stdioRedirections)
 #endif
 }
 
+void HostProcess::setInheritedFileDescriptors(QVector<int> &&fds)
+{
+    // we own the file descriptors now
+    closeAndClearFileDescriptors(m_inheritedFds);
+    m_inheritedFds = fds;
+}
+
 void HostProcess::setStopBeforeExec(bool stopBeforeExec)
 {
     m_stopBeforeExec = stopBeforeExec;
@@ -152,6 +167,7 @@ ProcessContainer::ProcessContainer(ProcessContainerManager *manager, Application
 ProcessContainer::~ProcessContainer()
 {
     closeAndClearFileDescriptors(m_stdioRedirections);
+    closeAndClearFileDescriptors(m_inheritedFds);
 }
 
 QString ProcessContainer::controlGroup() const
@@ -210,6 +226,12 @@ bool ProcessContainer::isReady()
     return true;
 }
 
+void ProcessContainer::addInheritedFileDescriptor(int fd)
+{
+    if (fd >= 0)
+        m_inheritedFds << fd;
+}
+
 AbstractContainerProcess *ProcessContainer::start(const QStringList &arguments,
                                                   const QMap<QString, QString> &runtimeEnvironment,
                                                   const QVariantMap &amConfig)
@@ -245,6 +267,7 @@ AbstractContainerProcess *ProcessContainer::start(const QStringList &arguments,
     process->setProcessEnvironment(penv);
     process->setStopBeforeExec(configuration().value(u"stopBeforeExec"_s).toBool());
     process->setStdioRedirections(std::move(m_stdioRedirections));
+    process->setInheritedFileDescriptors(std::move(m_inheritedFds));
 
     QString command = m_program;
     QStringList args = arguments;
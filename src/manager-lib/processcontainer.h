@@ -44,6 +44,7 @@ public:
     virtual Am::RunState state() const override;
 
     void setStdioRedirections(QVector<int> &&stdioRedirections);
+    void setInheritedFileDescriptors(QVector<int> &&fds);
     void setWorkingDirectory(const QString &dir);
     void setProcessEnvironment(const QProcessEnvironment &environment);
 
@@ -59,6 +60,7 @@ private:
     qint64 m_pid = 0;
     bool m_stopBeforeExec = false;
     QVector<int> m_stdioRedirections;
+    QVector<int> m_inheritedFds;
 };
 
 class ProcessContainer : public AbstractContainer
@@ -77,6 +79,9 @@ public:
 
     bool isReady() override;
 
+    // the fd is owned by the container and will be available (with the same number) in the child
+    void addInheritedFileDescriptor(int fd);
+
     AbstractContainerProcess *start(const QStringList &arguments,
                                     const QMap<QString, QString> &runtimeEnvironment,
                                     const QVariantMap &amConfig) override;
@@ -84,6 +89,7 @@ public:
 private:
     QString m_currentControlGroup;
     QVector<int> m_stdioRedirections;
+    QVector<int> m_inheritedFds;
     QMap<QString, QString> m_debugWrapperEnvironment;
     QStringList m_debugWrapperCommand;
     MemoryWatcher *m_memWatcher = nullptr;
@@ -4,7 +4,6 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
 
 #include <QCoreApplication>
-#include <QMutexLocker>
 #include <QtQml/qqmlinfo.h>
 
 #include "abstractruntime.h"
@@ -102,6 +101,7 @@ using namespace Qt::StringLiterals;
 QT_USE_NAMESPACE_AM
 
 QThread *ProcessStatus::m_workerThread = nullptr;
+ProcessSampler *ProcessStatus::m_sampler = nullptr;
 int ProcessStatus::m_instanceCount = 0;
 
 ProcessStatus::ProcessStatus(QObject *parent)
@@ -111,45 +111,69 @@ ProcessStatus::ProcessStatus(QObject *parent)
         m_workerThread = new QThread;
         m_workerThread->setObjectName(u"QtAM-ProcessStatus"_s);
         m_workerThread->start();
+        m_sampler = new ProcessSampler;
+        m_sampler->moveToThread(m_workerThread);
     }
     ++m_instanceCount;
 
-    m_reader = new ProcessReader;
-    m_reader->moveToThread(m_workerThread);
-
-    connect(m_reader, &ProcessReader::updated, this, [this]() {
+    connect(m_sampler, &ProcessSampler::updated, this, [this](const QSet<quintptr> &subscribers) {
+        if (!m_pendingUpdate || !subscribers.contains(quintptr(this)))
+            return;
         fetchReadings();
         emit cpuLoadChanged();
+        emit gpuLoadChanged();
         emit memoryReportingChanged(m_memoryVirtual, m_memoryRss, m_memoryPss);
         m_pendingUpdate = false;
     });
-    connect(this, &ProcessStatus::processIdChanged, m_reader, &ProcessReader::setProcessId);
-    connect(this, &ProcessStatus::memoryReportingEnabledChanged, m_reader, &ProcessReader::enableMemoryReporting);
+    connect(this, &ProcessStatus::processIdChanged, this, &ProcessStatus::updateSubscription);
+    connect(this, &ProcessStatus::memoryReportingEnabledChanged, this, &ProcessStatus::updateSubscription);
+    connect(this, &ProcessStatus::detailedMemoryReportingEnabledChanged, this, &ProcessStatus::updateSubscription);
+    connect(this, &ProcessStatus::gpuLoadReportingEnabledChanged, this, &ProcessStatus::updateSubscription);
+    updateSubscription();
 }
 
 ProcessStatus::~ProcessStatus()
 {
-    m_reader->deleteLater();
+    const quintptr key = quintptr(this);
+    QMetaObject::invokeMethod(m_sampler, [key]() { m_sampler->unsubscribe(key); });
 
     --m_instanceCount;
     if (m_instanceCount == 0) {
         m_workerThread->quit();
         m_workerThread->wait();
+        delete m_sampler; // safe: its thread is not running anymore
+        m_sampler = nullptr;
         delete m_workerThread;
         m_workerThread = nullptr;
     }
 }
 
+void ProcessStatus::updateSubscription()
+{
+    QMetaObject::invokeMethod(m_sampler, [key = quintptr(this), pid = m_pid,
+                                          mem = m_memoryReportingEnabled,
+                                          details = m_detailedMemoryReportingEnabled,
+                                          gpu = m_gpuLoadReportingEnabled]() {
+        m_sampler->subscribe(key, pid, mem, details, gpu);
+    });
+}
+
 /*!
     \qmlmethod ProcessStatus::update
 
-    Updates the cpuLoad, memoryVirtual, memoryRss, and memoryPss properties.
+    Updates the cpuLoad, gpuLoad, memoryVirtual, memoryRss, and memoryPss properties.
+
+    All ProcessStatus instances share a single sampler running in a background thread: update
+    requests from multiple instances are coalesced, and each process is read only once, even if
+    it is monitored by more than one ProcessStatus.
 */
 void ProcessStatus::update()
 {
     if (!m_pendingUpdate) {
         m_pendingUpdate = true;
-        QMetaObject::invokeMethod(m_reader, &ProcessReader::update);
+        QMetaObject::invokeMethod(m_sampler, [key = quintptr(this)]() {
+            m_sampler->requestUpdate(key);
+        });
     }
 }
 
@@ -247,22 +271,50 @@ qreal ProcessStatus::cpuLoad()
     return m_cpuLoad;
 }
 
+/*!
+    \qmlproperty real ProcessStatus::gpuLoad
+    \readonly
+    \since 6.9
+
+    This property holds the process' GPU utilization during the previous measurement interval,
+    when update() was last called. The value ranges from 0 (the process did not use the GPU) to 1
+    (the process kept at least one GPU engine busy all the time).
+
+    The value is only measured if \l gpuLoadReportingEnabled is \c true.
+
+    \note This is only supported on \e Linux, with kernel drivers that report per-client engine
+           usage via the \l{https://docs.kernel.org/gpu/drm-usage-stats.html}{DRM fdinfo}
+           interface (e.g. \c i915, \c amdgpu, \c msm, \c panfrost or \c v3d). The System UI
+           also needs to be allowed to inspect the file descriptors of the process, which
+           requires elevated privileges if the application runs as a different user. The value is
+           always 0 otherwise.
+
+    \sa ProcessStatus::update, gpuLoadReportingEnabled
+*/
+qreal ProcessStatus::gpuLoad() const
+{
+    return m_gpuLoad;
+}
+
 void ProcessStatus::fetchReadings()
 {
-    QMutexLocker locker(&m_reader->mutex);
+    const ProcessSampler::Sample sample = m_sampler->sample(m_pid);
+    const ProcessReader::Memory memory = m_memoryReportingEnabled ? sample.memory
+                                                                  : ProcessReader::Memory { };
 
-    m_cpuLoad = m_reader->cpuLoad;
+    m_cpuLoad = sample.cpuLoad;
+    m_gpuLoad = sample.gpuLoad;
 
     // Although smaps claims to report kB it's actually KiB (2^10 = 1024 Bytes)
-    m_memoryVirtual[u"total"_s] = static_cast<quint64>(m_reader->memory.totalVm) << 10;
-    m_memoryVirtual[u"text"_s] = static_cast<quint64>(m_reader->memory.textVm) << 10;
-    m_memoryVirtual[u"heap"_s] = static_cast<quint64>(m_reader->memory.heapVm) << 10;
-    m_memoryRss[u"total"_s] = static_cast<quint64>(m_reader->memory.totalRss) << 10;
-    m_memoryRss[u"text"_s] = static_cast<quint64>(m_reader->memory.textRss) << 10;
-    m_memoryRss[u"heap"_s] = static_cast<quint64>(m_reader->memory.heapRss) << 10;
-    m_memoryPss[u"total"_s] = static_cast<quint64>(m_reader->memory.totalPss) << 10;
-    m_memoryPss[u"text"_s] = static_cast<quint64>(m_reader->memory.textPss) << 10;
-    m_memoryPss[u"heap"_s] = static_cast<quint64>(m_reader->memory.heapPss) << 10;
+    m_memoryVirtual[u"total"_s] = static_cast<quint64>(memory.totalVm) << 10;
+    m_memoryVirtual[u"text"_s] = static_cast<quint64>(memory.textVm) << 10;
+    m_memoryVirtual[u"heap"_s] = static_cast<quint64>(memory.heapVm) << 10;
+    m_memoryRss[u"total"_s] = static_cast<quint64>(memory.totalRss) << 10;
+    m_memoryRss[u"text"_s] = static_cast<quint64>(memory.textRss) << 10;
+    m_memoryRss[u"heap"_s] = static_cast<quint64>(memory.heapRss) << 10;
+    m_memoryPss[u"total"_s] = static_cast<quint64>(memory.totalPss) << 10;
+    m_memoryPss[u"text"_s] = static_cast<quint64>(memory.textPss) << 10;
+    m_memoryPss[u"heap"_s] = static_cast<quint64>(memory.heapPss) << 10;
 }
 
 /*!
@@ -342,6 +394,58 @@ void ProcessStatus::setMemoryReportingEnabled(bool enabled)
     }
 }
 
+/*!
+    \qmlproperty bool ProcessStatus::detailedMemoryReportingEnabled
+    \since 6.9
+
+    A boolean value that determines whether the \c text and \c heap keys of the memory properties
+    are calculated. The default value is \c true.
+
+    Calculating the breakdown requires parsing the complete memory map of the process, which
+    can be expensive for processes with many mappings. If you only need the \c total values,
+    set this property to \c false: on Linux 4.14 and newer, the totals are then read from the
+    pre-aggregated \c smaps_rollup file instead, and \c text and \c heap are reported as 0.
+    If more than one ProcessStatus monitors the same process and any of them requests the
+    detailed breakdown, the breakdown is calculated for all of them.
+
+    This property has no effect if \l memoryReportingEnabled is \c false.
+*/
+bool ProcessStatus::isDetailedMemoryReportingEnabled() const
+{
+    return m_detailedMemoryReportingEnabled;
+}
+
+void ProcessStatus::setDetailedMemoryReportingEnabled(bool enabled)
+{
+    if (enabled != m_detailedMemoryReportingEnabled) {
+        m_detailedMemoryReportingEnabled = enabled;
+        emit detailedMemoryReportingEnabledChanged(m_detailedMemoryReportingEnabled);
+    }
+}
+
+/*!
+    \qmlproperty bool ProcessStatus::gpuLoadReportingEnabled
+    \since 6.9
+
+    A boolean value that determines whether the \l gpuLoad property is refreshed each time
+    \l{ProcessStatus::update()}{update()} is called. The default value is \c false, because
+    every measurement has to inspect all file descriptors of the process. If more than one
+    ProcessStatus monitors the same process and any of them enables this property, the GPU load
+    is measured for all of them.
+*/
+bool ProcessStatus::isGpuLoadReportingEnabled() const
+{
+    return m_gpuLoadReportingEnabled;
+}
+
+void ProcessStatus::setGpuLoadReportingEnabled(bool enabled)
+{
+    if (enabled != m_gpuLoadReportingEnabled) {
+        m_gpuLoadReportingEnabled = enabled;
+        emit gpuLoadReportingEnabledChanged(m_gpuLoadReportingEnabled);
+    }
+}
+
 /*!
     \qmlproperty list<string> ProcessStatus::roleNames
     \readonly
@@ -352,7 +456,7 @@ void ProcessStatus::setMemoryReportingEnabled(bool enabled)
 */
 QStringList ProcessStatus::roleNames() const
 {
-    return { u"cpuLoad"_s, u"memoryVirtual"_s, u"memoryRss"_s, u"memoryPss"_s };
+    return { u"cpuLoad"_s, u"gpuLoad"_s, u"memoryVirtual"_s, u"memoryRss"_s, u"memoryPss"_s };
 }
 
 void ProcessStatus::classBegin()
@@ -16,7 +16,7 @@
 #include <QtAppManCommon/global.h>
 #include <QtAppManManager/amnamespace.h>
 #include <QtAppManManager/application.h>
-#include <QtAppManMonitor/processreader.h>
+#include <QtAppManMonitor/processsampler.h>
 
 QT_BEGIN_NAMESPACE_AM
 
@@ -28,11 +28,18 @@ class ProcessStatus : public QObject, public QQmlParserStatus
     Q_PROPERTY(QString applicationId READ applicationId WRITE setApplicationId NOTIFY applicationIdChanged FINAL)
     Q_PROPERTY(qint64 processId READ processId NOTIFY processIdChanged FINAL)
     Q_PROPERTY(qreal cpuLoad READ cpuLoad NOTIFY cpuLoadChanged FINAL)
+    Q_PROPERTY(qreal gpuLoad READ gpuLoad NOTIFY gpuLoadChanged FINAL)
     Q_PROPERTY(QVariantMap memoryVirtual READ memoryVirtual NOTIFY memoryReportingChanged FINAL)
     Q_PROPERTY(QVariantMap memoryRss READ memoryRss NOTIFY memoryReportingChanged FINAL)
     Q_PROPERTY(QVariantMap memoryPss READ memoryPss NOTIFY memoryReportingChanged FINAL)
     Q_PROPERTY(bool memoryReportingEnabled READ isMemoryReportingEnabled WRITE setMemoryReportingEnabled
                                            NOTIFY memoryReportingEnabledChanged)
+    Q_PROPERTY(bool detailedMemoryReportingEnabled READ isDetailedMemoryReportingEnabled
+                                                   WRITE setDetailedMemoryReportingEnabled
+                                                   NOTIFY detailedMemoryReportingEnabledChanged FINAL)
+    Q_PROPERTY(bool gpuLoadReportingEnabled READ isGpuLoadReportingEnabled
+                                            WRITE setGpuLoadReportingEnabled
+                                            NOTIFY gpuLoadReportingEnabledChanged FINAL)
     Q_PROPERTY(QStringList roleNames READ roleNames CONSTANT FINAL)
 public:
     ProcessStatus(QObject *parent = nullptr);
@@ -48,6 +55,7 @@ public:
     void setApplicationId(const QString &appId);
 
     qreal cpuLoad();
+    qreal gpuLoad() const;
     QVariantMap memoryVirtual() const;
     QVariantMap memoryRss() const;
     QVariantMap memoryPss() const;
@@ -55,6 +63,12 @@ public:
     bool isMemoryReportingEnabled() const;
     void setMemoryReportingEnabled(bool enabled);
 
+    bool isDetailedMemoryReportingEnabled() const;
+    void setDetailedMemoryReportingEnabled(bool enabled);
+
+    bool isGpuLoadReportingEnabled() const;
+    void setGpuLoadReportingEnabled(bool enabled);
+
     void classBegin() override;
     void componentComplete() override;
 
@@ -62,9 +76,12 @@ Q_SIGNALS:
     void applicationIdChanged(const QString &applicationId);
     void processIdChanged(qint64 processId);
     void cpuLoadChanged();
+    void gpuLoadChanged();
     void memoryReportingChanged(const QVariantMap &memoryVirtual, const QVariantMap &memoryRss,
                                                                   const QVariantMap &memoryPss);
     void memoryReportingEnabledChanged(bool enabled);
+    void detailedMemoryReportingEnabledChanged(bool enabled);
+    void gpuLoadReportingEnabledChanged(bool enabled);
 
 private Q_SLOTS:
     void onRunStateChanged(QtAM::Am::RunState state);
@@ -72,20 +89,25 @@ private Q_SLOTS:
 private:
     void fetchReadings();
     void determinePid();
+    void updateSubscription();
 
     QString m_appId;
     qint64 m_pid = 0;
 
     qreal m_cpuLoad = 0;
+    qreal m_gpuLoad = 0;
     QVariantMap m_memoryVirtual;
     QVariantMap m_memoryRss;
     QVariantMap m_memoryPss;
     bool m_memoryReportingEnabled = true;
+    bool m_detailedMemoryReportingEnabled = true;
+    bool m_gpuLoadReportingEnabled = false;
 
     QPointer<Application> m_application;
 
     bool m_pendingUpdate = false;
-    ProcessReader *m_reader;
+    // all instances share one sampler, so that each PID is only read once per update cycle
+    static ProcessSampler *m_sampler;
     static QThread *m_workerThread;
     static int m_instanceCount;
 };
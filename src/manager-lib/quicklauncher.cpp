@@ -7,32 +7,50 @@
 #include <QTimer>
 #include <QDateTime>
 #include <QMetaObject>
+#include <QtMath>
 
 #include "logging.h"
 #include "abstractcontainer.h"
 #include "abstractruntime.h"
+#include "application.h"
+#include "applicationmanager.h"
 #include "containerfactory.h"
 #include "runtimefactory.h"
 #include "quicklauncher.h"
 #include "systemreader.h"
+#include "processreader.h"
 
+#include <algorithm>
 #include <memory>
 
 using namespace Qt::StringLiterals;
 
 QT_BEGIN_NAMESPACE_AM
 
+// half-lifes of the short-term and the time-of-day launch history
+static constexpr qint64 RecentDemandHalfLife = 30 * 60 * 1000;
+static constexpr qint64 HourlyDemandHalfLife = 7 * 24 * 60 * 60 * 1000;
+// without any history, keep one instance per combination for this long after startup
+static constexpr qint64 LearningPeriod = 60 * 60 * 1000;
+// the application launch history used for preloading
+static constexpr qint64 ApplicationDemandHalfLife = 24 * 60 * 60 * 1000;
+// do not re-populate the pools for this long after a critical memory situation
+static constexpr qint64 MemoryCriticalPause = 60 * 1000;
+
 QuickLauncher *QuickLauncher::s_instance = nullptr;
 
 QuickLauncher *QuickLauncher::createInstance(const QMap<std::pair<QString, QString>, int> &runtimesPerContainer,
                                              qreal idleLoad, int failedStartLimit,
-                                             int failedStartLimitIntervalSec)
+                                             int failedStartLimitIntervalSec,
+                                             bool adaptivePoolSize, quint64 memoryBudget,
+                                             bool preloadApplications)
 {
     if (Q_UNLIKELY(s_instance))
         qFatal("QuickLauncher instance already exists");
 
     s_instance = new QuickLauncher(runtimesPerContainer, idleLoad, failedStartLimit,
-                                   failedStartLimitIntervalSec);
+                                   failedStartLimitIntervalSec, adaptivePoolSize, memoryBudget,
+                                   preloadApplications);
     return s_instance;
 }
 
@@ -45,16 +63,22 @@ QuickLauncher::~QuickLauncher()
 {
     if (m_idleTimerId)
         killTimer(m_idleTimerId);
+    if (m_adaptiveTimerId)
+        killTimer(m_adaptiveTimerId);
     delete m_idleCpu;
     s_instance = nullptr;
 }
 
 QuickLauncher::QuickLauncher(const QMap<std::pair<QString, QString>, int> &runtimesPerContainer,
                              qreal idleLoad, int failedStartLimit, int failedStartLimitIntervalSec,
+                             bool adaptivePoolSize, quint64 memoryBudget, bool preloadApplications,
                              QObject *parent)
     : QObject(parent)
     , m_failedStartLimit(qMax(0, failedStartLimit))
     , m_failedStartLimitIntervalSec(qMax(0, failedStartLimitIntervalSec))
+    , m_adaptivePoolSize(adaptivePoolSize)
+    , m_memoryBudget(adaptivePoolSize ? memoryBudget : 0)
+    , m_preloadApplications(preloadApplications)
 {
     auto findMaximum = [&runtimesPerContainer](const QuickLaunchEntry &qle) -> int {
         static const QString anyId = u"*"_s;
@@ -105,6 +129,7 @@ QuickLauncher::QuickLauncher(const QMap<std::pair<QString, QString>, int> &runti
             // or you have a typo in your YAML, which could potentially freeze your target (container
             // construction can be expensive)
             entry.m_maximum = qBound(0, findMaximum(entry), 10);
+            entry.m_target = entry.m_maximum;
 
             if (!entry.m_maximum)
                 continue;
@@ -123,6 +148,31 @@ QuickLauncher::QuickLauncher(const QMap<std::pair<QString, QString>, int> &runti
         m_idleCpu = new CpuReader();
         m_idleTimerId = startTimer(1000);
     }
+
+    if (m_adaptivePoolSize) {
+        // the pools are sized according to the launch history, which needs to be re-evaluated
+        // regularly, since demand decays over time and changes with the time of day
+        m_learningUntil = QDateTime::currentMSecsSinceEpoch() + LearningPeriod;
+        m_adaptiveTimerId = startTimer(60 * 1000);
+
+        m_memoryWatcher = new MemoryWatcher(this);
+        connect(m_memoryWatcher, &MemoryWatcher::memoryLow, this, [this]() {
+            qCDebug(LogQuickLaunch) << "Memory is low: trimming cold quick-launch pools";
+            m_learningUntil = 0;
+            updatePoolTargets();
+            trim(false);
+        });
+        connect(m_memoryWatcher, &MemoryWatcher::memoryCritical, this, [this]() {
+            qCWarning(LogQuickLaunch) << "Memory is critical: removing all quick-launch instances";
+            m_pausedUntil = QDateTime::currentMSecsSinceEpoch() + MemoryCriticalPause;
+            trim(true);
+        });
+        if (!m_memoryWatcher->startWatching())
+            qCDebug(LogQuickLaunch) << "Could not watch the system memory consumption";
+
+        qCDebug(LogQuickLaunch) << "Adaptive pool sizing is enabled, memory budget:"
+                                << (m_memoryBudget ? QString::number(m_memoryBudget) : u"unlimited"_s);
+    }
     triggerRebuild();
 }
 
@@ -136,6 +186,12 @@ void QuickLauncher::timerEvent(QTimerEvent *te)
             if (m_isIdle)
                 rebuild();
         }
+    } else if (te && te->timerId() == m_adaptiveTimerId) {
+        // shrinking the pools is always fine, but growing them is left to the idle check above
+        updatePoolTargets();
+        trim(false);
+        if (!m_idleCpu || m_isIdle)
+            rebuild();
     }
 }
 
@@ -144,6 +200,16 @@ void QuickLauncher::rebuild()
     if (m_shuttingDown)
         return;
 
+    if (m_adaptivePoolSize) {
+        const qint64 pausedFor = m_pausedUntil - QDateTime::currentMSecsSinceEpoch();
+        if (pausedFor > 0) {
+            triggerRebuild(int(pausedFor));
+            return;
+        }
+        updatePoolTargets();
+        trim(false);
+    }
+
     int todo = 0;
     int done = 0;
 
@@ -151,8 +217,8 @@ void QuickLauncher::rebuild()
         if (entry->m_disabled)
             continue;
 
-        if (entry->m_containersAndRuntimes.size() < entry->m_maximum) {
-            todo += (entry->m_maximum - entry->m_containersAndRuntimes.size());
+        if (entry->m_containersAndRuntimes.size() < entry->m_target) {
+            todo += (entry->m_target - entry->m_containersAndRuntimes.size());
             if (done >= 1)
                 continue;
 
@@ -215,6 +281,7 @@ void QuickLauncher::rebuild()
 
             entry->m_containersAndRuntimes << qMakePair(container, runtime);
             ++done;
+            updatePreloadHints(*entry);
 
             qCDebug(LogQuickLaunch) << "Added new quick-launch entry for container:"
                                     << entry->m_containerId << "/ runtime:"
@@ -247,6 +314,7 @@ void QuickLauncher::removeEntry(AbstractContainer *container, AbstractRuntime *r
                                         << entry->m_containerId << "/ runtime:"
                                         << (entry->m_runtimeId.isEmpty() ? u"(none)"_s : entry->m_runtimeId);
 
+                entry->m_reservedFor.remove(car.second);
                 entry->m_containersAndRuntimes.removeAt(i--);
                 carRemoved++;
             }
@@ -284,10 +352,13 @@ void QuickLauncher::checkFailedStarts()
     }
 }
 
-QPair<AbstractContainer *, AbstractRuntime *> QuickLauncher::take(const QString &containerId, const QString &runtimeId)
+QPair<AbstractContainer *, AbstractRuntime *> QuickLauncher::take(const QString &containerId, const QString &runtimeId,
+                                                                   const QString &applicationId)
 {
     QPair<AbstractContainer *, AbstractRuntime *> result(nullptr, nullptr);
 
+    recordLaunch(containerId, runtimeId, applicationId);
+
     // 1st pass: find entry with matching container and runtime
     // 2nd pass: find entry with matching container and no runtime
     for (int pass = 1; pass <= 2; ++pass) {
@@ -295,11 +366,14 @@ QPair<AbstractContainer *, AbstractRuntime *> QuickLauncher::take(const QString
             if (entry->m_containerId == containerId) {
                 if (((pass == 1) && (entry->m_runtimeId == runtimeId))
                         || ((pass == 2) && (entry->m_runtimeId.isEmpty()))) {
-                    if (!entry->m_containersAndRuntimes.isEmpty()) {
-                        result = entry->m_containersAndRuntimes.takeFirst();
+                    const qsizetype index = pickInstance(entry->reservations(), applicationId);
+                    if (index >= 0) {
+                        result = entry->m_containersAndRuntimes.takeAt(index);
+                        entry->m_reservedFor.remove(result.second);
                         result.first->disconnect(this);
                         if (result.second)
                             result.second->disconnect(this);
+                        updatePreloadHints(*entry);
                         triggerRebuild();
 
                         pass = 2;
@@ -313,6 +387,226 @@ QPair<AbstractContainer *, AbstractRuntime *> QuickLauncher::take(const QString
     return result;
 }
 
+void QuickLauncher::recordLaunch(const QString &containerId, const QString &runtimeId,
+                                 const QString &applicationId)
+{
+    // the launch is accounted to the same entry that take() would pick, even if its pool is
+    // currently empty: a miss is exactly the kind of demand we want to learn from
+    QuickLaunchEntry *match = nullptr;
+    for (auto entry = m_quickLaunchPool.begin(); entry != m_quickLaunchPool.end(); ++entry) {
+        if (entry->m_containerId != containerId)
+            continue;
+        if (entry->m_runtimeId == runtimeId) {
+            match = &(*entry);
+            break;
+        } else if (!match && entry->m_runtimeId.isEmpty()) {
+            match = &(*entry);
+        }
+    }
+    if (!match)
+        return;
+
+    const QDateTime now = QDateTime::currentDateTime();
+    const qint64 nowMSecs = now.toMSecsSinceEpoch();
+
+    if (m_adaptivePoolSize) {
+        match->decayDemand(nowMSecs);
+        match->m_recentDemand += 1;
+        match->m_hourlyDemand[size_t(now.time().hour())] += 1;
+        match->m_lastDemandUpdate = nowMSecs;
+    }
+
+    if (m_preloadApplications && !applicationId.isEmpty()) {
+        if (match->m_lastApplicationLaunch && (nowMSecs > match->m_lastApplicationLaunch)) {
+            const double factor = std::exp2(-double(nowMSecs - match->m_lastApplicationLaunch)
+                                            / ApplicationDemandHalfLife);
+            for (auto it = match->m_applicationDemand.begin(); it != match->m_applicationDemand.end(); ) {
+                it.value() *= factor;
+                // forget about apps that have not been launched in a long time
+                if (it.value() < 0.01)
+                    it = match->m_applicationDemand.erase(it);
+                else
+                    ++it;
+            }
+        }
+        match->m_applicationDemand[applicationId] += 1;
+        match->m_lastApplicationLaunch = nowMSecs;
+    }
+}
+
+void QuickLauncher::updatePreloadHints(QuickLaunchEntry &entry)
+{
+    // only runtimes can preload anything
+    if (!m_preloadApplications || entry.m_runtimeId.isEmpty() || entry.m_applicationDemand.isEmpty())
+        return;
+
+    const QStringList candidates = rankApplications(entry.m_applicationDemand);
+
+    // Whatever an application loads (e.g. QML modules and plugins) cannot be unloaded again, so
+    // a runtime is reserved for the application it preloaded. The unreserved runtimes are hinted
+    // with the most likely applications that do not have a reserved runtime yet.
+    qsizetype candidate = 0;
+    for (const auto &car : std::as_const(entry.m_containersAndRuntimes)) {
+        if (!car.second || entry.m_reservedFor.contains(car.second))
+            continue;
+
+        const QStringList reserved = entry.reservations();
+        Application *app = nullptr;
+        while (!app && (candidate < candidates.size())) {
+            const QString &appId = candidates.at(candidate++);
+            if (reserved.contains(appId))
+                continue;
+            app = ApplicationManager::instance()->fromId(appId);
+            // apps that are already running will not be launched again anytime soon
+            if (app && (app->isBlocked() || (app->runState() != Am::NotRunning)
+                        || (app->info()->runtimeName() != entry.m_runtimeId))) {
+                app = nullptr;
+            }
+        }
+        if (!app)
+            break;
+        if (car.second->preloadApplication(app))
+            entry.m_reservedFor.insert(car.second, app->id());
+    }
+}
+
+QStringList QuickLauncher::rankApplications(const QHash<QString, double> &applicationDemand)
+{
+    QVector<std::pair<double, QString>> candidates;
+    candidates.reserve(applicationDemand.size());
+    for (auto it = applicationDemand.cbegin(); it != applicationDemand.cend(); ++it)
+        candidates.emplace_back(it.value(), it.key());
+    // the id is only compared to get a stable order
+    std::sort(candidates.begin(), candidates.end(), [](const auto &a, const auto &b) {
+        return (a.first > b.first) || ((a.first == b.first) && (a.second < b.second));
+    });
+
+    QStringList result;
+    result.reserve(candidates.size());
+    for (const auto &candidate : std::as_const(candidates))
+        result << candidate.second;
+    return result;
+}
+
+qsizetype QuickLauncher::pickInstance(const QStringList &reservedFor, const QString &applicationId)
+{
+    // an instance that preloaded this very application is the best match ...
+    if (!applicationId.isEmpty()) {
+        if (qsizetype index = reservedFor.indexOf(applicationId); index >= 0)
+            return index;
+    }
+    // ... but instances reserved for other applications must not be used at all
+    return reservedFor.indexOf(QString { });
+}
+
+void QuickLauncher::updatePoolTargets()
+{
+    const QDateTime now = QDateTime::currentDateTime();
+    const qint64 nowMSecs = now.toMSecsSinceEpoch();
+    const int hour = now.time().hour();
+    const bool learning = (nowMSecs < m_learningUntil);
+
+    QVector<PoolSizing> pools(m_quickLaunchPool.size());
+
+    for (int i = 0; i < m_quickLaunchPool.size(); ++i) {
+        QuickLaunchEntry &entry = m_quickLaunchPool[i];
+        PoolSizing &pool = pools[i];
+        entry.decayDemand(nowMSecs);
+
+        // the expected number of launches within the next hour
+        pool.demand = std::max(entry.demand(hour), entry.demand((hour + 1) % 24));
+        pool.wanted = qBound(0, int(std::ceil(pool.demand - 0.05)), entry.m_maximum);
+
+        // without any history at all, keep one instance around until we have learned enough
+        if (!pool.wanted && learning && !entry.m_lastDemandUpdate)
+            pool.wanted = qMin(1, entry.m_maximum);
+
+        for (const auto &car : std::as_const(entry.m_containersAndRuntimes)) {
+            const auto *process = car.first ? car.first->process() : nullptr;
+            if (quint64 cost = ProcessReader::readResidentMemory(process ? process->processId() : 0)) {
+                entry.m_instanceCost = cost;
+                break;
+            }
+        }
+        pool.instanceCost = entry.m_instanceCost;
+    }
+
+    calculatePoolTargets(pools, m_memoryBudget);
+
+    for (int i = 0; i < m_quickLaunchPool.size(); ++i)
+        m_quickLaunchPool[i].m_target = pools.at(i).target;
+}
+
+void QuickLauncher::calculatePoolTargets(QVector<PoolSizing> &pools, quint64 memoryBudget)
+{
+    quint64 knownCost = 0;
+    for (PoolSizing &pool : pools) {
+        knownCost = std::max(knownCost, pool.instanceCost);
+        pool.target = 0;
+    }
+
+    // Hand out the instances one by one to the combination with the highest demand per instance,
+    // as long as they fit into the memory budget. Combinations that have never been measured are
+    // assumed to be as expensive as the most expensive one we know about. If nothing has been
+    // measured yet, only a single instance is handed out: once it is running, we know its cost.
+    quint64 used = 0;
+    bool unmeasuredUsed = false;
+    forever {
+        int best = -1;
+        double bestScore = -1;
+
+        for (int i = 0; i < pools.size(); ++i) {
+            const PoolSizing &pool = pools.at(i);
+            if (pool.target >= pool.wanted)
+                continue;
+            if (memoryBudget) {
+                const quint64 cost = pool.instanceCost ? pool.instanceCost : knownCost;
+                if (!cost ? unmeasuredUsed : (used + cost > memoryBudget))
+                    continue;
+            }
+            const double score = pool.demand / (pool.target + 1);
+            if (score > bestScore) {
+                best = i;
+                bestScore = score;
+            }
+        }
+        if (best < 0)
+            break;
+
+        PoolSizing &pool = pools[best];
+        ++pool.target;
+        const quint64 cost = pool.instanceCost ? pool.instanceCost : knownCost;
+        used += cost;
+        if (!cost)
+            unmeasuredUsed = true;
+    }
+}
+
+void QuickLauncher::trim(bool all)
+{
+    for (auto entry = m_quickLaunchPool.begin(); entry != m_quickLaunchPool.end(); ++entry) {
+        const int keep = all ? 0 : entry->m_target;
+
+        while (entry->m_containersAndRuntimes.size() > keep) {
+            const auto car = entry->m_containersAndRuntimes.takeLast();
+            entry->m_reservedFor.remove(car.second);
+
+            qCDebug(LogQuickLaunch) << "Trimming quick-launch entry for container:"
+                                    << entry->m_containerId << "/ runtime:"
+                                    << (entry->m_runtimeId.isEmpty() ? u"(none)"_s : entry->m_runtimeId);
+
+            // same as in take(): we are not interested in this instance anymore
+            car.first->disconnect(this);
+            if (car.second) {
+                car.second->disconnect(this);
+                car.second->stop();
+            } else {
+                car.first->deleteLater();
+            }
+        }
+    }
+}
+
 void QuickLauncher::shutDown()
 {
     m_shuttingDown = true;
@@ -338,6 +632,34 @@ void QuickLauncher::QuickLaunchEntry::addFailure()
     m_failedTimeStamps << QDateTime::currentMSecsSinceEpoch();
 }
 
+void QuickLauncher::QuickLaunchEntry::decayDemand(qint64 now)
+{
+    if (m_lastDemandUpdate && (now > m_lastDemandUpdate)) {
+        const double elapsed = double(now - m_lastDemandUpdate);
+        m_recentDemand *= std::exp2(-elapsed / RecentDemandHalfLife);
+        const double hourlyFactor = std::exp2(-elapsed / HourlyDemandHalfLife);
+        for (double &d : m_hourlyDemand)
+            d *= hourlyFactor;
+        m_lastDemandUpdate = now;
+    }
+}
+
+QStringList QuickLauncher::QuickLaunchEntry::reservations() const
+{
+    QStringList result;
+    result.reserve(m_containersAndRuntimes.size());
+    for (const auto &car : m_containersAndRuntimes)
+        result << m_reservedFor.value(car.second);
+    return result;
+}
+
+double QuickLauncher::QuickLaunchEntry::demand(int hourOfDay) const
+{
+    // the hourly buckets accumulate over many days: scale them down to launches per single day
+    static const double dailyShare = 1 - std::exp2(-double(24 * 60 * 60 * 1000) / HourlyDemandHalfLife);
+    return std::max(m_recentDemand, m_hourlyDemand[size_t(hourOfDay)] * dailyShare);
+}
+
 QT_END_NAMESPACE_AM
 
 #include "moc_quicklauncher.cpp"
@@ -6,7 +6,9 @@
 #ifndef QUICKLAUNCHER_H
 #define QUICKLAUNCHER_H
 
+#include <array>
 #include <QtCore/QObject>
+#include <QtCore/QHash>
 #include <QtCore/QPair>
 #include <QtCore/QVector>
 #include <QtAppManCommon/global.h>
@@ -16,6 +18,7 @@ QT_BEGIN_NAMESPACE_AM
 class AbstractContainer;
 class AbstractRuntime;
 class CpuReader;
+class MemoryWatcher;
 
 class QuickLauncher : public QObject
 {
@@ -24,14 +27,35 @@ class QuickLauncher : public QObject
 public:
     static QuickLauncher *createInstance(const QMap<std::pair<QString, QString>, int> &runtimesPerContainer,
                                          qreal idleLoad, int failedStartLimit,
-                                         int failedStartLimitIntervalSec);
+                                         int failedStartLimitIntervalSec,
+                                         bool adaptivePoolSize = false, quint64 memoryBudget = 0,
+                                         bool preloadApplications = false);
 
     static QuickLauncher *instance();
     ~QuickLauncher() override;
 
-    QPair<AbstractContainer *, AbstractRuntime *> take(const QString &containerId, const QString &runtimeId);
+    QPair<AbstractContainer *, AbstractRuntime *> take(const QString &containerId, const QString &runtimeId,
+                                                       const QString &applicationId = QString());
     void shutDown();
 
+    // adaptive pool sizing: the input and output of calculatePoolTargets() for one
+    // container/runtime combination
+    struct PoolSizing
+    {
+        double demand = 0; // the expected number of launches within the next hour
+        int wanted = 0; // the number of instances this demand would ask for
+        quint64 instanceCost = 0; // the memory footprint of one instance in bytes (0: unknown)
+        int target = 0; // the resulting pool size
+    };
+    // only public for the auto tests
+    static void calculatePoolTargets(QVector<PoolSizing> &pools, quint64 memoryBudget);
+
+    // preloading: the application ids sorted by decreasing demand
+    static QStringList rankApplications(const QHash<QString, double> &applicationDemand);
+    // preloading: the index of the pool instance to hand out for applicationId, given the ids of
+    // the applications the instances are reserved for (empty if not reserved). -1 if none fits.
+    static qsizetype pickInstance(const QStringList &reservedFor, const QString &applicationId);
+
 public Q_SLOTS:
     void rebuild();
 
@@ -44,6 +68,7 @@ protected:
 private:
     QuickLauncher(const QMap<std::pair<QString, QString>, int> &runtimesPerContainer,
                   qreal idleLoad, int failedStartLimit, int failedStartLimitIntervalSec,
+                  bool adaptivePoolSize, quint64 memoryBudget, bool preloadApplications,
                   QObject *parent = nullptr);
     QuickLauncher(const QuickLauncher &);
     QuickLauncher &operator=(const QuickLauncher &);
@@ -52,6 +77,10 @@ private:
     void triggerRebuild(int delay = 0);
     void removeEntry(AbstractContainer *container, AbstractRuntime *runtime);
     void checkFailedStarts();
+    void recordLaunch(const QString &containerId, const QString &runtimeId,
+                      const QString &applicationId);
+    void updatePoolTargets();
+    void trim(bool all);
 
     struct QuickLaunchEntry
     {
@@ -64,8 +93,27 @@ private:
         QVector<qint64> m_failedTimeStamps; // msecs since epoch when the instance failed
 
         QList<QPair<AbstractContainer *, AbstractRuntime *>> m_containersAndRuntimes;
+
+        // adaptive pool sizing: the launch history of this container/runtime combination
+        void decayDemand(qint64 now);
+        double demand(int hourOfDay) const;
+        int m_target = 1; // the current pool size, at most m_maximum
+        double m_recentDemand = 0; // launches, decaying with a half-life of 30 minutes
+        std::array<double, 24> m_hourlyDemand { }; // launches per hour of day, decaying over a week
+        qint64 m_lastDemandUpdate = 0; // msecs since epoch
+        quint64 m_instanceCost = 0; // last known memory footprint of a pooled instance in bytes
+
+        // preloading: which applications were launched from this pool, decaying with a day half-life
+        QHash<QString, double> m_applicationDemand;
+        qint64 m_lastApplicationLaunch = 0; // msecs since epoch
+        // a runtime that preloaded an application can only be used for exactly this application
+        QHash<AbstractRuntime *, QString> m_reservedFor;
+
+        QStringList reservations() const;
     };
 
+    void updatePreloadHints(QuickLaunchEntry &entry);
+
     QVector<QuickLaunchEntry> m_quickLaunchPool;
     int m_idleTimerId = 0;
     CpuReader *m_idleCpu = nullptr;
@@ -74,6 +122,13 @@ private:
     bool m_shuttingDown = false;
     int m_failedStartLimit;
     int m_failedStartLimitIntervalSec;
+    bool m_adaptivePoolSize = false;
+    quint64 m_memoryBudget = 0;
+    bool m_preloadApplications = false;
+    qint64 m_learningUntil = 0; // msecs since epoch
+    qint64 m_pausedUntil = 0; // msecs since epoch
+    int m_adaptiveTimerId = 0;
+    MemoryWatcher *m_memoryWatcher = nullptr;
 };
 
 QT_END_NAMESPACE_AM
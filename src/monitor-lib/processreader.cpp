@@ -30,9 +30,20 @@ void ProcessReader::enableMemoryReporting(bool enabled)
         memory = Memory();
 }
 
+void ProcessReader::enableDetailedMemoryReporting(bool enabled)
+{
+    m_detailedMemoryReporting = enabled;
+}
+
+void ProcessReader::enableGpuLoadReporting(bool enabled)
+{
+    m_gpuLoadReportingEnabled = enabled;
+}
+
 void ProcessReader::update()
 {
     qreal load = readCpuLoad();
+    qreal gpu = readGpuLoad();
 
     if (m_memoryReportingEnabled) {
         Memory mem;
@@ -40,9 +51,11 @@ void ProcessReader::update()
         QMutexLocker locker(&mutex);
         memory = memRead ? mem : Memory();
         cpuLoad = load;
+        gpuLoad = gpu;
     } else {
         QMutexLocker locker(&mutex);
         cpuLoad = load;
+        gpuLoad = gpu;
     }
 
     emit updated();
@@ -58,6 +71,9 @@ void ProcessReader::openCpuLoad()
         qCWarning(LogSystem) << "Cannot read CPU load from" << fileName;
     m_lastCpuUsage = 0;
     m_elapsedTime.invalidate();
+
+    // the GPU load is also relative to the last reading, so it needs a new reader as well
+    m_gpuReader.reset();
 }
 
 qreal ProcessReader::readCpuLoad()
@@ -95,11 +111,33 @@ qreal ProcessReader::readCpuLoad()
     return load;
 }
 
+qreal ProcessReader::readGpuLoad()
+{
+    // this has to scan all fds of the process, so it is only done on request
+    if (!m_gpuLoadReportingEnabled || !m_pid) {
+        m_gpuReader.reset();
+        return 0.0;
+    }
+    if (!m_gpuReader)
+        m_gpuReader.reset(new DrmGpuReader(m_pid));
+    return m_gpuReader->readLoadValue();
+}
+
 
 bool ProcessReader::readMemory(Memory &mem)
 {
-    const QByteArray smapsFile = "/proc/" + QByteArray::number(m_pid) + "/smaps";
-    return readSmaps(smapsFile, mem);
+    const QByteArray procDir = "/proc/" + QByteArray::number(m_pid);
+
+    // If nobody is interested in the text/heap breakdown, the kernel can do the summing up for us
+    // (Linux 4.14+): reading smaps_rollup is a lot cheaper than parsing the per-mapping smaps.
+    static const bool hasSmapsRollup = (::access("/proc/self/smaps_rollup", R_OK) == 0);
+
+    if (!m_detailedMemoryReporting && hasSmapsRollup) {
+        if (readSmapsRollup(procDir + "/smaps_rollup", mem) && readStatm(procDir + "/statm", mem))
+            return true;
+        mem = Memory();
+    }
+    return readSmaps(procDir + "/smaps", mem);
 }
 
 static uint parseValue(const char *pl) {
@@ -265,14 +303,99 @@ bool ProcessReader::readSmaps(const QByteArray &smapsFile, Memory &mem)
     return ok;
 }
 
+bool ProcessReader::readSmapsRollup(const QByteArray &smapsRollupFile, Memory &mem)
+{
+    FILE *sf = nullptr;
+    auto closeFile = qScopeGuard([=]() { if (sf) fclose(sf); });
+
+    sf = fopen(smapsRollupFile.constData(), "r");
+    if (!sf)
+        return false;
+
+    const int lineLen = 100;
+    char line[lineLen];
+
+    // the first line is the pseudo mapping "<first>-<last> ---p 00000000 00:00 0 [rollup]"
+    if (!fgets(line, lineLen, sf) || !strstr(line, "[rollup]"))
+        return false;
+
+    static const char strRss[] = "Rss:";
+    static const char strPss[] = "Pss:";
+    const int rssTag  = 0x01;
+    const int pssTag  = 0x02;
+    const int allTags = rssTag | pssTag;
+    int foundTags = 0;
+
+    while (foundTags < allTags && fgets(line, lineLen, sf)) {
+        if (!qstrncmp(line, strRss, sizeof(strRss) - 1)) {
+            foundTags |= rssTag;
+            mem.totalRss = parseValue(line + sizeof(strRss) - 1);
+        } else if (!qstrncmp(line, strPss, sizeof(strPss) - 1)) {
+            foundTags |= pssTag;
+            mem.totalPss = parseValue(line + sizeof(strPss) - 1);
+        }
+    }
+    return (foundTags == allTags);
+}
+
+// returns the total virtual and the resident size in bytes
+static bool parseStatm(const QByteArray &statmFile, quint64 &vmSize, quint64 &rssSize)
+{
+    SysFsReader statm(statmFile);
+    if (!statm.isOpen())
+        return false;
+    const QByteArray str = statm.readValue();
+    if (str.isEmpty())
+        return false;
+
+    // the first two fields are the total program size and the resident set size (in pages)
+    static const quint64 pageSize = quint64(sysconf(_SC_PAGESIZE));
+    char *endPtr = nullptr;
+    vmSize = strtoull(str.constData(), &endPtr, 10) * pageSize;
+    rssSize = strtoull(endPtr, nullptr, 10) * pageSize;
+    return true;
+}
+
+bool ProcessReader::readStatm(const QByteArray &statmFile, Memory &mem)
+{
+    // smaps_rollup has no "Size:" entry, so the virtual size has to come from statm
+    quint64 vmSize = 0;
+    quint64 rssSize = 0;
+    if (!parseStatm(statmFile, vmSize, rssSize))
+        return false;
+    mem.totalVm = quint32(vmSize >> 10);
+    return true;
+}
+
+quint64 ProcessReader::readResidentMemory(qint64 pid)
+{
+    quint64 vmSize = 0;
+    quint64 rssSize = 0;
+    if ((pid <= 0) || !parseStatm("/proc/" + QByteArray::number(pid) + "/statm", vmSize, rssSize))
+        return 0;
+    return rssSize;
+}
+
 bool ProcessReader::testReadSmaps(const QByteArray &smapsFile)
 {
     memory = Memory();
     return readSmaps(smapsFile, memory);
 }
 
+bool ProcessReader::testReadSmapsRollup(const QByteArray &smapsRollupFile)
+{
+    memory = Memory();
+    return readSmapsRollup(smapsRollupFile, memory);
+}
+
 #elif defined(Q_OS_MACOS)
 
+quint64 ProcessReader::readResidentMemory(qint64 pid)
+{
+    Q_UNUSED(pid)
+    return 0;
+}
+
 void ProcessReader::openCpuLoad()
 {
 }
@@ -282,6 +405,11 @@ qreal ProcessReader::readCpuLoad()
     return 0.0;
 }
 
+qreal ProcessReader::readGpuLoad()
+{
+    return 0.0;
+}
+
 bool ProcessReader::readMemory(Memory &mem)
 {
     struct task_basic_info t_info;
@@ -301,6 +429,12 @@ bool ProcessReader::readMemory(Memory &mem)
 
 #else
 
+quint64 ProcessReader::readResidentMemory(qint64 pid)
+{
+    Q_UNUSED(pid)
+    return 0;
+}
+
 void ProcessReader::openCpuLoad()
 {
 }
@@ -310,6 +444,11 @@ qreal ProcessReader::readCpuLoad()
     return 0.0;
 }
 
+qreal ProcessReader::readGpuLoad()
+{
+    return 0.0;
+}
+
 bool ProcessReader::readMemory(Memory &mem)
 {
     Q_UNUSED(mem)
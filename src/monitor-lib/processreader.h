@@ -15,6 +15,7 @@
 #if defined(Q_OS_LINUX)
 #  include <memory>
 #  include <QtAppManMonitor/sysfsreader.h>
+#  include <QtAppManMonitor/systemreader.h>
 #endif
 
 QT_BEGIN_NAMESPACE_AM
@@ -25,6 +26,7 @@ class ProcessReader : public QObject {
 public:
     QMutex mutex;
     qreal cpuLoad = 0.0;
+    qreal gpuLoad = 0.0;
     struct Memory {
         quint32 totalVm = 0;
         quint32 totalRss = 0;
@@ -37,15 +39,21 @@ public:
         quint32 heapPss = 0;
     } memory;
 
+    // a cheap way to get the current resident set size of any process in bytes (0 on error)
+    static quint64 readResidentMemory(qint64 pid);
+
 #if defined(Q_OS_LINUX)
     // solely for testing purposes
     bool testReadSmaps(const QByteArray &smapsFile);
+    bool testReadSmapsRollup(const QByteArray &smapsRollupFile);
 #endif
 
 public Q_SLOTS:
     void update();
     void setProcessId(qint64 pid);
     void enableMemoryReporting(bool enabled);
+    void enableDetailedMemoryReporting(bool enabled);
+    void enableGpuLoadReporting(bool enabled);
 
 Q_SIGNALS:
     void updated();
@@ -53,18 +61,24 @@ Q_SIGNALS:
 private:
     void openCpuLoad();
     qreal readCpuLoad();
+    qreal readGpuLoad();
     bool readMemory(Memory &mem);
 
 #if defined(Q_OS_LINUX)
     bool readSmaps(const QByteArray &smapsFile, Memory &mem);
+    bool readSmapsRollup(const QByteArray &smapsRollupFile, Memory &mem);
+    bool readStatm(const QByteArray &statmFile, Memory &mem);
 
     std::unique_ptr<SysFsReader> m_statReader;
     QElapsedTimer m_elapsedTime;
     quint64 m_lastCpuUsage = 0.0;
+    std::unique_ptr<DrmGpuReader> m_gpuReader;
 #endif
 
     qint64 m_pid = 0;
     bool m_memoryReportingEnabled = true;
+    bool m_detailedMemoryReporting = true;
+    bool m_gpuLoadReportingEnabled = false;
 };
 
 QT_END_NAMESPACE_AM
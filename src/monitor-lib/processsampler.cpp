@@ -0,0 +1,148 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#include <QMutexLocker>
+#include "processsampler.h"
+
+
+QT_BEGIN_NAMESPACE_AM
+
+ProcessSampler::ProcessSampler(QObject *parent)
+    : QObject(parent)
+{ }
+
+ProcessSampler::~ProcessSampler()
+{
+    qDeleteAll(m_readers);
+}
+
+ProcessSampler::Sample ProcessSampler::sample(qint64 pid) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_samples.value(pid);
+}
+
+void ProcessSampler::subscribe(quintptr subscriber, qint64 pid, bool memoryReporting,
+                               bool detailedMemoryReporting, bool gpuLoadReporting)
+{
+    Subscription &s = m_subscriptions[subscriber];
+    const bool pidChanged = (s.pid != pid);
+    s.pid = pid;
+    s.memoryReporting = memoryReporting;
+    s.detailedMemoryReporting = detailedMemoryReporting;
+    s.gpuLoadReporting = gpuLoadReporting;
+
+    if (pidChanged)
+        removeUnusedReaders();
+}
+
+void ProcessSampler::unsubscribe(quintptr subscriber)
+{
+    m_pendingSubscribers.remove(subscriber);
+    if (m_subscriptions.remove(subscriber))
+        removeUnusedReaders();
+}
+
+void ProcessSampler::requestUpdate(quintptr subscriber)
+{
+    m_pendingSubscribers.insert(subscriber);
+
+    // all requests that are already queued up will be handled before the tick
+    if (!m_tickScheduled) {
+        m_tickScheduled = true;
+        QMetaObject::invokeMethod(this, &ProcessSampler::tick, Qt::QueuedConnection);
+    }
+}
+
+void ProcessSampler::tick()
+{
+    m_tickScheduled = false;
+
+    struct Request
+    {
+        bool memoryReporting = false;
+        bool detailedMemoryReporting = false;
+        bool gpuLoadReporting = false;
+    };
+    QHash<qint64, Request> requests;
+    QSet<quintptr> served = std::exchange(m_pendingSubscribers, { });
+
+    for (auto sit = served.begin(); sit != served.end(); ) {
+        const auto it = m_subscriptions.constFind(*sit);
+        if (it == m_subscriptions.cend()) {
+            sit = served.erase(sit);
+            continue;
+        }
+        ++sit;
+
+        // merge the requirements of all subscribers for the same PID
+        Request &r = requests[it->pid];
+        r.memoryReporting = r.memoryReporting || it->memoryReporting;
+        r.detailedMemoryReporting = r.detailedMemoryReporting
+                                    || (it->memoryReporting && it->detailedMemoryReporting);
+        r.gpuLoadReporting = r.gpuLoadReporting || it->gpuLoadReporting;
+    }
+
+    QHash<qint64, Sample> samples;
+    samples.reserve(requests.size());
+
+    for (auto it = requests.cbegin(); it != requests.cend(); ++it) {
+        const qint64 pid = it.key();
+        if (!pid) { // there is nothing to read for PID 0 (e.g. apps in single-process mode)
+            samples.insert(pid, Sample { });
+            continue;
+        }
+
+        ProcessReader *&reader = m_readers[pid];
+        if (!reader) {
+            reader = new ProcessReader;
+            reader->setProcessId(pid);
+        }
+        reader->enableMemoryReporting(it->memoryReporting);
+        reader->enableDetailedMemoryReporting(it->detailedMemoryReporting);
+        reader->enableGpuLoadReporting(it->gpuLoadReporting);
+        reader->update();
+
+        QMutexLocker readerLocker(&reader->mutex);
+        samples.insert(pid, Sample { reader->cpuLoad, reader->gpuLoad, reader->memory });
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        for (auto it = samples.cbegin(); it != samples.cend(); ++it)
+            m_samples.insert(it.key(), it.value());
+    }
+
+    if (!served.isEmpty())
+        emit updated(served);
+}
+
+void ProcessSampler::removeUnusedReaders()
+{
+    QSet<qint64> pids;
+    for (const auto &s : std::as_const(m_subscriptions))
+        pids.insert(s.pid);
+
+    // the CPU load is calculated relative to the last reading, so a reader has to be kept alive
+    // for as long as there is at least one subscriber for its PID
+    for (auto it = m_readers.begin(); it != m_readers.end(); ) {
+        if (!pids.contains(it.key())) {
+            delete it.value();
+            it = m_readers.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    QMutexLocker locker(&m_mutex);
+    for (auto it = m_samples.begin(); it != m_samples.end(); ) {
+        if (!pids.contains(it.key()))
+            it = m_samples.erase(it);
+        else
+            ++it;
+    }
+}
+
+QT_END_NAMESPACE_AM
+
+#include "moc_processsampler.cpp"
@@ -0,0 +1,74 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
+
+#ifndef PROCESSSAMPLER_H
+#define PROCESSSAMPLER_H
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QObject>
+#include <QtCore/QSet>
+
+#include <QtAppManCommon/global.h>
+#include <QtAppManMonitor/processreader.h>
+
+QT_BEGIN_NAMESPACE_AM
+
+// A shared sampling engine for process statistics, which is supposed to live in a worker thread.
+// Any number of subscribers (identified by an opaque key) can register a PID and then request
+// updates. All requests that arrive before the next tick are coalesced, and every distinct PID is
+// only read once per tick, no matter how many subscribers are interested in it.
+// All slots need to be called in the sampler's thread (e.g. via QMetaObject::invokeMethod), while
+// sample() can be called from any thread.
+class ProcessSampler : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Sample
+    {
+        qreal cpuLoad = 0.0;
+        qreal gpuLoad = 0.0;
+        ProcessReader::Memory memory;
+    };
+
+    explicit ProcessSampler(QObject *parent = nullptr);
+    ~ProcessSampler() override;
+
+    Sample sample(qint64 pid) const;
+
+public Q_SLOTS:
+    void subscribe(quintptr subscriber, qint64 pid, bool memoryReporting, bool detailedMemoryReporting,
+                   bool gpuLoadReporting = false);
+    void unsubscribe(quintptr subscriber);
+    void requestUpdate(quintptr subscriber);
+
+Q_SIGNALS:
+    // the subscribers whose update requests were served in this tick: this is a set, because
+    // every subscriber has to do a lookup
+    void updated(const QSet<quintptr> &subscribers);
+
+private:
+    void tick();
+    void removeUnusedReaders();
+
+    struct Subscription
+    {
+        qint64 pid = 0;
+        bool memoryReporting = true;
+        bool detailedMemoryReporting = true;
+        bool gpuLoadReporting = false;
+    };
+    QHash<quintptr, Subscription> m_subscriptions;
+    QSet<quintptr> m_pendingSubscribers;
+    bool m_tickScheduled = false;
+    QHash<qint64, ProcessReader *> m_readers;
+
+    mutable QMutex m_mutex; // protects m_samples
+    QHash<qint64, Sample> m_samples;
+};
+
+QT_END_NAMESPACE_AM
+
+#endif // PROCESSSAMPLER_H
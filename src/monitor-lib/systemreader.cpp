@@ -41,7 +41,17 @@ QT_END_NAMESPACE_AM
 #  include <QOpenGLContext>
 #  include <QOpenGLFunctions>
 
+#  include <QScopeGuard>
+#  include <QTimer>
+#  include <QByteArrayView>
+
 #  include <sys/eventfd.h>
+#  include <dirent.h>
+#  include <limits.h>
+#  include <ctype.h>
+#  include <poll.h>
+
+#  include <algorithm>
 #  include <fcntl.h>
 #  include <unistd.h>
 #  include <sys/ioctl.h>
@@ -260,6 +270,15 @@ GpuReader::GpuReader()
 
 void GpuReader::setActive(bool enabled)
 {
+    // no need to spawn vendor tools, if the kernel can tell us directly
+    if (m_drmReader || (enabled && DrmGpuReader::isSupported())) {
+        if (!enabled)
+            m_drmReader.reset();
+        else if (!m_drmReader)
+            m_drmReader.reset(new DrmGpuReader);
+        return;
+    }
+
     if (!s_gpuToolProcess)
         s_gpuToolProcess = new GpuTool();
 
@@ -275,26 +294,276 @@ void GpuReader::setActive(bool enabled)
 
 bool GpuReader::isActive() const
 {
+    if (m_drmReader)
+        return true;
     return s_gpuToolProcess ? s_gpuToolProcess->isRunning() : false;
 }
 
 qreal GpuReader::readLoadValue()
 {
+    if (m_drmReader)
+        return m_drmReader->readLoadValue();
     return s_gpuToolProcess ? s_gpuToolProcess->loadValue() : -1;
 }
 
+DrmGpuReader::DrmGpuReader(qint64 pid)
+    : m_pid(pid)
+{ }
+
+bool DrmGpuReader::isSupported()
+{
+    // the sysfs counters are world-readable and cover all clients
+    if (readSysFsLoad() >= 0)
+        return true;
+    if (!hasFdInfoDriver())
+        return false;
+
+    // A DRM driver alone is not enough: older kernels and some drivers do not report any
+    // drm-engine-* keys at all. Also, the fds of other users' processes can only be inspected
+    // with elevated privileges (CAP_SYS_PTRACE): summing up only the visible clients would
+    // undercount the load, so the vendor tools are preferred in both cases.
+    QHash<QByteArray, Client> clients;
+    const int inaccessible = readAllClients(clients);
+    if (inaccessible) {
+        qCDebug(LogSystem) << "Not using DRM fdinfo for the GPU load:" << inaccessible
+                           << "processes cannot be inspected";
+        return false;
+    }
+    return !clients.isEmpty();
+}
+
+bool DrmGpuReader::hasFdInfoDriver()
+{
+    const QByteArray drmDir = QFile::encodeName(g_systemRootDir) + "/sys/class/drm/";
+    DIR *dir = ::opendir(drmDir.constData());
+    if (!dir)
+        return false;
+    auto closeDir = qScopeGuard([dir]() { ::closedir(dir); });
+
+    while (const auto *entry = ::readdir(dir)) {
+        const QByteArrayView name(entry->d_name);
+        if (!name.startsWith("card") || name.contains('-')) // skip the connectors, e.g. card0-HDMI-A-1
+            continue;
+
+        char target[PATH_MAX];
+        const QByteArray driverLink = drmDir + entry->d_name + "/device/driver";
+        const auto len = ::readlink(driverLink.constData(), target, sizeof(target) - 1);
+        if (len <= 0)
+            continue;
+        const QByteArrayView link(target, len);
+        const QByteArrayView driver = link.sliced(link.lastIndexOf('/') + 1);
+
+        // the proprietary NVIDIA driver does not implement the DRM fdinfo interface
+        if (!driver.isEmpty() && (driver != "nvidia"))
+            return true;
+    }
+    return false;
+}
+
+QByteArray DrmGpuReader::parseFdInfo(const QByteArray &fdInfo, Client &client)
+{
+    // see https://docs.kernel.org/gpu/drm-usage-stats.html
+    QByteArray pdev;
+    QByteArray clientId;
+
+    const QByteArrayView fdInfoView(fdInfo);
+    for (qsizetype pos = 0; pos < fdInfoView.size(); ) {
+        auto eol = fdInfoView.indexOf('\n', pos);
+        if (eol < 0)
+            eol = fdInfoView.size();
+        const QByteArrayView line = fdInfoView.sliced(pos, eol - pos);
+        pos = eol + 1;
+
+        if (!line.startsWith("drm-"))
+            continue;
+        const auto colon = line.indexOf(':');
+        if (colon < 0)
+            continue;
+        const QByteArrayView key = line.first(colon);
+        const QByteArrayView value = line.sliced(colon + 1).trimmed();
+
+        if (key == "drm-pdev") {
+            pdev = value.toByteArray();
+        } else if (key == "drm-client-id") {
+            clientId = value.toByteArray();
+        } else if (key.startsWith("drm-engine-capacity-")) {
+            const uint capacity = value.toUInt();
+            if (capacity > 1)
+                client.capacity.insert(key.sliced(20).toByteArray(), capacity);
+        } else if (key.startsWith("drm-engine-")) {
+            // "<nsec> ns"
+            const auto space = value.indexOf(' ');
+            bool ok = false;
+            const quint64 nsec = value.first(space < 0 ? value.size() : space).toULongLong(&ok);
+            if (ok)
+                client.busyNSec.insert(key.sliced(11).toByteArray(), nsec);
+        }
+    }
+    if (clientId.isEmpty())
+        return { };
+    // client ids are only unique per device. Also, the same client can be reachable via multiple
+    // fds (dup() and fork()), so this key is used to count every client only once.
+    return pdev + '/' + clientId;
+}
+
+qreal DrmGpuReader::readSysFsLoad()
+{
+    const QByteArray drmDir = QFile::encodeName(g_systemRootDir) + "/sys/class/drm/";
+    DIR *dir = ::opendir(drmDir.constData());
+    if (!dir)
+        return -1;
+    auto closeDir = qScopeGuard([dir]() { ::closedir(dir); });
+
+    qreal load = -1;
+    while (const auto *entry = ::readdir(dir)) {
+        const QByteArrayView name(entry->d_name);
+        if (!name.startsWith("card") || name.contains('-'))
+            continue;
+
+        SysFsReader busy(drmDir + entry->d_name + "/device/gpu_busy_percent", 16);
+        if (!busy.isOpen())
+            continue;
+        bool ok = false;
+        const int percent = busy.readValue().trimmed().toInt(&ok);
+        if (ok)
+            load = std::max(load, qreal(percent) / 100);
+    }
+    return load;
+}
+
+bool DrmGpuReader::readProcessClients(const QByteArray &procDir, QHash<QByteArray, Client> &clients)
+{
+    const QByteArray fdDir = procDir + "/fd/";
+    DIR *dir = ::opendir(fdDir.constData());
+    if (!dir)
+        return (errno != EACCES); // the process might have exited in the meantime
+    auto closeDir = qScopeGuard([dir]() { ::closedir(dir); });
+
+    while (const auto *entry = ::readdir(dir)) {
+        if (entry->d_name[0] == '.')
+            continue;
+
+        // only the fdinfo of DRM device nodes is interesting: checking the link target is a lot
+        // cheaper than reading the fdinfo of every fd
+        char target[PATH_MAX];
+        const QByteArray fdLink = fdDir + entry->d_name;
+        const auto len = ::readlink(fdLink.constData(), target, sizeof(target) - 1);
+        if ((len <= 0) || !QByteArrayView(target, len).startsWith("/dev/dri/"))
+            continue;
+
+        QFile fdInfoFile(QString::fromLocal8Bit(procDir + "/fdinfo/" + entry->d_name));
+        if (!fdInfoFile.open(QIODevice::ReadOnly))
+            continue;
+
+        Client client;
+        const QByteArray key = parseFdInfo(fdInfoFile.readAll(), client);
+        if (!key.isEmpty() && !client.busyNSec.isEmpty())
+            clients.insert(key, client);
+    }
+    return true;
+}
+
+int DrmGpuReader::readAllClients(QHash<QByteArray, Client> &clients)
+{
+    const QByteArray procDir = QFile::encodeName(g_systemRootDir) + "/proc/";
+    DIR *dir = ::opendir(procDir.constData());
+    if (!dir)
+        return 0;
+    auto closeDir = qScopeGuard([dir]() { ::closedir(dir); });
+
+    int inaccessible = 0;
+    while (const auto *entry = ::readdir(dir)) {
+        if (isdigit(entry->d_name[0]) && !readProcessClients(procDir + entry->d_name, clients))
+            ++inaccessible;
+    }
+    return inaccessible;
+}
+
+qreal DrmGpuReader::readLoadValue()
+{
+    qint64 elapsed = m_lastCheck.isValid() ? m_lastCheck.nsecsElapsed() : 0;
+    m_lastCheck.start();
+    return readLoadValue(elapsed);
+}
+
+qreal DrmGpuReader::testReadLoadValue(qint64 elapsedNSec)
+{
+    return readLoadValue(elapsedNSec);
+}
+
+qreal DrmGpuReader::readLoadValue(qint64 elapsedNSec)
+{
+    if (!m_pid) {
+        const qreal sysFsLoad = readSysFsLoad();
+        if (sysFsLoad >= 0)
+            return sysFsLoad;
+    }
+
+    QHash<QByteArray, Client> clients;
+
+    if (m_pid)
+        readProcessClients(QFile::encodeName(g_systemRootDir) + "/proc/" + QByteArray::number(m_pid), clients);
+    else
+        readAllClients(clients);
+
+    // the busy time of every engine during the last interval, summed up over all clients
+    QHash<QByteArray, quint64> engineBusy;
+    QHash<QByteArray, uint> engineCapacity;
+
+    for (auto it = clients.cbegin(); it != clients.cend(); ++it) {
+        // a new client has no reference value yet
+        const auto last = m_lastClients.constFind(it.key());
+        if (last == m_lastClients.cend())
+            continue;
+
+        const QByteArray device = it.key().left(it.key().lastIndexOf('/') + 1);
+        for (auto eit = it->busyNSec.cbegin(); eit != it->busyNSec.cend(); ++eit) {
+            const quint64 lastBusy = last->busyNSec.value(eit.key(), eit.value());
+            const QByteArray engine = device + eit.key();
+
+            engineBusy[engine] += (eit.value() > lastBusy) ? (eit.value() - lastBusy) : 0;
+            engineCapacity[engine] = it->capacity.value(eit.key(), 1);
+        }
+    }
+    m_lastClients = clients;
+
+    if (elapsedNSec <= 0)
+        return 0;
+
+    qreal load = 0;
+    for (auto it = engineBusy.cbegin(); it != engineBusy.cend(); ++it) {
+        load = std::max(load, qreal(it.value()) / qreal(elapsedNSec)
+                                  / qreal(engineCapacity.value(it.key(), 1)));
+    }
+    return std::min(load, qreal(1));
+}
+
 // TODO: can we always expect cgroup FS to be mounted on /sys/fs/cgroup?
+static const char *cGroupsBaseDir = "/sys/fs/cgroup/";
 static const char *cGroupsMemoryBaseDir = "/sys/fs/cgroup/memory/";
 
+bool MemoryReader::isCGroupV2()
+{
+    // only the root of the unified hierarchy has this file
+    return QFile::exists(g_systemRootDir + QString::fromLatin1(cGroupsBaseDir) + u"cgroup.controllers"_s);
+}
+
+QString MemoryReader::cGroupMemoryDir(const QString &groupPath)
+{
+    return g_systemRootDir + QString::fromLatin1(isCGroupV2() ? cGroupsBaseDir : cGroupsMemoryBaseDir)
+           + groupPath;
+}
+
 MemoryReader::MemoryReader() : MemoryReader(QString())
 { }
 
 MemoryReader::MemoryReader(const QString &groupPath)
     : m_groupPath(groupPath)
+    , m_cGroupV2(isCGroupV2())
 {
-    const QString path = g_systemRootDir + QString::fromLatin1(cGroupsMemoryBaseDir)
-                         + m_groupPath + u"/memory.stat"_s;
+    const QString path = cGroupMemoryDir(m_groupPath) + u"/memory.stat"_s;
 
+    // the v2 memory.stat is a lot longer, but the anon value we need comes first
     m_sysFs.reset(new SysFsReader(path.toLocal8Bit(), 1500));
     if (!m_sysFs->isOpen()) {
         qCWarning(LogSystem) << "WARNING: could not read memory statistics from" << m_sysFs->fileName()
@@ -317,8 +586,16 @@ MemoryReader::MemoryReader(const QString &groupPath)
 
 quint64 MemoryReader::groupLimit()
 {
-    QString path = g_systemRootDir + QString::fromLatin1(cGroupsMemoryBaseDir)
-                   + m_groupPath + u"/memory.limit_in_bytes"_s;
+    if (m_cGroupV2) {
+        const QString path = cGroupMemoryDir(m_groupPath) + u"/memory.max"_s;
+        const QByteArray ba = SysFsReader(path.toLocal8Bit(), 41).readValue();
+        // "max" means unlimited: the physical RAM is the limit then
+        if (ba.isEmpty() || ba.startsWith("max"))
+            return totalValue();
+        return ::strtoull(ba, nullptr, 10);
+    }
+
+    QString path = cGroupMemoryDir(m_groupPath) + u"/memory.limit_in_bytes"_s;
     QByteArray ba = SysFsReader(path.toLocal8Bit(), 41).readValue();
     return ::strtoull(ba, nullptr, 10);
 }
@@ -327,10 +604,15 @@ quint64 MemoryReader::readUsedValue() const
 {
     QByteArray buffer = m_sysFs->readValue();
 
-    qsizetype i = buffer.indexOf("total_rss ");
+    // v2's "anon" is the equivalent of v1's "total_rss": neither includes the page cache, which
+    // memory.current would
+    const QByteArray key = m_cGroupV2 ? "anon "_ba : "total_rss "_ba;
+    qsizetype i = buffer.startsWith(key) ? 0 : buffer.indexOf('\n' + key);
     if (i == -1)
         return 0;
-    return ::strtoull(buffer.data() + i + sizeof("total_rss ") - 1, nullptr, 10);
+    if (i > 0)
+        ++i;
+    return ::strtoull(buffer.data() + i + key.size(), nullptr, 10);
 }
 
 
@@ -390,6 +672,8 @@ MemoryThreshold::MemoryThreshold(const QList<qreal> &thresholds)
 
 MemoryThreshold::~MemoryThreshold()
 {
+    if (m_eventsFd != -1)
+        QT_CLOSE(m_eventsFd);
     if (m_usageFd != -1)
         QT_CLOSE(m_usageFd);
     if (m_controlFd != -1)
@@ -421,7 +705,11 @@ bool MemoryThreshold::setEnabled(bool enabled, const QString &groupPath, MemoryR
 
     if (enabled && !m_initialized) {
         quint64 limit = groupPath.isEmpty() ? reader->totalValue() : reader->groupLimit();
-        const QString cGroup = QString::fromLatin1(cGroupsMemoryBaseDir) + groupPath;
+
+        if (MemoryReader::isCGroupV2())
+            return enableCGroupV2(groupPath, limit);
+
+        const QString cGroup = MemoryReader::cGroupMemoryDir(groupPath);
 
         m_eventFd = ::eventfd(0, EFD_CLOEXEC);
 
@@ -470,12 +758,82 @@ bool MemoryThreshold::setEnabled(bool enabled, const QString &groupPath, MemoryR
         return false;
     } else {
         m_enabled = enabled;
-        m_notifier->setEnabled(enabled);
+        if (m_notifier)
+            m_notifier->setEnabled(enabled);
+        if (m_pollTimer) {
+            if (enabled)
+                m_pollTimer->start();
+            else
+                m_pollTimer->stop();
+        }
 
         return true;
     }
 }
 
+bool MemoryThreshold::enableCGroupV2(const QString &groupPath, quint64 limit)
+{
+    m_usageReader.reset(new MemoryReader(groupPath));
+
+    m_thresholdValues.clear();
+    for (qreal percent : std::as_const(m_thresholds))
+        m_thresholdValues << quint64(qreal(limit) * percent / 100);
+    std::sort(m_thresholdValues.begin(), m_thresholdValues.end());
+    m_thresholdLevel = 0;
+
+    // the root cgroup has no memory.events
+    if (!groupPath.isEmpty()) {
+        const QString eventsPath = MemoryReader::cGroupMemoryDir(groupPath) + u"/memory.events"_s;
+        m_eventsFd = QT_OPEN(eventsPath.toLocal8Bit().constData(), QT_OPEN_RDONLY);
+
+        if (m_eventsFd >= 0) {
+            // cgroup files signal modifications via POLLPRI
+            m_notifier = new QSocketNotifier(m_eventsFd, QSocketNotifier::Exception, this);
+            connect(m_notifier, &QSocketNotifier::activated, this, &MemoryThreshold::readMemoryEvents);
+            readMemoryEvents(); // the file has to be read once to arm the notification
+        } else {
+            qCWarning(LogSystem) << "Cannot open" << eventsPath;
+        }
+    }
+
+    m_pollTimer = new QTimer(this);
+    m_pollTimer->setInterval(1000);
+    connect(m_pollTimer, &QTimer::timeout, this, &MemoryThreshold::checkUsage);
+    m_pollTimer->start();
+    checkUsage();
+
+    return m_initialized = m_enabled = true;
+}
+
+void MemoryThreshold::checkUsage()
+{
+    // emulate the v1 behavior: only trigger when crossing a threshold, in either direction
+    const quint64 used = m_usageReader->readUsedValue();
+    qsizetype level = 0;
+    while ((level < m_thresholdValues.size()) && (used >= m_thresholdValues.at(level)))
+        ++level;
+
+    if (level != m_thresholdLevel) {
+        m_thresholdLevel = level;
+        emit thresholdTriggered();
+    }
+}
+
+void MemoryThreshold::readMemoryEvents()
+{
+    if (m_eventsFd < 0)
+        return;
+
+    char buffer[256];
+    if ((QT_LSEEK(m_eventsFd, 0, SEEK_SET) < 0) || (QT_READ(m_eventsFd, buffer, sizeof(buffer)) < 0)) {
+        qCWarning(LogSystem) << "Error reading memory.events:" << strerror(errno);
+        return;
+    }
+    // one of the high, max, oom or oom_kill counters changed: re-check right away
+    if (m_enabled && m_initialized)
+        emit thresholdTriggered();
+}
+
 void MemoryThreshold::readEventFd()
 {
     if (m_eventFd >= 0) {
@@ -496,6 +854,86 @@ void MemoryThreshold::readEventFd()
     }
 }
 
+MemoryPressureTrigger::MemoryPressureTrigger(QObject *parent)
+    : QObject(parent)
+{ }
+
+MemoryPressureTrigger::~MemoryPressureTrigger()
+{
+    stop();
+}
+
+QString MemoryPressureTrigger::pressureFile(const QString &groupPath)
+{
+    if (groupPath.isEmpty())
+        return g_systemRootDir + u"/proc/pressure/memory"_s;
+    return MemoryReader::cGroupMemoryDir(groupPath) + u"/memory.pressure"_s;
+}
+
+bool MemoryPressureTrigger::isSupported(const QString &groupPath)
+{
+    // there is no memory.pressure in cgroup v1
+    if (!groupPath.isEmpty() && !MemoryReader::isCGroupV2())
+        return false;
+    return QFile::exists(pressureFile(groupPath));
+}
+
+bool MemoryPressureTrigger::start(const QString &groupPath, Type type, std::chrono::microseconds stallTime,
+                                  std::chrono::microseconds window)
+{
+    stop();
+
+    const QByteArray fileName = pressureFile(groupPath).toLocal8Bit();
+    m_fd = QT_OPEN(fileName.constData(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (m_fd < 0) {
+        qCWarning(LogSystem) << "Cannot open" << fileName << ":" << strerror(errno);
+        return false;
+    }
+
+    // see https://docs.kernel.org/accounting/psi.html#monitoring-for-pressure-thresholds
+    const QByteArray trigger = (type == Full ? "full " : "some ") + QByteArray::number(stallTime.count())
+                               + ' ' + QByteArray::number(window.count());
+    if (QT_WRITE(m_fd, trigger.constData(), size_t(trigger.size()) + 1) < 0) {
+        qCWarning(LogSystem) << "Cannot register the memory pressure trigger" << trigger << "on"
+                             << fileName << ":" << strerror(errno);
+        stop();
+        return false;
+    }
+
+    // the kernel signals a triggered threshold via POLLPRI
+    m_notifier = new QSocketNotifier(m_fd, QSocketNotifier::Exception, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, [this]() {
+        struct pollfd pfd = { m_fd, POLLPRI, 0 };
+        if ((::poll(&pfd, 1, 0) > 0) && (pfd.revents & POLLERR)) {
+            // the monitored cgroup was removed
+            qCWarning(LogSystem) << "Memory pressure monitoring stopped unexpectedly";
+            stop();
+            return;
+        }
+        emit triggered();
+    });
+    return true;
+}
+
+void MemoryPressureTrigger::stop()
+{
+    if (m_notifier) {
+        // this can be called from within the notifier's activated signal
+        m_notifier->setEnabled(false);
+        m_notifier->deleteLater();
+        m_notifier = nullptr;
+    }
+    if (m_fd >= 0) {
+        QT_CLOSE(m_fd);
+        m_fd = -1;
+    }
+}
+
+bool MemoryPressureTrigger::isActive() const
+{
+    return m_fd >= 0;
+}
+
 MemoryWatcher::MemoryWatcher(QObject *parent)
     : QObject(parent)
 { }
@@ -515,26 +953,95 @@ bool MemoryWatcher::startWatching(const QString &groupPath)
 
     hasMemoryLowWarning = false;
     hasMemoryCriticalWarning = false;
+    m_memoryLowSent = false;
+    m_memoryCriticalSent = false;
+    m_pressureLow = false;
+    m_pressureCritical = false;
 
     m_reader.reset(new MemoryReader(groupPath));
     m_memLimit = groupPath.isEmpty() ? m_reader->totalValue() : m_reader->groupLimit();
 
     m_threshold.reset(new MemoryThreshold({m_warning, m_critical}));
     connect(m_threshold.get(), &MemoryThreshold::thresholdTriggered, this, &MemoryWatcher::checkMemoryConsumption);
-    return m_threshold->setEnabled(true, groupPath, m_reader.get());
+    bool ok = m_threshold->setEnabled(true, groupPath, m_reader.get());
+
+    // PSI triggers fire when tasks actually start to stall on memory, which usually happens well
+    // before the usage thresholds are reached (or the OOM killer kicks in)
+    m_pressureWarningTrigger.reset();
+    m_pressureCriticalTrigger.reset();
+
+    if (MemoryPressureTrigger::isSupported(groupPath)) {
+        // unprivileged users can only use windows that are a multiple of 2sec
+        static constexpr std::chrono::microseconds window = std::chrono::seconds(2);
+
+        if (!m_pressureClearTimer) {
+            m_pressureClearTimer = new QTimer(this);
+            m_pressureClearTimer->setSingleShot(true);
+            m_pressureClearTimer->setInterval(std::chrono::duration_cast<std::chrono::milliseconds>(window * 2));
+            connect(m_pressureClearTimer, &QTimer::timeout, this, &MemoryWatcher::clearPressure);
+        }
+
+        auto createTrigger = [&](qreal percent, MemoryPressureTrigger::Type type,
+                                 void (MemoryWatcher::*slot)()) -> MemoryPressureTrigger * {
+            auto trigger = new MemoryPressureTrigger;
+            const auto stall = std::chrono::microseconds(qint64(qreal(window.count()) * percent / 100));
+            if (!trigger->start(groupPath, type, stall, window)) {
+                delete trigger;
+                return nullptr;
+            }
+            connect(trigger, &MemoryPressureTrigger::triggered, this, slot);
+            return trigger;
+        };
+        m_pressureWarningTrigger.reset(createTrigger(PressureWarning, MemoryPressureTrigger::Some,
+                                                     &MemoryWatcher::pressureWarningTriggered));
+        m_pressureCriticalTrigger.reset(createTrigger(PressureCritical, MemoryPressureTrigger::Full,
+                                                      &MemoryWatcher::pressureCriticalTriggered));
+        ok = ok || m_pressureWarningTrigger || m_pressureCriticalTrigger;
+    }
+    return ok;
 }
 
 void MemoryWatcher::checkMemoryConsumption()
 {
     qreal percentUsed = qreal(m_reader->readUsedValue()) / qreal(m_memLimit) * 100;
-    bool nowMemoryCritical = (percentUsed >= m_critical);
-    bool nowMemoryLow = (percentUsed >= m_warning);
-    if (nowMemoryCritical  && !hasMemoryCriticalWarning)
+    hasMemoryCriticalWarning = (percentUsed >= m_critical);
+    hasMemoryLowWarning = (percentUsed >= m_warning);
+    updateWarnings();
+}
+
+void MemoryWatcher::pressureWarningTriggered()
+{
+    m_pressureLow = true;
+    m_pressureClearTimer->start();
+    updateWarnings();
+}
+
+void MemoryWatcher::pressureCriticalTriggered()
+{
+    m_pressureCritical = true;
+    m_pressureClearTimer->start();
+    updateWarnings();
+}
+
+void MemoryWatcher::clearPressure()
+{
+    m_pressureLow = false;
+    m_pressureCritical = false;
+    updateWarnings();
+}
+
+void MemoryWatcher::updateWarnings()
+{
+    // the usage thresholds and the PSI triggers both feed into the same warnings: each one is
+    // only sent once, until neither of the two sources reports it anymore
+    const bool nowMemoryCritical = hasMemoryCriticalWarning || m_pressureCritical;
+    const bool nowMemoryLow = hasMemoryLowWarning || m_pressureLow;
+    if (nowMemoryCritical && !m_memoryCriticalSent)
         emit memoryCritical();
-    if (nowMemoryLow && !hasMemoryLowWarning)
+    if (nowMemoryLow && !m_memoryLowSent)
         emit memoryLow();
-    hasMemoryCriticalWarning = nowMemoryCritical;
-    hasMemoryLowWarning = nowMemoryLow;
+    m_memoryCriticalSent = nowMemoryCritical;
+    m_memoryLowSent = nowMemoryLow;
 }
 
 QMap<QByteArray, QByteArray> fetchCGroupProcessInfo(qint64 pid)
@@ -787,6 +1294,8 @@ MemoryWatcher::MemoryWatcher(QObject *parent)
     Q_UNUSED(m_memLimit)
     Q_UNUSED(hasMemoryLowWarning)
     Q_UNUSED(hasMemoryCriticalWarning)
+    Q_UNUSED(m_memoryLowSent)
+    Q_UNUSED(m_memoryCriticalSent)
 }
 
 void MemoryWatcher::setThresholds(qreal warning, qreal critical)
@@ -804,6 +1313,9 @@ bool MemoryWatcher::startWatching(const QString &groupPath)
 void MemoryWatcher::checkMemoryConsumption()
 { }
 
+void MemoryWatcher::updateWarnings()
+{ }
+
 QT_END_NAMESPACE_AM
 
 #endif // !defined(Q_OS_LINUX)
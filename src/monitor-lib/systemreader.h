@@ -7,16 +7,19 @@
 #define SYSTEMREADER_H
 
 #include <QtCore/QByteArray>
+#include <QtCore/QHash>
 #include <QtCore/QPair>
 #include <QtCore/QElapsedTimer>
 #include <QtCore/QObject>
 #include <QtAppManCommon/global.h>
 
+#include <chrono>
 #include <memory>
 
 #if defined(Q_OS_LINUX)
 #  include <QtAppManMonitor/sysfsreader.h>
 QT_FORWARD_DECLARE_CLASS(QSocketNotifier)
+QT_FORWARD_DECLARE_CLASS(QTimer)
 #endif
 
 QT_BEGIN_NAMESPACE_AM
@@ -51,6 +54,54 @@ private:
     static Vendor s_vendor;
 };
 
+#if defined(Q_OS_LINUX)
+// Calculates the GPU load from the per-engine busy times that the kernel's DRM drivers report
+// for each client in /proc/<pid>/fdinfo (drm-engine-*). The load of the busiest engine is
+// returned, so a fully loaded render engine means a load of 1, even if e.g. the video engines
+// are idle.
+// With a PID of 0, the system-wide load is reported: this is read from the gpu_busy_percent
+// counters in sysfs, if the driver provides them, or summed up from the DRM clients of all
+// processes otherwise. The latter only sees the processes whose fds are accessible, which
+// requires elevated privileges (CAP_SYS_PTRACE) for processes of other users: isSupported()
+// checks for that, so GpuReader can fall back to the vendor tools.
+class DrmGpuReader
+{
+public:
+    explicit DrmGpuReader(qint64 pid = 0);
+    qreal readLoadValue();
+
+    // true, if the system-wide load can be read: either via sysfs, or if there are DRM clients
+    // reporting drm-engine-* keys and the fds of all processes are accessible
+    static bool isSupported();
+
+    struct Client
+    {
+        QHash<QByteArray, quint64> busyNSec; // per engine
+        QHash<QByteArray, uint> capacity;    // per engine, if different from 1
+    };
+    // Parses the contents of one fdinfo file. Returns a unique key for the DRM client, or an
+    // empty key, if the file does not belong to a DRM client.
+    static QByteArray parseFdInfo(const QByteArray &fdInfo, Client &client);
+
+    // solely for testing purposes
+    qreal testReadLoadValue(qint64 elapsedNSec);
+
+private:
+    qreal readLoadValue(qint64 elapsedNSec);
+    static qreal readSysFsLoad();
+    static bool hasFdInfoDriver();
+    // returns false, if the process' fds are not accessible
+    static bool readProcessClients(const QByteArray &procDir, QHash<QByteArray, Client> &clients);
+    // returns the number of processes whose fds are not accessible
+    static int readAllClients(QHash<QByteArray, Client> &clients);
+
+    qint64 m_pid;
+    QElapsedTimer m_lastCheck;
+    QHash<QByteArray, Client> m_lastClients;
+    Q_DISABLE_COPY_MOVE(DrmGpuReader)
+};
+#endif
+
 class GpuTool;
 
 class GpuReader
@@ -64,6 +115,7 @@ public:
 private:
 #if defined(Q_OS_LINUX)
     static GpuTool *s_gpuToolProcess;
+    std::unique_ptr<DrmGpuReader> m_drmReader; // preferred over the vendor tools, if supported
 #endif
     Q_DISABLE_COPY_MOVE(GpuReader)
 };
@@ -76,6 +128,11 @@ public:
 #if defined(Q_OS_LINUX)
     explicit MemoryReader(const QString &groupPath);
     quint64 groupLimit();
+
+    // true, if the cgroup v2 unified hierarchy is mounted instead of the v1 memory controller
+    static bool isCGroupV2();
+    // the directory of the given memory cgroup, for both cgroup v1 and v2
+    static QString cGroupMemoryDir(const QString &groupPath);
 #endif
     quint64 totalValue() const;
     quint64 readUsedValue() const;
@@ -85,6 +142,7 @@ private:
 #if defined(Q_OS_LINUX)
     std::unique_ptr<SysFsReader> m_sysFs;
     const QString m_groupPath;
+    const bool m_cGroupV2;
 #elif defined(Q_OS_MACOS) || defined(Q_OS_IOS)
     static int s_pageSize;
 #endif
@@ -134,15 +192,62 @@ private:
 #if defined(Q_OS_LINUX)
 private Q_SLOTS:
     void readEventFd();
+    void checkUsage();
+    void readMemoryEvents();
 
 private:
+    bool enableCGroupV2(const QString &groupPath, quint64 limit);
+
+    // cgroup v1: eventfd based usage thresholds
     int m_eventFd = -1;
     int m_controlFd = -1;
     int m_usageFd = -1;
     QSocketNotifier *m_notifier = nullptr;
+
+    // cgroup v2: there are no usage threshold events, so the usage is polled. The high, max and
+    // oom events from memory.events are handled immediately though.
+    int m_eventsFd = -1;
+    QTimer *m_pollTimer = nullptr;
+    std::unique_ptr<MemoryReader> m_usageReader;
+    QList<quint64> m_thresholdValues;
+    qsizetype m_thresholdLevel = 0;
 #endif
 };
 
+#if defined(Q_OS_LINUX)
+// Uses the kernel's pressure stall information (PSI) triggers (Linux 5.2+) to get notified, when
+// tasks have been stalled waiting for memory for at least stallTime within any window. Type
+// Some means that at least one task was stalled, while Full means that all non-idle tasks were
+// stalled at the same time.
+// Without a groupPath, the system-wide /proc/pressure/memory is used, otherwise the memory.pressure
+// file of the given cgroup (v2 only).
+class MemoryPressureTrigger : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Type { Some, Full };
+
+    explicit MemoryPressureTrigger(QObject *parent = nullptr);
+    ~MemoryPressureTrigger() override;
+
+    static QString pressureFile(const QString &groupPath);
+    static bool isSupported(const QString &groupPath = QString());
+
+    bool start(const QString &groupPath, Type type, std::chrono::microseconds stallTime,
+               std::chrono::microseconds window);
+    void stop();
+    bool isActive() const;
+
+Q_SIGNALS:
+    void triggered();
+
+private:
+    int m_fd = -1;
+    QSocketNotifier *m_notifier = nullptr;
+};
+#endif
+
 class MemoryWatcher : public QObject
 {
     Q_OBJECT
@@ -158,13 +263,37 @@ Q_SIGNALS:
     void memoryCritical();
 
 private:
+    void updateWarnings();
+
     qreal m_warning = 75.0;
     qreal m_critical = 90.0;
     quint64 m_memLimit = 0;
-    bool hasMemoryLowWarning = false;
-    bool hasMemoryCriticalWarning = false;
+    bool hasMemoryLowWarning = false;  // usage based
+    bool hasMemoryCriticalWarning = false;  // usage based
+    bool m_memoryLowSent = false;  // usage or pressure based
+    bool m_memoryCriticalSent = false;  // usage or pressure based
     std::unique_ptr<MemoryThreshold> m_threshold;
     std::unique_ptr<MemoryReader> m_reader;
+#if defined(Q_OS_LINUX)
+private Q_SLOTS:
+    void pressureWarningTriggered();
+    void pressureCriticalTriggered();
+    void clearPressure();
+
+private:
+    // Percentage of the PSI window (2 seconds), in which tasks were stalled on memory:
+    // warning for at least one task ("some"), critical for all tasks ("full").
+    static constexpr qreal PressureWarning = 10.0;
+    static constexpr qreal PressureCritical = 10.0;
+
+    // The kernel sends at most one event per window while the pressure persists, so the pressure
+    // is considered to be gone after two windows without an event.
+    bool m_pressureLow = false;
+    bool m_pressureCritical = false;
+    QTimer *m_pressureClearTimer = nullptr;
+    std::unique_ptr<MemoryPressureTrigger> m_pressureWarningTrigger;
+    std::unique_ptr<MemoryPressureTrigger> m_pressureCriticalTrigger;
+#endif
 };
 
 #if defined(Q_OS_LINUX)
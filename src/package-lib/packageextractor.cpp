@@ -12,6 +12,11 @@
 #include <QUrl>
 #include <QDebug>
 #include <QCryptographicHash>
+#include <QScopeGuard>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
 
 #include <archive.h>
 #include <archive_entry.h>
@@ -26,6 +31,11 @@
 #include "packageinfo.h"
 #include "qtyaml.h"
 
+#if defined(Q_OS_LINUX)
+#  include <fcntl.h>
+#  include <cerrno>
+#endif
+
 // archive.h might #define this for Android
 #ifdef open
 #  undef open
@@ -42,6 +52,10 @@ using namespace Qt::StringLiterals;
 
 QT_BEGIN_NAMESPACE_AM
 
+static constexpr int ReadBufferCount = 16;
+static constexpr qsizetype ReadBufferSize = 64 * 1024;
+static constexpr int WriteBufferCount = 16;
+
 PackageExtractor::PackageExtractor(const QUrl &downloadUrl, const QDir &destinationDir, QObject *parent)
     : QObject(parent)
     , d(new PackageExtractorPrivate(this, downloadUrl))
@@ -64,6 +78,16 @@ void PackageExtractor::setFileExtractedCallback(const std::function<void(const Q
     d->m_fileExtractedCallback = callback;
 }
 
+void PackageExtractor::setDownloadRateLimit(qint64 bytesPerSecond)
+{
+    d->m_downloadThrottle.setLimit(bytesPerSecond);
+}
+
+void PackageExtractor::setDiskWriteRateLimit(qint64 bytesPerSecond)
+{
+    d->m_diskWriteThrottle.setLimit(bytesPerSecond);
+}
+
 const InstallationReport &PackageExtractor::installationReport() const
 {
     return d->m_report;
@@ -74,11 +98,14 @@ bool PackageExtractor::extract()
     if (!wasCanceled()) {
         d->m_failed = false;
 
+        d->startPipeline();
         d->download(d->m_url);
 
-        QMetaObject::invokeMethod(d, "extract", Qt::QueuedConnection);
+        // the decoder thread quits the loop when it is done
         d->m_loop.exec();
 
+        d->stopPipeline();
+
         delete d->m_reply;
         d->m_reply = nullptr;
     }
@@ -111,12 +138,46 @@ QString PackageExtractor::errorString() const
 void PackageExtractor::cancel()
 {
     if (!d->m_canceled.fetchAndStoreOrdered(1)) {
+        d->wakePipeline();
         if (d->m_loop.isRunning())
             d->m_loop.wakeUp();
     }
 }
 
 
+void ThroughputThrottle::setLimit(qint64 bytesPerSecond)
+{
+    m_limit = std::max(bytesPerSecond, qint64(0));
+    m_bytes = 0;
+    m_timer.invalidate();
+}
+
+void ThroughputThrottle::consume(qint64 bytes, const QAtomicInt &canceled)
+{
+    if (!m_limit || (bytes <= 0))
+        return;
+
+    if (!m_timer.isValid())
+        m_timer.start();
+    m_bytes += bytes;
+
+    const qint64 budgetMSec = m_bytes * 1000 / m_limit;
+    qint64 elapsedMSec = m_timer.elapsed();
+
+    // do not let an idle period build up a large burst budget
+    if (elapsedMSec > (budgetMSec + 1000)) {
+        m_timer.restart();
+        m_bytes = bytes;
+        return;
+    }
+
+    while ((elapsedMSec < budgetMSec) && !canceled.loadRelaxed()) {
+        QThread::msleep(ulong(std::min(budgetMSec - elapsedMSec, qint64(50))));
+        elapsedMSec = m_timer.elapsed();
+    }
+}
+
+
 /* * * * * * * * * * * * * * * * * * *
  *  vvv PackageExtractorPrivate vvv  *
  * * * * * * * * * * * * * * * * * * */
@@ -127,64 +188,57 @@ PackageExtractorPrivate::PackageExtractorPrivate(PackageExtractor *extractor, co
     , m_url(downloadUrl)
     , m_nam(new QNetworkAccessManager(this))
     , m_report(QString())
-{
-    m_buffer.resize(64 * 1024);
-}
+{ }
 
 qint64 PackageExtractorPrivate::readTar(struct archive *ar, const void **archiveBuffer)
 {
-    forever {
-        // the event loop is gone
-        if (!m_loop.isRunning()) {
-            archive_set_error(ar, -1, "no eventlopp");
-            return -1;
-        }
-        // we have been canceled
-        if (q->wasCanceled()) {
-            archive_set_error(ar, -1, "canceled");
-            return -1;
-        }
-        qint64 bytesAvailable = m_reply->bytesAvailable();
-
-        // there is something to read
-        // (or this is a FIFO and we need this ugly hack - for testing only though!)
-        if ((bytesAvailable > 0) || m_downloadingFromFIFO) {
-            qint64 bytesRead = m_reply->read(m_buffer.data(), m_buffer.size());
-
-            if (bytesRead < 0) {
-                // another FIFO hack: if the writer dies, we will get an -1 return from read()
-                if (m_downloadingFromFIFO && m_reply->atEnd()) {
-                    return 0;
-                } else {
-                    archive_set_error(ar, -1, "could not read from tar archive");
-                    return -1;
-                }
-            }
+    // called by libarchive on the decoder thread
 
-            m_bytesReadTotal += bytesRead;
-            *archiveBuffer = m_buffer.constData();
+    QMutexLocker locker(&m_pipelineMutex);
 
-            qint64 progress = m_downloadTotal ? (100 * m_bytesReadTotal / m_downloadTotal) : 0;
-            if (progress != m_lastProgress) {
-                emit q->progress(qreal(progress) / 100);
-                m_lastProgress = progress;
-            }
+    // libarchive is done with the buffer we handed out the last time
+    if (!m_decoderReadBuffer.isNull()) {
+        m_freeReadBuffers.append(std::exchange(m_decoderReadBuffer, { }));
+        if (std::exchange(m_downloadStalled, false))
+            QMetaObject::invokeMethod(this, &PackageExtractorPrivate::fillReadBuffers, Qt::QueuedConnection);
+    }
 
-            return bytesRead;
-        }
+    while (m_filledReadBuffers.isEmpty() && !m_downloadFinished && !q->wasCanceled())
+        m_pipelineCondition.wait(&m_pipelineMutex);
 
+    // we have been canceled
+    if (q->wasCanceled()) {
+        archive_set_error(ar, -1, "canceled");
+        return -1;
+    }
+
+    if (m_filledReadBuffers.isEmpty()) {
         // got an error while reading
-        if (m_reply->error() != QNetworkReply::NoError) {
-            archive_set_error(ar, -1, "%s", m_reply->errorString().toLocal8Bit().constData());
+        if (!m_downloadError.isEmpty()) {
+            archive_set_error(ar, -1, "%s", m_downloadError.toLocal8Bit().constData());
             return -1;
         }
-
         // we're done
-        if (m_reply->isFinished())
-            return 0;
+        return 0;
+    }
 
-        m_loop.processEvents(QEventLoop::WaitForMoreEvents);
+    m_decoderReadBuffer = m_filledReadBuffers.dequeue();
+    locker.unlock();
+
+    const qint64 bytesRead = m_decoderReadBuffer.size();
+    m_bytesReadTotal += bytesRead;
+    *archiveBuffer = m_decoderReadBuffer.constData();
+
+    const qint64 downloadTotal = m_downloadTotal.loadRelaxed();
+    qint64 progress = downloadTotal ? (100 * m_bytesReadTotal / downloadTotal) : 0;
+    if (progress != m_lastProgress) {
+        postProgress(qreal(progress) / 100);
+        m_lastProgress = progress;
     }
+
+    m_downloadThrottle.consume(bytesRead, m_canceled);
+
+    return bytesRead;
 }
 
 void PackageExtractorPrivate::extract()
@@ -226,6 +280,9 @@ void PackageExtractorPrivate::extract()
             archive_entry *entry = nullptr;
             QFile f;
 
+            // the writer thread might still reference f, if we leave this scope via an exception
+            auto drainWrites = qScopeGuard([this]() { waitForWrites(); });
+
             // Try to read the next entry from the archive
 
             switch (archive_read_next_header(ar, &entry)) {
@@ -304,9 +361,21 @@ void PackageExtractorPrivate::extract()
 
                 } else { // PackageEntry_File
                     f.setFileName(m_destinationPath + entryPath);
-                    if (!f.open(QFile::WriteOnly | QFile::Truncate))
+                    // we are writing big chunks from the writer thread: no need for buffering
+                    if (!f.open(QFile::WriteOnly | QFile::Truncate | QFile::Unbuffered))
                         throw Exception(f, "could not create file");
 
+#if defined(Q_OS_LINUX)
+                    // reserve the space up-front: this avoids fragmentation and lets us fail
+                    // early, if the disk is full
+                    if (const auto entrySize = archive_entry_size(entry); entrySize > 0) {
+                        int err = ::posix_fallocate(f.handle(), 0, entrySize);
+                        if (err == ENOSPC)
+                            throw Exception(err, "could not allocate %1 bytes for file %2").arg(entrySize).arg(entryPath);
+                        // other errors (e.g. not supported by the file-system) are not fatal
+                    }
+#endif
+
                     if (entryMode & S_IEXEC)
                         f.setPermissions(f.permissions() | QFile::ExeUser);
                 }
@@ -352,10 +421,10 @@ void PackageExtractorPrivate::extract()
 
                     switch (packageEntryType) {
                     case PackageEntry_File:
+                        // the writer thread writes the data, while we continue with hashing
+                        // and decompressing the next block
+                        queueWrite(&f, buffer, qsizetype(bytesRead));
                         digest.addData({ buffer, qsizetype(bytesRead) });
-
-                        if (!f.write(buffer, qint64(bytesRead)))
-                            throw Exception(f, "could not write to file");
                         break;
                     case PackageEntry_Header:
                         header.append(buffer, qsizetype(bytesRead));
@@ -378,6 +447,8 @@ void PackageExtractorPrivate::extract()
                 break;
 
             case PackageEntry_File:
+                if (auto writeError = waitForWrites())
+                    throw *writeError;
                 f.close();
                 Q_FALLTHROUGH();
 
@@ -387,7 +458,7 @@ void PackageExtractorPrivate::extract()
 
                 // Finally call the user's code to post-process whatever was extracted right now
                 if (m_fileExtractedCallback)
-                    m_fileExtractedCallback(entryPath);
+                    callFileExtractedCallback(entryPath);
                 break;
             }
             default:
@@ -403,7 +474,7 @@ void PackageExtractorPrivate::extract()
         // signature metadata
         processMetaData(footer, digest, false /*footer*/);
 
-        emit q->progress(1);
+        postProgress(1);
 
     } catch (const Exception &e) {
         if (!q->wasCanceled())
@@ -412,8 +483,26 @@ void PackageExtractorPrivate::extract()
 
     if (ar)
         archive_read_free(ar);
+}
 
-    m_loop.quit();
+void PackageExtractorPrivate::callFileExtractedCallback(const QString &entryPath) noexcept(false)
+{
+    // Called on the decoder thread, but the callback has to run in the thread that called
+    // extract(): users like the InstallationTask emit signals and access their own state from
+    // there. That thread is running m_loop, so we can block until the callback has finished,
+    // which also means that it can safely change the destination directory or the callback.
+
+    std::optional<Exception> callbackError;
+    QMetaObject::invokeMethod(this, [this, &entryPath, &callbackError]() {
+        try {
+            m_fileExtractedCallback(entryPath);
+        } catch (const Exception &e) {
+            callbackError = e;
+        }
+    }, Qt::BlockingQueuedConnection);
+
+    if (callbackError)
+        throw *callbackError;
 }
 
 void PackageExtractorPrivate::processMetaData(const QByteArray &metadata, QCryptographicHash &digest,
@@ -478,6 +567,8 @@ void PackageExtractorPrivate::processMetaData(const QByteArray &metadata, QCrypt
 
 void PackageExtractorPrivate::setError(Error errorCode, const QString &errorString)
 {
+    QMutexLocker locker(&m_pipelineMutex);
+
     m_failed = true;
 
     // only the first error is the one that counts!
@@ -488,15 +579,217 @@ void PackageExtractorPrivate::setError(Error errorCode, const QString &errorStri
 }
 
 
+void PackageExtractorPrivate::postProgress(qreal progress)
+{
+    // always emit the progress signal from the thread that called extract(), as before
+    QMetaObject::invokeMethod(this, [this, progress]() { emit q->progress(progress); },
+                              Qt::QueuedConnection);
+}
+
+void PackageExtractorPrivate::startPipeline()
+{
+    {
+        QMutexLocker locker(&m_pipelineMutex);
+
+        m_freeReadBuffers.clear();
+        m_filledReadBuffers.clear();
+        m_decoderReadBuffer = { };
+        for (int i = 0; i < ReadBufferCount; ++i)
+            m_freeReadBuffers.append(QByteArray(ReadBufferSize, Qt::Uninitialized));
+        m_downloadFinished = false;
+        m_downloadStalled = false;
+        m_downloadError.clear();
+
+        m_freeWriteBuffers.clear();
+        m_writeQueue.clear();
+        for (int i = 0; i < WriteBufferCount; ++i)
+            m_freeWriteBuffers.append(QByteArray());
+        m_pendingWrites = 0;
+        m_stopWriter = false;
+        m_writeError.reset();
+    }
+
+    m_writerThread.reset(QThread::create([this]() { writeLoop(); }));
+    m_writerThread->setObjectName(u"QtAM-PackageExtractor-Writer"_s);
+    m_writerThread->start();
+
+    m_decoderThread.reset(QThread::create([this]() {
+        extract();
+        QMetaObject::invokeMethod(&m_loop, "quit", Qt::QueuedConnection);
+    }));
+    m_decoderThread->setObjectName(u"QtAM-PackageExtractor-Decoder"_s);
+    m_decoderThread->start();
+}
+
+void PackageExtractorPrivate::stopPipeline()
+{
+    {
+        // make sure the decoder is not waiting for a download that will never continue
+        QMutexLocker locker(&m_pipelineMutex);
+        if (!m_downloadFinished) {
+            m_downloadFinished = true;
+            if (m_downloadError.isEmpty())
+                m_downloadError = u"download was aborted"_s;
+        }
+        m_pipelineCondition.wakeAll();
+    }
+    if (m_decoderThread) {
+        m_decoderThread->wait();
+        m_decoderThread.reset();
+    }
+
+    {
+        QMutexLocker locker(&m_pipelineMutex);
+        m_stopWriter = true;
+        m_pipelineCondition.wakeAll();
+    }
+    if (m_writerThread) {
+        m_writerThread->wait();
+        m_writerThread.reset();
+    }
+}
+
+void PackageExtractorPrivate::wakePipeline()
+{
+    QMutexLocker locker(&m_pipelineMutex);
+    m_pipelineCondition.wakeAll();
+}
+
+void PackageExtractorPrivate::fillReadBuffers()
+{
+    // download stage: move everything the QNetworkReply has to offer into the read buffers
+
+    if (!m_reply)
+        return;
+
+    QMutexLocker locker(&m_pipelineMutex);
+    bool wakeDecoder = false;
+
+    while (!m_downloadFinished && !q->wasCanceled()) {
+        if (m_freeReadBuffers.isEmpty()) {
+            // readTar() will call us again, as soon as a buffer is available
+            m_downloadStalled = true;
+            break;
+        }
+
+        // This is an ugly hack, but it allows us to use FIFOs in the unit tests: bytesAvailable()
+        // on a QFile wrapping a FIFO will always return 0, so we have to do a blocking read.
+        if (!m_downloadingFromFIFO && (m_reply->bytesAvailable() <= 0)) {
+            if (m_reply->isFinished()) {
+                m_downloadFinished = true;
+                wakeDecoder = true;
+            }
+            break;
+        }
+
+        QByteArray buffer = m_freeReadBuffers.takeLast();
+        locker.unlock();
+        buffer.resize(ReadBufferSize);
+        const qint64 bytesRead = m_reply->read(buffer.data(), buffer.size());
+        locker.relock();
+
+        if (bytesRead <= 0) {
+            m_freeReadBuffers.append(std::move(buffer));
+
+            if (!m_downloadingFromFIFO)
+                break;
+            // another FIFO hack: if the writer dies, we will get an -1 return from read()
+            if ((bytesRead < 0) && !m_reply->atEnd())
+                m_downloadError = u"could not read from tar archive"_s;
+            m_downloadFinished = true;
+            wakeDecoder = true;
+            break;
+        }
+
+        buffer.resize(bytesRead);
+        m_filledReadBuffers.enqueue(std::move(buffer));
+        wakeDecoder = true;
+    }
+
+    if (wakeDecoder)
+        m_pipelineCondition.wakeAll();
+}
+
+void PackageExtractorPrivate::queueWrite(QFile *file, const char *data, qsizetype size) noexcept(false)
+{
+    // called on the decoder thread: the data is only valid until the next libarchive call
+
+    QMutexLocker locker(&m_pipelineMutex);
+    while (m_freeWriteBuffers.isEmpty() && !m_writeError && !q->wasCanceled())
+        m_pipelineCondition.wait(&m_pipelineMutex);
+
+    if (q->wasCanceled())
+        throw Exception(Error::Canceled, "canceled");
+    if (m_writeError)
+        throw *m_writeError;
+
+    QByteArray buffer = m_freeWriteBuffers.takeLast();
+    locker.unlock();
+    buffer.resize(size);
+    std::memcpy(buffer.data(), data, size_t(size));
+    locker.relock();
+
+    m_writeQueue.enqueue({ file, std::move(buffer) });
+    ++m_pendingWrites;
+    m_pipelineCondition.wakeAll();
+}
+
+std::optional<Exception> PackageExtractorPrivate::waitForWrites()
+{
+    QMutexLocker locker(&m_pipelineMutex);
+    while (m_pendingWrites)
+        m_pipelineCondition.wait(&m_pipelineMutex);
+    return m_writeError;
+}
+
+void PackageExtractorPrivate::writeLoop()
+{
+    // writer stage: this thread only ever blocks on the disk
+
+    QMutexLocker locker(&m_pipelineMutex);
+
+    forever {
+        while (m_writeQueue.isEmpty() && !m_stopWriter)
+            m_pipelineCondition.wait(&m_pipelineMutex);
+        if (m_writeQueue.isEmpty())
+            break;
+
+        auto [file, buffer] = m_writeQueue.dequeue();
+        // after an error or a cancellation, we still need to drain the queue
+        const bool skip = m_writeError || q->wasCanceled();
+        locker.unlock();
+
+        std::optional<Exception> error;
+        if (!skip) {
+            if (file->write(buffer.constData(), buffer.size()) != buffer.size())
+                error = Exception(*file, "could not write to file");
+            else
+                m_diskWriteThrottle.consume(buffer.size(), m_canceled);
+        }
+
+        locker.relock();
+        if (error && !m_writeError)
+            m_writeError = error;
+        m_freeWriteBuffers.append(std::move(buffer));
+        --m_pendingWrites;
+        m_pipelineCondition.wakeAll();
+    }
+}
+
 void PackageExtractorPrivate::download(const QUrl &url)
 {
     QNetworkRequest request(url);
     m_reply = m_nam->get(request);
 
+    // apply back-pressure to the sender instead of buffering everything while we are throttled
+    if (m_downloadThrottle.limit())
+        m_reply->setReadBufferSize(std::max(m_downloadThrottle.limit(), qint64(ReadBufferSize)));
+
 #if defined(Q_OS_UNIX)
     // This is an ugly hack, but it allows us to use FIFOs in the unit tests.
     // (the problem being, that bytesAvailable() on a QFile wrapping a FIFO will always return 0)
 
+    m_downloadingFromFIFO = false;
     if (url.isLocalFile()) {
         struct stat statBuffer;
         if (stat(url.toLocalFile().toLocal8Bit(), &statBuffer) == 0) {
@@ -507,18 +800,35 @@ void PackageExtractorPrivate::download(const QUrl &url)
     }
 #endif
 
+    connectReply();
+
+    // FIFOs will never signal readyRead()
+    QMetaObject::invokeMethod(this, &PackageExtractorPrivate::fillReadBuffers, Qt::QueuedConnection);
+}
+
+void PackageExtractorPrivate::connectReply()
+{
     connect(m_reply, &QNetworkReply::errorOccurred,
             this, &PackageExtractorPrivate::networkError);
     connect(m_reply, &QNetworkReply::metaDataChanged,
             this, &PackageExtractorPrivate::handleRedirect);
     connect(m_reply, &QNetworkReply::downloadProgress,
             this, &PackageExtractorPrivate::downloadProgressChanged);
+    connect(m_reply, &QNetworkReply::readyRead,
+            this, &PackageExtractorPrivate::fillReadBuffers);
+    connect(m_reply, &QNetworkReply::finished,
+            this, &PackageExtractorPrivate::fillReadBuffers);
 }
 
 void PackageExtractorPrivate::networkError(QNetworkReply::NetworkError)
 {
-    setError(Error::Network, qobject_cast<QNetworkReply *>(sender())->errorString());
-    QMetaObject::invokeMethod(&m_loop, "quit", Qt::QueuedConnection);
+    const QString errorString = qobject_cast<QNetworkReply *>(sender())->errorString();
+    setError(Error::Network, errorString);
+
+    QMutexLocker locker(&m_pipelineMutex);
+    m_downloadError = errorString;
+    m_downloadFinished = true;
+    m_pipelineCondition.wakeAll();
 }
 
 void PackageExtractorPrivate::handleRedirect()
@@ -530,13 +840,16 @@ void PackageExtractorPrivate::handleRedirect()
         m_reply->deleteLater();
         QNetworkRequest request(url);
         m_reply = m_nam->get(request);
+        if (m_downloadThrottle.limit())
+            m_reply->setReadBufferSize(std::max(m_downloadThrottle.limit(), qint64(ReadBufferSize)));
+        connectReply();
     }
 }
 
 void PackageExtractorPrivate::downloadProgressChanged(qint64 downloaded, qint64 total)
 {
     Q_UNUSED(downloaded)
-    m_downloadTotal = total;
+    m_downloadTotal.storeRelaxed(total);
 }
 
 QT_END_NAMESPACE_AM
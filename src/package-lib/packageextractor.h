@@ -31,8 +31,13 @@ public:
     QDir destinationDirectory() const;
     void setDestinationDirectory(const QDir &destinationDir);
 
+    // the callback is called in the thread running extract(), while the extraction is paused
     void setFileExtractedCallback(const std::function<void(const QString &)> &callback);
 
+    // 0 means unlimited
+    void setDownloadRateLimit(qint64 bytesPerSecond);
+    void setDiskWriteRateLimit(qint64 bytesPerSecond);
+
     bool extract();
 
     const InstallationReport &installationReport() const;
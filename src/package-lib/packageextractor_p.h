@@ -9,17 +9,42 @@
 #include <QObject>
 #include <QNetworkReply>
 #include <QEventLoop>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+#include <QThread>
+
+#include <memory>
+#include <optional>
 
 #include <archive.h>
 
 #include <QtAppManPackage/packageextractor.h>
 #include <QtAppManApplication/installationreport.h>
+#include <QtAppManCommon/exception.h>
 
 QT_FORWARD_DECLARE_CLASS(QCryptographicHash)
+QT_FORWARD_DECLARE_CLASS(QFile)
 
 QT_BEGIN_NAMESPACE_AM
 
 
+// Blocks the calling thread just long enough to keep the average throughput below the limit
+class ThroughputThrottle
+{
+public:
+    void setLimit(qint64 bytesPerSecond);
+    qint64 limit() const { return m_limit; }
+    void consume(qint64 bytes, const QAtomicInt &canceled);
+
+private:
+    qint64 m_limit = 0;
+    qint64 m_bytes = 0;
+    QElapsedTimer m_timer;
+};
+
+
 class PackageExtractorPrivate : public QObject
 {
     Q_OBJECT
@@ -27,19 +52,30 @@ class PackageExtractorPrivate : public QObject
 public:
     PackageExtractorPrivate(PackageExtractor *extractor, const QUrl &downloadUrl);
 
-    Q_INVOKABLE void extract();
+    void extract();
 
     void download(const QUrl &url);
 
+    void startPipeline();
+    void stopPipeline();
+    void wakePipeline();
+
 private Q_SLOTS:
     void networkError(QNetworkReply::NetworkError);
     void handleRedirect();
     void downloadProgressChanged(qint64 downloaded, qint64 total);
+    void fillReadBuffers();
 
 private:
+    void connectReply();
     void setError(Error errorCode, const QString &errorString);
+    void postProgress(qreal progress);
     qint64 readTar(struct archive *ar, const void **archiveBuffer);
     void processMetaData(const QByteArray &metadata, QCryptographicHash &digest, bool isHeader) noexcept(false);
+    void callFileExtractedCallback(const QString &entryPath) noexcept(false);
+    void queueWrite(QFile *file, const char *data, qsizetype size) noexcept(false);
+    std::optional<Exception> waitForWrites();
+    void writeLoop();
 
 private:
     PackageExtractor *q;
@@ -56,13 +92,37 @@ private:
     QNetworkAccessManager *m_nam;
     QNetworkReply *m_reply = nullptr;
     bool m_downloadingFromFIFO = false;
-    QByteArray m_buffer;
     InstallationReport m_report;
 
-    qint64 m_downloadTotal = 0;
+    QAtomicInteger<qint64> m_downloadTotal = 0;
     qint64 m_bytesReadTotal = 0;
     qint64 m_lastProgress = 0;
 
+    // The extraction runs as a pipeline of 3 stages, connected via pools of pre-allocated buffers:
+    //  * downloading: in the thread calling extract(), as the QNetworkReply lives there
+    //  * decompressing, unpacking and hashing: m_decoderThread
+    //  * writing the extracted files: m_writerThread
+    // All the members below are protected by m_pipelineMutex.
+    QMutex m_pipelineMutex;
+    QWaitCondition m_pipelineCondition;
+    QList<QByteArray> m_freeReadBuffers;
+    QQueue<QByteArray> m_filledReadBuffers;
+    QByteArray m_decoderReadBuffer; // owned by libarchive until the next readTar() call
+    bool m_downloadFinished = false;
+    bool m_downloadStalled = false;
+    QString m_downloadError;
+    QList<QByteArray> m_freeWriteBuffers;
+    QQueue<std::pair<QFile *, QByteArray>> m_writeQueue;
+    qsizetype m_pendingWrites = 0;
+    bool m_stopWriter = false;
+    std::optional<Exception> m_writeError;
+
+    std::unique_ptr<QThread> m_decoderThread;
+    std::unique_ptr<QThread> m_writerThread;
+
+    ThroughputThrottle m_downloadThrottle;
+    ThroughputThrottle m_diskWriteThrottle;
+
     friend class PackageExtractor;
 };
 
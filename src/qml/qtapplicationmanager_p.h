@@ -15,6 +15,7 @@
 #include <QtAppManSharedMain/memorystatus.h>
 #include <QtAppManSharedMain/monitormodel.h>
 #include <QtAppManSharedMain/startuptimer.h>
+#include <QtAppManSharedMain/watchdog.h>
 
 
 QT_BEGIN_NAMESPACE
@@ -49,6 +50,22 @@ public:
     }
 };
 
+class ForeignWatchdog
+{
+    Q_GADGET
+    QML_FOREIGN(QtAM::Watchdog)
+    QML_NAMED_ELEMENT(Watchdog)
+    QML_ADDED_IN_VERSION(2, 0)
+    QML_SINGLETON
+public:
+    static QtAM::Watchdog *create(QQmlEngine *, QJSEngine *)
+    {
+        auto *wd = QtAM::Watchdog::create();
+        QQmlEngine::setObjectOwnership(wd, QQmlEngine::CppOwnership);
+        return wd;
+    }
+};
+
 class ForeignIntentRequest
 {
     Q_GADGET
@@ -146,6 +146,10 @@ QT_BEGIN_NAMESPACE_AM
     been crossed. Your application is expected to free up as many resources as
     possible in this case: this will most likely involve clearing internal caches.
 
+    On Linux, this signal is also sent when the kernel's pressure stall information (PSI)
+    reports that tasks are regularly waiting for memory to become available, which usually
+    happens well before the threshold is reached.
+
     \sa memoryCriticalWarning()
 */
 
@@ -9,6 +9,7 @@
 
 #include <QQuickWindow>
 #include <qqmlinfo.h>
+#include <cmath>
 
 using namespace Qt::StringLiterals;
 
@@ -63,6 +64,15 @@ using namespace Qt::StringLiterals;
 
     Please note that when using FrameTimer as a MonitorModel data source there's no need to set it
     to \l{FrameTimer::running}{running} as MonitorModel will already call update() as needed.
+
+    Average frame rates tend to hide short stutters. In addition to the FPS values, FrameTimer
+    therefore records every frame time in a histogram and provides the 50th, 95th, 99th and 99.9th
+    percentile of the frame times, as well as the number of missed vsyncs and long frames per
+    update() interval. A cumulative histogram can be retrieved via frameTimeHistogram().
+
+    \note Qt Quick only renders frames when the scene changes, so the time between two frames also
+           includes idle periods of the window. These metrics are therefore most meaningful while
+           the window is continuously animating.
 */
 
 QT_BEGIN_NAMESPACE_AM
@@ -139,6 +149,68 @@ qreal FrameTimer::jitterFps() const
     return m_jitterFps;
 }
 
+/*!
+    \qmlproperty real FrameTimer::p50FrameTime
+    \qmlproperty real FrameTimer::p95FrameTime
+    \qmlproperty real FrameTimer::p99FrameTime
+    \qmlproperty real FrameTimer::p999FrameTime
+    \readonly
+
+    The 50th (median), 95th, 99th and 99.9th percentile of the frame times of the given \l window,
+    in milliseconds, since update() was last called. The values have a relative error of less than
+    3%.
+
+    \sa window update() frameTimeHistogram()
+*/
+qreal FrameTimer::p50FrameTime() const
+{
+    return m_p50FrameTime;
+}
+
+qreal FrameTimer::p95FrameTime() const
+{
+    return m_p95FrameTime;
+}
+
+qreal FrameTimer::p99FrameTime() const
+{
+    return m_p99FrameTime;
+}
+
+qreal FrameTimer::p999FrameTime() const
+{
+    return m_p999FrameTime;
+}
+
+/*!
+    \qmlproperty int FrameTimer::missedVsyncs
+    \readonly
+
+    The number of vsync intervals (assuming a 60Hz display) in which the given \l window did not
+    present a new frame, although it was rendering, since update() was last called. A frame that
+    took 50ms accounts for two missed vsyncs.
+
+    \sa longFrames update()
+*/
+int FrameTimer::missedVsyncs() const
+{
+    return m_missedVsyncs;
+}
+
+/*!
+    \qmlproperty int FrameTimer::longFrames
+    \readonly
+
+    The number of frames of the given \l window that took longer than three vsync intervals
+    (assuming a 60Hz display), since update() was last called.
+
+    \sa missedVsyncs update()
+*/
+int FrameTimer::longFrames() const
+{
+    return m_longFrames;
+}
+
 /*!
     \qmlproperty Object FrameTimer::window
 
@@ -166,6 +238,7 @@ void FrameTimer::setWindow(QObject *window)
     }
 
     m_window = window;
+    resetFrameTimeHistogram();
 
     if (m_window) {
         bool connected = false;
@@ -205,15 +278,17 @@ void FrameTimer::setWindow(QObject *window)
 */
 QStringList FrameTimer::roleNames() const
 {
-    return { u"averageFps"_s, u"minimumFps"_s, u"maximumFps"_s, u"jitterFps"_s };
+    return { u"averageFps"_s, u"minimumFps"_s, u"maximumFps"_s, u"jitterFps"_s,
+             u"p50FrameTime"_s, u"p95FrameTime"_s, u"p99FrameTime"_s, u"p999FrameTime"_s,
+             u"missedVsyncs"_s, u"longFrames"_s };
 }
 
 /*!
     \qmlmethod FrameTimer::update
 
-    Updates the properties averageFps, minimumFps, maximumFps and jitterFps. Then resets internal
-    counters so that new numbers can be taken for the new time period starting from the moment
-    this method is called.
+    Updates the properties averageFps, minimumFps, maximumFps, jitterFps, the frame time
+    percentiles, missedVsyncs and longFrames. Then resets internal counters so that new numbers
+    can be taken for the new time period starting from the moment this method is called.
 
     Note that you normally don't have to call this method directly, as FrameTimer does it automatically
     every \l interval milliseconds while \l{FrameTimer::running}{running} is set to true.
@@ -227,11 +302,20 @@ void FrameTimer::update()
     m_maximumFps = m_min ? MicrosInSec / m_min : qreal(0);
     m_jitterFps = m_count ? m_jitter / m_count :  qreal(0);
 
+    m_p50FrameTime = m_histogram.valueAtPercentile(50) / qreal(1000);
+    m_p95FrameTime = m_histogram.valueAtPercentile(95) / qreal(1000);
+    m_p99FrameTime = m_histogram.valueAtPercentile(99) / qreal(1000);
+    m_p999FrameTime = m_histogram.valueAtPercentile(99.9) / qreal(1000);
+    m_missedVsyncs = m_missedVsyncCount;
+    m_longFrames = m_longFrameCount;
+
     // Start counting again for the next sampling period but keep m_timer running because
     // we still need the diff between the last rendered frame and the upcoming one.
     m_count = m_sum = m_max = 0;
     m_jitter = 0;
     m_min = std::numeric_limits<int>::max();
+    m_histogram.reset();
+    m_missedVsyncCount = m_longFrameCount = 0;
 
     emit updated();
 }
@@ -292,6 +376,149 @@ void FrameTimer::reportFrameSwap()
     m_min = qMin(m_min, frameTime);
     m_max = qMax(m_max, frameTime);
     m_jitter += qAbs(MicrosInSec / IdealFrameTime - MicrosInSec / frameTime);
+
+    recordFrameTime(frameTime);
+}
+
+void FrameTimer::recordFrameTime(int frameTime)
+{
+    m_histogram.record(frameTime);
+    m_totalHistogram.record(frameTime);
+
+    // anything up to half a vsync interval late is still considered to be on time
+    if (int missed = (frameTime + IdealFrameTime / 2) / IdealFrameTime - 1; missed > 0) {
+        m_missedVsyncCount += missed;
+        m_totalMissedVsyncCount += quint64(missed);
+    }
+    if (frameTime > LongFrameTime) {
+        ++m_longFrameCount;
+        ++m_totalLongFrameCount;
+    }
+}
+
+/*!
+    \qmlmethod var FrameTimer::frameTimeHistogram()
+
+    Returns the cumulative frame time statistics of the given \l window since it was set, or since
+    resetFrameTimeHistogram() was last called. Contrary to the properties, this data is not reset
+    by update(). The returned object has the following fields:
+
+    \table
+    \header
+        \li Name
+        \li Description
+    \row
+        \li \c frameCount
+        \li The number of recorded frames.
+    \row
+        \li \c missedVsyncs, \c longFrames
+        \li See the properties with the same names.
+    \row
+        \li \c p50, \c p95, \c p99, \c p999
+        \li The respective percentiles of the frame times, in milliseconds.
+    \row
+        \li \c buckets
+        \li A list of all non-empty histogram buckets, each with a \c from and \c to frame time
+             in milliseconds (both inclusive) and a \c count.
+    \endtable
+
+    \sa resetFrameTimeHistogram()
+*/
+QVariantMap FrameTimer::frameTimeHistogram() const
+{
+    return {
+        { u"frameCount"_s, m_totalHistogram.count() },
+        { u"missedVsyncs"_s, m_totalMissedVsyncCount },
+        { u"longFrames"_s, m_totalLongFrameCount },
+        { u"p50"_s, m_totalHistogram.valueAtPercentile(50) / qreal(1000) },
+        { u"p95"_s, m_totalHistogram.valueAtPercentile(95) / qreal(1000) },
+        { u"p99"_s, m_totalHistogram.valueAtPercentile(99) / qreal(1000) },
+        { u"p999"_s, m_totalHistogram.valueAtPercentile(99.9) / qreal(1000) },
+        { u"buckets"_s, m_totalHistogram.toList() },
+    };
+}
+
+/*!
+    \qmlmethod FrameTimer::resetFrameTimeHistogram()
+
+    Clears the cumulative frame time statistics returned by frameTimeHistogram().
+*/
+void FrameTimer::resetFrameTimeHistogram()
+{
+    m_totalHistogram.reset();
+    m_totalMissedVsyncCount = m_totalLongFrameCount = 0;
+}
+
+int FrameTimer::Histogram::bucketIndex(int usec)
+{
+    if (usec < SubBucketCount)
+        return qMax(0, usec);
+
+    const int msb = 31 - qCountLeadingZeroBits(quint32(usec));
+    const int shift = msb - SubBucketBits + 1;
+    if (shift > MaximumShift)
+        return BucketCount - 1;
+    // (usec >> shift) is in [SubBucketHalfCount, SubBucketCount)
+    return shift * SubBucketHalfCount + (usec >> shift);
+}
+
+int FrameTimer::Histogram::bucketLowestValue(int index)
+{
+    if (index < SubBucketCount)
+        return index;
+    const int shift = index / SubBucketHalfCount - 1;
+    return (index - shift * SubBucketHalfCount) << shift;
+}
+
+int FrameTimer::Histogram::bucketHighestValue(int index)
+{
+    if (index < SubBucketCount)
+        return index;
+    const int shift = index / SubBucketHalfCount - 1;
+    return bucketLowestValue(index) + (1 << shift) - 1;
+}
+
+void FrameTimer::Histogram::record(int usec)
+{
+    ++m_buckets[size_t(bucketIndex(usec))];
+    ++m_count;
+}
+
+void FrameTimer::Histogram::reset()
+{
+    if (m_count)
+        m_buckets.fill(0);
+    m_count = 0;
+}
+
+int FrameTimer::Histogram::valueAtPercentile(qreal percentile) const
+{
+    if (!m_count)
+        return 0;
+
+    const auto target = qMax(quint64(1), quint64(std::ceil(percentile / 100 * qreal(m_count))));
+    quint64 sum = 0;
+    for (int i = 0; i < BucketCount; ++i) {
+        sum += m_buckets[size_t(i)];
+        if (sum >= target)
+            return bucketHighestValue(i);
+    }
+    return bucketHighestValue(BucketCount - 1);
+}
+
+QVariantList FrameTimer::Histogram::toList() const
+{
+    QVariantList list;
+    for (int i = 0; i < BucketCount; ++i) {
+        if (const auto count = m_buckets[size_t(i)]) {
+            list << QVariantMap {
+                { u"from"_s, bucketLowestValue(i) / qreal(1000) },
+                { u"to"_s, bucketHighestValue(i) / qreal(1000) },
+                { u"count"_s, count },
+            };
+        }
+    }
+    return list;
 }
 
 FrameTimerImpl *FrameTimer::implementation()
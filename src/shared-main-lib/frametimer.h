@@ -11,7 +11,9 @@
 #include <QtCore/QMetaObject>
 #include <QtCore/QPointer>
 #include <QtCore/QTimer>
+#include <QtCore/QVariantMap>
 #include <QtAppManCommon/global.h>
+#include <array>
 #include <limits>
 
 
@@ -26,6 +28,12 @@ class FrameTimer : public QObject
     Q_PROPERTY(qreal minimumFps READ minimumFps NOTIFY updated FINAL)
     Q_PROPERTY(qreal maximumFps READ maximumFps NOTIFY updated FINAL)
     Q_PROPERTY(qreal jitterFps READ jitterFps NOTIFY updated FINAL)
+    Q_PROPERTY(qreal p50FrameTime READ p50FrameTime NOTIFY updated FINAL)
+    Q_PROPERTY(qreal p95FrameTime READ p95FrameTime NOTIFY updated FINAL)
+    Q_PROPERTY(qreal p99FrameTime READ p99FrameTime NOTIFY updated FINAL)
+    Q_PROPERTY(qreal p999FrameTime READ p999FrameTime NOTIFY updated FINAL)
+    Q_PROPERTY(int missedVsyncs READ missedVsyncs NOTIFY updated FINAL)
+    Q_PROPERTY(int longFrames READ longFrames NOTIFY updated FINAL)
 
     Q_PROPERTY(QObject* window READ window WRITE setWindow NOTIFY windowChanged FINAL)
 
@@ -47,6 +55,15 @@ public:
     qreal minimumFps() const;
     qreal maximumFps() const;
     qreal jitterFps() const;
+    qreal p50FrameTime() const;
+    qreal p95FrameTime() const;
+    qreal p99FrameTime() const;
+    qreal p999FrameTime() const;
+    int missedVsyncs() const;
+    int longFrames() const;
+
+    Q_INVOKABLE QVariantMap frameTimeHistogram() const;
+    Q_INVOKABLE void resetFrameTimeHistogram();
 
     QObject *window() const;
     void setWindow(QObject *window);
@@ -68,6 +85,35 @@ protected:
     std::unique_ptr<FrameTimerImpl> m_impl;
 
 private:
+    // A log-linear (HDR style) histogram of frame times in usec: values below SubBucketCount are
+    // recorded exactly, above that every power of two is split into SubBucketCount / 2 buckets,
+    // which keeps the relative error below 1 / SubBucketHalfCount (~3%). Recording is O(1).
+    class Histogram
+    {
+    public:
+        static constexpr int SubBucketBits = 6;
+        static constexpr int SubBucketCount = 1 << SubBucketBits;
+        static constexpr int SubBucketHalfCount = SubBucketCount / 2;
+        static constexpr int MaximumShift = 21; // up to 2^27 usec, ~134 sec
+        static constexpr int BucketCount = (MaximumShift + 1) * SubBucketHalfCount + SubBucketHalfCount;
+
+        void record(int usec);
+        void reset();
+        quint64 count() const { return m_count; }
+        int valueAtPercentile(qreal percentile) const;
+        QVariantList toList() const;
+
+        static int bucketIndex(int usec);
+        static int bucketLowestValue(int index);
+        static int bucketHighestValue(int index);
+
+    private:
+        std::array<quint32, BucketCount> m_buckets = { };
+        quint64 m_count = 0;
+    };
+
+    void recordFrameTime(int frameTime);
+
     QPointer<QObject> m_window;
 
     int m_count = 0;
@@ -85,9 +131,27 @@ private:
     qreal m_maximumFps = 0.0;
     qreal m_jitterFps = 0.0;
 
+    // per update() interval
+    Histogram m_histogram;
+    int m_missedVsyncCount = 0;
+    int m_longFrameCount = 0;
+
+    qreal m_p50FrameTime = 0.0;
+    qreal m_p95FrameTime = 0.0;
+    qreal m_p99FrameTime = 0.0;
+    qreal m_p999FrameTime = 0.0;
+    int m_missedVsyncs = 0;
+    int m_longFrames = 0;
+
+    // cumulative since the window was set, or resetFrameTimeHistogram() was called
+    Histogram m_totalHistogram;
+    quint64 m_totalMissedVsyncCount = 0;
+    quint64 m_totalLongFrameCount = 0;
+
     QMetaObject::Connection m_frameSwapConnection;
 
     static const int IdealFrameTime = 16667; // usec - could be made configurable via an env variable
+    static const int LongFrameTime = 3 * IdealFrameTime; // usec - clearly visible to users
     static const qreal MicrosInSec;
 };
 
@@ -71,11 +71,20 @@ GpuStatus::~GpuStatus()
     GPU utilization when update() was last called, as a value ranging from 0 (inclusive,
     completely idle) to 1 (inclusive, fully busy).
 
-    \note This is dependent on tools from the graphics hardware vendor and might not work on
-          every system.
-
-    Currently, this only works on \e Linux with either \e Intel or \e NVIDIA chipsets, plus the
-    tools from the respective vendors have to be installed:
+    \note This is only supported on \e Linux and might not work on every system.
+
+    If the kernel driver of the GPU supports it, the load is read directly from the kernel:
+    either from the \c gpu_busy_percent counter in sysfs (e.g. \c amdgpu), or by summing up the
+    per-client engine busy times that are reported via the
+    \l{https://docs.kernel.org/gpu/drm-usage-stats.html}{DRM fdinfo} interface (e.g. \c i915,
+    \c msm, \c panfrost or \c v3d). In the latter case, the load of the busiest GPU engine is
+    reported. Summing up the clients is only done if the driver actually reports engine busy
+    times and if the file descriptors of all processes are accessible, i.e. if the application
+    manager runs as \c root or has the \c CAP_SYS_PTRACE capability. See ProcessStatus::gpuLoad
+    for the per-application counterpart.
+
+    Otherwise, the tools from the respective vendors have to be installed for \e Intel or
+    \e NVIDIA chipsets:
 
     \table
     \header
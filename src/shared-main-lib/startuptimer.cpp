@@ -339,6 +339,7 @@ StartupTimer::~StartupTimer()
 void StartupTimer::checkpoint(const char *name)
 {
     if (Q_LIKELY(m_initialized)) {
+        QMutexLocker locker(&m_mutex);
         qint64 delta = m_timer.nsecsElapsed();
         m_checkpoints << qMakePair(quint64(delta / 1000) + m_processCreation, name);
     }
@@ -356,8 +357,11 @@ void StartupTimer::checkFirstFrame()
 {
     if (Q_LIKELY(m_initialized)) {
         QByteArray ba = "after first frame drawn";
-        m_timeToFirstFrame = quint64(m_timer.nsecsElapsed() / 1000) + m_processCreation;
-        m_checkpoints << qMakePair(m_timeToFirstFrame, ba);
+        {
+            QMutexLocker locker(&m_mutex);
+            m_timeToFirstFrame = quint64(m_timer.nsecsElapsed() / 1000) + m_processCreation;
+            m_checkpoints << qMakePair(m_timeToFirstFrame, ba);
+        }
         emit timeToFirstFrameChanged(m_timeToFirstFrame);
     }
 }
@@ -365,6 +369,7 @@ void StartupTimer::checkFirstFrame()
 void StartupTimer::reset()
 {
     if (m_initialized) {
+        QMutexLocker locker(&m_mutex);
         m_timer.restart();
         m_checkpoints.clear();
         m_processCreation = 0;
@@ -392,6 +397,7 @@ void StartupTimer::setAutomaticReporting(bool enableAutomaticReporting)
 
 void StartupTimer::createReport(const QString &title)
 {
+    QMutexLocker locker(&m_mutex);
     if (m_output && !m_checkpoints.isEmpty()) {
         bool ansiColorSupport = (m_output == stderr) ? Console::stderrSupportsAnsiColor() : false;
         ColorPrint cprt(m_output, ansiColorSupport);
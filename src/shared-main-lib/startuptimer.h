@@ -12,6 +12,7 @@
 #include <QtCore/QPair>
 #include <QtCore/QByteArray>
 #include <QtCore/QElapsedTimer>
+#include <QtCore/QMutex>
 #include <QtAppManCommon/global.h>
 
 QT_BEGIN_NAMESPACE_AM
@@ -59,6 +60,7 @@ private:
     quint64 m_timeToFirstFrame = 0;
     quint64 m_systemUpTime = 0;
     QElapsedTimer m_timer;
+    QMutex m_mutex; // checkpoints can be added from startup worker threads
     QVector<std::pair<quint64, QByteArray>> m_checkpoints;
 
     Q_DISABLE_COPY_MOVE(StartupTimer)
@@ -1,7 +1,11 @@
 // Copyright (C) 2024 The Qt Company Ltd.
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only
 
+#include <algorithm>
+#include <optional>
 #include <QCoreApplication>
+#include <QDateTime>
+#include <QMetaEnum>
 #include <QThread>
 #include <private/qquickwindow_p.h>
 #include <private/qsgrenderloop_p.h>
@@ -47,6 +51,67 @@ stop the watchdog thread, if the 'clean shutdown' flag is not set. This is not i
 watchdog thread is still active while the QCoreApplication instance is being destroyed and this will
 result in TSAN warnings.
 
+The event loop watching also doubles as a low-overhead profiler: the duration of every event is
+recorded in a per-thread histogram, keyed by event type and receiver class. The slowest events are
+additionally kept with the receiver's objectName. This data is only ever written by the watched
+thread (see EventProfile) and can be read via Watchdog::eventLoopProfile() from any thread. It is
+also used to attribute stalls to a specific receiver when logging warnings.
+
+*/
+
+/*!
+    \qmltype Watchdog
+    \inqmlmodule QtApplicationManager
+    \ingroup common-singletons
+    \brief Provides access to the event loop profile collected by the watchdog.
+
+    While the event loop watching of the \l{Watchdog}{watchdog} is enabled, the time spent
+    delivering each event is recorded per thread. This singleton gives you access to this data, so
+    you can find out which receivers are responsible for stalls, even if those stalls stay below
+    the warn threshold.
+
+    See \l{Watchdog#Profiling}{Profiling} for more information.
+*/
+
+/*!
+    \qmlmethod var Watchdog::eventLoopProfile()
+
+    Returns a snapshot of the event loop profile of all watched threads. The returned object
+    contains a \c bucketLimits list with the upper limits of the histogram buckets in milliseconds
+    and a \c threads list. Each entry in that list has these fields:
+
+    \table
+    \header
+        \li Name
+        \li Description
+    \row
+        \li \c thread, \c threadName, \c mainThread
+        \li The identity of the watched thread.
+    \row
+        \li \c stuckCount
+        \li How often the thread's event loop exceeded the warn threshold since the last report.
+    \row
+        \li \c eventCount
+        \li The number of events that have been recorded.
+    \row
+        \li \c histogram
+        \li A list of entries with the fields \c eventType, \c receiverClass, \c count,
+             \c totalTime, \c maximumTime (both in milliseconds) and \c buckets, sorted by
+             \c totalTime, longest first.
+    \row
+        \li \c slowest
+        \li The slowest single events with the fields \c eventType, \c receiverClass,
+             \c receiverName, \c receiver, \c duration (in milliseconds) and \c timestamp.
+    \endtable
+
+    An empty object is returned, if the watchdog is not running.
+*/
+
+/*!
+    \qmlmethod Watchdog::resetEventLoopProfile()
+
+    Clears the event loop profile of all watched threads. The reset is done asynchronously: events
+    that are currently being delivered might still be counted.
 */
 
 QT_BEGIN_NAMESPACE_AM
@@ -68,6 +133,30 @@ QDebug &operator<<(QDebug &dbg, WatchdogPrivate::RenderState rs)
     return dbg;
 }
 
+static QByteArray eventTypeName(int eventType)
+{
+    static const QMetaEnum me = QMetaEnum::fromType<QEvent::Type>();
+    if (const char *name = me.valueToKey(eventType))
+        return name;
+    return QByteArray::number(eventType); // e.g. user events
+}
+
+static QByteArray describeEvent(int eventType, const QByteArray &className, const QString &objectName)
+{
+    QByteArray str = eventTypeName(eventType) + " event to " + (className.isEmpty() ? "?" : className);
+    if (!objectName.isEmpty())
+        str = str + " \"" + objectName.toUtf8() + '"';
+    return str;
+}
+
+QByteArray WatchdogPrivate::EventProfile::describeSlot(const Slot *slot)
+{
+    // the slot's key and content are never changed after it has been published
+    if (!slot)
+        return "event to ? (the profile is full)";
+    return describeEvent(slot->m_eventType, slot->m_className, { });
+}
+
 static quintptr currentThreadHandle()
 {
 #if defined(Q_OS_DARWIN)
@@ -155,10 +244,7 @@ WatchdogPrivate::WatchdogPrivate(Watchdog *q)
     Q_ASSERT(thread() == m_wdThread);
     Q_ASSERT(m_quickWindowCheck->thread() == m_wdThread);
 
-    QElapsedTimer et;
-    et.start();
-    Q_ASSERT(et.isMonotonic());
-    m_referenceTime = et.msecsSinceReference();
+    m_referenceTime = std::chrono::steady_clock::now();
 
     connect(m_quickWindowCheck, &QTimer::timeout,
             this, &WatchdogPrivate::quickWindowCheck);
@@ -336,23 +422,45 @@ void WatchdogPrivate::watchEventLoop(QThread *thread)
     // eld is now owned by QThreadStorage and deleted automatically
 }
 
-void WatchdogPrivate::eventNotify(EventLoopData *eld, bool begin)
+void WatchdogPrivate::eventNotify(EventLoopData *eld, bool begin, QObject *receiver, QEvent *event)
 {
     // we're on the watched thread
 
     Q_ASSERT(QThread::currentThread() == eld->m_thread);
 
+    const quint64 timeNowUSec = nowUSec();
+
     if (begin) {
-        eld->m_timer = now();
+        // the receiver might not survive the event delivery, so everything we need to know about
+        // it has to be collected now. The class name is copied into the profile slot (only once
+        // per event type and class), because dynamic (QML) meta-objects could go away.
+        eld->m_beginUSec = timeNowUSec;
+        eld->m_currentObjectName = receiver->objectName();
+        eld->m_currentEventType = int(event->type());
+        eld->m_currentSlot.storeRelease(eld->m_profile.findSlot(eld->m_currentEventType,
+                                                                receiver->metaObject()->className()));
+        eld->m_currentReceiver.storeRelaxed(receiver);
+        eld->m_timer = timeNowUSec / 1000; // publishes the current event
     } else if (eld->m_timer) {
         // !begin && !m_timer would be the end of a nested event loop - we need to ignore that,
         // because we cannot record nested event start times
-        auto elapsed = std::chrono::milliseconds(now() - eld->m_timer.fetchAndStoreAcquire(0));
+        eld->m_timer.fetchAndStoreAcquire(0);
+        const quint64 elapsedUSec = timeNowUSec - eld->m_beginUSec;
+        const auto elapsed = std::chrono::milliseconds(elapsedUSec / 1000);
+        EventProfile::Slot *slot = eld->m_currentSlot.loadRelaxed();
+
+        eld->m_profile.record(slot, eld->m_currentEventType,
+                              eld->m_currentObjectName,
+                              quintptr(eld->m_currentReceiver.loadRelaxed()), elapsedUSec);
 
         if (m_warnEventLoopTime.count() && (elapsed > m_warnEventLoopTime)) {
+            QByteArray event = EventProfile::describeSlot(slot);
+            if (!eld->m_currentObjectName.isEmpty())
+                event = event + " \"" + eld->m_currentObjectName.toUtf8() + '"';
+
             QMetaObject::invokeMethod(m_eventLoopCheck,
                 //[this, eld](std::chrono::milliseconds elapsed) { // TODO: modernize in 6.9
-                [this, eld, elapsed]() {
+                [this, eld, elapsed, event]() {
                     // we're on the wd thread
                     Q_ASSERT(QThread::currentThread() == m_wdThread);
 
@@ -363,6 +471,7 @@ void WatchdogPrivate::eventNotify(EventLoopData *eld, bool begin)
                     qCWarning(LogWatchdog).nospace()
                         << "Event loop of thread " << static_cast<void *>(eld->m_thread.get())
                         << " was stuck for " << elapsed
+                        << " while delivering a " << event.constData()
                         << ", but then continued (the warn threshold is "
                         << m_warnEventLoopTime << ")";
 
@@ -396,6 +505,8 @@ void WatchdogPrivate::eventLoopCheck()
                 << "Event loop of thread " << static_cast<void *>(eld->m_thread.get())
                 << " was stuck " << counter << ((counter == 1) ? " time" : " times") << ". "
                 << "The longest period was " << eld->m_longestStuckDuration << ".";
+
+            logEventLoopProfile(eld, false);
         }
 
         const quint64 lastEvent = eld->m_timer;
@@ -404,26 +515,273 @@ void WatchdogPrivate::eventLoopCheck()
 
         const auto elapsed = std::chrono::milliseconds(timeNow - lastEvent);
 
+        // Only called when we are about to log something: the slot was published before m_timer
+        // was set, so it belongs to the event that started at lastEvent, unless the watched thread
+        // has moved on in the meantime. In this case there is nothing to complain about anymore.
+        auto currentEvent = [eld, lastEvent]() -> std::optional<std::pair<QByteArray, const void *>> {
+            const auto *slot = eld->m_currentSlot.loadAcquire();
+            const void *receiver = eld->m_currentReceiver.loadRelaxed();
+            if (quint64(eld->m_timer.loadAcquire()) != lastEvent)
+                return std::nullopt;
+            return std::make_pair(EventProfile::describeSlot(slot), receiver);
+        };
+
         if (m_killEventLoopTime.count() && (elapsed > m_killEventLoopTime) && eld->m_thread) {
+            const auto current = currentEvent();
+            if (!current)
+                continue;
+
             qCCritical(LogWatchdog).nospace()
                 << "Event loop of thread " << static_cast<void *>(eld->m_thread.get())
                 << " is getting killed, because it is now stuck for over " << elapsed
-                << " (the kill threshold is " << m_killEventLoopTime << ")";
+                << " while delivering a " << current->first.constData() << " (" << current->second
+                << ") (the kill threshold is " << m_killEventLoopTime << ")";
+
+            logEventLoopProfile(eld, true);
 
             // avoid multiple messages, until the thread is actually killed
             m_threadIsBeingKilled = 1;
             killThread(eld->m_threadHandle);
         } else if (m_warnEventLoopTime.count() && (elapsed > m_warnEventLoopTime)
                    && (elapsed > (m_eventLoopCheckInterval / 2))) {
+            const auto current = currentEvent();
+            if (!current)
+                continue;
+
             qCWarning(LogWatchdog).nospace()
                 << "Event loop of thread " << static_cast<void *>(eld->m_thread.get())
                 << " is currently stuck for over " << elapsed
-                << " (the warn threshold is " << m_warnEventLoopTime << ")";
+                << " while delivering a " << current->first.constData() << " (" << current->second
+                << ") (the warn threshold is " << m_warnEventLoopTime << ")";
         }
     }
 }
 
 
+QVariantMap WatchdogPrivate::eventLoopProfile() const
+{
+    // we're on the wd thread
+    Q_ASSERT(QThread::currentThread() == m_wdThread);
+
+    QVariantList bucketLimits;
+    for (int i = 0; i < EventProfile::BucketCount - 1; ++i)
+        bucketLimits << (250 << i) / 1000.;
+
+    QVariantList threads;
+    for (const auto *eld : std::as_const(m_eventLoops)) {
+        QVariantMap map = eld->m_profile.toMap();
+        map[u"thread"_s] = u"0x"_s + QString::number(quintptr(eld->m_thread.get()), 16);
+        map[u"threadName"_s] = eld->m_thread ? eld->m_thread->objectName() : QString();
+        map[u"mainThread"_s] = eld->m_isMainThread;
+        map[u"stuckCount"_s] = eld->m_stuckCounter;
+        threads << map;
+    }
+    return {
+        { u"bucketLimits"_s, bucketLimits },
+        { u"threads"_s, threads },
+    };
+}
+
+void WatchdogPrivate::resetEventLoopProfile()
+{
+    // we're on the wd thread
+    Q_ASSERT(QThread::currentThread() == m_wdThread);
+
+    // the actual reset has to happen on the watched thread
+    for (auto *eld : std::as_const(m_eventLoops))
+        eld->m_profile.m_resetRequested.storeRelaxed(1);
+}
+
+void WatchdogPrivate::logEventLoopProfile(const EventLoopData *eld, bool critical) const
+{
+    // we're on the wd thread
+    Q_ASSERT(QThread::currentThread() == m_wdThread);
+
+    static constexpr int TopCount = 5;
+
+    auto log = [critical]() {
+        return critical ? QMessageLogger().critical(LogWatchdog).nospace().noquote()
+                        : QMessageLogger().warning(LogWatchdog).nospace().noquote();
+    };
+
+    const QVariantMap profile = eld->m_profile.toMap();
+    const QVariantList slowest = profile.value(u"slowest"_s).toList();
+    const QVariantList histogram = profile.value(u"histogram"_s).toList();
+
+    if (!slowest.isEmpty()) {
+        log() << "The slowest events on thread " << static_cast<void *>(eld->m_thread.get()) << " were:";
+        for (qsizetype i = 0; i < std::min<qsizetype>(TopCount, slowest.size()); ++i) {
+            const QVariantMap se = slowest.at(i).toMap();
+            log() << "  * " << se.value(u"duration"_s).toDouble() << "ms: "
+                  << se.value(u"eventType"_s).toString() << " event to "
+                  << se.value(u"receiverClass"_s).toString() << " \""
+                  << se.value(u"receiverName"_s).toString() << "\" ("
+                  << se.value(u"receiver"_s).toString() << ")";
+        }
+    }
+    if (!histogram.isEmpty()) {
+        log() << "The most expensive receivers on thread " << static_cast<void *>(eld->m_thread.get())
+              << " were:";
+        for (qsizetype i = 0; i < std::min<qsizetype>(TopCount, histogram.size()); ++i) {
+            const QVariantMap h = histogram.at(i).toMap();
+            log() << "  * " << h.value(u"totalTime"_s).toDouble() << "ms in "
+                  << h.value(u"count"_s).toULongLong() << " " << h.value(u"eventType"_s).toString()
+                  << " events to " << h.value(u"receiverClass"_s).toString()
+                  << " (longest: " << h.value(u"maximumTime"_s).toDouble() << "ms)";
+        }
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// WatchdogPrivate   /   EventProfile
+///////////////////////////////////////////////////////////////////////////////////////////////////
+
+
+int WatchdogPrivate::EventProfile::bucketIndex(quint64 usec)
+{
+    // 0: < 250us, 1: < 500us, 2: < 1ms, ... 12: < 1024ms, 13: anything longer
+    if (usec < 250)
+        return 0;
+    return std::min(BucketCount - 1, 64 - int(qCountLeadingZeroBits(usec / 250)));
+}
+
+WatchdogPrivate::EventProfile::Slot *WatchdogPrivate::EventProfile::findSlot(int eventType,
+                                                                            const char *className)
+{
+    // we're on the watched thread, which is the only writer
+
+    // open addressing with linear probing: slots are never freed, so a lookup can stop at the
+    // first empty slot
+    const quintptr hash = (quintptr(className) >> 4) ^ (quintptr(eventType) * 0x9e3779b9U);
+    for (int i = 0; i < SlotCount; ++i) {
+        Slot &s = m_slots[(hash + quintptr(i)) % SlotCount];
+        const char *key = s.m_classNameKey.loadRelaxed();
+        if (!key) {
+            s.m_eventType = eventType;
+            s.m_className = className;
+            s.m_classNameKey.storeRelease(className); // publish
+            return &s;
+        } else if ((key == className) && (s.m_eventType == eventType)) {
+            return &s;
+        }
+    }
+    return nullptr;
+}
+
+void WatchdogPrivate::EventProfile::record(Slot *slot, int eventType, const QString &objectName,
+                                           quintptr receiver, quint64 usec)
+{
+    // we're on the watched thread, which is the only writer: a plain load/store is enough to
+    // update the counters, no read-modify-write atomics are needed
+    auto add = [](auto &atomic, quint64 value) {
+        atomic.storeRelaxed(atomic.loadRelaxed() + value);
+    };
+
+    if (Q_UNLIKELY(m_resetRequested.loadRelaxed()))
+        reset();
+
+    if (Q_LIKELY(slot)) {
+        add(slot->m_buckets[bucketIndex(usec)], 1);
+        add(slot->m_count, 1);
+        add(slot->m_totalUSec, usec);
+        if (usec > slot->m_maximumUSec.loadRelaxed())
+            slot->m_maximumUSec.storeRelaxed(usec);
+    } else {
+        add(m_unrecordedEvents, 1);
+    }
+
+    if (usec > m_slowestThreshold.loadRelaxed()) {
+        QMutexLocker locker(&m_slowestMutex);
+        auto it = std::upper_bound(m_slowest.begin(), m_slowest.end(), usec,
+                                   [](quint64 d, const SlowEvent &se) { return d > se.m_durationUSec; });
+        m_slowest.insert(it, { usec, eventType, slot ? slot->m_className : QByteArray(), objectName,
+                               receiver, QDateTime::currentMSecsSinceEpoch() });
+        if (m_slowest.size() > SlowestCount)
+            m_slowest.removeLast();
+        if (m_slowest.size() == SlowestCount)
+            m_slowestThreshold.storeRelaxed(m_slowest.constLast().m_durationUSec);
+    }
+}
+
+void WatchdogPrivate::EventProfile::reset()
+{
+    // we're on the watched thread
+    // The slots keep their keys, as a concurrent reader might still access the class names.
+    m_resetRequested.storeRelaxed(0);
+
+    for (Slot &slot : m_slots) {
+        if (!slot.m_classNameKey.loadRelaxed())
+            break;
+        for (auto &bucket : slot.m_buckets)
+            bucket.storeRelaxed(0);
+        slot.m_count.storeRelaxed(0);
+        slot.m_totalUSec.storeRelaxed(0);
+        slot.m_maximumUSec.storeRelaxed(0);
+    }
+    m_unrecordedEvents.storeRelaxed(0);
+
+    QMutexLocker locker(&m_slowestMutex);
+    m_slowest.clear();
+    m_slowestThreshold.storeRelaxed(0);
+}
+
+QVariantMap WatchdogPrivate::EventProfile::toMap() const
+{
+    // we can be on any thread
+
+    QVariantList histogram;
+    quint64 eventCount = 0;
+
+    for (const Slot &slot : m_slots) {
+        if (!slot.m_classNameKey.loadAcquire())
+            continue;
+        const quint64 count = slot.m_count.loadRelaxed();
+        if (!count)
+            continue;
+        eventCount += count;
+
+        QVariantList buckets;
+        for (const auto &bucket : slot.m_buckets)
+            buckets << bucket.loadRelaxed();
+
+        histogram << QVariantMap {
+            { u"eventType"_s, QString::fromLatin1(eventTypeName(slot.m_eventType)) },
+            { u"receiverClass"_s, QString::fromLatin1(slot.m_className) },
+            { u"count"_s, count },
+            { u"totalTime"_s, slot.m_totalUSec.loadRelaxed() / 1000. },
+            { u"maximumTime"_s, slot.m_maximumUSec.loadRelaxed() / 1000. },
+            { u"buckets"_s, buckets },
+        };
+    }
+    std::sort(histogram.begin(), histogram.end(), [](const QVariant &a, const QVariant &b) {
+        return a.toMap().value(u"totalTime"_s).toDouble() > b.toMap().value(u"totalTime"_s).toDouble();
+    });
+
+    QVariantList slowest;
+    {
+        QMutexLocker locker(&m_slowestMutex);
+        for (const SlowEvent &se : m_slowest) {
+            slowest << QVariantMap {
+                { u"eventType"_s, QString::fromLatin1(eventTypeName(se.m_eventType)) },
+                { u"receiverClass"_s, QString::fromLatin1(se.m_className) },
+                { u"receiverName"_s, se.m_objectName },
+                { u"receiver"_s, u"0x"_s + QString::number(se.m_receiver, 16) },
+                { u"duration"_s, se.m_durationUSec / 1000. },
+                { u"timestamp"_s, QDateTime::fromMSecsSinceEpoch(se.m_timeStamp) },
+            };
+        }
+    }
+
+    return {
+        { u"eventCount"_s, eventCount },
+        { u"unrecordedEventCount"_s, m_unrecordedEvents.loadRelaxed() },
+        { u"histogram"_s, histogram },
+        { u"slowest"_s, slowest },
+    };
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // WatchdogPrivate   /   QuickWindow
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -678,10 +1036,14 @@ void WatchdogPrivate::quickWindowCheck()
 
 quint64 WatchdogPrivate::now() const
 {
-    QElapsedTimer et;
-    et.start();
-    qint64 msr = et.msecsSinceReference();
-    return (msr < m_referenceTime) ? 0ULL : quint64(msr - m_referenceTime);
+    return nowUSec() / 1000;
+}
+
+quint64 WatchdogPrivate::nowUSec() const
+{
+    const auto elapsed = std::chrono::steady_clock::now() - m_referenceTime;
+    return quint64(std::max(std::chrono::microseconds(0),
+                            std::chrono::duration_cast<std::chrono::microseconds>(elapsed)).count());
 }
 
 
@@ -753,6 +1115,26 @@ void Watchdog::setQuickWindowTimeouts(std::chrono::milliseconds check,
         }, Qt::QueuedConnection);
 }
 
+QVariantMap Watchdog::eventLoopProfile() const
+{
+    QVariantMap profile;
+    if (!d || !d->m_wdThread->isRunning())
+        return profile;
+
+    // the list of watched event loops is owned by the wd thread
+    QMetaObject::invokeMethod(d, [this, &profile]() {
+            profile = d->eventLoopProfile();
+        }, Qt::BlockingQueuedConnection);
+    return profile;
+}
+
+void Watchdog::resetEventLoopProfile()
+{
+    QMetaObject::invokeMethod(d, [this]() {
+            d->resetEventLoopProfile();
+        }, Qt::QueuedConnection);
+}
+
 void Watchdog::eventCallback(const QThread *thread, bool begin, QObject *receiver, QEvent *event)
 {
     // This function is called twice for every event: it has to be as efficient as possible.
@@ -766,7 +1148,7 @@ void Watchdog::eventCallback(const QThread *thread, bool begin, QObject *receive
 
     if (auto *eld = std::as_const(WatchdogPrivate::s_eventLoopData).localData()) {
         Q_ASSERT(eld->m_thread == thread);
-        d->eventNotify(eld, begin);
+        d->eventNotify(eld, begin, receiver, event);
     }
 
     if (begin && (event->type() == QEvent::PlatformSurface)) {
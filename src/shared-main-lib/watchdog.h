@@ -5,6 +5,7 @@
 #define WATCHDOG_H
 
 #include <QtCore/QObject>
+#include <QtCore/QVariantMap>
 #include <QtAppManCommon/global.h>
 
 QT_FORWARD_DECLARE_CLASS(QEventLoop)
@@ -29,6 +30,9 @@ public:
 
     inline bool isActive() const { return m_active.loadRelaxed(); }
 
+    Q_INVOKABLE QVariantMap eventLoopProfile() const;
+    Q_INVOKABLE void resetEventLoopProfile();
+
     // callback API that needs to be fed from QCoreApplication::notify
     void eventCallback(const QThread *thread, bool begin, QObject *receiver, QEvent *event);
 
@@ -4,9 +4,11 @@
 #ifndef WATCHDOG_P_H
 #define WATCHDOG_P_H
 
+#include <array>
 #include <chrono>
 
 #include <QtCore/QObject>
+#include <QtCore/QMutex>
 #include <QtCore/QTimer>
 #include <QtQuick/QQuickWindow>
 #include <QtCore/QEventLoop>
@@ -70,6 +72,54 @@ public:
     };
     QList<QuickWindowData *> m_quickWindows;
 
+    // Per-thread event statistics: only the watched thread writes to it, but any thread can read
+    // it at any time. The histograms use single-writer atomics and are therefore lock-free. The
+    // list of the slowest events is protected by a mutex, but it is only ever locked by the
+    // watched thread when an event makes it into that list.
+    struct EventProfile {
+        // upper limits of the duration buckets: 250us, 500us, 1ms, 2ms, ... 1024ms, and one more
+        // bucket for anything longer than that
+        static constexpr int BucketCount = 14;
+        static constexpr int SlotCount = 256;
+        static constexpr int SlowestCount = 10;
+
+        struct Slot {
+            // the key: the class name pointer is published last and signals a valid slot
+            QAtomicPointer<const char> m_classNameKey = nullptr;
+            int m_eventType = 0;
+            QByteArray m_className; // a copy: dynamic (QML) meta-objects could go away
+
+            QAtomicInteger<quint32> m_buckets[BucketCount] = { };
+            QAtomicInteger<quint64> m_count = 0;
+            QAtomicInteger<quint64> m_totalUSec = 0;
+            QAtomicInteger<quint64> m_maximumUSec = 0;
+        };
+        std::array<Slot, SlotCount> m_slots;
+        QAtomicInteger<quint64> m_unrecordedEvents = 0; // all slots are in use
+
+        struct SlowEvent {
+            quint64 m_durationUSec = 0;
+            int m_eventType = 0;
+            QByteArray m_className;
+            QString m_objectName;
+            quintptr m_receiver = 0;
+            qint64 m_timeStamp = 0; // msecs since epoch
+        };
+        mutable QMutex m_slowestMutex;
+        QList<SlowEvent> m_slowest; // sorted, longest first
+        QAtomicInteger<quint64> m_slowestThreshold = 0; // shortest duration in a full m_slowest
+
+        QAtomicInteger<int> m_resetRequested = 0;
+
+        Slot *findSlot(int eventType, const char *className);
+        void record(Slot *slot, int eventType, const QString &objectName, quintptr receiver,
+                    quint64 usec);
+        void reset();
+        QVariantMap toMap() const;
+        static int bucketIndex(quint64 usec);
+        static QByteArray describeSlot(const Slot *slot);
+    };
+
     struct EventLoopData {
         // watchdog thread use only
         QPointer<QThread> m_thread;
@@ -82,8 +132,22 @@ public:
         // written from the watched thread, read from the watchdog thread
         QAtomicInteger<qint64> m_timer = { 0 };
         QAtomicInteger<quintptr> m_threadHandle = 0; // QPointer is not thread-safe
+
+        // the event that is currently being delivered: written from the watched thread, read from
+        // the watchdog thread to attribute a stall. The profile slot holds a copy of both the event
+        // type and the class name, so the watchdog thread always gets a consistent pair.
+        QAtomicPointer<EventProfile::Slot> m_currentSlot = nullptr; // nullptr: the profile is full
+        QAtomicPointer<QObject> m_currentReceiver = nullptr; // never dereferenced outside the watched thread
+        quint64 m_beginUSec = 0; // watched thread use only
+        int m_currentEventType = 0; // watched thread use only
+        QString m_currentObjectName; // watched thread use only
+
+        EventProfile m_profile;
     };
-    void eventNotify(EventLoopData *eld, bool begin);
+    void eventNotify(EventLoopData *eld, bool begin, QObject *receiver, QEvent *event);
+    QVariantMap eventLoopProfile() const;
+    void resetEventLoopProfile();
+    void logEventLoopProfile(const EventLoopData *eld, bool critical) const;
     // This needs to be static to outlive qApp, as we cannot remove local data once set,
     // which is a bit of design flaw in QThreadStorage
     static QThreadStorage<EventLoopData *> s_eventLoopData;
@@ -95,7 +159,8 @@ public:
     QThread *m_wdThread;
 
     quint64 now() const;
-    qint64 m_referenceTime;
+    quint64 nowUSec() const;
+    std::chrono::steady_clock::time_point m_referenceTime;
 
     QTimer *m_quickWindowCheck;
     std::chrono::milliseconds m_quickWindowCheckInterval { };
@@ -208,6 +208,10 @@ Controller::Controller(ApplicationMain *am, bool quickLaunched, const QPair<QStr
 
         connect(am, &ApplicationMain::startApplication,
                 this, &Controller::startApplication);
+        if (quickLaunched) {
+            connect(am, &ApplicationMain::preloadApplication,
+                    this, &Controller::preloadApplication);
+        }
 
         StartupTimer::instance()->checkpoint("after D-Bus connections");
     } else {
@@ -274,6 +278,12 @@ void Controller::startApplication(const QString &baseDir, const QString &qmlFile
         return;
     }
 
+    // the manager only hands out a launcher that preloaded an application for exactly this one
+    if (!m_preloadedApplicationId.isEmpty() && (m_preloadedApplicationId != applicationId)) {
+        qCWarning(LogQmlRuntime) << "starting" << applicationId << "in a launcher that preloaded"
+                                 << m_preloadedApplicationId;
+    }
+
     if (m_quickLaunched) {
         StartupTimer::instance()->reset();
         StartupTimer::instance()->checkpoint("quick-launching application");
@@ -446,8 +456,14 @@ void Controller::startApplication(const QString &baseDir, const QString &qmlFile
     qmlProtectModule("QtApplicationManager", 2);
     qmlProtectModule("QtApplicationManager.Application", 2);
 
+    if (m_preloadedComponent && (m_preloadedComponent->url() == qmlFileUrl))
+        qCDebug(LogQmlRuntime) << "using the preloaded main qml file";
+
     m_engine.load(qmlFileUrl);
 
+    // the engine's type cache now holds on to everything the application needs
+    delete m_preloadedComponent;
+
     StartupTimer::instance()->checkpoint("after engine loading main qml file");
 
     auto topLevels = m_engine.rootObjects();
@@ -563,5 +579,69 @@ void Controller::updateSlowAnimations(bool isSlow)
     }
 }
 
+void Controller::preloadApplication(const QString &baseDir, const QString &qmlFile,
+                                    const QVariantMap &application)
+{
+    if (m_launched || !m_quickLaunched)
+        return;
+
+    const QString applicationId = application.value(u"id"_s).toString();
+    const QUrl qmlFileUrl = filePathToUrl(qmlFile, baseDir);
+
+    // Everything the application imports ends up in the shared engine and cannot be unloaded
+    // again, so only ever preload a single application: the manager reserves this launcher for it.
+    if (!m_preloadedApplicationId.isEmpty()) {
+        if (m_preloadedApplicationId != applicationId) {
+            qCWarning(LogQmlRuntime) << "not preloading" << applicationId << "- this launcher already"
+                                     << "preloaded" << m_preloadedApplicationId;
+        }
+        return;
+    }
+
+    const QVariantMap runtimeParameters = qdbus_cast<QVariantMap>(application.value(u"runtimeParameters"_s));
+
+    // resources and plugins cannot be unloaded again, in case a different application is
+    // launched in the end
+    if (runtimeParameters.contains(u"resources"_s) || runtimeParameters.contains(u"pluginPaths"_s)
+            || runtimeParameters.value(u"loadDummyData"_s).toBool()) {
+        qCDebug(LogQmlRuntime) << "not preloading" << applicationId
+                               << "- it needs custom resources, plugins or dummy-data";
+        return;
+    }
+
+    QVariant imports = runtimeParameters.value(u"importPaths"_s);
+    const QVariantList ipvl = (imports.metaType() == QMetaType::fromType<QString>())
+            ? QVariantList{imports}
+            : qdbus_cast<QVariantList>(imports);
+
+    for (const QVariant &v : ipvl) {
+        const QString path = v.toString();
+        const QFileInfo fi(path);
+        if (!(fi.isNativePath() && fi.isAbsolute()))
+            m_engine.addImportPath(toAbsoluteFilePath(path, baseDir));
+    }
+
+    qCDebug(LogQmlRuntime) << "preloading" << applicationId << "- main:" << qmlFile
+                           << "- baseDir:" << baseDir;
+
+    // only compile the component (and all its imports) in the background: nothing is instantiated
+    // until the application is actually started via startApplication()
+    auto *component = new QQmlComponent(&m_engine, qmlFileUrl, QQmlComponent::Asynchronous, this);
+    m_preloadedApplicationId = applicationId;
+    m_preloadedComponent = component;
+
+    auto checkStatus = [component, applicationId]() {
+        if (component->isError()) {
+            qCWarning(LogQmlRuntime) << "preloading" << applicationId << "failed:" << component->errors();
+        } else if (component->isReady()) {
+            qCDebug(LogQmlRuntime) << "preloading" << applicationId << "is complete";
+        }
+    };
+    if (component->isLoading())
+        connect(component, &QQmlComponent::statusChanged, this, checkStatus);
+    else
+        checkStatus();
+}
+
 
 #include "moc_launcher-qml_p.cpp"
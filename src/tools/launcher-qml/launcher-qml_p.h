@@ -8,6 +8,8 @@
 
 #include <QObject>
 #include <QVariantMap>
+#include <QHash>
+#include <QUrl>
 #include <QVector>
 #include <QPointer>
 #include <QQmlIncubationController>
@@ -16,6 +18,7 @@
 
 QT_FORWARD_DECLARE_CLASS(QTimerEvent)
 QT_FORWARD_DECLARE_CLASS(QQuickWindow)
+QT_FORWARD_DECLARE_CLASS(QQmlComponent)
 
 QT_BEGIN_NAMESPACE_AM
 
@@ -33,6 +36,8 @@ public Q_SLOTS:
     void startApplication(const QString &baseDir, const QString &qmlFile, const QString &document,
                           const QString &mimeType, const QVariantMap &application,
                           const QVariantMap &systemProperties);
+    void preloadApplication(const QString &baseDir, const QString &qmlFile,
+                            const QVariantMap &application);
 
 private:
     QQmlApplicationEngine m_engine;
@@ -41,6 +46,8 @@ private:
     bool m_quickLaunched;
     QQuickWindow *m_window = nullptr;
     QVector<QPointer<QQuickWindow>> m_allWindows;
+    QString m_preloadedApplicationId;
+    QPointer<QQmlComponent> m_preloadedComponent;
 
     void updateSlowAnimationsForWindow(QQuickWindow *window);
 
@@ -2,14 +2,21 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
 
 #include <cstdio>
+#include <optional>
 
 #include <QHttpServer>
+#include <QHttpServerResponder>
 #include <QTcpServer>
 #include <QJsonArray>
 #include <QJsonObject>
+#include <QJsonDocument>
 #include <QTemporaryFile>
-#include <QBuffer>
+#include <QFile>
+#include <QFileInfo>
 #include <QtAppManCommon/exception.h>
+#if QT_VERSION >= QT_VERSION_CHECK(6, 8, 0)
+#  include <QHttpHeaders>
+#endif
 
 #include "psconfiguration.h"
 #include "pspackages.h"
@@ -22,6 +29,209 @@ QT_USE_NAMESPACE_AM
 using namespace Qt::StringLiterals;
 
 
+#if QT_VERSION < QT_VERSION_CHECK(6, 8, 0)
+using ResponderRef = QHttpServerResponder &&;
+#else
+using ResponderRef = QHttpServerResponder &;
+#endif
+
+// A read-only window into a file: QHttpServerResponder streams QIODevices in chunks and derives
+// the Content-Length from size(), so this is all we need to serve byte ranges without copying.
+class FileRange : public QIODevice
+{
+public:
+    FileRange(const QString &filePath, qint64 offset, qint64 length)
+        : m_file(filePath)
+        , m_offset(offset)
+        , m_length(length)
+    { }
+
+    bool open(OpenMode mode) override
+    {
+        if ((mode & ReadWrite) != ReadOnly)
+            return false;
+        if (!m_file.open(QIODevice::ReadOnly) || !m_file.seek(m_offset)) {
+            setErrorString(m_file.errorString());
+            m_file.close();
+            return false;
+        }
+        return QIODevice::open(mode | Unbuffered);
+    }
+
+    void close() override
+    {
+        QIODevice::close();
+        m_file.close();
+    }
+
+    qint64 size() const override
+    {
+        return m_length;
+    }
+
+    bool seek(qint64 pos) override
+    {
+        if ((pos < 0) || (pos > m_length) || !m_file.seek(m_offset + pos))
+            return false;
+        return QIODevice::seek(pos);
+    }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override
+    {
+        const qint64 remaining = m_length - (m_file.pos() - m_offset);
+        if (remaining <= 0)
+            return -1;
+        return m_file.read(data, std::min(maxSize, remaining));
+    }
+
+    qint64 writeData(const char *, qint64) override
+    {
+        return -1;
+    }
+
+private:
+    QFile m_file;
+    qint64 m_offset;
+    qint64 m_length;
+};
+
+static QByteArray requestHeader(const QHttpServerRequest &req, const QByteArray &name)
+{
+#if QT_VERSION < QT_VERSION_CHECK(6, 8, 0)
+    return req.value(name);
+#else
+    return req.headers().value(name).toByteArray();
+#endif
+}
+
+static bool matchesETag(const QByteArray &headerValue, const QByteArray &etag)
+{
+    const auto tags = headerValue.split(',');
+    for (QByteArray tag : tags) {
+        tag = tag.trimmed();
+        if (tag.startsWith("W/")) // weak comparison is fine for GET
+            tag = tag.mid(2);
+        if ((tag == "*") || (tag == etag))
+            return true;
+    }
+    return false;
+}
+
+// Parses a single "bytes=<first>-<last>" range (including the open and suffix forms) and returns
+// the offset and length, { -1, 0 } for a syntactically valid, but unsatisfiable range, or
+// std::nullopt if the header should be ignored (invalid or multiple ranges).
+static std::optional<std::pair<qint64, qint64>> parseRange(const QByteArray &headerValue, qint64 size)
+{
+    if (!headerValue.startsWith("bytes="))
+        return std::nullopt;
+    const QByteArray spec = headerValue.mid(6).trimmed();
+    const qsizetype dash = spec.indexOf('-');
+    if ((dash < 0) || spec.contains(','))
+        return std::nullopt;
+
+    bool firstOk = false;
+    bool lastOk = false;
+    const qint64 first = spec.left(dash).toLongLong(&firstOk);
+    qint64 last = spec.mid(dash + 1).toLongLong(&lastOk);
+
+    if (dash == 0) { // suffix: the last N bytes
+        if (!lastOk || (last < 0))
+            return std::nullopt;
+        if (!last || !size)
+            return std::make_pair(qint64(-1), qint64(0));
+        last = std::min(last, size);
+        return std::make_pair(size - last, last);
+    }
+    if (!firstOk || (first < 0) || ((dash + 1 < spec.size()) && (!lastOk || (last < first))))
+        return std::nullopt;
+    if (first >= size)
+        return std::make_pair(qint64(-1), qint64(0));
+    if ((dash + 1 == spec.size()) || (last >= size))
+        last = size - 1;
+    return std::make_pair(first, last - first + 1);
+}
+
+static void sendFile(QHttpServerResponder &responder, const QHttpServerRequest &req,
+                     const QString &filePath, const QByteArray &sha1)
+{
+    using StatusCode = QHttpServerResponder::StatusCode;
+
+    const QByteArray etag = '"' + sha1.toHex() + '"';
+    const QByteArray contentType = "application/octet-stream";
+    const qint64 size = QFileInfo(filePath).size();
+
+    const QByteArray ifNoneMatch = requestHeader(req, "If-None-Match");
+    if (!ifNoneMatch.isEmpty() && matchesETag(ifNoneMatch, etag)) {
+#if QT_VERSION < QT_VERSION_CHECK(6, 8, 0)
+        responder.write(QByteArray { }, { { "ETag", etag } }, StatusCode::NotModified);
+#else
+        QHttpHeaders headers;
+        headers.append(QHttpHeaders::WellKnownHeader::ETag, etag);
+        responder.write(QByteArray { }, headers, StatusCode::NotModified);
+#endif
+        return;
+    }
+
+    qint64 offset = 0;
+    qint64 length = size;
+    bool partial = false;
+
+    const QByteArray range = requestHeader(req, "Range");
+    const QByteArray ifRange = requestHeader(req, "If-Range");
+    if (!range.isEmpty() && (ifRange.isEmpty() || (ifRange == etag))) {
+        if (auto r = parseRange(range, size)) {
+            if (r->first < 0) {
+                const QByteArray contentRange = "bytes */" + QByteArray::number(size);
+#if QT_VERSION < QT_VERSION_CHECK(6, 8, 0)
+                responder.write(QByteArray { }, { { "Content-Range", contentRange } },
+                                StatusCode::RequestRangeNotSatisfiable);
+#else
+                QHttpHeaders headers;
+                headers.append(QHttpHeaders::WellKnownHeader::ContentRange, contentRange);
+                responder.write(QByteArray { }, headers, StatusCode::RequestRangeNotSatisfiable);
+#endif
+                return;
+            }
+            offset = r->first;
+            length = r->second;
+            partial = true;
+        }
+    }
+
+    auto body = new FileRange(filePath, offset, length);
+    if (!body->open(QIODevice::ReadOnly)) {
+        delete body;
+        responder.write(StatusCode::NotFound);
+        return;
+    }
+
+    const QByteArray contentRange = !partial ? QByteArray { }
+        : "bytes " + QByteArray::number(offset) + '-' + QByteArray::number(offset + length - 1)
+          + '/' + QByteArray::number(size);
+    const auto status = partial ? StatusCode::PartialContent : StatusCode::Ok;
+
+    // the responder takes ownership of body and streams it in chunks
+#if QT_VERSION < QT_VERSION_CHECK(6, 8, 0)
+    if (partial) {
+        responder.write(body, { { "Content-Type", contentType }, { "ETag", etag },
+                                { "Accept-Ranges", "bytes" }, { "Content-Range", contentRange } },
+                        status);
+    } else {
+        responder.write(body, { { "Content-Type", contentType }, { "ETag", etag },
+                                { "Accept-Ranges", "bytes" } }, status);
+    }
+#else
+    QHttpHeaders headers;
+    headers.append(QHttpHeaders::WellKnownHeader::ContentType, contentType);
+    headers.append(QHttpHeaders::WellKnownHeader::ETag, etag);
+    headers.append(QHttpHeaders::WellKnownHeader::AcceptRanges, "bytes");
+    if (partial)
+        headers.append(QHttpHeaders::WellKnownHeader::ContentRange, contentRange);
+    responder.write(body, headers, status);
+#endif
+}
+
 static QJsonObject asJson(const QMap<QString, QString> &map)
 {
     QJsonObject result;
@@ -88,48 +298,62 @@ void PSHttpInterface::setupRouting(PSPackages *packages)
         return QJsonObject { { u"status"_s, status } };
     });
 
-    d->server->route(u"/package/list"_s, GetOrPost, [packages](const QHttpServerRequest &req) {
+    d->server->route(u"/package/list"_s, GetOrPost, [this, packages](const QHttpServerRequest &req) {
         const auto query = req.query();
         const QString architecture = query.queryItemValue(u"architecture"_s);
         const QString category = query.queryItemValue(u"category"_s);
         const QString filter = query.queryItemValue(u"filter"_s);
+        const qsizetype offset = std::max(0, query.queryItemValue(u"offset"_s).toInt());
+        bool hasLimit = false;
+        const qsizetype limit = std::max(0, query.queryItemValue(u"limit"_s).toInt(&hasLimit));
+
+        if (d->catalogRevision != packages->catalogRevision()) {
+            d->catalogRevision = packages->catalogRevision();
+            d->packageJson.clear();
+            d->listResponses.clear();
+        }
 
-        QJsonArray pkgs;
-
-        const auto spList = packages->byArchitecture(architecture);
-
-        for (const PSPackage *sp : spList) {
-            if (!category.isEmpty() && sp->packageInfo->categories().contains(category))
-                continue;
-            if (!filter.isEmpty()) {
-                bool match = false;
-                const auto names = sp->packageInfo->names();
-                for (const auto &name : names) {
-                    if (name.contains(filter)) {
-                        match = true;
-                        break;
-                    }
+        const QString cacheKey = architecture + u'\n' + category + u'\n' + filter + u'\n'
+                                 + QString::number(offset) + u'\n'
+                                 + (hasLimit ? QString::number(limit) : QString { });
+
+        QByteArray response = d->listResponses.value(cacheKey);
+        if (response.isEmpty()) {
+            const auto spList = packages->catalog(architecture, category, filter);
+            const qsizetype end = hasLimit ? std::min(spList.size(), offset + limit) : spList.size();
+
+            response = "[";
+            for (qsizetype i = offset; i < end; ++i) {
+                const PSPackage *sp = spList.at(i);
+                QByteArray &json = d->packageJson[sp];
+
+                if (json.isEmpty()) {
+                    const QString iconUrl = u"package/icon?id="_s
+                                            + QString::fromLatin1(QUrl::toPercentEncoding(sp->packageInfo->id()))
+                                            + u"&architecture="_s
+                                            + QString::fromLatin1(QUrl::toPercentEncoding(sp->architectureOrAll()));
+
+                    json = QJsonDocument(QJsonObject {
+                        { u"id"_s, sp->packageInfo->id() },
+                        { u"architecture"_s, sp->architecture },
+                        { u"names"_s, asJson(sp->packageInfo->names()) },
+                        { u"descriptions"_s, asJson(sp->packageInfo->descriptions()) },
+                        { u"version"_s, sp->packageInfo->version() },
+                        { u"categories"_s, QJsonArray::fromStringList(sp->packageInfo->categories()) },
+                        { u"iconUrl"_s, iconUrl },
+                    }).toJson(QJsonDocument::Compact);
                 }
-                if (match)
-                    continue;
+                if (i > offset)
+                    response.append(',');
+                response.append(json);
             }
+            response.append(']');
 
-            const QString iconUrl = u"package/icon?id="_s
-                                    + QString::fromLatin1(QUrl::toPercentEncoding(sp->packageInfo->id()))
-                                    + u"&architecture="_s
-                                    + QString::fromLatin1(QUrl::toPercentEncoding(sp->architectureOrAll()));
-
-            pkgs.append(QJsonObject {
-                { u"id"_s, sp->packageInfo->id() },
-                { u"architecture"_s, sp->architecture },
-                { u"names"_s, asJson(sp->packageInfo->names()) },
-                { u"descriptions"_s, asJson(sp->packageInfo->descriptions()) },
-                { u"version"_s, sp->packageInfo->version() },
-                { u"categories"_s, QJsonArray::fromStringList(sp->packageInfo->categories()) },
-                { u"iconUrl"_s, iconUrl },
-            });
+            if (d->listResponses.size() >= 1024) // the query space is unbounded
+                d->listResponses.clear();
+            d->listResponses.insert(cacheKey, response);
         }
-        return QHttpServerResponse { pkgs };
+        return QHttpServerResponse("application/json", response);
     });
 
     d->server->route(u"/package/icon"_s, GetOrPost, [packages](const QHttpServerRequest &req) {
@@ -144,7 +368,8 @@ void PSHttpInterface::setupRouting(PSPackages *packages)
         return QHttpServerResponse(QHttpServerResponse::StatusCode::NotFound);
     });
 
-    d->server->route(u"/package/download"_s, GetOrPost, [this, packages](const QHttpServerRequest &req) {
+    d->server->route(u"/package/download"_s, GetOrPost, [this, packages](const QHttpServerRequest &req,
+                                                                        ResponderRef responder) {
         const auto query = req.query();
         QString id = query.queryItemValue(u"id"_s);
         const QString architecture = query.queryItemValue(u"architecture"_s);
@@ -153,25 +378,20 @@ void PSHttpInterface::setupRouting(PSPackages *packages)
         if (auto *sp = packages->byIdAndArchitecture(id, architecture)) {
             if (!d->cfg->storeSignCertificate.isEmpty()) {
                 try {
-                    QBuffer buffer;
-                    buffer.open(QIODevice::WriteOnly);
-                    packages->storeSign(sp, hardwareId, &buffer);
-
-                    return QHttpServerResponse("application/octet-stream", buffer.data());
+                    const auto [filePath, sha1] = packages->cachedStoreSign(sp, hardwareId);
+                    sendFile(responder, req, filePath, sha1);
                 } catch (const Exception &e) {
                     colorOut() << ColorPrint::red << " x failed" << ColorPrint::reset << ": "
                                << e.errorString();
-                    return QHttpServerResponse { QHttpServerResponse::StatusCode::InternalServerError };
+                    responder.write(QHttpServerResponder::StatusCode::InternalServerError);
                 }
-
             } else {
-                QFile f(sp->filePath);
-                if (f.open(QIODevice::ReadOnly))
-                    return QHttpServerResponse("application/octet-stream", f.readAll());
+                sendFile(responder, req, sp->filePath, sp->sha1);
             }
+            return;
         }
 
-        return QHttpServerResponse(QHttpServerResponse::StatusCode::NotFound);
+        responder.write(QHttpServerResponder::StatusCode::NotFound);
     });
 
     d->server->route(u"/package/upload"_s, QHttpServerRequest::Method::Put, [packages](const QHttpServerRequest &req) {
@@ -5,16 +5,26 @@
 #define PSHTTPINTERFACE_P_H
 
 #include <QString>
+#include <QHash>
+#include <QByteArray>
 #include <QHttpServer>
 #include "psconfiguration.h"
 
 
+class PSPackage;
+
+
 class PSHttpInterfacePrivate
 {
 public:
     PSConfiguration *cfg = nullptr;
     QHttpServer *server = nullptr;
     QString listenAddress;
+
+    // pre-serialized /package/list responses, valid for PSPackages::catalogRevision()
+    quint64 catalogRevision = 0;
+    QHash<const PSPackage *, QByteArray> packageJson;
+    QHash<QString, QByteArray> listResponses;
 };
 
 #endif // PSHTTPINTERFACE_P_H
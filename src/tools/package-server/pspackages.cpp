@@ -5,6 +5,10 @@
 #include <QFileSystemWatcher>
 #include <QDirIterator>
 #include <QTemporaryDir>
+#include <QSaveFile>
+#include <QSet>
+#include <algorithm>
+#include <iterator>
 #include <QCryptographicHash>
 #include <QMessageAuthenticationCode>
 #include <QtAppManCommon/exception.h>
@@ -43,6 +47,23 @@ static const QString UploadDirName   = u"upload"_s;
 static const QString RemoveDirName   = u"remove"_s;
 static const QString PackagesDirName = u".packages"_s;
 static const QString LockFileName    = u".lock"_s;
+static const QString StoreSignCacheDirName = u".store-signed"_s;
+
+
+static QList<int> intersected(const QList<int> &a, const QList<int> &b)
+{
+    QList<int> result;
+    std::set_intersection(a.cbegin(), a.cend(), b.cbegin(), b.cend(), std::back_inserter(result));
+    return result;
+}
+
+static QSet<QString> trigrams(const QString &str)
+{
+    QSet<QString> result;
+    for (qsizetype i = 0; i + 3 <= str.size(); ++i)
+        result.insert(str.mid(i, 3));
+    return result;
+}
 
 
 PSPackages::PSPackages(PSConfiguration *cfg, QObject *parent)
@@ -114,6 +135,9 @@ void PSPackages::initialize()
     d->scanUploads();
     d->scanRemoves();
 
+    if (!d->cfg->storeSignCertificate.isEmpty())
+        d->setupStoreSignCache();
+
     auto dirWatcher = new QFileSystemWatcher({ dd.absoluteFilePath(UploadDirName),
                                               dd.absoluteFilePath(RemoveDirName) }, this);
     QObject::connect(dirWatcher, &QFileSystemWatcher::directoryChanged,
@@ -225,6 +249,46 @@ QList<PSPackage *> PSPackages::byArchitecture(const QString &architecture) const
     return packages;
 }
 
+QList<PSPackage *> PSPackages::catalog(const QString &architecture, const QString &category,
+                                       const QString &filter) const
+{
+    PSCatalog *c = d->ensureCatalog();
+
+    QList<int> indices = c->architectureBucket(architecture);
+    if (!category.isEmpty() && !indices.isEmpty())
+        indices = intersected(indices, c->byCategory.value(category));
+
+    // the trigram index narrows down the candidates, but we still need to verify the actual
+    // substring match (and short filters cannot use the index at all)
+    const auto filterTrigrams = trigrams(filter);
+    for (const QString &trigram : filterTrigrams) {
+        if (indices.isEmpty())
+            break;
+        indices = intersected(indices, c->byNameTrigram.value(trigram));
+    }
+
+    QList<PSPackage *> result;
+    result.reserve(indices.size());
+
+    for (int index : std::as_const(indices)) {
+        PSPackage *sp = c->packages.at(index);
+        if (!filter.isEmpty()) {
+            const auto names = sp->packageInfo->names();
+            if (std::none_of(names.cbegin(), names.cend(), [&filter](const QString &name) {
+                    return name.contains(filter); })) {
+                continue;
+            }
+        }
+        result.append(sp);
+    }
+    return result;
+}
+
+quint64 PSPackages::catalogRevision() const
+{
+    return d->catalogRevision;
+}
+
 PSPackage *PSPackages::byIdAndArchitecture(const QString &id, const QString &architecture) const
 {
     auto *sp = d->packages.value(id).value(architecture, nullptr);
@@ -245,9 +309,11 @@ int PSPackages::removeIf(const std::function<bool(PSPackage *)> &pred)
                 colorOut() << ColorPrint::red << " - removing " << ColorPrint::bcyan << sp->id
                            << ColorPrint::reset << " [" << sp->architectureOrAll() << "]";
                 QFile::remove(sp->filePath);
+                d->removeFromStoreSignCache(sp);
                 delete sp;
                 ait = iit->erase(ait); // clazy:exclude=strict-iterators
                 ++count;
+                d->invalidateCatalog();
             } else {
                 ++ait;
             }
@@ -291,6 +357,8 @@ std::pair<PSPackages::UploadResult, PSPackage *> PSPackages::upload(const QStrin
                 scannedSp->filePath = finalPath;
                 d->packages[id][architecture] = result.second = scannedSp.release();
                 result.first = UploadResult::Updated;
+                d->invalidateCatalog();
+                d->removeFromStoreSignCache(existingSp);
                 delete existingSp;
             }
         } else {
@@ -300,6 +368,7 @@ std::pair<PSPackages::UploadResult, PSPackage *> PSPackages::upload(const QStrin
             scannedSp->filePath = finalPath;
             d->packages[id][architecture] = result.second = scannedSp.release();
             result.first = UploadResult::Added;
+            d->invalidateCatalog();
         }
 
         const char *action = nullptr;
@@ -367,10 +436,165 @@ void PSPackages::storeSign(PSPackage *sp, const QString &hardwareId, QIODevice *
         throw Exception("could not re-create package: %1").arg(pc.errorString());
 }
 
+std::pair<QString, QByteArray> PSPackages::cachedStoreSign(PSPackage *sp, const QString &hardwareId)
+{
+    // returns the file path and the SHA1 of the store-signed package. The signature only depends
+    // on the package, the hardware-id and the certificate, so we can re-use it for all downloads
+
+    if (d->storeSignCacheDirectory.isEmpty())
+        d->setupStoreSignCache();
+
+    const QString fileName = QString::fromLatin1(sp->sha1.toHex()) + u'_'
+            + QString::fromLatin1(QCryptographicHash::hash(hardwareId.toUtf8(),
+                                                           QCryptographicHash::Sha1).toHex())
+            + u".ampkg"_s;
+    const QString filePath = d->storeSignCacheDirectory + u'/' + fileName;
+
+    QByteArray sha1 = d->storeSignCacheSha1.value(fileName);
+    if (!sha1.isEmpty() && QFileInfo::exists(filePath))
+        return { filePath, sha1 };
+
+    QFile f(filePath);
+    if (!f.open(QIODevice::ReadOnly)) {
+        QSaveFile sf(filePath);
+        if (!sf.open(QIODevice::WriteOnly))
+            throw Exception(sf, "could not create store-signed package");
+        storeSign(sp, hardwareId, &sf);
+        if (!sf.commit())
+            throw Exception(sf, "could not write store-signed package");
+
+        if (!f.open(QIODevice::ReadOnly))
+            throw Exception(f, "could not open store-signed package");
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    if (!hash.addData(&f))
+        throw Exception(f, "could not read the store-signed package");
+    sha1 = hash.result();
+    d->storeSignCacheSha1.insert(fileName, sha1);
+
+    return { filePath, sha1 };
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 
 
+void PSPackagesPrivate::setupStoreSignCache()
+{
+    // Each certificate gets its own sub-directory and entries are named <package sha1>_<hw-id sha1>:
+    // this way we can prune everything that became stale while we were not running.
+
+    const QString certificateDirName = QString::fromLatin1(
+        QCryptographicHash::hash(cfg->storeSignCertificate, QCryptographicHash::Sha1).toHex());
+
+    QDir cacheDir(cfg->dataDirectory.absoluteFilePath(StoreSignCacheDirName));
+    if (!cacheDir.mkpath(certificateDirName)) {
+        throw Exception("could not create a '%1' directory inside the data directory %2")
+            .arg(StoreSignCacheDirName).arg(cfg->dataDirectory.absolutePath());
+    }
+
+    const auto certificateDirs = cacheDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString &dirName : certificateDirs) {
+        if (dirName != certificateDirName)
+            QDir(cacheDir.absoluteFilePath(dirName)).removeRecursively();
+    }
+
+    storeSignCacheDirectory = cacheDir.absoluteFilePath(certificateDirName);
+    storeSignCacheSha1.clear();
+
+    QSet<QString> packageSha1s;
+    for (const auto &pkg : std::as_const(packages)) {
+        for (const PSPackage *sp : pkg)
+            packageSha1s.insert(QString::fromLatin1(sp->sha1.toHex()));
+    }
+
+    QDirIterator dit(storeSignCacheDirectory, QDir::Files | QDir::Hidden);
+    while (dit.hasNext()) {
+        dit.next();
+        if (!packageSha1s.contains(dit.fileName().section(u'_', 0, 0)))
+            QFile::remove(dit.filePath());
+    }
+}
+
+void PSPackagesPrivate::removeFromStoreSignCache(const PSPackage *sp)
+{
+    if (storeSignCacheDirectory.isEmpty())
+        return;
+
+    const QString prefix = QString::fromLatin1(sp->sha1.toHex()) + u'_';
+    const auto fileNames = QDir(storeSignCacheDirectory).entryList({ prefix + u'*' }, QDir::Files);
+    for (const QString &fileName : fileNames) {
+        QFile::remove(storeSignCacheDirectory + u'/' + fileName);
+        storeSignCacheSha1.remove(fileName);
+    }
+}
+
+void PSPackagesPrivate::invalidateCatalog()
+{
+    catalog.reset();
+    ++catalogRevision;
+}
+
+PSCatalog *PSPackagesPrivate::ensureCatalog()
+{
+    if (catalog)
+        return catalog.get();
+
+    catalog = std::make_unique<PSCatalog>();
+
+    for (const auto &pkg : std::as_const(packages)) {
+        for (PSPackage *sp : pkg) {
+            const int index = int(catalog->packages.size());
+            catalog->packages.append(sp);
+
+            const auto categories = sp->packageInfo->categories();
+            for (const QString &category : categories) {
+                auto &bucket = catalog->byCategory[category];
+                if (bucket.isEmpty() || (bucket.constLast() != index))
+                    bucket.append(index);
+            }
+
+            QSet<QString> nameTrigrams;
+            const auto names = sp->packageInfo->names();
+            for (const QString &name : names)
+                nameTrigrams.unite(trigrams(name));
+            for (const QString &trigram : std::as_const(nameTrigrams))
+                catalog->byNameTrigram[trigram].append(index);
+        }
+    }
+    return catalog.get();
+}
+
+const QList<int> &PSCatalog::architectureBucket(const QString &architecture)
+{
+    // same semantics as PSPackages::byArchitecture(): per id, prefer the exact architecture and
+    // fall back to the platform independent package
+
+    auto it = byArchitecture.constFind(architecture);
+    if (it != byArchitecture.cend())
+        return *it;
+
+    QList<int> bucket;
+    for (int i = 0; i < packages.size(); ) {
+        const QString &id = packages.at(i)->id;
+        int exact = -1;
+        int fallback = -1;
+        for ( ; (i < packages.size()) && (packages.at(i)->id == id); ++i) {
+            const QString &packageArchitecture = packages.at(i)->architecture;
+            if (packageArchitecture == architecture)
+                exact = i;
+            else if (packageArchitecture.isEmpty())
+                fallback = i;
+        }
+        if (exact >= 0)
+            bucket.append(exact);
+        else if ((fallback >= 0) && !architecture.isEmpty())
+            bucket.append(fallback);
+    }
+    return *byArchitecture.insert(architecture, bucket);
+}
+
 void PSPackagesPrivate::scanRemoves()
 {
     int fileCount = 0;
@@ -444,6 +668,7 @@ void PSPackagesPrivate::scanPackages()
             }
 
             packages[id][architecture] = scannedSp.release();
+            invalidateCatalog();
 
             colorOut() << ColorPrint::green << " + adding   " << ColorPrint::bcyan << id
                        << ColorPrint::reset << " [" << architectureOrAll << "]";
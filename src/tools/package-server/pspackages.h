@@ -41,6 +41,9 @@ public:
 
     PSPackage *scan(const QString &filePath);
     QList<PSPackage *> byArchitecture(const QString &architecture) const;
+    QList<PSPackage *> catalog(const QString &architecture, const QString &category,
+                               const QString &filter) const;
+    quint64 catalogRevision() const;
     PSPackage *byIdAndArchitecture(const QString &id, const QString &architecture) const;
 
     enum class UploadResult {
@@ -51,6 +54,7 @@ public:
 
     std::pair<UploadResult, PSPackage *> upload(const QString &filePath);
     void storeSign(PSPackage *sp, const QString &hardwareId, QIODevice *destination);
+    std::pair<QString, QByteArray> cachedStoreSign(PSPackage *sp, const QString &hardwareId);
     int removeIf(const std::function<bool (PSPackage *)> &pred);
 
 private:
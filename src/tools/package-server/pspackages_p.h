@@ -6,6 +6,7 @@
 
 #include <memory>
 #include <QMap>
+#include <QHash>
 #include <QLockFile>
 #include "psconfiguration.h"
 
@@ -14,18 +15,38 @@ class PSPackages;
 class PSPackage;
 
 
+class PSCatalog
+{
+public:
+    QList<PSPackage *> packages; // sorted by id, then by architecture
+    QHash<QString, QList<int>> byCategory; // sorted indices into packages
+    QHash<QString, QList<int>> byNameTrigram; // sorted indices into packages
+    QHash<QString, QList<int>> byArchitecture; // filled on demand, as it depends on the fallback
+
+    const QList<int> &architectureBucket(const QString &architecture);
+};
+
+
 class PSPackagesPrivate
 {
 public:
     void scanPackages();
     void scanUploads();
     void scanRemoves();
+    void setupStoreSignCache();
+    void removeFromStoreSignCache(const PSPackage *sp);
+    void invalidateCatalog();
+    PSCatalog *ensureCatalog();
 
     PSPackages *q = nullptr;
     PSConfiguration *cfg = nullptr;
     QMap<QString, QMap<QString, PSPackage *>> packages; // by-id, by-architecture
     std::unique_ptr<QLockFile> lockFile;
     QByteArray lockFilePath; // for the signal handler
+    QString storeSignCacheDirectory;
+    QHash<QString, QByteArray> storeSignCacheSha1; // by-file-name
+    std::unique_ptr<PSCatalog> catalog;
+    quint64 catalogRevision = 0;
 };
 
 #endif // PSPACKAGES_P_H
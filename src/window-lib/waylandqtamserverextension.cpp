@@ -7,17 +7,20 @@
 
 #include <QDataStream>
 #include <QCborValue>
+#include <QCborMap>
 #include <QtWaylandCompositor/QWaylandCompositor>
 #include <QtWaylandCompositor/QWaylandResource>
 #include <QtWaylandCompositor/QWaylandSurface>
 
 #include <QtAppManCommon/logging.h>
 
+#include <utility>
+
 QT_BEGIN_NAMESPACE_AM
 
 WaylandQtAMServerExtension::WaylandQtAMServerExtension(QWaylandCompositor *compositor)
     : QWaylandCompositorExtensionTemplate(compositor)
-    , QtWaylandServer::qtam_extension(compositor->display(), 2)
+    , QtWaylandServer::qtam_extension(compositor->display(), 3)
 { }
 
 QVariantMap WaylandQtAMServerExtension::windowProperties(const QWaylandSurface *surface) const
@@ -29,8 +32,18 @@ void WaylandQtAMServerExtension::setWindowProperty(QWaylandSurface *surface, con
 {
     if (setWindowPropertyHelper(surface, name, value)) {
         if (Resource *target = resourceMap().value(surface->waylandClient())) {
-            QByteArray data;
+            if (target->version() >= 3) {
+                // coalesce all changes within this event loop iteration into a single event
+                m_pendingWindowProperties[surface].insert(name, value);
+                if (!m_sendScheduled) {
+                    m_sendScheduled = true;
+                    QMetaObject::invokeMethod(this, &WaylandQtAMServerExtension::sendPendingWindowProperties,
+                                              Qt::QueuedConnection);
+                }
+                return;
+            }
 
+            QByteArray data;
             switch (target->version()) {
             case 1: {
                 QDataStream ds(&data, QDataStream::WriteOnly);
@@ -51,6 +64,21 @@ void WaylandQtAMServerExtension::setWindowProperty(QWaylandSurface *surface, con
     }
 }
 
+void WaylandQtAMServerExtension::sendPendingWindowProperties()
+{
+    m_sendScheduled = false;
+    const auto pending = std::exchange(m_pendingWindowProperties, { });
+
+    for (auto it = pending.cbegin(); it != pending.cend(); ++it) {
+        QWaylandSurface *surface = it.key();
+        if (Resource *target = resourceMap().value(surface->waylandClient())) {
+            qCDebug(LogWayland) << "window properties: server send" << surface << it.value();
+            send_window_properties_changed(target->handle, surface->resource(),
+                                           QCborValue::fromVariant(it.value()).toCbor());
+        }
+    }
+}
+
 bool WaylandQtAMServerExtension::setWindowPropertyHelper(QWaylandSurface *surface, const QString &name, const QVariant &value)
 {
     auto it = m_windowProperties.find(surface);
@@ -59,6 +87,7 @@ bool WaylandQtAMServerExtension::setWindowPropertyHelper(QWaylandSurface *surfac
             m_windowProperties[surface].insert(name, value);
             connect(surface, &QWaylandSurface::surfaceDestroyed, this, [this, surface]() {
                 m_windowProperties.remove(surface);
+                m_pendingWindowProperties.remove(surface);
             });
         } else {
             it.value().insert(name, value);
@@ -92,6 +121,24 @@ void WaylandQtAMServerExtension::qtam_extension_set_window_property(QtWaylandSer
     setWindowPropertyHelper(surface, name, variantValue);
 }
 
+void WaylandQtAMServerExtension::qtam_extension_set_window_properties(QtWaylandServer::qtam_extension::Resource *resource, wl_resource *surface_resource, wl_array *properties)
+{
+    Q_UNUSED(resource)
+
+    QWaylandSurface *surface = QWaylandSurface::fromResource(surface_resource);
+    const auto data = QByteArray::fromRawData(static_cast<const char *>(properties->data), qsizetype(properties->size));
+    const QCborValue cbor = QCborValue::fromCbor(data);
+    if (!cbor.isMap()) {
+        qCWarning(LogWayland) << "Received invalid window properties from" << surface;
+        return;
+    }
+    const QVariantMap variantMap = cbor.toMap().toVariantMap();
+
+    qCDebug(LogWayland) << "window properties: server receive" << surface << variantMap;
+    for (auto it = variantMap.cbegin(); it != variantMap.cend(); ++it)
+        setWindowPropertyHelper(surface, it.key(), it.value());
+}
+
 QT_END_NAMESPACE_AM
 
 #include "moc_waylandqtamserverextension_p.cpp"
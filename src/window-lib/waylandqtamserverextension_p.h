@@ -8,6 +8,7 @@
 
 #include <QtWaylandCompositor/QWaylandCompositorExtensionTemplate>
 #include <QtCore/QVariant>
+#include <QtCore/QHash>
 #include "private/qwayland-server-qtam-extension.h"
 
 #include <QtAppManCommon/global.h>
@@ -44,9 +45,14 @@ Q_SIGNALS:
 
 private:
     bool setWindowPropertyHelper(QWaylandSurface *surface, const QString &name, const QVariant &value);
+    void sendPendingWindowProperties();
     void qtam_extension_set_window_property(Resource *resource, wl_resource *surface_resource, const QString &name, wl_array *value) override;
+    void qtam_extension_set_window_properties(Resource *resource, wl_resource *surface_resource, wl_array *properties) override;
 
     QMap<const QWaylandSurface *, QVariantMap> m_windowProperties;  // AXIVION Line Qt-QMapWithPointerKey: cleared on destroyed signal
+    // changes for version 3 clients, sent once per event loop iteration
+    QHash<QWaylandSurface *, QVariantMap> m_pendingWindowProperties; // cleared on destroyed signal
+    bool m_sendScheduled = false;
 };
 
 QT_END_NAMESPACE_AM
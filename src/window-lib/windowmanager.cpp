@@ -13,6 +13,9 @@
 #include <QMetaObject>
 #include <QThread>
 #include <QQmlComponent>
+#include <QImageWriter>
+#include <QTimer>
+#include <QFileInfo>
 #include <private/qabstractanimation_p.h>
 #include <QLocalServer>
 #include "global.h"
@@ -367,6 +370,9 @@ WindowManager::WindowManager(QQmlEngine *qmlEngine, const QString &waylandSocket
 
     d->qmlEngine = qmlEngine;
 
+    // leave some cores for rendering: screenshot encoding is never urgent
+    d->screenshotPool.setMaxThreadCount(std::max(1, QThread::idealThreadCount() / 2));
+
     qApp->installEventFilter(this);
 
     connect(AbstractRuntime::signaler(), &RuntimeSignaler::inProcessSurfaceItemReady,
@@ -527,12 +533,9 @@ Window *WindowManager::window(int index) const
 */
 QList<Window *> WindowManager::windowsOfApplication(const QString &id) const
 {
-    QList<Window *> result;
-    for (Window *window : std::as_const(d->windowsInModel)) {
-        if (window->application() && window->application()->id() == id)
-            result << window;
-    }
-    return result;
+    if (id.isEmpty())
+        return { };
+    return d->windowsInModelByApplication.value(id);
 }
 
 /*!
@@ -543,7 +546,7 @@ QList<Window *> WindowManager::windowsOfApplication(const QString &id) const
  */
 int WindowManager::indexOfWindow(Window *window) const
 {
-    return int(d->windowsInModel.indexOf(window));
+    return d->modelRowOfWindow.value(window, -1);
 }
 
 /*!
@@ -614,11 +617,24 @@ void WindowManager::setupInProcessRuntime(AbstractRuntime *runtime)
 */
 void WindowManager::releaseWindow(Window *window)
 {
-    auto index = d->allWindows.indexOf(window);
-    if (index == -1)
+    if (!d->allWindows.remove(window))
         return;
 
-    d->allWindows.removeAt(index);
+    if (window->isInProcess()) {
+        if (auto rootItem = static_cast<InProcessWindow *>(window)->rootItem()) {
+            if (d->windowsBySurfaceItem.value(rootItem) == window)
+                d->windowsBySurfaceItem.remove(rootItem);
+        }
+    } else {
+#if QT_CONFIG(am_multi_process)
+        // a destroyed surface has already been removed from the index
+        auto windowSurface = static_cast<WaylandWindow *>(window)->surface();
+        if (QWaylandSurface *surface = windowSurface ? windowSurface->surface() : nullptr) {
+            if (d->windowsByWaylandSurface.value(surface) == window)
+                d->windowsByWaylandSurface.remove(surface);
+        }
+#endif
+    }
 
     disconnect(window, nullptr, this, nullptr);
 
@@ -633,8 +649,13 @@ void WindowManager::releaseWindow(Window *window)
  */
 void WindowManager::addWindow(Window *window)
 {
-    beginInsertRows(QModelIndex(), count(), count());
+    const int row = count();
+    beginInsertRows(QModelIndex(), row, row);
     d->windowsInModel << window;
+    d->modelRowOfWindow.insert(window, row);
+    const QString appId = d->applicationIdOfWindow(window);
+    if (!appId.isEmpty())
+        d->windowsInModelByApplication[appId] << window;
     endInsertRows();
     emit countChanged();
     emit windowAdded(window);
@@ -645,7 +666,7 @@ void WindowManager::addWindow(Window *window)
  */
 void WindowManager::removeWindow(Window *window)
 {
-    qsizetype index = d->windowsInModel.indexOf(window);
+    int index = indexOfWindow(window);
     if (index < 0)
         return;
 
@@ -657,8 +678,20 @@ void WindowManager::removeWindow(Window *window)
 
     emit windowAboutToBeRemoved(window);
 
-    beginRemoveRows(QModelIndex(), int(index), int(index));
+    beginRemoveRows(QModelIndex(), index, index);
     d->windowsInModel.removeAt(index);
+    d->modelRowOfWindow.remove(window);
+    for (int row = index; row < d->windowsInModel.size(); ++row)
+        d->modelRowOfWindow[d->windowsInModel.at(row)] = row;
+    const QString appId = d->applicationIdOfWindow(window);
+    if (!appId.isEmpty()) {
+        auto it = d->windowsInModelByApplication.find(appId);
+        if (it != d->windowsInModelByApplication.end()) {
+            it->removeOne(window);
+            if (it->isEmpty())
+                d->windowsInModelByApplication.erase(it);
+        }
+    }
     endRemoveRows();
     emit countChanged();
 }
@@ -740,13 +773,10 @@ void WindowManager::inProcessSurfaceItemCreated(AbstractRuntime *runtime,
     }
 
     //Only create a new Window if we don't have it already in the window list, as the user controls whether windows are removed or not
-    int index = d->findWindowBySurfaceItem(surfaceItem.data());
-    if (index == -1) {
-        setupWindow(new InProcessWindow(app, surfaceItem));
-    } else {
-        auto window = qobject_cast<InProcessWindow*>(d->allWindows.at(index));
+    if (auto window = qobject_cast<InProcessWindow *>(d->findWindowBySurfaceItem(surfaceItem.data())))
         window->setContentState(Window::SurfaceWithContent);
-    }
+    else
+        setupWindow(new InProcessWindow(app, surfaceItem));
 }
 
 /*! \internal
@@ -796,7 +826,26 @@ void WindowManager::setupWindow(Window *window)
         }
     }, Qt::QueuedConnection);
 
-    d->allWindows << window;
+    d->allWindows.insert(window);
+
+    if (window->isInProcess()) {
+        if (auto rootItem = static_cast<InProcessWindow *>(window)->rootItem())
+            d->windowsBySurfaceItem.insert(rootItem, window);
+    } else {
+#if QT_CONFIG(am_multi_process)
+        auto windowSurface = static_cast<WaylandWindow *>(window)->surface();
+        if (QWaylandSurface *surface = windowSurface ? windowSurface->surface() : nullptr) {
+            d->windowsByWaylandSurface.insert(surface, window);
+            // the surface pointer might get reused by the compositor, once it has been destroyed
+            connect(surface, &QWaylandSurface::surfaceDestroyed, this, [this, surface, window]() {
+                auto it = d->windowsByWaylandSurface.find(surface);
+                if ((it != d->windowsByWaylandSurface.end()) && (it.value() == window))
+                    d->windowsByWaylandSurface.erase(it);
+            });
+        }
+#endif
+    }
+
     addWindow(window);
 }
 
@@ -846,8 +895,7 @@ void WindowManager::waylandSurfaceMapped(WindowSurface *surface)
 
     // Only create a new Window if we don't have it already in the window list, as the user controls
     // whether windows are removed or not
-    int index = d->findWindowByWaylandSurface(surface->surface());
-    if (index == -1) {
+    if (!d->findWindowByWaylandSurface(surface->surface())) {
         WaylandWindow *w = new WaylandWindow(app, surface);
         setupWindow(w);
     }
@@ -868,7 +916,7 @@ void WindowManager::waylandSurfaceMapped(WindowSurface *surface)
 */
 
 /*!
-    \qmlmethod bool WindowManager::makeScreenshot(string filename, string selector)
+    \qmlmethod bool WindowManager::makeScreenshot(string filename, string selector, object options)
 
     Creates one or several screenshots depending on the \a selector, saving them to the files
     specified by \a filename.
@@ -913,13 +961,98 @@ void WindowManager::waylandSurfaceMapped(WindowSurface *surface)
     com.pelagicore.*[type=cluster]:1
     \endcode
 
-    Returns \c true on success and \c false otherwise.
+    The optional \a options map supports these keys:
+
+    \table
+    \header
+        \li Key
+        \li Description
+    \row
+        \li \c raw
+        \li If set to \c true, the images are written without compression. This is a lot faster
+            than the default, at the expense of much larger files. PNG files are stored
+            uncompressed, while all other formats use the fastest setting of their encoder.
+            This option has been available since 6.9.
+    \endtable
+
+    Only the grabbing of the images happens on the GUI thread: encoding and writing the files
+    is done on a pool of worker threads. The screenshotFinished signal is emitted once all
+    requested screenshots have been written. Window screenshots that could not be grabbed within
+    10 seconds (e.g. because the window is never rendered) are reported as failed.
+
+    Returns \c true if the \a selector matched at least one screen or window and \c false
+    otherwise. In the former case, screenshotFinished is always emitted, even if all the
+    screenshots failed.
 
     \note This call will be handled asynchronously, so even a positive return value does not mean
           that all screenshot images have been created already.
 */
-//TODO: either change return value to list of to-be-created filenames or add a 'finished' signal
+
+/*!
+    \qmlsignal WindowManager::screenshotFinished(string filename, string selector, bool success, list<string> files)
+    \since 6.9
+
+    This signal is emitted when all screenshots requested by a call to makeScreenshot() with
+    the given \a filename and \a selector have been written. The \a files list contains the
+    names of all the files that were actually created, while \a success is only \c true if no
+    screenshot failed.
+*/
 bool WindowManager::makeScreenshot(const QString &filename, const QString &selector)
+{
+    return makeScreenshot(filename, selector, { }, nullptr);
+}
+
+bool WindowManager::makeScreenshot(const QString &filename, const QString &selector,
+                                   const QVariantMap &options)
+{
+    return makeScreenshot(filename, selector, options, nullptr);
+}
+
+namespace {
+
+struct ScreenshotRequest
+{
+    QString filename;
+    QString selector;
+    bool raw = false;
+    WindowManager::ScreenshotCallback callback;
+
+    int pending = 0;
+    bool success = true;
+    QStringList files;
+    QList<QSharedPointer<const QQuickItemGrabResult>> grabbers;
+    QHash<const QQuickItemGrabResult *, QString> pendingGrabs; // grabber -> file name
+};
+
+// a grabber might never become ready, e.g. if its window is not rendered anymore
+constexpr std::chrono::milliseconds ScreenshotGrabTimeout { 10000 };
+
+// runs on the screenshot thread pool
+bool writeScreenshot(const QImage &image, const QString &fileName, bool raw)
+{
+    QImageWriter writer(fileName);
+    // the format is only deduced from the file name when writing, but we need it right now
+    if (writer.format().isEmpty())
+        writer.setFormat(QFileInfo(fileName).suffix().toLower().toLatin1());
+    if (raw) {
+        // the PNG writer maps quality 100 to zlib level 0, while other formats interpret the
+        // compression hint (0..100) with 0 being the fastest
+        if (writer.format() == "png")
+            writer.setQuality(100);
+        else
+            writer.setCompression(0);
+    }
+    if (!writer.write(image)) {
+        qCWarning(LogGraphics) << "Failed to write screenshot" << fileName << ":" << writer.errorString();
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool WindowManager::makeScreenshot(const QString &filename, const QString &selector,
+                                   const QVariantMap &options, const ScreenshotCallback &callback)
 {
     // filename:
     // %s -> screenId
@@ -966,24 +1099,61 @@ bool WindowManager::makeScreenshot(const QString &filename, const QString &selec
     QString attributeName = match.captured(3);
     QString attributeValue = match.captured(4);
 
-    // qWarning() << "Matching result:" << match.isValid();
-    // qWarning() << "  screen ...... :" << screenId;
-    // qWarning() << "  app ......... :" << appId;
-    // qWarning() << "  attributeName :" << attributeName;
-    // qWarning() << "  attributeValue:" << attributeValue;
+    auto request = QSharedPointer<ScreenshotRequest>::create();
+    request->filename = filename;
+    request->selector = selector;
+    request->raw = options.value(u"raw"_s).toBool();
+    request->callback = callback;
+    // this extra reference is dropped at the end of this function, so the request cannot finish
+    // while it is still being set up
+    request->pending = 1;
+    // failed grabs are finished right away, so pending cannot tell us whether anything matched
+    bool matched = false;
+
+    // always called on the GUI thread
+    auto finishOne = [this, request](const QString &saveTo, bool ok) {
+        if (!saveTo.isEmpty()) {
+            if (ok)
+                request->files << saveTo;
+            else
+                request->success = false;
+        }
 
-    bool result = true;
-    bool foundAtLeastOne = false;
+        if (--request->pending == 0) {
+            emit screenshotFinished(request->filename, request->selector, request->success,
+                                    request->files);
+            if (request->callback)
+                request->callback(request->success, request->files);
+        }
+    };
+
+    auto encode = [this, request, finishOne](const QImage &image, const QString &saveTo) {
+        if (image.isNull()) {
+            finishOne(saveTo, false);
+            return;
+        }
+        // the worker must not hold a reference to the request: the last reference would
+        // otherwise be dropped on the worker thread and with it the QQuickItemGrabResults
+        auto done = new std::function<void(bool)>([finishOne, saveTo](bool ok) {
+            finishOne(saveTo, ok);
+        });
+        d->screenshotPool.start([this, raw = request->raw, image, saveTo, done]() {
+            bool ok = writeScreenshot(image, saveTo, raw);
+            QMetaObject::invokeMethod(this, [done, ok]() {
+                (*done)(ok);
+                delete done;
+            }, Qt::QueuedConnection);
+        });
+    };
 
     if (appId.isEmpty() && attributeName.isEmpty()) {
         // fullscreen screenshot
 
         for (int i = 0; i < d->views.count(); ++i) {
             if (screenId.isEmpty() || screenId.toInt() == i) {
-                QImage img = d->views.at(i)->grabWindow();
-
-                foundAtLeastOne = true;
-                result &= img.save(substituteFilename(QString::number(i), QString()));
+                matched = true;
+                ++request->pending;
+                encode(d->views.at(i)->grabWindow(), substituteFilename(QString::number(i), QString()));
             }
         }
     } else {
@@ -995,8 +1165,6 @@ bool WindowManager::makeScreenshot(const QString &filename, const QString &selec
             return app->isAlias() || (!appId.isEmpty() && (appId != app->id()));
         });
 
-        auto grabbers = new QList<QSharedPointer<const QQuickItemGrabResult>>;
-
         for (const Window *w : std::as_const(d->windowsInModel)) {
             if (apps.contains(w->application())) {
                 if (attributeName.isEmpty()
@@ -1005,8 +1173,6 @@ bool WindowManager::makeScreenshot(const QString &filename, const QString &selec
                         if (screenId.isEmpty() || screenId.toInt() == i) {
                             QQuickWindow *view = d->views.at(i);
 
-                            bool onScreen = false;
-
                             auto itemList = w->items().values();
                             if (itemList.count() == 0)
                                 continue;
@@ -1014,44 +1180,72 @@ bool WindowManager::makeScreenshot(const QString &filename, const QString &selec
                             // grab the first view - they all have the same content anyway
                             WindowItem *windowItem = itemList.first();
 
-                            onScreen = windowItem->QQuickItem::window() == view;
-
-                            if (onScreen) {
-                                foundAtLeastOne = true;
-                                QSharedPointer<const QQuickItemGrabResult> grabber = windowItem->grabToImage();
-
-                                if (!grabber) {
-                                    result = false;
-                                    continue;
-                                }
+                            if (windowItem->QQuickItem::window() != view)
+                                continue;
 
-                                QString saveTo = substituteFilename(QString::number(i), w->application()->id());
-                                grabbers->append(grabber);
-                                connect(grabber.data(), &QQuickItemGrabResult::ready, this, [grabbers, grabber, saveTo]() {
-                                    grabber->saveToFile(saveTo);
-                                    grabbers->removeOne(grabber);
-                                    if (grabbers->isEmpty())
-                                        delete grabbers;
-                                });
+                            QString saveTo = substituteFilename(QString::number(i), w->application()->id());
+                            matched = true;
+                            ++request->pending;
 
+                            QSharedPointer<const QQuickItemGrabResult> grabber = windowItem->grabToImage();
+                            if (!grabber) {
+                                finishOne(saveTo, false);
+                                continue;
                             }
+
+                            // the grabber has to be kept alive until it is ready
+                            request->grabbers.append(grabber);
+                            const QQuickItemGrabResult *grabberPtr = grabber.data();
+                            request->pendingGrabs.insert(grabberPtr, saveTo);
+                            connect(grabberPtr, &QQuickItemGrabResult::ready, this,
+                                    [this, request, grabberPtr, saveTo, encode]() {
+                                if (!request->pendingGrabs.remove(grabberPtr))
+                                    return; // already timed out
+                                encode(grabberPtr->image(), saveTo);
+                                // we cannot delete the grabber while it is emitting this signal
+                                QMetaObject::invokeMethod(this, [request, grabberPtr]() {
+                                    request->grabbers.removeIf([grabberPtr](const auto &g) {
+                                        return g.data() == grabberPtr;
+                                    });
+                                }, Qt::QueuedConnection);
+                            });
                         }
                     }
                 }
             }
         }
     }
-    return foundAtLeastOne && result;
+
+    if (!matched) {
+        // nothing matched the selector
+        return false;
+    }
+
+    if (!request->pendingGrabs.isEmpty()) {
+        // make sure that the callback (e.g. a delayed D-Bus reply) is always called
+        QTimer::singleShot(ScreenshotGrabTimeout, this, [request, finishOne]() {
+            const auto pendingGrabs = std::exchange(request->pendingGrabs, { });
+            for (const QString &saveTo : pendingGrabs) {
+                qCWarning(LogGraphics) << "Timed out while grabbing the window content for screenshot"
+                                       << saveTo;
+                finishOne(saveTo, false);
+            }
+            // also breaks the reference cycle between the grabbers' connections and the request
+            request->grabbers.clear();
+        });
+    }
+    finishOne({ }, true);  // drop the setup reference
+    return true;
 }
 
-int WindowManagerPrivate::findWindowBySurfaceItem(QQuickItem *quickItem) const
+Window *WindowManagerPrivate::findWindowBySurfaceItem(QQuickItem *quickItem) const
 {
-    for (int i = 0; i < allWindows.count(); ++i) {
-        auto *window = allWindows.at(i);
-        if (window->isInProcess() && static_cast<InProcessWindow*>(window)->rootItem() == quickItem)
-            return i;
-    }
-    return -1;
+    return windowsBySurfaceItem.value(quickItem);
+}
+
+QString WindowManagerPrivate::applicationIdOfWindow(const Window *window)
+{
+    return window->application() ? window->application()->id() : QString { };
 }
 
 QList<QQuickWindow *> WindowManager::compositorViews() const
@@ -1061,19 +1255,9 @@ QList<QQuickWindow *> WindowManager::compositorViews() const
 
 #if QT_CONFIG(am_multi_process)
 
-int WindowManagerPrivate::findWindowByWaylandSurface(QWaylandSurface *waylandSurface) const
+Window *WindowManagerPrivate::findWindowByWaylandSurface(QWaylandSurface *waylandSurface) const
 {
-    for (int i = 0; i < allWindows.count(); ++i) {
-        auto *window = allWindows.at(i);
-
-        if (window->isInProcess())
-            continue;
-
-        auto windowSurface = static_cast<WaylandWindow*>(window)->surface();
-        if (windowSurface && windowSurface->surface() == waylandSurface)
-            return i;
-    }
-    return -1;
+    return windowsByWaylandSurface.value(waylandSurface);
 }
 
 QString WindowManagerPrivate::applicationId(Application *app, WindowSurface *windowSurface)
@@ -8,6 +8,7 @@
 
 #include <QtCore/QAbstractListModel>
 #include <QtAppManCommon/global.h>
+#include <functional>
 
 
 #if QT_CONFIG(am_multi_process)
@@ -101,12 +102,22 @@ Q_SIGNALS:
 
     void windowPropertyChanged(QtAM::Window *window, const QString &name, const QVariant &value);
 
+    void screenshotFinished(const QString &filename, const QString &selector, bool success,
+                            const QStringList &files);
+
 public:
     void inProcessSurfaceItemCreated(QtAM::AbstractRuntime *runtime,
                                      QSharedPointer<QtAM::InProcessSurfaceItem> surfaceItem);
     void setupWindow(QtAM::Window *window);
 
     Q_SCRIPTABLE bool makeScreenshot(const QString &filename, const QString &selector);
+    Q_INVOKABLE bool makeScreenshot(const QString &filename, const QString &selector,
+                                    const QVariantMap &options);
+
+    // the callback is called exactly once, if this function returns true
+    using ScreenshotCallback = std::function<void(bool success, const QStringList &files)>;
+    bool makeScreenshot(const QString &filename, const QString &selector, const QVariantMap &options,
+                        const ScreenshotCallback &callback);
 
     QList<QQuickWindow *> compositorViews() const;
 
@@ -9,6 +9,8 @@
 #include <QVector>
 #include <QMap>
 #include <QHash>
+#include <QSet>
+#include <QThreadPool>
 
 #include <QtAppManWindow/windowmanager.h>
 
@@ -19,10 +21,11 @@ QT_BEGIN_NAMESPACE_AM
 class WindowManagerPrivate
 {
 public:
-    int findWindowBySurfaceItem(QQuickItem *quickItem) const;
+    Window *findWindowBySurfaceItem(QQuickItem *quickItem) const;
+    static QString applicationIdOfWindow(const Window *window);
 
 #if QT_CONFIG(am_multi_process)
-    int findWindowByWaylandSurface(QWaylandSurface *waylandSurface) const;
+    Window *findWindowByWaylandSurface(QWaylandSurface *waylandSurface) const;
 
     WaylandCompositor *waylandCompositor = nullptr;
     QVector<int> extraWaylandSockets;
@@ -38,18 +41,32 @@ public:
     QHash<int, QByteArray> roleNames;
 
     // All windows, regardless of content state, that haven't been released (hence destroyed) yet.
-    QVector<Window *> allWindows;
+    QSet<Window *> allWindows;
+
+    // Lookup indices for allWindows, maintained by setupWindow() and releaseWindow().
+    QHash<const QQuickItem *, Window *> windowsBySurfaceItem;
+#if QT_CONFIG(am_multi_process)
+    QHash<const QWaylandSurface *, Window *> windowsByWaylandSurface; // cleared on surfaceDestroyed
+#endif
 
     // Windows that are actually exposed by the model to the QML side.
     // Only windows whose content state is different than Window::NoSurface are
     // kept here.
     QVector<Window *> windowsInModel;
+
+    // Lookup indices for windowsInModel, maintained by addWindow() and removeWindow().
+    // The per-application lists are kept in model order.
+    QHash<const Window *, int> modelRowOfWindow;
+    QHash<QString, QVector<Window *>> windowsInModelByApplication;
     bool aboutToBeRemoved = false;
 
     bool shuttingDown = false;
     bool slowAnimations = false;
     bool allowUnknownUiClients = false;
 
+    // encodes and writes screenshots off the GUI thread
+    QThreadPool screenshotPool;
+
     QList<QQuickWindow *> views;
     QString waylandSocketName;
     QQmlEngine *qmlEngine = nullptr;
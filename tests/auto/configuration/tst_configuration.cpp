@@ -73,6 +73,7 @@ void tst_Configuration::defaultConfig()
     QCOMPARE(c.yaml.applications.documentDir, u""_s);
 
     QCOMPARE(c.yaml.applications.installationDir, u""_s);
+    QCOMPARE(c.yaml.applications.watchPackageDirectories, false);
     QCOMPARE(c.yaml.intents.timeouts.disambiguation.count(), 10000);
     QCOMPARE(c.yaml.intents.timeouts.startApplication.count(), 3000);
     QCOMPARE(c.yaml.intents.timeouts.replyFromApplication.count(), 5000);
@@ -92,6 +93,9 @@ void tst_Configuration::defaultConfig()
     QCOMPARE(c.yaml.logging.rules, {});
     QCOMPARE(c.yaml.logging.messagePattern, u""_s);
     QCOMPARE(c.yaml.logging.useAMConsoleLogger, QVariant());
+    QCOMPARE(c.yaml.logging.asyncOutput.enabled, false);
+    QCOMPARE(c.yaml.logging.asyncOutput.queueSize, 1024);
+    QCOMPARE(c.yaml.logging.asyncOutput.overflowPolicy, u""_s);
     QCOMPARE(c.yaml.ui.style, u""_s);
     QCOMPARE(c.yaml.ui.iconThemeName, u""_s);
     QCOMPARE(c.yaml.ui.iconThemeSearchPaths, {});
@@ -115,6 +119,9 @@ void tst_Configuration::defaultConfig()
 
     QCOMPARE(c.yaml.quicklaunch.idleLoad, qreal(0));
     QVERIFY(c.yaml.quicklaunch.runtimesPerContainer.isEmpty());
+    QCOMPARE(c.yaml.quicklaunch.adaptivePoolSize, false);
+    QCOMPARE(c.yaml.quicklaunch.memoryBudget, 0);
+    QCOMPARE(c.yaml.quicklaunch.preloadApplications, false);
 
     QCOMPARE(c.yaml.wayland.socketName, u""_s);
     QVERIFY(c.yaml.wayland.extraSockets.isEmpty());
@@ -127,6 +134,9 @@ void tst_Configuration::defaultConfig()
     QCOMPARE(c.yaml.crashAction.stackFramesToIgnore.onException, -1);
 
     QCOMPARE(c.yaml.installer.caCertificates, {});
+    QCOMPARE(c.yaml.installer.maximumConcurrentInstallations, 1);
+    QCOMPARE(c.yaml.installer.downloadRateLimit, 0);
+    QCOMPARE(c.yaml.installer.diskWriteRateLimit, 0);
 
     QCOMPARE(c.yaml.plugins.container, {});
     QCOMPARE(c.yaml.plugins.startup, {});
@@ -164,6 +174,7 @@ void tst_Configuration::simpleConfig()
     QCOMPARE(c.yaml.applications.documentDir, u"doc-dir"_s);
 
     QCOMPARE(c.yaml.applications.installationDir, u"installation-dir"_s);
+    QCOMPARE(c.yaml.applications.watchPackageDirectories, true);
     QCOMPARE(c.yaml.intents.timeouts.disambiguation.count(), 1);
     QCOMPARE(c.yaml.intents.timeouts.startApplication.count(), 2);
     QCOMPARE(c.yaml.intents.timeouts.replyFromApplication.count(), 3);
@@ -183,6 +194,9 @@ void tst_Configuration::simpleConfig()
     QCOMPARE(c.yaml.logging.rules, QStringList({ u"lr1"_s, u"lr2"_s }));
     QCOMPARE(c.yaml.logging.messagePattern, u"msgPattern"_s);
     QCOMPARE(c.yaml.logging.useAMConsoleLogger, QVariant(true));
+    QCOMPARE(c.yaml.logging.asyncOutput.enabled, true);
+    QCOMPARE(c.yaml.logging.asyncOutput.queueSize, 256);
+    QCOMPARE(c.yaml.logging.asyncOutput.overflowPolicy, u"block"_s);
     QCOMPARE(c.yaml.ui.style, u"mystyle"_s);
     QCOMPARE(c.yaml.ui.iconThemeName, u"mytheme"_s);
     QCOMPARE(c.yaml.ui.iconThemeSearchPaths, QStringList({ u"itsp1"_s, u"itsp2"_s }));
@@ -233,6 +247,9 @@ void tst_Configuration::simpleConfig()
     QCOMPARE(c.yaml.quicklaunch.runtimesPerContainer, rpc);
     QCOMPARE(c.yaml.quicklaunch.failedStartLimit, 42);
     QCOMPARE(c.yaml.quicklaunch.failedStartLimitIntervalSec.count(), 43);
+    QCOMPARE(c.yaml.quicklaunch.adaptivePoolSize, true);
+    QCOMPARE(c.yaml.quicklaunch.memoryBudget, 256);
+    QCOMPARE(c.yaml.quicklaunch.preloadApplications, true);
 
     QCOMPARE(c.yaml.wayland.socketName, u"my-wlsock-42"_s);
 
@@ -250,6 +267,9 @@ void tst_Configuration::simpleConfig()
     QCOMPARE(c.yaml.crashAction.stackFramesToIgnore.onException, -1);
 
     QCOMPARE(c.yaml.installer.caCertificates, QStringList({ u"cert1"_s, u"cert2"_s }));
+    QCOMPARE(c.yaml.installer.maximumConcurrentInstallations, 4);
+    QCOMPARE(c.yaml.installer.downloadRateLimit, 1000000);
+    QCOMPARE(c.yaml.installer.diskWriteRateLimit, 2000000);
 
     QCOMPARE(c.yaml.plugins.startup, QStringList({ u"s1"_s, u"s2"_s }));
     QCOMPARE(c.yaml.plugins.container, QStringList({ u"c1"_s, u"c2"_s }));
@@ -287,6 +307,7 @@ void tst_Configuration::mergedConfig()
     QCOMPARE(c.yaml.applications.documentDir, u"doc-dir2"_s);
 
     QCOMPARE(c.yaml.applications.installationDir, u"installation-dir2"_s);
+    QCOMPARE(c.yaml.applications.watchPackageDirectories, true);
     QCOMPARE(c.yaml.intents.timeouts.disambiguation.count(), 5);
     QCOMPARE(c.yaml.intents.timeouts.startApplication.count(), 6);
     QCOMPARE(c.yaml.intents.timeouts.replyFromApplication.count(), 7);
@@ -309,6 +330,9 @@ void tst_Configuration::mergedConfig()
     QCOMPARE(c.yaml.logging.rules, QStringList({ u"lr1"_s, u"lr2"_s, u"lr3"_s }));
     QCOMPARE(c.yaml.logging.messagePattern, u"msgPattern2"_s);
     QCOMPARE(c.yaml.logging.useAMConsoleLogger, true);
+    QCOMPARE(c.yaml.logging.asyncOutput.enabled, true);
+    QCOMPARE(c.yaml.logging.asyncOutput.queueSize, 256);
+    QCOMPARE(c.yaml.logging.asyncOutput.overflowPolicy, u"block"_s);
     QCOMPARE(c.yaml.ui.style, u"mystyle2"_s);
     QCOMPARE(c.yaml.ui.iconThemeName, u"mytheme2"_s);
     QCOMPARE(c.yaml.ui.iconThemeSearchPaths, QStringList({ u"itsp1"_s, u"itsp2"_s, u"itsp3"_s }));
@@ -382,6 +406,9 @@ void tst_Configuration::mergedConfig()
     QCOMPARE(c.yaml.quicklaunch.runtimesPerContainer, rpc);
     QCOMPARE(c.yaml.quicklaunch.failedStartLimit, 44);
     QCOMPARE(c.yaml.quicklaunch.failedStartLimitIntervalSec.count(), 45);
+    QCOMPARE(c.yaml.quicklaunch.adaptivePoolSize, true);
+    QCOMPARE(c.yaml.quicklaunch.memoryBudget, 256);
+    QCOMPARE(c.yaml.quicklaunch.preloadApplications, true);
 
     QCOMPARE(c.yaml.wayland.socketName, u"other-wlsock-0"_s);
 
@@ -399,6 +426,9 @@ void tst_Configuration::mergedConfig()
     QCOMPARE(c.yaml.crashAction.stackFramesToIgnore.onException, -1);
 
     QCOMPARE(c.yaml.installer.caCertificates, QStringList({ u"cert1"_s, u"cert2"_s, u"cert3"_s }));
+    QCOMPARE(c.yaml.installer.maximumConcurrentInstallations, 4);
+    QCOMPARE(c.yaml.installer.downloadRateLimit, 1000000);
+    QCOMPARE(c.yaml.installer.diskWriteRateLimit, 2000000);
 
     QCOMPARE(c.yaml.plugins.container, QStringList({ u"c1"_s, u"c2"_s, u"c3"_s, u"c4"_s }));
     QCOMPARE(c.yaml.plugins.startup, QStringList({ u"s1"_s, u"s2"_s, u"s3"_s }));
@@ -516,6 +546,9 @@ void tst_Configuration::commandLineConfig()
 
     QCOMPARE(c.yaml.quicklaunch.idleLoad, qreal(0));
     QVERIFY(c.yaml.quicklaunch.runtimesPerContainer.isEmpty());
+    QCOMPARE(c.yaml.quicklaunch.adaptivePoolSize, false);
+    QCOMPARE(c.yaml.quicklaunch.memoryBudget, 0);
+    QCOMPARE(c.yaml.quicklaunch.preloadApplications, false);
 
     QCOMPARE(c.yaml.wayland.socketName, u""_s);
     QVERIFY(c.yaml.wayland.extraSockets.isEmpty());
@@ -528,6 +561,9 @@ void tst_Configuration::commandLineConfig()
     QCOMPARE(c.yaml.crashAction.stackFramesToIgnore.onException, -1);
 
     QCOMPARE(c.yaml.installer.caCertificates, {});
+    QCOMPARE(c.yaml.installer.maximumConcurrentInstallations, 1);
+    QCOMPARE(c.yaml.installer.downloadRateLimit, 0);
+    QCOMPARE(c.yaml.installer.diskWriteRateLimit, 0);
 
     QCOMPARE(c.yaml.plugins.container, {});
     QCOMPARE(c.yaml.plugins.startup, {});
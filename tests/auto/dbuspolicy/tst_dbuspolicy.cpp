@@ -0,0 +1,172 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtCore>
+#include <QtTest>
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusAbstractAdaptor>
+
+#include <unistd.h>
+
+#include "dbuspolicy.h"
+#include "dbuscontextadaptor.h"
+#include "dbusdaemon.h"
+#include "exception.h"
+
+using namespace Qt::StringLiterals;
+
+QT_USE_NAMESPACE_AM
+
+class TestAdaptor : public QDBusAbstractAdaptor
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "io.qt.test.DBusPolicy")
+
+public:
+    TestAdaptor(QObject *parent)
+        : QDBusAbstractAdaptor(parent)
+    { }
+
+public Q_SLOTS:
+    uint uidCall()
+    {
+        QT_AM_AUTHENTICATE_DBUS(uint)
+        return 42;
+    }
+    uint capabilitiesCall()
+    {
+        QT_AM_AUTHENTICATE_DBUS(uint)
+        return 42;
+    }
+};
+
+class tst_DBusPolicy : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_DBusPolicy() = default;
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void init();
+
+    void uidCached();
+    void capabilitiesCached();
+    void nameOwnerChanged();
+
+private:
+    QDBusMessage call(const QString &connectionName, const QString &method);
+
+    DBusContextAdaptor *m_contextAdaptor = nullptr;
+    bool m_identified = false;
+    int m_identifyCount = 0;
+};
+
+void tst_DBusPolicy::initTestCase()
+{
+    try {
+        DBusDaemonProcess::start();
+    } catch (const Exception &e) {
+        QSKIP(qPrintable(e.errorString()));
+    }
+    QVERIFY(QDBusConnection::sessionBus().isConnected());
+
+    auto policy = DBusPolicy::createInstance([this](qint64) {
+        ++m_identifyCount;
+        return m_identified ? QStringList { u"app"_s } : QStringList { };
+    }, [](const QString &) {
+        return QStringList { };
+    });
+
+    m_contextAdaptor = DBusContextAdaptor::create<TestAdaptor>(this);
+    QVERIFY(policy->add(m_contextAdaptor->generatedAdaptor<TestAdaptor>(), QVariantMap {
+        { u"uidCall"_s, QVariantMap { { u"uids"_s, QVariantList { ::getuid() + 1 } } } },
+        { u"capabilitiesCall"_s, QVariantMap { { u"capabilities"_s, QVariantList { u"cap"_s } } } },
+    }));
+    QVERIFY(m_contextAdaptor->registerOnDBus(QDBusConnection::sessionBus(), u"/Test"_s));
+}
+
+void tst_DBusPolicy::cleanupTestCase()
+{
+    delete DBusPolicy::instance();
+}
+
+void tst_DBusPolicy::init()
+{
+    DBusPolicy::instance()->clearCredentialCache();
+    m_identified = false;
+    m_identifyCount = 0;
+}
+
+QDBusMessage tst_DBusPolicy::call(const QString &connectionName, const QString &method)
+{
+    auto connection = QDBusConnection::connectToBus(QDBusConnection::SessionBus, connectionName);
+    auto message = QDBusMessage::createMethodCall(QDBusConnection::sessionBus().baseService(),
+                                                  u"/Test"_s, u"io.qt.test.DBusPolicy"_s, method);
+    // the service lives in this thread, so we need to keep the event loop running
+    return connection.call(message, QDBus::BlockWithGui);
+}
+
+void tst_DBusPolicy::uidCached()
+{
+    const auto *policy = DBusPolicy::instance();
+    const quint64 hits = policy->credentialCacheHits();
+    const quint64 misses = policy->credentialCacheMisses();
+
+    for (int i = 0; i < 3; ++i) {
+        const QDBusMessage reply = call(u"client"_s, u"uidCall"_s);
+        QCOMPARE(reply.type(), QDBusMessage::ReplyMessage);
+        QCOMPARE(reply.arguments().value(0).toUInt(), 42U);
+    }
+    // only the first call has to ask the bus daemon
+    QCOMPARE(policy->credentialCacheMisses() - misses, quint64(1));
+    QCOMPARE(policy->credentialCacheHits() - hits, quint64(2));
+    QCOMPARE(policy->credentialCacheSize(), qsizetype(1));
+}
+
+void tst_DBusPolicy::capabilitiesCached()
+{
+    auto *policy = DBusPolicy::instance();
+
+    auto checkDenied = [this](int identifyCount) {
+        const QDBusMessage reply = call(u"client"_s, u"capabilitiesCall"_s);
+        QCOMPARE(reply.type(), QDBusMessage::ErrorMessage);
+        QCOMPARE(reply.errorName(), u"org.freedesktop.DBus.Error.AccessDenied"_s);
+        QCOMPARE(m_identifyCount, identifyCount);
+    };
+
+    // not yet identified (e.g. a quick-launcher): nothing is remembered
+    checkDenied(1);
+    checkDenied(2);
+
+    // identified: the capabilities are only looked up once
+    m_identified = true;
+    checkDenied(3);
+    checkDenied(3);
+
+    policy->invalidateApplication(u"other"_s);
+    checkDenied(3);
+
+    // the application got updated or removed
+    policy->invalidateApplication(u"app"_s);
+    checkDenied(4);
+    checkDenied(4);
+}
+
+void tst_DBusPolicy::nameOwnerChanged()
+{
+    const auto *policy = DBusPolicy::instance();
+
+    QCOMPARE(call(u"disconnecting-client"_s, u"uidCall"_s).type(), QDBusMessage::ReplyMessage);
+    QCOMPARE(policy->credentialCacheSize(), qsizetype(1));
+
+    QDBusConnection::disconnectFromBus(u"disconnecting-client"_s);
+    QTRY_COMPARE(policy->credentialCacheSize(), qsizetype(0));
+}
+
+QTEST_GUILESS_MAIN(tst_DBusPolicy)
+
+#include "tst_dbuspolicy.moc"
@@ -0,0 +1,268 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtCore>
+#include <QtTest>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "asynclogwriter.h"
+
+using namespace Qt::StringLiterals;
+using namespace std::chrono_literals;
+
+QT_USE_NAMESPACE_AM
+
+class tst_Logging : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_Logging() = default;
+
+private Q_SLOTS:
+    void init();
+    void cleanup();
+
+    void asyncQueueSize_data();
+    void asyncQueueSize();
+    void asyncOrder();
+    void asyncFlush();
+    void asyncFlushTimeout();
+    void asyncDrop();
+    void asyncBlock();
+
+private:
+    // fills the pipe, so that the writer thread blocks in writev() until we start reading
+    qsizetype fillPipe();
+    void startReader();
+    QByteArray stopReader();
+
+    int m_pipe[2] = { -1, -1 };
+    std::thread m_reader;
+    QByteArray m_output;
+};
+
+void tst_Logging::init()
+{
+    QVERIFY(::pipe(m_pipe) == 0);
+    m_output.clear();
+}
+
+void tst_Logging::cleanup()
+{
+    if (m_reader.joinable()) {
+        ::close(m_pipe[1]);
+        m_pipe[1] = -1;
+        m_reader.join();
+    }
+    for (int &fd : m_pipe) {
+        if (fd >= 0)
+            ::close(fd);
+        fd = -1;
+    }
+}
+
+qsizetype tst_Logging::fillPipe()
+{
+    const int flags = ::fcntl(m_pipe[1], F_GETFL);
+    ::fcntl(m_pipe[1], F_SETFL, flags | O_NONBLOCK);
+    const QByteArray chunk(4096, '#');
+    qsizetype filled = 0;
+    // writes up to PIPE_BUF are atomic, so we have to fill up the rest byte by byte
+    for (size_t chunkSize : { size_t(chunk.size()), size_t(1) }) {
+        while (true) {
+            const auto written = ::write(m_pipe[1], chunk.constData(), chunkSize);
+            if (written <= 0)
+                break;
+            filled += written;
+        }
+    }
+    ::fcntl(m_pipe[1], F_SETFL, flags);
+    return filled;
+}
+
+void tst_Logging::startReader()
+{
+    m_reader = std::thread([this]() {
+        char buffer[4096];
+        while (true) {
+            const auto bytesRead = ::read(m_pipe[0], buffer, sizeof(buffer));
+            if (bytesRead > 0)
+                m_output.append(buffer, bytesRead);
+            else if ((bytesRead == 0) || (errno != EINTR))
+                break;
+        }
+    });
+}
+
+QByteArray tst_Logging::stopReader()
+{
+    ::close(m_pipe[1]);
+    m_pipe[1] = -1;
+    m_reader.join();
+    return m_output;
+}
+
+static QByteArray record(int i)
+{
+    return "record " + QByteArray::number(i) + '\n';
+}
+
+static QByteArray records(int from, int to)
+{
+    QByteArray result;
+    for (int i = from; i < to; ++i)
+        result.append(record(i));
+    return result;
+}
+
+void tst_Logging::asyncQueueSize_data()
+{
+    QTest::addColumn<int>("requested");
+    QTest::addColumn<int>("actual");
+
+    QTest::newRow("min") << 0 << 2;
+    QTest::newRow("pow2") << 64 << 64;
+    QTest::newRow("round-up") << 100 << 128;
+    QTest::newRow("max") << (1 << 24) << (1 << 20);
+}
+
+void tst_Logging::asyncQueueSize()
+{
+    QFETCH(int, requested);
+    QFETCH(int, actual);
+
+    AsyncLogWriter writer(m_pipe[1], requested, AsyncLogWriter::Drop);
+    QCOMPARE(writer.queueSize(), actual);
+    QCOMPARE(writer.overflowPolicy(), AsyncLogWriter::Drop);
+}
+
+void tst_Logging::asyncOrder()
+{
+    startReader();
+    {
+        // more records than slots, posted from a single thread: the ring wraps around many times
+        AsyncLogWriter writer(m_pipe[1], 8, AsyncLogWriter::Block);
+        for (int i = 0; i < 1000; ++i) {
+            QByteArray ba = record(i);
+            writer.post(ba);
+        }
+    } // the destructor writes everything that is still queued
+    QCOMPARE(stopReader(), records(0, 1000));
+}
+
+void tst_Logging::asyncFlush()
+{
+    AsyncLogWriter writer(m_pipe[1], 16, AsyncLogWriter::Drop);
+    for (int i = 0; i < 10; ++i) {
+        QByteArray ba = record(i);
+        writer.post(ba);
+    }
+    writer.flush(1000);
+
+    // everything needs to be in the pipe now, without stopping the writer
+    QByteArray output;
+    const int flags = ::fcntl(m_pipe[0], F_GETFL);
+    ::fcntl(m_pipe[0], F_SETFL, flags | O_NONBLOCK);
+    char buffer[4096];
+    qsizetype bytesRead;
+    while ((bytesRead = ::read(m_pipe[0], buffer, sizeof(buffer))) > 0)
+        output.append(buffer, bytesRead);
+    ::fcntl(m_pipe[0], F_SETFL, flags);
+
+    QVERIFY(output.startsWith(records(0, 10)));
+    QCOMPARE(writer.droppedCount(), quint64(0));
+}
+
+void tst_Logging::asyncFlushTimeout()
+{
+    const qsizetype filled = fillPipe();
+    QVERIFY(filled > 0);
+    {
+        AsyncLogWriter writer(m_pipe[1], 16, AsyncLogWriter::Drop);
+        for (int i = 0; i < 10; ++i) {
+            QByteArray ba = record(i);
+            writer.post(ba);
+        }
+
+        // the writer is stuck in writev(): flush() has to give up without touching the records
+        QElapsedTimer timer;
+        timer.start();
+        writer.flush(100);
+        QVERIFY(timer.elapsed() >= 100);
+
+        startReader(); // the writer cannot be destroyed while it is stuck
+    }
+    // every record is written exactly once
+    QCOMPARE(stopReader().mid(filled), records(0, 10));
+}
+
+void tst_Logging::asyncDrop()
+{
+    const qsizetype filled = fillPipe();
+    QVERIFY(filled > 0);
+
+    const int queueSize = 4;
+    const int count = 100;
+    {
+        AsyncLogWriter writer(m_pipe[1], queueSize, AsyncLogWriter::Drop);
+
+        // the writer is stuck in writev(), so it cannot hand back any slots: exactly
+        // queueSize records are accepted and the rest is dropped
+        for (int i = 0; i < count; ++i) {
+            QByteArray ba = record(i);
+            writer.post(ba);
+        }
+        const quint64 dropped = writer.droppedCount();
+
+        startReader(); // the writer cannot be destroyed while it is stuck
+        QCOMPARE(dropped, quint64(count - queueSize));
+    }
+    QByteArray output = stopReader().mid(filled);
+
+    // the notice is written before the next batch, so its position depends on the timing
+    const QByteArray notice = "[... 96 log message(s) dropped: the asynchronous output queue was full ...]\n";
+    QVERIFY2(output.contains(notice), output.constData());
+    QCOMPARE(output.replace(notice, ""), records(0, queueSize));
+}
+
+void tst_Logging::asyncBlock()
+{
+    const qsizetype filled = fillPipe();
+    QVERIFY(filled > 0);
+
+    const int count = 100;
+    std::atomic<int> posted { 0 };
+    {
+        AsyncLogWriter writer(m_pipe[1], 4, AsyncLogWriter::Block);
+
+        std::thread producer([&]() {
+            for (int i = 0; i < count; ++i) {
+                QByteArray ba = record(i);
+                writer.post(ba);
+                ++posted;
+            }
+        });
+
+        // the producer has to wait for the stuck writer ...
+        std::this_thread::sleep_for(200ms);
+        const int postedWhileStuck = posted.load();
+
+        // ... until the pipe gets drained
+        startReader();
+        producer.join();
+        QCOMPARE(postedWhileStuck, 4);
+        QCOMPARE(posted.load(), count);
+        QCOMPARE(writer.droppedCount(), quint64(0));
+    }
+    QCOMPARE(stopReader().mid(filled), records(0, count));
+}
+
+QTEST_APPLESS_MAIN(tst_Logging)
+
+#include "tst_logging.moc"
@@ -48,6 +48,7 @@ private Q_SLOTS:
     void cleanupTestCase();
 
     void httpInterface();
+    void downloadRanges();
 
 private:
     QTemporaryDir m_tmpDir;
@@ -153,6 +154,16 @@ void tst_PackageServerTool::httpInterface()
         QVERIFY(!testAmpkg.isEmpty());
     }
 
+    const QJsonObject testPackage {
+        { u"architecture"_s, u""_s },
+        { u"id"_s, u"com.pelagicore.test"_s },
+        { u"categories"_s, QJsonArray { u"test-category"_s } },
+        { u"iconUrl"_s, u"package/icon?id=com.pelagicore.test&architecture=all"_s },
+        { u"names"_s, QJsonObject { { u"de"_s, u"Hallo"_s }, { u"en"_s, u"Hello"_s } } },
+        { u"descriptions"_s, QJsonObject { } },
+        { u"version"_s, u"1.0"_s },
+    };
+
     static const auto Get = QNetworkAccessManager::GetOperation;
     static const auto Post = QNetworkAccessManager::PostOperation;
     static const auto Put = QNetworkAccessManager::PutOperation;
@@ -169,15 +180,34 @@ void tst_PackageServerTool::httpInterface()
          QJsonArray { u"test-category"_s } },
 
         { "packages", "/package/list", QUrlQuery(), Get, 200,
-         QJsonArray { QJsonObject {
-             { u"architecture"_s, u""_s },
-             { u"id"_s, u"com.pelagicore.test"_s },
-             { u"categories"_s, QJsonArray { u"test-category"_s } },
-             { u"iconUrl"_s, u"package/icon?id=com.pelagicore.test&architecture=all"_s },
-             { u"names"_s, QJsonObject { { u"de"_s, u"Hallo"_s }, { u"en"_s, u"Hello"_s } } },
-             { u"descriptions"_s, QJsonObject { } },
-             { u"version"_s, u"1.0"_s },
-        } } },
+         QJsonArray { testPackage } },
+
+        { "packages-category", "/package/list", QUrlQuery { { u"category"_s, u"test-category"_s } }, Get, 200,
+         QJsonArray { testPackage } },
+
+        { "packages-no-category", "/package/list", QUrlQuery { { u"category"_s, u"foo"_s } }, Get, 200,
+         QJsonArray { } },
+
+        { "packages-filter", "/package/list", QUrlQuery { { u"filter"_s, u"ello"_s } }, Get, 200,
+         QJsonArray { testPackage } },
+
+        { "packages-short-filter", "/package/list", QUrlQuery { { u"filter"_s, u"Ha"_s } }, Get, 200,
+         QJsonArray { testPackage } },
+
+        { "packages-no-filter-match", "/package/list", QUrlQuery { { u"filter"_s, u"Hallow"_s } }, Get, 200,
+         QJsonArray { } },
+
+        { "packages-architecture", "/package/list", QUrlQuery { { u"architecture"_s, u"linux_x86_64"_s } }, Get, 200,
+         QJsonArray { testPackage } },
+
+        { "packages-limit", "/package/list", QUrlQuery { { u"offset"_s, u"0"_s }, { u"limit"_s, u"1"_s } }, Get, 200,
+         QJsonArray { testPackage } },
+
+        { "packages-zero-limit", "/package/list", QUrlQuery { { u"limit"_s, u"0"_s } }, Get, 200,
+         QJsonArray { } },
+
+        { "packages-offset", "/package/list", QUrlQuery { { u"offset"_s, u"1"_s } }, Get, 200,
+         QJsonArray { } },
 
         { "no-icon", "/package/icon", QUrlQuery(), Get, 404,
          QByteArray { } },
@@ -276,6 +306,58 @@ void tst_PackageServerTool::httpInterface()
     }
 }
 
+void tst_PackageServerTool::downloadRanges()
+{
+    QFile f(QString::fromLatin1(AM_TESTDATA_DIR "/packages/test.appkg"));
+    QVERIFY(f.open(QIODevice::ReadOnly));
+    const QByteArray testAmpkg = f.readAll();
+    QVERIFY(testAmpkg.size() > 100);
+
+    auto url = m_url;
+    url.setPath(u"/package/download"_s);
+    url.setQuery(QUrlQuery { { u"id"_s, u"com.pelagicore.test"_s } });
+
+    auto get = [this, url](const QList<std::pair<QByteArray, QByteArray>> &headers) {
+        QNetworkRequest req(url);
+        for (const auto &[name, value] : headers)
+            req.setRawHeader(name, value);
+        QNetworkReply *reply = m_nam.get(req);
+        QTest::qWaitFor([reply]() { return reply->isFinished(); }, 3000 * QtAM::timeoutFactor());
+        return reply;
+    };
+
+    QNetworkReply *reply = get({ });
+    QVERIFY(reply->isFinished());
+    QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 200);
+    QCOMPARE(reply->rawHeader("Accept-Ranges"), QByteArray("bytes"));
+    const QByteArray etag = reply->rawHeader("ETag");
+    QVERIFY(etag.startsWith('"'));
+    QCOMPARE(reply->readAll(), testAmpkg);
+
+    reply = get({ { "If-None-Match", etag } });
+    QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 304);
+
+    reply = get({ { "Range", "bytes=10-19" } });
+    QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 206);
+    QCOMPARE(reply->rawHeader("Content-Range"), "bytes 10-19/" + QByteArray::number(testAmpkg.size()));
+    QCOMPARE(reply->readAll(), testAmpkg.mid(10, 10));
+
+    reply = get({ { "Range", "bytes=100-" }, { "If-Range", etag } });
+    QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 206);
+    QCOMPARE(reply->readAll(), testAmpkg.mid(100));
+
+    reply = get({ { "Range", "bytes=-5" } });
+    QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 206);
+    QCOMPARE(reply->readAll(), testAmpkg.right(5));
+
+    reply = get({ { "Range", "bytes=10-19" }, { "If-Range", "\"outdated\"" } });
+    QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 200);
+    QCOMPARE(reply->readAll(), testAmpkg);
+
+    reply = get({ { "Range", "bytes=" + QByteArray::number(testAmpkg.size()) + '-' } });
+    QCOMPARE(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), 416);
+}
+
 QTEST_GUILESS_MAIN(tst_PackageServerTool)
 
 #include "tst_package-server-tool.moc"
@@ -0,0 +1,215 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <memory>
+
+#include <QtCore>
+#include <QtTest>
+
+#include "packagedatabase.h"
+#include "packageinfo.h"
+#include "utilities.h"
+
+using namespace Qt::StringLiterals;
+
+QT_USE_NAMESPACE_AM
+
+class tst_PackageDatabase : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_PackageDatabase() = default;
+
+private Q_SLOTS:
+    void init();
+    void cleanup();
+
+    void rescanUnchanged();
+    void rescanAdded();
+    void rescanChanged();
+    void rescanRemoved();
+    void rescanSkipped();
+    void rescanInvalid();
+
+private:
+    bool writeManifest(const QString &dirName, const QString &version, const QString &id = { });
+    QStringList builtInIds() const;
+
+    std::unique_ptr<QTemporaryDir> m_tmpDir;
+    QDir m_builtInDir;
+    std::unique_ptr<PackageDatabase> m_pdb;
+
+    // the PackageInfo objects are gone after the signal handlers, so we only record what we need
+    QStringList m_added;
+    QStringList m_changed; // "<id>: <old version> -> <new version>"
+    QStringList m_removed;
+};
+
+bool tst_PackageDatabase::writeManifest(const QString &dirName, const QString &version, const QString &id)
+{
+    if (!m_builtInDir.mkpath(dirName))
+        return false;
+    QFile f(m_builtInDir.filePath(dirName + u"/info.yaml"_s));
+    if (!f.open(QFile::WriteOnly | QFile::Truncate))
+        return false;
+
+    const QString pkgId = id.isEmpty() ? dirName : id;
+    const QString yaml = uR"(formatVersion: 1
+formatType: am-package
+---
+id: '%1'
+icon: 'icon.png'
+name:
+  en: '%1'
+version: '%2'
+applications:
+- id: '%1'
+  code: 'main.qml'
+  runtime: 'qml'
+)"_s.arg(pkgId, version);
+    return f.write(yaml.toUtf8()) > 0;
+}
+
+QStringList tst_PackageDatabase::builtInIds() const
+{
+    QStringList ids;
+    const auto packages = m_pdb->builtInPackages();
+    for (const auto *pi : packages)
+        ids << pi->id();
+    ids.sort();
+    return ids;
+}
+
+void tst_PackageDatabase::init()
+{
+    m_tmpDir.reset(new QTemporaryDir());
+    QVERIFY(m_tmpDir->isValid());
+    m_builtInDir.setPath(m_tmpDir->path());
+
+    QVERIFY(writeManifest(u"a"_s, u"1.0"_s));
+    QVERIFY(writeManifest(u"b"_s, u"1.0"_s));
+
+    m_pdb.reset(new PackageDatabase({ m_builtInDir.absolutePath() }));
+    m_pdb->enableIncrementalUpdates();
+    m_pdb->parse(PackageDatabase::Builtin);
+    QCOMPARE(builtInIds(), QStringList({ u"a"_s, u"b"_s }));
+
+    m_added.clear();
+    m_changed.clear();
+    m_removed.clear();
+
+    connect(m_pdb.get(), &PackageDatabase::packageInfoAdded,
+            this, [this](PackageInfo *pi) {
+        QVERIFY(m_pdb->builtInPackages().contains(pi));
+        m_added << pi->id();
+    });
+    connect(m_pdb.get(), &PackageDatabase::packageInfoChanged,
+            this, [this](PackageInfo *oldPi, PackageInfo *newPi) {
+        QCOMPARE(oldPi->id(), newPi->id());
+        QVERIFY(!m_pdb->builtInPackages().contains(oldPi));
+        QVERIFY(m_pdb->builtInPackages().contains(newPi));
+        m_changed << (newPi->id() + u": "_s + oldPi->version() + u" -> "_s + newPi->version());
+    });
+    connect(m_pdb.get(), &PackageDatabase::packageInfoAboutToBeRemoved,
+            this, [this](PackageInfo *pi) {
+        m_removed << pi->id();
+    });
+}
+
+void tst_PackageDatabase::cleanup()
+{
+    m_pdb.reset();
+    m_tmpDir.reset();
+}
+
+void tst_PackageDatabase::rescanUnchanged()
+{
+    QVERIFY(m_pdb->rescan());
+    QVERIFY(m_added.isEmpty());
+    QVERIFY(m_changed.isEmpty());
+    QVERIFY(m_removed.isEmpty());
+    QCOMPARE(builtInIds(), QStringList({ u"a"_s, u"b"_s }));
+}
+
+void tst_PackageDatabase::rescanAdded()
+{
+    QSignalSpy dirsChanged(m_pdb.get(), &PackageDatabase::packageDirectoriesChanged);
+
+    QVERIFY(writeManifest(u"c"_s, u"1.0"_s));
+    QTRY_VERIFY_WITH_TIMEOUT(!dirsChanged.isEmpty(), 5000 * timeoutFactor());
+
+    QVERIFY(m_pdb->rescan());
+    QCOMPARE(m_added, QStringList({ u"c"_s }));
+    QVERIFY(m_changed.isEmpty());
+    QVERIFY(m_removed.isEmpty());
+    QCOMPARE(builtInIds(), QStringList({ u"a"_s, u"b"_s, u"c"_s }));
+
+    // nothing changed since the last rescan
+    QVERIFY(m_pdb->rescan());
+    QCOMPARE(m_added.size(), 1);
+}
+
+void tst_PackageDatabase::rescanChanged()
+{
+    QSignalSpy dirsChanged(m_pdb.get(), &PackageDatabase::packageDirectoriesChanged);
+
+    QVERIFY(writeManifest(u"a"_s, u"2.0.0"_s));
+    QTRY_VERIFY_WITH_TIMEOUT(!dirsChanged.isEmpty(), 5000 * timeoutFactor());
+
+    QVERIFY(m_pdb->rescan());
+    QVERIFY(m_added.isEmpty());
+    QCOMPARE(m_changed, QStringList({ u"a: 1.0 -> 2.0.0"_s }));
+    QVERIFY(m_removed.isEmpty());
+    QCOMPARE(builtInIds(), QStringList({ u"a"_s, u"b"_s }));
+}
+
+void tst_PackageDatabase::rescanRemoved()
+{
+    QSignalSpy dirsChanged(m_pdb.get(), &PackageDatabase::packageDirectoriesChanged);
+
+    QVERIFY(QDir(m_builtInDir.filePath(u"b"_s)).removeRecursively());
+    QTRY_VERIFY_WITH_TIMEOUT(!dirsChanged.isEmpty(), 5000 * timeoutFactor());
+
+    QVERIFY(m_pdb->rescan());
+    QVERIFY(m_added.isEmpty());
+    QVERIFY(m_changed.isEmpty());
+    QCOMPARE(m_removed, QStringList({ u"b"_s }));
+    QCOMPARE(builtInIds(), QStringList({ u"a"_s }));
+}
+
+void tst_PackageDatabase::rescanSkipped()
+{
+    QVERIFY(writeManifest(u"a"_s, u"2.0.0"_s));
+    QVERIFY(QDir(m_builtInDir.filePath(u"b"_s)).removeRecursively());
+
+    // packages that are in use are left alone, until the caller retries
+    QVERIFY(!m_pdb->rescan({ u"a"_s, u"b"_s }));
+    QVERIFY(m_changed.isEmpty());
+    QVERIFY(m_removed.isEmpty());
+    QCOMPARE(builtInIds(), QStringList({ u"a"_s, u"b"_s }));
+
+    QVERIFY(!m_pdb->rescan({ u"b"_s }));
+    QCOMPARE(m_changed, QStringList({ u"a: 1.0 -> 2.0.0"_s }));
+    QVERIFY(m_removed.isEmpty());
+
+    QVERIFY(m_pdb->rescan());
+    QCOMPARE(m_changed.size(), 1);
+    QCOMPARE(m_removed, QStringList({ u"b"_s }));
+    QCOMPARE(builtInIds(), QStringList({ u"a"_s }));
+}
+
+void tst_PackageDatabase::rescanInvalid()
+{
+    // the id does not match the directory name
+    QVERIFY(writeManifest(u"d"_s, u"1.0"_s, u"e"_s));
+    QTest::ignoreMessage(QtWarningMsg, QRegularExpression(u"^Ignoring changes to package \"d\""_s));
+
+    QVERIFY(m_pdb->rescan());
+    QVERIFY(m_added.isEmpty());
+    QCOMPARE(builtInIds(), QStringList({ u"a"_s, u"b"_s }));
+}
+
+QTEST_GUILESS_MAIN(tst_PackageDatabase)
+
+#include "tst_packagedatabase.moc"
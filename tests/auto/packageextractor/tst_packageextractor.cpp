@@ -20,6 +20,7 @@
 #include "packageextractor.h"
 #include "installationreport.h"
 #include "packageutilities.h"
+#include "exception.h"
 #include "utilities.h"
 
 #include "../error-checking.h"
@@ -44,6 +45,12 @@ private Q_SLOTS:
     void extractAndVerify();
 
     void cancelExtraction();
+    void fileExtractedCallback();
+    void callbackError();
+    void cancelFromCallback();
+    void writeError();
+    void cancelWhileWriting();
+    void throughputLimits();
 
     void extractFromFifo();
 
@@ -216,6 +223,116 @@ void tst_PackageExtractor::cancelExtraction()
     }
 }
 
+void tst_PackageExtractor::fileExtractedCallback()
+{
+    PackageExtractor extractor(QUrl::fromLocalFile(QString::fromLatin1(AM_TESTDATA_DIR "packages/test.appkg")), m_extractDir->path());
+
+    QStringList files;
+    bool wrongThread = false;
+    extractor.setFileExtractedCallback([&](const QString &file) {
+        wrongThread = wrongThread || (QThread::currentThread() != thread());
+        // the file has to be complete on disk, when we are called
+        if (file == u"test")
+            QCOMPARE(QFileInfo(extractor.destinationDirectory().filePath(file)).size(), qint64(5));
+        files << file;
+    });
+
+    QVERIFY2(extractor.extract(), qPrintable(extractor.errorString()));
+    QVERIFY(!wrongThread);
+    QCOMPARE(files, QStringList({ u"info.yaml"_s, u"icon.png"_s, u"test"_s, m_taest }));
+}
+
+void tst_PackageExtractor::callbackError()
+{
+    PackageExtractor extractor(QUrl::fromLocalFile(QString::fromLatin1(AM_TESTDATA_DIR "packages/test.appkg")), m_extractDir->path());
+
+    QStringList files;
+    extractor.setFileExtractedCallback([&files](const QString &file) {
+        files << file;
+        if (file == u"icon.png")
+            throw Exception(Error::Package, "rejected %1").arg(file);
+    });
+
+    // an exception in the decoder stage has to end the extraction with exactly this error
+    QVERIFY(!extractor.extract());
+    QVERIFY(!extractor.wasCanceled());
+    QCOMPARE(extractor.errorCode(), Error::Package);
+    QCOMPARE(extractor.errorString(), u"rejected icon.png"_s);
+    QCOMPARE(files, QStringList({ u"info.yaml"_s, u"icon.png"_s }));
+}
+
+void tst_PackageExtractor::cancelFromCallback()
+{
+    PackageExtractor extractor(QUrl::fromLocalFile(QString::fromLatin1(AM_TESTDATA_DIR "packages/test.appkg")), m_extractDir->path());
+
+    QStringList files;
+    extractor.setFileExtractedCallback([&files, &extractor](const QString &file) {
+        files << file;
+        extractor.cancel();
+    });
+
+    QVERIFY(!extractor.extract());
+    QVERIFY(extractor.wasCanceled());
+    QCOMPARE(extractor.errorCode(), Error::Canceled);
+    QCOMPARE(files, QStringList({ u"info.yaml"_s }));
+}
+
+void tst_PackageExtractor::writeError()
+{
+#if !defined(Q_OS_LINUX)
+    QSKIP("This test needs /dev/full");
+#else
+    // every write to /dev/full fails with ENOSPC, so the writer stage will report an error
+    QVERIFY(QFile::link(u"/dev/full"_s, QDir(m_extractDir->path()).filePath(u"test"_s)));
+
+    PackageExtractor extractor(QUrl::fromLocalFile(QString::fromLatin1(AM_TESTDATA_DIR "packages/test.appkg")), m_extractDir->path());
+
+    QStringList files;
+    extractor.setFileExtractedCallback([&files](const QString &file) { files << file; });
+
+    QVERIFY(!extractor.extract());
+    QVERIFY(!extractor.wasCanceled());
+    QCOMPARE(extractor.errorCode(), Error::IO);
+    QT_AM_CHECK_ERRORSTRING(extractor.errorString(), u"~.*could not write to file.*"_s);
+    // the callback must not see the file that could not be written
+    QCOMPARE(files, QStringList({ u"info.yaml"_s, u"icon.png"_s }));
+#endif
+}
+
+void tst_PackageExtractor::cancelWhileWriting()
+{
+    // at this rate, writing bigtest (5MB) would take more than 10sec
+    PackageExtractor extractor(QUrl::fromLocalFile(QString::fromLatin1(AM_TESTDATA_DIR "packages/bigtest.appkg")), m_extractDir->path());
+    extractor.setDiskWriteRateLimit(512 * 1024);
+
+    QTimer::singleShot(200, &extractor, &PackageExtractor::cancel);
+
+    QElapsedTimer timer;
+    timer.start();
+    QVERIFY(!extractor.extract());
+    QVERIFY(extractor.wasCanceled());
+    QCOMPARE(extractor.errorCode(), Error::Canceled);
+    // the writer has to stop throttling and the decoder must not wait for it
+    QVERIFY(timer.elapsed() < 5000 * timeoutFactor());
+}
+
+void tst_PackageExtractor::throughputLimits()
+{
+    const QString path = QString::fromLatin1(AM_TESTDATA_DIR "packages/test.appkg");
+    const qint64 size = QFileInfo(path).size();
+    QVERIFY(size > 0);
+
+    // the limits are set to read or write the package in about 0.5sec each
+    PackageExtractor extractor(QUrl::fromLocalFile(path), m_extractDir->path());
+    extractor.setDownloadRateLimit(size * 2);
+    extractor.setDiskWriteRateLimit(size * 2);
+
+    QElapsedTimer timer;
+    timer.start();
+    QVERIFY2(extractor.extract(), qPrintable(extractor.errorString()));
+    QVERIFY(timer.elapsed() >= 400);
+}
+
 class FifoSource : public QThread // clazy:exclude=missing-qobject-macro
 {
 public:
@@ -6,6 +6,7 @@
 #include <QtCore>
 #include <QtTest>
 #include <QtAppManMonitor/processreader.h>
+#include <QtAppManMonitor/processsampler.h>
 
 QT_USE_NAMESPACE_AM
 
@@ -22,6 +23,10 @@ private Q_SLOTS:
     void memTestProcess();
     void memBasic();
     void memAdvanced();
+    void memRollupInvalid();
+    void memRollup();
+    void residentMemory();
+    void sampler();
 
 private:
     void printMem();
@@ -101,6 +106,82 @@ void tst_ProcessReader::memAdvanced()
     QCOMPARE(reader.memory.heapPss, 15740u);
 }
 
+void tst_ProcessReader::memRollupInvalid()
+{
+    // a full smaps file is not a valid rollup
+    QVERIFY(!reader.testReadSmapsRollup(QFINDTESTDATA("basic.smaps").toLocal8Bit()));
+    QVERIFY(!reader.testReadSmapsRollup(QFINDTESTDATA("tst_processreader.cpp").toLocal8Bit()));
+    QCOMPARE(reader.memory.totalRss, 0u);
+    QCOMPARE(reader.memory.totalPss, 0u);
+}
+
+void tst_ProcessReader::memRollup()
+{
+    QVERIFY(reader.testReadSmapsRollup(QFINDTESTDATA("basic.smaps_rollup").toLocal8Bit()));
+    // the rollup has to match the totals of the detailed parser
+    QCOMPARE(reader.memory.totalRss, 20352u);
+    QCOMPARE(reader.memory.totalPss, 13814u);
+    // no breakdown available
+    QCOMPARE(reader.memory.textPss, 0u);
+    QCOMPARE(reader.memory.heapPss, 0u);
+
+    const QByteArray file = "/proc/" + QByteArray::number(QCoreApplication::applicationPid()) + "/smaps_rollup";
+    if (QFile::exists(QString::fromLocal8Bit(file))) {
+        QVERIFY(reader.testReadSmapsRollup(file));
+        QVERIFY(reader.memory.totalRss >= reader.memory.totalPss);
+        QVERIFY(reader.memory.totalPss > 0);
+    }
+}
+
+void tst_ProcessReader::residentMemory()
+{
+    QCOMPARE(ProcessReader::readResidentMemory(0), quint64(0));
+    QCOMPARE(ProcessReader::readResidentMemory(-1), quint64(0));
+
+    // statm and smaps are not read atomically, so only check for plausibility
+    const quint64 rss = ProcessReader::readResidentMemory(QCoreApplication::applicationPid());
+    QVERIFY(rss > 0);
+    const QByteArray file = "/proc/" + QByteArray::number(QCoreApplication::applicationPid()) + "/smaps";
+    QVERIFY(reader.testReadSmaps(file));
+    QVERIFY(rss / 1024 < 2 * quint64(reader.memory.totalVm));
+}
+
+void tst_ProcessReader::sampler()
+{
+    using Subscribers = QSet<quintptr>;
+
+    ProcessSampler sampler;
+    QSignalSpy spy(&sampler, &ProcessSampler::updated);
+    const qint64 pid = QCoreApplication::applicationPid();
+
+    sampler.subscribe(1, pid, true, false);
+    sampler.subscribe(2, pid, false, false);
+    sampler.subscribe(3, 0, false, false);
+
+    // only the subscribers that requested an update are reported, unknown ones are ignored
+    sampler.requestUpdate(1);
+    sampler.requestUpdate(3);
+    sampler.requestUpdate(42);
+    QVERIFY(spy.wait());
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(0).value<Subscribers>(), Subscribers({ 1, 3 }));
+    QVERIFY(sampler.sample(pid).memory.totalVm > 0);
+
+    // all requests before the next tick are coalesced
+    sampler.requestUpdate(2);
+    sampler.requestUpdate(2);
+    sampler.requestUpdate(1);
+    QVERIFY(spy.wait());
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy.at(1).at(0).value<Subscribers>(), Subscribers({ 1, 2 }));
+
+    // nothing to report
+    sampler.unsubscribe(3);
+    sampler.requestUpdate(3);
+    QVERIFY(!spy.wait(100));
+    QCOMPARE(spy.count(), 2);
+}
+
 void tst_ProcessReader::printMem()
 {
     qDebug() << "totalVm:" << reader.memory.totalVm;
@@ -114,6 +195,6 @@ void tst_ProcessReader::printMem()
     qDebug() << "heapPss:" << reader.memory.heapPss;
 }
 
-QTEST_APPLESS_MAIN(tst_ProcessReader)
+QTEST_GUILESS_MAIN(tst_ProcessReader)
 
 #include "tst_processreader.moc"
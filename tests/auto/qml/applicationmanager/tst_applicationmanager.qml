@@ -42,6 +42,10 @@ TestCase {
         }
     }
 
+    ProcessStatus {
+        id: processStatus
+    }
+
     ApplicationModel {
         id: appModel
         sortFunction: function(la, ra) { return la.id > ra.id }
@@ -208,6 +212,61 @@ TestCase {
         compare(appModel.count, 2);
     }
 
+    ApplicationModel {
+        id: appRolesModel
+    }
+
+    function test_applicationModelRoles() {
+        compare(appRolesModel.count, 2);
+
+        appRolesModel.sortRoles = [ "-name" ];
+        compare(appRolesModel.indexOfApplication(simpleApplication.id), 0);
+        compare(appRolesModel.indexOfApplication(capsApplication.id), 1);
+        appRolesModel.sortRoles = [ "isRunning", "name" ];
+        compare(appRolesModel.indexOfApplication(capsApplication.id), 0);
+        compare(appRolesModel.indexOfApplication(simpleApplication.id), 1);
+
+        appRolesModel.filterRoles = { capabilities: "cameraAccess" };
+        compare(appRolesModel.count, 1);
+        compare(appRolesModel.indexOfApplication(capsApplication.id), 0);
+        appRolesModel.filterRoles = { name: [ "Simple1", "Caps" ], isBlocked: false };
+        compare(appRolesModel.count, 2);
+        appRolesModel.filterRoles = { isRunning: true };
+        compare(appRolesModel.count, 0);
+
+        // both filters have to accept an application
+        appRolesModel.filterRoles = { isBlocked: false };
+        appRolesModel.filterFunction = function(app) { return app.id === simpleApplication.id; };
+        compare(appRolesModel.count, 1);
+        appRolesModel.filterFunction = undefined;
+        compare(appRolesModel.count, 2);
+
+        // changes in the referenced roles are picked up without calling invalidate()
+        appRolesModel.sortRoles = [ "-isRunning", "name" ];
+        compare(appRolesModel.indexOfApplication(simpleApplication.id), 1);
+        appRolesModel.filterRoles = { isRunning: false };
+        compare(appRolesModel.count, 2);
+
+        ApplicationManager.startApplication(simpleApplication.id);
+        tryCompare(simpleApplication, "runState", Am.Running);
+        tryCompare(appRolesModel, "count", 1);
+        compare(appRolesModel.indexOfApplication(capsApplication.id), 0);
+
+        appRolesModel.filterRoles = { };
+        compare(appRolesModel.count, 2);
+        compare(appRolesModel.indexOfApplication(simpleApplication.id), 0);
+
+        ApplicationManager.stopApplication(simpleApplication.id);
+        tryCompare(simpleApplication, "runState", Am.NotRunning);
+        tryCompare(appRolesModel, "count", 2);
+        compare(appRolesModel.indexOfApplication(simpleApplication.id), 1);
+        tryCompare(WindowManager, "count", 0);
+        runStateChangedSpy.clear();
+
+        appRolesModel.sortRoles = [ ];
+        appRolesModel.filterRoles = { };
+    }
+
     function test_get_data() {
         return [
                     {tag: "get(row)", argument: 0 },
@@ -309,6 +368,15 @@ TestCase {
         compare(WindowManager.windowsOfApplication(data.appId).length, 1)
         compare(WindowManager.windowsOfApplication(data.appId)[0], lastWindowAdded)
 
+        let pid = 0
+        if (!singleProcess) {
+            processStatus.applicationId = data.appId
+            pid = processStatus.processId
+            verify(pid > 0)
+            compare(ApplicationManager.identifyApplication(pid), data.appId)
+            compare(ApplicationManager.identifyAllApplications(pid), [ data.appId ])
+        }
+
         ApplicationManager.stopApplication(data.appId, data.forceKill);
 
         checkApplicationState(data.appId, Am.ShuttingDown);
@@ -321,6 +389,11 @@ TestCase {
         compare(listView.currentItem.modelData.isShuttingDown, false)
         compare(listView.currentItem.modelData.application.lastExitCode, data.exitCode)
         compare(listView.currentItem.modelData.application.lastExitStatus, data.exitStatus)
+
+        if (pid) {
+            compare(ApplicationManager.identifyApplication(pid), "")
+            processStatus.applicationId = ""
+        }
     }
 
     function test_startAndStopAllApplications_data() {
@@ -71,8 +71,13 @@ TestCase {
         var params = matchParams
         params.list = "c"
         verify(!IntentServer.applicationIntent("match", "intents1", params))
+        params.list = 1
+        verify(!IntentServer.applicationIntent("match", "intents1", params))
         params.list = "b"
         verify(IntentServer.applicationIntent("match", "intents1", params))
+        // the compiled matcher is re-used: check that repeated lookups give the same result
+        compare(IntentServer.applicationIntent("match", "intents1", params),
+                IntentServer.applicationIntent("match", "intents1", params))
 
         params.int = 2
         verify(!IntentServer.applicationIntent("match", "intents1", params))
@@ -54,6 +54,44 @@ TestCase {
         verify(mem.totalMemory < 500000000000) // 500GB
         verify(mem.memoryUsed < mem.totalMemory)
     }
+    Rectangle {
+        id: spinner
+        width: 10; height: 10
+        RotationAnimation on rotation { id: spin; running: false; loops: Animation.Infinite; from: 0; to: 360 }
+    }
+
+    function test_frames() {
+        verify(Window.window)
+        frames.window = Window.window
+        compare(frames.frameTimeHistogram().frameCount, 0)
+        spin.running = true
+        tryVerify(function() { return frames.frameTimeHistogram().frameCount >= 10 }, spyTimeout,
+                  "no frames rendered")
+        spin.running = false
+
+        frames.update()
+        verify(frames.p50FrameTime > 0)
+        verify(frames.p50FrameTime <= frames.p95FrameTime)
+        verify(frames.p95FrameTime <= frames.p99FrameTime)
+        verify(frames.p99FrameTime <= frames.p999FrameTime)
+        verify(frames.missedVsyncs >= 0)
+        verify(frames.longFrames >= 0)
+        verify(frames.roleNames.indexOf("p99FrameTime") >= 0)
+
+        let histogram = frames.frameTimeHistogram()
+        verify(histogram.buckets.length > 0)
+        let count = 0
+        for (let bucket of histogram.buckets) {
+            verify(bucket.from <= bucket.to)
+            count += bucket.count
+        }
+        compare(count, histogram.frameCount)
+
+        frames.resetFrameTimeHistogram()
+        compare(frames.frameTimeHistogram().frameCount, 0)
+        frames.window = null
+    }
+
     function test_model() {
         compare(monitor.running, false)
         compare(monitor.dataSources.length, 5)
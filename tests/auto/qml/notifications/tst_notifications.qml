@@ -112,4 +112,43 @@ TestCase {
         compare(model0.actionList[1].actionId, "default");
         compare(model0.actionList[1].actionText, "Default");
     }
+
+    SignalSpy {
+        id: notificationAddedSpy
+        target: NotificationManager
+        signalName: "notificationAdded"
+    }
+
+    function test_batchingAndMaximumCount() {
+        compare(NotificationManager.count, 0);
+
+        // all notifications shown in one event loop iteration end up in one model update
+        notificationManagerCountSpy.clear();
+        notificationAddedSpy.clear();
+        let sticky = notificationComponent.createObject(testCase, { summary: "sticky", sticky: true });
+        sticky.show();
+        for (let i = 0; i < 5; i++)
+            notificationComponent.createObject(testCase, { summary: `N${i}`, timeout: 60000 }).show();
+        notificationManagerCountSpy.wait(1000 * AmTest.timeoutFactor);
+        compare(NotificationManager.count, 6);
+        compare(notificationManagerCountSpy.count, 1);
+        compare(notificationAddedSpy.count, 6);
+        compare(NotificationManager.indexOfNotification(sticky.notificationId), 0);
+
+        // the oldest non-sticky notifications are evicted first
+        notificationManagerCountSpy.clear();
+        NotificationManager.maximumCount = 3;
+        notificationManagerCountSpy.wait(1000 * AmTest.timeoutFactor);
+        compare(NotificationManager.count, 3);
+        compare(NotificationManager.get(0).summary, "sticky");
+        compare(NotificationManager.get(1).summary, "N3");
+        compare(NotificationManager.get(2).summary, "N4");
+
+        // a dismissed notification is gone from the model in the next event loop iteration
+        NotificationManager.dismissNotification(sticky.notificationId);
+        compare(NotificationManager.indexOfNotification(sticky.notificationId), -1);
+        tryCompare(NotificationManager, "count", 2);
+
+        NotificationManager.maximumCount = 0;
+    }
 }
@@ -75,6 +75,12 @@ TestCase {
         signalName: "windowPropertyChanged"
     }
 
+    SignalSpy {
+        id: screenshotFinishedSpy
+        target: WindowManager
+        signalName: "screenshotFinished"
+    }
+
     SignalSpy {
         id: runStateChangedSpy
         target: ApplicationManager
@@ -103,6 +109,21 @@ TestCase {
         windowAboutToBeRemovedSpy.clear();
     }
 
+    // cross-check the WindowManager lookup functions against the model
+    function verifyWindowIndices(appId) {
+        let expected = []
+        for (let i = 0; i < WindowManager.count; ++i) {
+            let win = WindowManager.window(i)
+            compare(WindowManager.indexOfWindow(win), i)
+            if (win.application && win.application.id === appId)
+                expected.push(win)
+        }
+        let windows = WindowManager.windowsOfApplication(appId)
+        compare(windows.length, expected.length)
+        for (let j = 0; j < windows.length; ++j)
+            compare(windows[j], expected[j])
+    }
+
     function test_windowmanager_added_removed_signals() {
         var app = ApplicationManager.application("test.winmap.amwin");
 
@@ -261,15 +282,20 @@ TestCase {
 
         app.start("show-main");
         tryCompare(WindowManager, "count", 1, spyTimeout);
+        verifyWindowIndices(data.appId);
 
         app.start("show-sub");
         tryCompare(WindowManager, "count", 2, spyTimeout);
+        verifyWindowIndices(data.appId);
 
         app.start("hide-sub");
         tryCompare(WindowManager, "count", 1, spyTimeout);
+        verifyWindowIndices(data.appId);
 
         app.stop();
         tryCompare(WindowManager, "count", 0, spyTimeout);
+        verifyWindowIndices(data.appId);
+        compare(WindowManager.indexOfWindow(null), -1);
     }
 
     function test_wayland_ping_pong() {
@@ -333,4 +359,48 @@ TestCase {
 
         compare(lastWindowAdded.windowProperty("objectName"), 42);
     }
+
+    function test_screenshot() {
+        if (Qt.platform.os !== "linux")
+            skip("This test needs mktemp");
+
+        let tmpDir = AmTest.runProgram([ "mktemp", "-d" ]).stdout.trim();
+        verify(AmTest.dirExists(tmpDir));
+
+        var app = ApplicationManager.application("test.winmap.amwin");
+        app.start("show-main");
+        tryCompare(WindowManager, "count", 1, spyTimeout);
+        tryVerify(function () { return topChrome.window !== null }, spyTimeout);
+
+        screenshotFinishedSpy.clear();
+        verify(WindowManager.makeScreenshot(tmpDir + "/app-%i.png", "test.winmap.amwin", { raw: true }));
+        screenshotFinishedSpy.wait(spyTimeout);
+        let args = screenshotFinishedSpy.signalArguments[0];
+        compare(args[0], tmpDir + "/app-%i.png");
+        compare(args[1], "test.winmap.amwin");
+        verify(args[2]);
+        compare(args[3], [ tmpDir + "/app-test.winmap.amwin.png" ]);
+
+        // the same screenshot with the default compression
+        screenshotFinishedSpy.clear();
+        verify(WindowManager.makeScreenshot(tmpDir + "/compressed-%i.png", "test.winmap.amwin"));
+        screenshotFinishedSpy.wait(spyTimeout);
+        args = screenshotFinishedSpy.signalArguments[0];
+        verify(args[2]);
+        compare(args[3], [ tmpDir + "/compressed-test.winmap.amwin.png" ]);
+
+        // the window is single colored, so the uncompressed PNG is always the bigger one
+        let fileSize = function(fileName) {
+            return parseInt(AmTest.runProgram([ "stat", "-c", "%s", fileName ]).stdout.trim());
+        };
+        let rawSize = fileSize(tmpDir + "/app-test.winmap.amwin.png");
+        let compressedSize = fileSize(tmpDir + "/compressed-test.winmap.amwin.png");
+        verify(compressedSize > 0);
+        verify(rawSize > compressedSize, "raw: " + rawSize + ", compressed: " + compressedSize);
+
+        // nothing matches the selector
+        verify(!WindowManager.makeScreenshot(tmpDir + "/none.png", "no.such.app"));
+
+        AmTest.runProgram([ "rm", "-rf", tmpDir ]);
+    }
 }
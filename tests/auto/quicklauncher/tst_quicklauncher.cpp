@@ -0,0 +1,135 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtCore>
+#include <QtTest>
+
+#include "quicklauncher.h"
+
+using namespace Qt::StringLiterals;
+
+QT_USE_NAMESPACE_AM
+
+using PoolSizing = QuickLauncher::PoolSizing;
+
+class tst_QuickLauncher : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_QuickLauncher() = default;
+
+private Q_SLOTS:
+    void poolTargets_data();
+    void poolTargets();
+    void rankApplications();
+    void pickInstance_data();
+    void pickInstance();
+};
+
+static constexpr quint64 MiB = 1024 * 1024;
+
+void tst_QuickLauncher::poolTargets_data()
+{
+    QTest::addColumn<QVector<double>>("demand");
+    QTest::addColumn<QVector<int>>("wanted");
+    QTest::addColumn<QVector<quint64>>("cost");
+    QTest::addColumn<quint64>("budget");
+    QTest::addColumn<QVector<int>>("targets");
+
+    QTest::newRow("no-demand")
+        << QVector<double> { 0, 0 } << QVector<int> { 0, 0 }
+        << QVector<quint64> { 100 * MiB, 100 * MiB } << 1000 * MiB << QVector<int> { 0, 0 };
+    QTest::newRow("unlimited")
+        << QVector<double> { 3, 1, 0 } << QVector<int> { 3, 1, 0 }
+        << QVector<quint64> { 0, 0, 0 } << quint64(0) << QVector<int> { 3, 1, 0 };
+    QTest::newRow("budget-fits-all")
+        << QVector<double> { 3, 1 } << QVector<int> { 3, 1 }
+        << QVector<quint64> { 100 * MiB, 100 * MiB } << 400 * MiB << QVector<int> { 3, 1 };
+    // demand per instance: A 4, 2, 1.33 ... vs. B 1.5: the 3rd instance goes to B
+    QTest::newRow("ranking")
+        << QVector<double> { 4, 1.5 } << QVector<int> { 4, 2 }
+        << QVector<quint64> { 100 * MiB, 100 * MiB } << 300 * MiB << QVector<int> { 2, 1 };
+    // ... A 4, 2, B 1.5, A 1.33, A 1 vs. B 0.75
+    QTest::newRow("ranking-more-budget")
+        << QVector<double> { 4, 1.5 } << QVector<int> { 4, 2 }
+        << QVector<quint64> { 100 * MiB, 100 * MiB } << 500 * MiB << QVector<int> { 4, 1 };
+    // a cheaper combination can still fit in, when the expensive one does not anymore
+    QTest::newRow("cheap-fills-up")
+        << QVector<double> { 4, 1 } << QVector<int> { 4, 1 }
+        << QVector<quint64> { 200 * MiB, 50 * MiB } << 450 * MiB << QVector<int> { 2, 1 };
+    // B was never measured: it is assumed to be as expensive as A
+    QTest::newRow("unknown-cost")
+        << QVector<double> { 2, 1 } << QVector<int> { 1, 1 }
+        << QVector<quint64> { 200 * MiB, 0 } << 300 * MiB << QVector<int> { 1, 0 };
+    // nothing was measured yet: only one instance is started, so that it can be measured
+    QTest::newRow("nothing-measured")
+        << QVector<double> { 2, 1 } << QVector<int> { 2, 1 }
+        << QVector<quint64> { 0, 0 } << 1000 * MiB << QVector<int> { 1, 0 };
+    QTest::newRow("budget-too-small")
+        << QVector<double> { 2, 1 } << QVector<int> { 2, 1 }
+        << QVector<quint64> { 200 * MiB, 100 * MiB } << 50 * MiB << QVector<int> { 0, 0 };
+}
+
+void tst_QuickLauncher::poolTargets()
+{
+    QFETCH(QVector<double>, demand);
+    QFETCH(QVector<int>, wanted);
+    QFETCH(QVector<quint64>, cost);
+    QFETCH(quint64, budget);
+    QFETCH(QVector<int>, targets);
+
+    QVector<PoolSizing> pools(demand.size());
+    for (int i = 0; i < pools.size(); ++i) {
+        pools[i].demand = demand.at(i);
+        pools[i].wanted = wanted.at(i);
+        pools[i].instanceCost = cost.at(i);
+        pools[i].target = 42; // has to be overwritten
+    }
+
+    QuickLauncher::calculatePoolTargets(pools, budget);
+
+    QVector<int> result;
+    for (const auto &pool : std::as_const(pools))
+        result << pool.target;
+    QCOMPARE(result, targets);
+}
+
+void tst_QuickLauncher::rankApplications()
+{
+    QCOMPARE(QuickLauncher::rankApplications({ }), QStringList { });
+
+    const QHash<QString, double> demand {
+        { u"c"_s, 0.5 }, { u"a"_s, 3 }, { u"d"_s, 1 }, { u"b"_s, 1 }
+    };
+    // equal demand is ordered by id
+    QCOMPARE(QuickLauncher::rankApplications(demand),
+             QStringList({ u"a"_s, u"b"_s, u"d"_s, u"c"_s }));
+}
+
+void tst_QuickLauncher::pickInstance_data()
+{
+    QTest::addColumn<QStringList>("reservedFor");
+    QTest::addColumn<QString>("applicationId");
+    QTest::addColumn<int>("index");
+
+    QTest::newRow("empty-pool") << QStringList { } << u"a"_s << -1;
+    QTest::newRow("no-reservations") << QStringList { u""_s, u""_s } << u"a"_s << 0;
+    QTest::newRow("no-app") << QStringList { u"a"_s, u""_s } << QString { } << 1;
+    QTest::newRow("reserved-for-app") << QStringList { u""_s, u"b"_s, u"a"_s } << u"a"_s << 2;
+    QTest::newRow("reserved-for-others") << QStringList { u"b"_s, u""_s, u"c"_s } << u"a"_s << 1;
+    QTest::newRow("all-reserved-for-others") << QStringList { u"b"_s, u"c"_s } << u"a"_s << -1;
+}
+
+void tst_QuickLauncher::pickInstance()
+{
+    QFETCH(QStringList, reservedFor);
+    QFETCH(QString, applicationId);
+    QFETCH(int, index);
+
+    QCOMPARE(QuickLauncher::pickInstance(reservedFor, applicationId), qsizetype(index));
+}
+
+QTEST_APPLESS_MAIN(tst_QuickLauncher)
+
+#include "tst_quicklauncher.moc"
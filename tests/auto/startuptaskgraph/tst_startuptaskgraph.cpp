@@ -0,0 +1,177 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtCore>
+#include <QtTest>
+
+#include "startuptaskgraph.h"
+#include "exception.h"
+#include "utilities.h"
+
+#include "../error-checking.h"
+
+using namespace Qt::StringLiterals;
+
+QT_USE_NAMESPACE_AM
+
+class tst_StartupTaskGraph : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_StartupTaskGraph() = default;
+
+private Q_SLOTS:
+    void init();
+
+    void ordering();
+    void concurrency();
+    void unknownDependency();
+    void cycles();
+    void errorPropagation_data();
+    void errorPropagation();
+
+private:
+    std::function<void()> record(const char *name);
+
+    QMutex m_mutex;
+    QStringList m_executed;
+    QStringList m_wrongThread;
+};
+
+void tst_StartupTaskGraph::init()
+{
+    m_executed.clear();
+    m_wrongThread.clear();
+}
+
+// records the execution order and whether the task ran in the expected thread
+std::function<void()> tst_StartupTaskGraph::record(const char *name)
+{
+    return [this, name]() {
+        const bool isMainThread = (QThread::currentThread() == thread());
+        const QString taskName = QString::fromLatin1(name);
+        QMutexLocker locker(&m_mutex);
+        if (isMainThread != taskName.startsWith(u"main"))
+            m_wrongThread << taskName;
+        m_executed << taskName;
+    };
+}
+
+void tst_StartupTaskGraph::ordering()
+{
+    StartupTaskGraph graph;
+    graph.add("main-a", StartupTaskGraph::MainThread, { }, record("main-a"));
+    graph.add("any-b", StartupTaskGraph::AnyThread, { "main-a" }, record("any-b"));
+    graph.add("main-c", StartupTaskGraph::MainThread, { }, record("main-c"));
+    graph.add("main-d", StartupTaskGraph::MainThread, { "any-b" }, record("main-d"));
+    graph.add("main-e", StartupTaskGraph::MainThread, { "main-a" }, record("main-e"));
+    graph.add("any-f", StartupTaskGraph::AnyThread, { "main-d", "main-e" }, record("any-f"));
+    graph.run();
+
+    QVERIFY2(m_wrongThread.isEmpty(), qPrintable(m_wrongThread.join(u", ")));
+    QCOMPARE(m_executed.size(), 6);
+
+    auto before = [this](const QString &first, const QString &second) {
+        return m_executed.indexOf(first) < m_executed.indexOf(second);
+    };
+    // dependencies
+    QVERIFY(before(u"main-a"_s, u"any-b"_s));
+    QVERIFY(before(u"any-b"_s, u"main-d"_s));
+    QVERIFY(before(u"main-a"_s, u"main-e"_s));
+    QVERIFY(before(u"main-d"_s, u"any-f"_s));
+    QVERIFY(before(u"main-e"_s, u"any-f"_s));
+    // main-thread tasks keep the order they were added in, unless they have to wait
+    QVERIFY(before(u"main-a"_s, u"main-c"_s));
+    QVERIFY(before(u"main-c"_s, u"main-e"_s));
+}
+
+void tst_StartupTaskGraph::concurrency()
+{
+    // the worker task can only finish, if the main-thread task runs at the same time
+    QSemaphore mainStarted;
+    bool workerTimedOut = false;
+
+    StartupTaskGraph graph;
+    graph.add("worker", StartupTaskGraph::AnyThread, { }, [&]() {
+        workerTimedOut = !mainStarted.tryAcquire(1, 5000 * timeoutFactor());
+    });
+    graph.add("main", StartupTaskGraph::MainThread, { }, [&]() {
+        mainStarted.release();
+    });
+    graph.run();
+
+    QVERIFY(!workerTimedOut);
+}
+
+void tst_StartupTaskGraph::unknownDependency()
+{
+    StartupTaskGraph graph;
+    graph.add("main-a", StartupTaskGraph::MainThread, { }, record("main-a"));
+
+    try {
+        graph.add("main-b", StartupTaskGraph::MainThread, { "main-a", "missing" }, record("main-b"));
+        QFAIL("Adding a task with an unknown dependency did not throw");
+    } catch (const Exception &e) {
+        QCOMPARE(e.errorString(), u"startup task 'main-b' depends on the unknown task 'missing'"_s);
+    }
+
+    // the rejected task is not part of the graph
+    graph.run();
+    QCOMPARE(m_executed, QStringList({ u"main-a"_s }));
+}
+
+void tst_StartupTaskGraph::cycles()
+{
+    // dependencies have to be added first, so neither a task depending on itself, nor one
+    // depending on a task that is added later (which would be needed to close a cycle) is accepted
+    StartupTaskGraph graph;
+
+    QVERIFY_THROWS_EXCEPTION(Exception, graph.add("main-a", StartupTaskGraph::MainThread,
+                                                  { "main-a" }, record("main-a")));
+
+    QVERIFY_THROWS_EXCEPTION(Exception, graph.add("main-a", StartupTaskGraph::MainThread,
+                                                  { "main-b" }, record("main-a")));
+    graph.add("main-b", StartupTaskGraph::MainThread, { }, record("main-b"));
+
+    graph.run();
+    QCOMPARE(m_executed, QStringList({ u"main-b"_s }));
+}
+
+void tst_StartupTaskGraph::errorPropagation_data()
+{
+    QTest::addColumn<bool>("failInWorker");
+
+    QTest::newRow("main-thread") << false;
+    QTest::newRow("worker-thread") << true;
+}
+
+void tst_StartupTaskGraph::errorPropagation()
+{
+    QFETCH(bool, failInWorker);
+
+    const auto failingAffinity = failInWorker ? StartupTaskGraph::AnyThread : StartupTaskGraph::MainThread;
+    const char *failingName = failInWorker ? "any-fail" : "main-fail";
+
+    StartupTaskGraph graph;
+    graph.add("main-a", StartupTaskGraph::MainThread, { }, record("main-a"));
+    graph.add(failingName, failingAffinity, { "main-a" }, [failingName]() {
+        throw Exception("%1 failed").arg(failingName);
+    });
+    graph.add("main-dependent", StartupTaskGraph::MainThread, { failingName }, record("main-dependent"));
+    graph.add("any-dependent", StartupTaskGraph::AnyThread, { failingName }, record("any-dependent"));
+
+    try {
+        graph.run();
+        QFAIL("StartupTaskGraph::run() did not throw");
+    } catch (const Exception &e) {
+        QCOMPARE(e.errorString(), QString::fromLatin1(failingName) + u" failed"_s);
+    }
+
+    // nothing depending on the failed task was started
+    QCOMPARE(m_executed, QStringList({ u"main-a"_s }));
+}
+
+QTEST_GUILESS_MAIN(tst_StartupTaskGraph)
+
+#include "tst_startuptaskgraph.moc"
@@ -6,6 +6,8 @@
 #include <QtCore>
 #include <QtTest>
 
+#include <unistd.h>
+
 #include "systemreader.h"
 
 using namespace Qt::StringLiterals;
@@ -23,6 +25,11 @@ private Q_SLOTS:
     void cgroupProcessInfo();
     void memoryReaderReadUsedValue();
     void memoryReaderGroupLimit();
+    void memoryReaderCGroupV2();
+    void memoryThresholdCGroupV2();
+    void memoryWatcherPressure();
+    void drmParseFdInfo();
+    void drmGpuReader();
 };
 
 tst_SystemReader::tst_SystemReader()
@@ -50,6 +57,294 @@ void tst_SystemReader::memoryReaderGroupLimit()
     QCOMPARE(value, Q_UINT64_C(524288000));
 }
 
-QTEST_APPLESS_MAIN(tst_SystemReader)
+void tst_SystemReader::memoryReaderCGroupV2()
+{
+    QTemporaryDir root;
+    QVERIFY(root.isValid());
+    const QString oldRootDir = std::exchange(g_systemRootDir, root.path());
+    auto restoreRootDir = qScopeGuard([&oldRootDir]() { g_systemRootDir = oldRootDir; });
+
+    auto writeFile = [&root](const QString &fileName, const QByteArray &content) {
+        QVERIFY(QDir(root.path()).mkpath(QFileInfo(fileName).path()));
+        QFile f(root.filePath(fileName));
+        QVERIFY(f.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        QCOMPARE(f.write(content), content.size());
+    };
+
+    QVERIFY(!MemoryReader::isCGroupV2());
+    writeFile(u"sys/fs/cgroup/cgroup.controllers"_s, "cpuset cpu io memory pids\n");
+    QVERIFY(MemoryReader::isCGroupV2());
+
+    const QString group = u"/system.slice/run-u5853.scope"_s;
+    QCOMPARE(MemoryReader::cGroupMemoryDir(group), root.path() + u"/sys/fs/cgroup/"_s + group);
+
+    writeFile(u"sys/fs/cgroup"_s + group + u"/memory.stat"_s,
+              "anon 66809856\nfile 1048576\nkernel 4096\ninactive_anon 4096\nactive_anon 66805760\n");
+    writeFile(u"sys/fs/cgroup"_s + group + u"/memory.max"_s, "524288000\n");
+
+    MemoryReader memoryReader(group);
+    QCOMPARE(memoryReader.readUsedValue(), Q_UINT64_C(66809856));
+    QCOMPARE(memoryReader.groupLimit(), Q_UINT64_C(524288000));
+
+    // unlimited
+    writeFile(u"sys/fs/cgroup"_s + group + u"/memory.max"_s, "max\n");
+    QCOMPARE(memoryReader.groupLimit(), memoryReader.totalValue());
+
+    // PSI
+    QVERIFY(!MemoryPressureTrigger::isSupported());
+    QVERIFY(!MemoryPressureTrigger::isSupported(group));
+    writeFile(u"proc/pressure/memory"_s, "some avg10=0.00 avg60=0.00 avg300=0.00 total=0\n"
+                                         "full avg10=0.00 avg60=0.00 avg300=0.00 total=0\n");
+    writeFile(u"sys/fs/cgroup"_s + group + u"/memory.pressure"_s, "some avg10=0.00 avg60=0.00 avg300=0.00 total=0\n"
+                                                                  "full avg10=0.00 avg60=0.00 avg300=0.00 total=0\n");
+    QVERIFY(MemoryPressureTrigger::isSupported());
+    QVERIFY(MemoryPressureTrigger::isSupported(group));
+}
+
+void tst_SystemReader::memoryThresholdCGroupV2()
+{
+    QTemporaryDir root;
+    QVERIFY(root.isValid());
+    const QString oldRootDir = std::exchange(g_systemRootDir, root.path());
+    auto restoreRootDir = qScopeGuard([&oldRootDir]() { g_systemRootDir = oldRootDir; });
+
+    auto writeFile = [&root](const QString &fileName, const QByteArray &content) {
+        QVERIFY(QDir(root.path()).mkpath(QFileInfo(fileName).path()));
+        QFile f(root.filePath(fileName));
+        QVERIFY(f.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        QCOMPARE(f.write(content), content.size());
+    };
+
+    const QString group = u"/app.slice"_s;
+    const QString groupDir = u"sys/fs/cgroup"_s + group;
+    auto setUsage = [&](quint64 anon) {
+        writeFile(groupDir + u"/memory.stat"_s, "anon " + QByteArray::number(anon) + "\nfile 4096\n");
+    };
+
+    writeFile(u"sys/fs/cgroup/cgroup.controllers"_s, "cpuset cpu io memory pids\n");
+    writeFile(groupDir + u"/memory.max"_s, "1000000\n");
+    writeFile(groupDir + u"/memory.events"_s, "low 0\nhigh 0\nmax 0\noom 0\noom_kill 0\n");
+    setUsage(100000);
+
+    MemoryReader reader(group);
+    MemoryThreshold threshold({ 80, 50 }); // the order does not matter
+    QSignalSpy spy(&threshold, &MemoryThreshold::thresholdTriggered);
+
+    // neither arming memory.events nor the initial check below all thresholds may trigger
+    QVERIFY(threshold.setEnabled(true, group, &reader));
+    QVERIFY(threshold.isEnabled());
+    QCOMPARE(spy.count(), 0);
+
+    // only crossing a threshold triggers, in either direction
+    auto checkUsage = [&](quint64 anon, int expectedCount) {
+        setUsage(anon);
+        QVERIFY(QMetaObject::invokeMethod(&threshold, "checkUsage"));
+        QCOMPARE(spy.count(), expectedCount);
+    };
+    checkUsage(600000, 1);
+    checkUsage(650000, 1);
+    checkUsage(800000, 2); // exactly at the threshold
+    checkUsage(900000, 2);
+    checkUsage(700000, 3);
+    checkUsage(499999, 4);
+    checkUsage(100, 4);
+    checkUsage(950000, 5); // crossing both thresholds at once triggers only once
+
+    // memory.events: every change needs to trigger, so the file has to be re-read (re-armed)
+    // every time
+    QVERIFY(QMetaObject::invokeMethod(&threshold, "readMemoryEvents"));
+    QCOMPARE(spy.count(), 6);
+    writeFile(groupDir + u"/memory.events"_s, "low 0\nhigh 3\nmax 1\noom 0\noom_kill 0\n");
+    QVERIFY(QMetaObject::invokeMethod(&threshold, "readMemoryEvents"));
+    QCOMPARE(spy.count(), 7);
+
+    // ... but not while disabled
+    QVERIFY(threshold.setEnabled(false));
+    QVERIFY(!threshold.isEnabled());
+    QVERIFY(QMetaObject::invokeMethod(&threshold, "readMemoryEvents"));
+    QCOMPARE(spy.count(), 7);
+    QVERIFY(threshold.setEnabled(true));
+    QVERIFY(QMetaObject::invokeMethod(&threshold, "readMemoryEvents"));
+    QCOMPARE(spy.count(), 8);
+
+    // the root cgroup has no memory.events
+    writeFile(u"sys/fs/cgroup/memory.stat"_s, "anon 4096\nfile 4096\n");
+    MemoryReader rootReader;
+    MemoryThreshold rootThreshold({ 50 });
+    QSignalSpy rootSpy(&rootThreshold, &MemoryThreshold::thresholdTriggered);
+    QVERIFY(rootThreshold.setEnabled(true, QString(), &rootReader));
+    QVERIFY(QMetaObject::invokeMethod(&rootThreshold, "readMemoryEvents"));
+    QCOMPARE(rootSpy.count(), 0);
+}
+
+void tst_SystemReader::memoryWatcherPressure()
+{
+    QTemporaryDir root;
+    QVERIFY(root.isValid());
+    const QString oldRootDir = std::exchange(g_systemRootDir, root.path());
+    auto restoreRootDir = qScopeGuard([&oldRootDir]() { g_systemRootDir = oldRootDir; });
+
+    auto writeFile = [&root](const QString &fileName, const QByteArray &content) {
+        QVERIFY(QDir(root.path()).mkpath(QFileInfo(fileName).path()));
+        QFile f(root.filePath(fileName));
+        QVERIFY(f.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        QCOMPARE(f.write(content), content.size());
+    };
+
+    const QString group = u"/app.slice"_s;
+    const QString groupDir = u"sys/fs/cgroup"_s + group;
+    auto setUsage = [&](quint64 anon) {
+        writeFile(groupDir + u"/memory.stat"_s, "anon " + QByteArray::number(anon) + "\nfile 4096\n");
+    };
+
+    writeFile(u"sys/fs/cgroup/cgroup.controllers"_s, "cpuset cpu io memory pids\n");
+    writeFile(groupDir + u"/memory.max"_s, "1000000\n");
+    writeFile(groupDir + u"/memory.events"_s, "low 0\nhigh 0\nmax 0\noom 0\noom_kill 0\n");
+    writeFile(groupDir + u"/memory.pressure"_s, "some avg10=0.00 avg60=0.00 avg300=0.00 total=0\n"
+                                                "full avg10=0.00 avg60=0.00 avg300=0.00 total=0\n");
+    setUsage(100000);
+
+    MemoryWatcher watcher(nullptr);
+    watcher.setThresholds(50, 80);
+    QSignalSpy lowSpy(&watcher, &MemoryWatcher::memoryLow);
+    QSignalSpy criticalSpy(&watcher, &MemoryWatcher::memoryCritical);
+    QVERIFY(watcher.startWatching(group));
+
+    auto check = [&](const char *pressureSlot, quint64 anon, int lowCount, int criticalCount) {
+        if (pressureSlot) {
+            QVERIFY(QMetaObject::invokeMethod(&watcher, pressureSlot));
+        } else {
+            setUsage(anon);
+            watcher.checkMemoryConsumption();
+        }
+        QCOMPARE(lowSpy.count(), lowCount);
+        QCOMPARE(criticalSpy.count(), criticalCount);
+    };
+    check(nullptr, 100000, 0, 0);
+
+    // a PSI trigger is latched: it only warns once, while the pressure persists
+    check("pressureWarningTriggered", 0, 1, 0);
+    check("pressureWarningTriggered", 0, 1, 0);
+
+    // the usage and the pressure feed into the same warning
+    check(nullptr, 600000, 1, 0);
+    check("clearPressure", 0, 1, 0);
+    check(nullptr, 100000, 1, 0);
+
+    // the latch has been reset
+    check("pressureWarningTriggered", 0, 2, 0);
+    check("pressureCriticalTriggered", 0, 2, 1);
+    check(nullptr, 900000, 2, 1);
+    check("clearPressure", 0, 2, 1);
+    check(nullptr, 100000, 2, 1);
+    check(nullptr, 900000, 3, 2);
+}
+
+void tst_SystemReader::drmParseFdInfo()
+{
+    DrmGpuReader::Client client;
+    auto key = DrmGpuReader::parseFdInfo("pos:\t0\n"
+                                         "flags:\t02100002\n"
+                                         "drm-driver:\ti915\n"
+                                         "drm-pdev:\t0000:00:02.0\n"
+                                         "drm-client-id:\t7\n"
+                                         "drm-engine-render:\t9288864723 ns\n"
+                                         "drm-engine-video:\t0 ns\n"
+                                         "drm-engine-capacity-video:\t2\n", client);
+    QCOMPARE(key, QByteArray("0000:00:02.0/7"));
+    QCOMPARE(client.busyNSec.size(), 2);
+    QCOMPARE(client.busyNSec.value("render"), Q_UINT64_C(9288864723));
+    QCOMPARE(client.busyNSec.value("video"), Q_UINT64_C(0));
+    QCOMPARE(client.capacity.value("video"), 2u);
+    QVERIFY(!client.capacity.contains("render"));
+
+    // not a DRM fd
+    DrmGpuReader::Client noClient;
+    QVERIFY(DrmGpuReader::parseFdInfo("pos:\t0\nflags:\t02\nmnt_id:\t25\n", noClient).isEmpty());
+}
+
+void tst_SystemReader::drmGpuReader()
+{
+    QTemporaryDir root;
+    QVERIFY(root.isValid());
+    const QString oldRootDir = std::exchange(g_systemRootDir, root.path());
+    auto restoreRootDir = qScopeGuard([&oldRootDir]() { g_systemRootDir = oldRootDir; });
+
+    QDir rootDir(root.path());
+    const QString pciDev = u"sys/devices/pci0000:00/0000:00:02.0"_s;
+    QVERIFY(rootDir.mkpath(pciDev));
+    QVERIFY(rootDir.mkpath(u"sys/bus/pci/drivers/i915"_s));
+    QVERIFY(rootDir.mkpath(u"sys/class/drm/card0"_s));
+    QVERIFY(QFile::link(root.filePath(pciDev), root.filePath(u"sys/class/drm/card0/device"_s)));
+    QVERIFY(QFile::link(root.filePath(u"sys/bus/pci/drivers/i915"_s), root.filePath(pciDev + u"/driver")));
+
+    // a DRM driver, but no client is reporting any engine busy times (yet)
+    QVERIFY(!DrmGpuReader::isSupported());
+
+    // two processes: 100 shares its DRM client with 200 (e.g. after a fork)
+    auto writeFdInfo = [&](int pid, int fd, int clientId, quint64 render, quint64 video) {
+        const QString procDir = u"proc/"_s + QString::number(pid);
+        QVERIFY(rootDir.mkpath(procDir + u"/fd"));
+        QVERIFY(rootDir.mkpath(procDir + u"/fdinfo"));
+        const QString fdLink = root.filePath(procDir + u"/fd/" + QString::number(fd));
+        if (!QFileInfo(fdLink).isSymLink())
+            QVERIFY(QFile::link(u"/dev/dri/renderD128"_s, fdLink));
+
+        QFile f(root.filePath(procDir + u"/fdinfo/" + QString::number(fd)));
+        QVERIFY(f.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        f.write("pos:\t0\ndrm-driver:\ti915\ndrm-pdev:\t0000:00:02.0\ndrm-client-id:\t"
+                + QByteArray::number(clientId)
+                + "\ndrm-engine-render:\t" + QByteArray::number(render)
+                + " ns\ndrm-engine-video:\t" + QByteArray::number(video)
+                + " ns\ndrm-engine-capacity-video:\t2\n");
+    };
+    // a non-DRM fd, which needs to be ignored
+    QVERIFY(rootDir.mkpath(u"proc/100/fd"_s));
+    QVERIFY(QFile::link(u"/dev/null"_s, root.filePath(u"proc/100/fd/0"_s)));
+
+    writeFdInfo(100, 5, 1, 1'000'000'000, 0);
+    writeFdInfo(200, 3, 1, 1'000'000'000, 0);
+    writeFdInfo(200, 4, 2, 500'000'000, 0);
+
+    QVERIFY(DrmGpuReader::isSupported());
+
+    // a process whose fds cannot be inspected would lead to an undercounted load
+    if (::geteuid() != 0) {
+        QVERIFY(rootDir.mkpath(u"proc/300/fd"_s));
+        QVERIFY(QFile::setPermissions(root.filePath(u"proc/300/fd"_s), { }));
+        QVERIFY(!DrmGpuReader::isSupported());
+        QVERIFY(QFile::setPermissions(root.filePath(u"proc/300/fd"_s),
+                                      QFileDevice::ReadOwner | QFileDevice::WriteOwner | QFileDevice::ExeOwner));
+        QVERIFY(DrmGpuReader::isSupported());
+    }
+
+    DrmGpuReader system;
+    DrmGpuReader process(200);
+    QCOMPARE(system.testReadLoadValue(0), 0.0);
+    QCOMPARE(process.testReadLoadValue(0), 0.0);
+
+    // within 1 second: client 1 used the render engine for 250ms, client 2 for another 250ms.
+    // client 2 also used both of the video engines for 800ms each.
+    writeFdInfo(100, 5, 1, 1'250'000'000, 0);
+    writeFdInfo(200, 3, 1, 1'250'000'000, 0);
+    writeFdInfo(200, 4, 2, 750'000'000, 1'600'000'000);
+
+    QCOMPARE(system.testReadLoadValue(1'000'000'000), 0.8);
+    QCOMPARE(process.testReadLoadValue(1'000'000'000), 0.8);
+
+    DrmGpuReader other(100);
+    QCOMPARE(other.testReadLoadValue(0), 0.0);
+    writeFdInfo(100, 5, 1, 1'750'000'000, 0);
+    QCOMPARE(other.testReadLoadValue(1'000'000'000), 0.5);
+
+    // the sysfs counter is preferred for the system-wide load
+    QFile busy(root.filePath(pciDev + u"/gpu_busy_percent"));
+    QVERIFY(busy.open(QIODevice::WriteOnly));
+    busy.write("42\n");
+    busy.close();
+    QCOMPARE(system.testReadLoadValue(1'000'000'000), 0.42);
+}
+
+QTEST_GUILESS_MAIN(tst_SystemReader)
 
 #include "tst_systemreader.moc"
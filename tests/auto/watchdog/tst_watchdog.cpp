@@ -0,0 +1,209 @@
+// Copyright (C) 2025 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtCore>
+#include <QtTest>
+
+#include <memory>
+
+#include "watchdog_p.h"
+
+using namespace Qt::StringLiterals;
+
+QT_USE_NAMESPACE_AM
+
+using EventProfile = WatchdogPrivate::EventProfile;
+
+class tst_Watchdog : public QObject
+{
+    Q_OBJECT
+
+public:
+    tst_Watchdog() = default;
+
+private Q_SLOTS:
+    void bucketIndex_data();
+    void bucketIndex();
+    void findSlot();
+    void slotsOutliveClassNames();
+    void profileFull();
+    void record();
+    void slowest();
+    void reset();
+};
+
+void tst_Watchdog::bucketIndex_data()
+{
+    QTest::addColumn<quint64>("usec");
+    QTest::addColumn<int>("index");
+
+    QTest::newRow("0us") << quint64(0) << 0;
+    QTest::newRow("249us") << quint64(249) << 0;
+    QTest::newRow("250us") << quint64(250) << 1;
+    QTest::newRow("499us") << quint64(499) << 1;
+    QTest::newRow("500us") << quint64(500) << 2;
+    QTest::newRow("1ms") << quint64(1000) << 3;
+    QTest::newRow("1023ms") << quint64(1023999) << 12;
+    QTest::newRow("1024ms") << quint64(1024000) << 13;
+    QTest::newRow("1h") << quint64(3600000000) << 13;
+}
+
+void tst_Watchdog::bucketIndex()
+{
+    QFETCH(quint64, usec);
+    QFETCH(int, index);
+
+    QCOMPARE(EventProfile::bucketIndex(usec), index);
+}
+
+void tst_Watchdog::findSlot()
+{
+    auto profile = std::make_unique<EventProfile>();
+    static const char className[] = "MyClass";
+
+    auto *slot = profile->findSlot(QEvent::Timer, className);
+    QVERIFY(slot);
+    QCOMPARE(slot->m_eventType, int(QEvent::Timer));
+    QCOMPARE(slot->m_className.constData(), "MyClass");
+    QCOMPARE(profile->findSlot(QEvent::Timer, className), slot);
+
+    // event type and class name always come from the same slot
+    auto *otherSlot = profile->findSlot(QEvent::MouseButtonPress, className);
+    QVERIFY(otherSlot);
+    QVERIFY(otherSlot != slot);
+    QCOMPARE(EventProfile::describeSlot(slot).constData(), "Timer event to MyClass");
+    QCOMPARE(EventProfile::describeSlot(otherSlot).constData(), "MouseButtonPress event to MyClass");
+}
+
+void tst_Watchdog::slotsOutliveClassNames()
+{
+    // dynamic meta-objects (e.g. QML types) can go away, while the profile is still around
+    auto profile = std::make_unique<EventProfile>();
+    auto className = std::make_unique<char[]>(16);
+    qstrcpy(className.get(), "DynamicType");
+
+    auto *slot = profile->findSlot(QEvent::Timer, className.get());
+    QVERIFY(slot);
+    profile->record(slot, QEvent::Timer, u"name"_s, 0x1234, 2000);
+
+    qstrcpy(className.get(), "Overwritten");
+    className.reset();
+
+    QCOMPARE(EventProfile::describeSlot(slot).constData(), "Timer event to DynamicType");
+    const QVariantMap map = profile->toMap();
+    QCOMPARE(map.value(u"histogram"_s).toList().value(0).toMap().value(u"receiverClass"_s).toString(),
+             u"DynamicType"_s);
+    QCOMPARE(map.value(u"slowest"_s).toList().value(0).toMap().value(u"receiverClass"_s).toString(),
+             u"DynamicType"_s);
+}
+
+void tst_Watchdog::profileFull()
+{
+    auto profile = std::make_unique<EventProfile>();
+    static const char classNames[EventProfile::SlotCount + 1] = { };
+
+    // the pointer is the key, not the string
+    for (int i = 0; i < EventProfile::SlotCount; ++i)
+        QVERIFY(profile->findSlot(QEvent::Timer, classNames + i));
+    QCOMPARE(profile->findSlot(QEvent::Timer, classNames + EventProfile::SlotCount), nullptr);
+
+    profile->record(nullptr, QEvent::Timer, { }, 0, 100);
+    profile->record(nullptr, QEvent::Timer, { }, 0, 100);
+
+    const QVariantMap map = profile->toMap();
+    QCOMPARE(map.value(u"unrecordedEventCount"_s).toULongLong(), 2ULL);
+    QCOMPARE(map.value(u"eventCount"_s).toULongLong(), 0ULL);
+    QVERIFY(EventProfile::describeSlot(nullptr).contains("the profile is full"));
+}
+
+void tst_Watchdog::record()
+{
+    auto profile = std::make_unique<EventProfile>();
+    static const char cheap[] = "Cheap";
+    static const char expensive[] = "Expensive";
+
+    auto *cheapSlot = profile->findSlot(QEvent::Timer, cheap);
+    auto *expensiveSlot = profile->findSlot(QEvent::Paint, expensive);
+
+    for (int i = 0; i < 10; ++i)
+        profile->record(cheapSlot, QEvent::Timer, { }, 0, 100);
+    profile->record(expensiveSlot, QEvent::Paint, { }, 0, 5000);
+    profile->record(expensiveSlot, QEvent::Paint, { }, 0, 1500);
+
+    const QVariantMap map = profile->toMap();
+    QCOMPARE(map.value(u"eventCount"_s).toULongLong(), 12ULL);
+    QCOMPARE(map.value(u"unrecordedEventCount"_s).toULongLong(), 0ULL);
+
+    // sorted by total time
+    const QVariantList histogram = map.value(u"histogram"_s).toList();
+    QCOMPARE(histogram.size(), 2);
+    const QVariantMap first = histogram.at(0).toMap();
+    QCOMPARE(first.value(u"eventType"_s).toString(), u"Paint"_s);
+    QCOMPARE(first.value(u"receiverClass"_s).toString(), u"Expensive"_s);
+    QCOMPARE(first.value(u"count"_s).toULongLong(), 2ULL);
+    QCOMPARE(first.value(u"totalTime"_s).toDouble(), 6.5);
+    QCOMPARE(first.value(u"maximumTime"_s).toDouble(), 5.);
+    const QVariantList buckets = first.value(u"buckets"_s).toList();
+    QCOMPARE(buckets.size(), EventProfile::BucketCount);
+    QCOMPARE(buckets.at(EventProfile::bucketIndex(1500)).toUInt(), 1U);
+    QCOMPARE(buckets.at(EventProfile::bucketIndex(5000)).toUInt(), 1U);
+
+    const QVariantMap second = histogram.at(1).toMap();
+    QCOMPARE(second.value(u"eventType"_s).toString(), u"Timer"_s);
+    QCOMPARE(second.value(u"count"_s).toULongLong(), 10ULL);
+    QCOMPARE(second.value(u"totalTime"_s).toDouble(), 1.);
+    QCOMPARE(second.value(u"buckets"_s).toList().at(0).toUInt(), 10U);
+}
+
+void tst_Watchdog::slowest()
+{
+    auto profile = std::make_unique<EventProfile>();
+    static const char className[] = "MyClass";
+    auto *slot = profile->findSlot(QEvent::Timer, className);
+
+    for (int i = 1; i <= EventProfile::SlowestCount + 5; ++i)
+        profile->record(slot, QEvent::Timer, u"obj"_s + QString::number(i), quintptr(i), quint64(i) * 1000);
+
+    // only the slowest events are kept, longest first
+    const QVariantList slowest = profile->toMap().value(u"slowest"_s).toList();
+    QCOMPARE(slowest.size(), EventProfile::SlowestCount);
+    for (int i = 0; i < slowest.size(); ++i) {
+        const QVariantMap se = slowest.at(i).toMap();
+        const int n = EventProfile::SlowestCount + 5 - i;
+        QCOMPARE(se.value(u"duration"_s).toDouble(), double(n));
+        QCOMPARE(se.value(u"receiverName"_s).toString(), u"obj"_s + QString::number(n));
+        QCOMPARE(se.value(u"receiver"_s).toString(), u"0x"_s + QString::number(n, 16));
+        QCOMPARE(se.value(u"receiverClass"_s).toString(), u"MyClass"_s);
+        QCOMPARE(se.value(u"eventType"_s).toString(), u"Timer"_s);
+    }
+}
+
+void tst_Watchdog::reset()
+{
+    auto profile = std::make_unique<EventProfile>();
+    static const char className[] = "MyClass";
+    auto *slot = profile->findSlot(QEvent::Timer, className);
+
+    profile->record(slot, QEvent::Timer, { }, 0, 1000);
+    profile->record(nullptr, QEvent::Timer, { }, 0, 1000);
+
+    // the reset is only requested from other threads and done by the next record()
+    profile->m_resetRequested.storeRelaxed(1);
+    QCOMPARE(profile->toMap().value(u"eventCount"_s).toULongLong(), 1ULL);
+
+    profile->record(slot, QEvent::Timer, { }, 0, 10);
+
+    const QVariantMap map = profile->toMap();
+    QCOMPARE(map.value(u"eventCount"_s).toULongLong(), 1ULL);
+    QCOMPARE(map.value(u"unrecordedEventCount"_s).toULongLong(), 0ULL);
+    QCOMPARE(map.value(u"slowest"_s).toList().size(), 1);
+    QCOMPARE(map.value(u"histogram"_s).toList().value(0).toMap().value(u"totalTime"_s).toDouble(), 0.01);
+
+    // the slots survive a reset, as they might still be referenced by a reader
+    QCOMPARE(profile->findSlot(QEvent::Timer, className), slot);
+    QCOMPARE(EventProfile::describeSlot(slot).constData(), "Timer event to MyClass");
+}
+
+QTEST_APPLESS_MAIN(tst_Watchdog)
+
+#include "tst_watchdog.moc"
@@ -6,11 +6,16 @@
 #include <QtCore>
 #include <QtTest>
 #include <QThreadPool>
+#include <QCborValue>
+#if defined(Q_OS_UNIX)
+#  include <unistd.h>
+#endif
 
 #include "qtyaml.h"
 #include "configcache.h"
 #include "exception.h"
 #include "global.h"
+#include "utilities.h"
 
 using namespace Qt::StringLiterals;
 
@@ -25,11 +30,16 @@ public:
 
 private Q_SLOTS:
     void parser();
+    void scalars_data();
+    void scalars();
     void documentParser();
     void cache();
     void mergedCache();
+    void fingerprintCache();
+    void brokenCacheContent();
     void parallel();
     void generate();
+    void cborMemfd();
 };
 
 
@@ -250,6 +260,72 @@ static const QVariantMap testMainDoc = {
                                  { u"offas0"_s, false }, { u"invalid"_s, u"1.5x"_s } } },
 };
 
+void tst_Yaml::scalars_data()
+{
+    QTest::addColumn<QByteArray>("yaml");
+    QTest::addColumn<QVariant>("value");
+
+    const QVariant vnull = QVariant::fromValue(nullptr);
+
+    QTest::newRow("zero") << "0"_ba << QVariant(0);
+    QTest::newRow("negative-zero") << "-0"_ba << QVariant(0);
+    QTest::newRow("positive") << "+42"_ba << QVariant(42);
+    QTest::newRow("negative") << "-42"_ba << QVariant(-42);
+    QTest::newRow("separators") << "1__000_"_ba << QVariant(1000);
+    QTest::newRow("int-max") << "2147483647"_ba << QVariant(2147483647);
+    QTest::newRow("int64") << "2147483648"_ba << QVariant(Q_INT64_C(2147483648));
+    QTest::newRow("int64-max") << "9223372036854775807"_ba << QVariant(std::numeric_limits<qint64>::max());
+    QTest::newRow("uint64") << "9223372036854775808"_ba << QVariant(Q_UINT64_C(9223372036854775808));
+    QTest::newRow("uint64-overflow") << "18446744073709551616"_ba << QVariant(u"18446744073709551616"_s);
+    QTest::newRow("leading-zero") << "08"_ba << QVariant(u"08"_s);
+    QTest::newRow("octal") << "-0_17"_ba << QVariant(-15);
+    QTest::newRow("octal-zero") << "00"_ba << QVariant(0);
+    QTest::newRow("hex") << "0xfF_"_ba << QVariant(255);
+    QTest::newRow("hex-negative") << "-0x10"_ba << QVariant(-16);
+    QTest::newRow("hex-uint64") << "0xffffffffffffffff"_ba << QVariant(std::numeric_limits<quint64>::max());
+    QTest::newRow("hex-invalid") << "0xg"_ba << QVariant(u"0xg"_s);
+    QTest::newRow("hex-empty") << "0x_"_ba << QVariant(u"0x_"_s);
+    QTest::newRow("hex-uppercase-x") << "0X10"_ba << QVariant(u"0X10"_s);
+    QTest::newRow("binary") << "+0b1_01"_ba << QVariant(5);
+    QTest::newRow("binary-invalid") << "0b2"_ba << QVariant(u"0b2"_s);
+    QTest::newRow("float") << "1_0.5"_ba << QVariant(10.5);
+    QTest::newRow("float-exponent") << "1.5e+3"_ba << QVariant(1500.);
+    QTest::newRow("float-exponent-unsigned") << "1.5e3"_ba << QVariant(u"1.5e3"_s);
+    QTest::newRow("float-exponent-empty") << "1.5e+"_ba << QVariant(u"1.5e+"_s);
+    QTest::newRow("float-two-dots") << "1.2.3"_ba << QVariant(u"1.2.3"_s);
+    QTest::newRow("dot") << "."_ba << QVariant(u"."_s);
+    QTest::newRow("exponent-only") << "1e+5"_ba << QVariant(u"1e+5"_s);
+    QTest::newRow("version") << "1.0-beta"_ba << QVariant(u"1.0-beta"_s);
+    QTest::newRow("inf") << "-.inf"_ba << QVariant(u"-.inf"_s);
+    QTest::newRow("nan") << ".NaN"_ba << QVariant(qQNaN());
+    QTest::newRow("null") << "~"_ba << vnull;
+    QTest::newRow("bool") << "Off"_ba << QVariant(false);
+    QTest::newRow("bool-mixed-case") << "oN"_ba << QVariant(u"oN"_s);
+    QTest::newRow("quoted-number") << "'42'"_ba << QVariant(u"42"_s);
+    QTest::newRow("quoted-bool") << "\"yes\""_ba << QVariant(u"yes"_s);
+    QTest::newRow("utf8") << "\xc3\xa4"_ba << QVariant(u"\u00e4"_s);
+}
+
+void tst_Yaml::scalars()
+{
+    QFETCH(QByteArray, yaml);
+    QFETCH(QVariant, value);
+
+    try {
+        const auto docs = YamlParser::parseAllDocuments("value: " + yaml);
+        QCOMPARE(docs.size(), 1);
+        const QVariant parsed = docs.constFirst().toMap().value(u"value"_s);
+
+        QCOMPARE(parsed.metaType(), value.metaType());
+        if ((value.metaType() == QMetaType::fromType<double>()) && qIsNaN(value.toDouble()))
+            QVERIFY(qIsNaN(parsed.toDouble()));
+        else
+            QCOMPARE(parsed, value);
+    } catch (const Exception &e) {
+        QVERIFY2(false, e.what());
+    }
+}
+
 void tst_Yaml::documentParser()
 {
     try {
@@ -422,6 +498,131 @@ void tst_Yaml::mergedCache()
     delete ct;
 }
 
+void tst_Yaml::fingerprintCache()
+{
+    // we need a real file with a stable inode and modification time, so we copy cache1
+    QTemporaryFile cache1File(u"cache1"_s);
+    QVERIFY(cache1File.open());
+    QFile cache1Resource(u":/data/cache1.yaml"_s);
+    QVERIFY(cache1Resource.open(QIODevice::ReadOnly));
+    QVERIFY(cache1File.write(cache1Resource.readAll()) > 0);
+    QVERIFY(cache1File.flush());
+
+    const QString cache1FileName = QFileInfo(cache1File).absoluteFilePath();
+    const QStringList files = { cache1FileName, u":/data/cache2.yaml"_s };
+
+    for (int step = 0; step < 3; ++step) {
+        AbstractConfigCache::Options options = AbstractConfigCache::CheckFingerprints;
+        if (step == 0)
+            options |= AbstractConfigCache::ClearCache;
+
+        if (step == 2) {
+            // change the size, so that the fingerprint definitely doesn't match anymore
+            QVERIFY(cache1File.seek(cache1File.size()));
+            QVERIFY(cache1File.write("value: changed\n") > 0);
+            QVERIFY(cache1File.flush());
+            QTest::ignoreMessage(QtWarningMsg, "Failed to read Cache: cached file checksums do not match");
+        }
+
+        try {
+            ConfigCache<CacheTest> cache(files, u"cache-test"_s, { 'F','T','S','T' }, 1, options);
+            cache.parse();
+            QCOMPARE(cache.parseReadFromCache(), step != 0);
+            QCOMPARE(cache.parseWroteToCache(), step != 1);
+
+            std::unique_ptr<CacheTest> ct1(cache.takeResult(cache1FileName));
+            QVERIFY(ct1);
+            QCOMPARE(ct1->name, u"cache1"_s);
+            QCOMPARE(ct1->value, step == 2 ? u"changed"_s : QString { });
+            std::unique_ptr<CacheTest> ct2(cache.takeResult(1));
+            QVERIFY(ct2);
+            QCOMPARE(ct2->name, u"cache2"_s);
+        } catch (const Exception &e) {
+            QVERIFY2(false, e.what());
+        }
+    }
+}
+
+void tst_Yaml::brokenCacheContent()
+{
+    const QStringList files = { u":/data/cache1.yaml"_s, u":/data/cache2.yaml"_s };
+    QString cacheFileName;
+
+    {
+        ConfigCache<CacheTest> cache(files, u"cache-test"_s, { 'B','T','S','T' }, 1,
+                                     AbstractConfigCache::ClearCache);
+        cache.parse();
+        QVERIFY(cache.parseWroteToCache());
+        cacheFileName = cache.cacheFilePath();
+    }
+
+    // corrupt the serialized content of the first entry: the table stays intact, so this is
+    // only detected when the entry is lazily decoded
+    {
+        QFile cacheFile(cacheFileName);
+        QVERIFY(cacheFile.open(QIODevice::ReadWrite));
+        const QByteArray header = cacheFile.read(6 * sizeof(quint32));
+        QCOMPARE(header.size(), qsizetype(6 * sizeof(quint32)));
+        const quint32 tableSize = qFromBigEndian<quint32>(header.constData() + 5 * sizeof(quint32));
+        QVERIFY(cacheFile.seek(header.size() + tableSize));
+        QCOMPARE(cacheFile.write("\x7f\xff\xff\xf0", 4), 4);
+    }
+
+    try {
+        ConfigCache<CacheTest> cache(files, u"cache-test"_s, { 'B','T','S','T' }, 1,
+                                     AbstractConfigCache::None);
+        cache.parse();
+        QVERIFY(cache.parseReadFromCache());
+        QVERIFY(!cache.parseWroteToCache());
+
+        QTest::ignoreMessage(QtWarningMsg, QRegularExpression(u"^Failed to read cache content for .*cache1.yaml"_s));
+        std::unique_ptr<CacheTest> ct1(cache.takeResult(0));
+        QVERIFY(ct1);
+        QCOMPARE(ct1->name, u"cache1"_s);
+        QCOMPARE(ct1->file, u":/data/cache1.yaml"_s);
+        std::unique_ptr<CacheTest> ct2(cache.takeResult(1));
+        QVERIFY(ct2);
+        QCOMPARE(ct2->name, u"cache2"_s);
+
+        // the broken cache must not be used anymore
+        QVERIFY(!QFile::exists(cacheFileName));
+    } catch (const Exception &e) {
+        QVERIFY2(false, e.what());
+    }
+
+    QFile mappedFile(cacheFileName);
+    const uchar *mapped = nullptr;
+    QByteArray mappedContent;
+
+    for (int step = 0; step < 2; ++step) {
+        if (step == 1) {
+            // keep the current cache mapped, like a concurrently running process would do
+            QVERIFY(mappedFile.open(QIODevice::ReadOnly));
+            mapped = mappedFile.map(0, mappedFile.size());
+            QVERIFY(mapped);
+            mappedContent = QByteArray(reinterpret_cast<const char *>(mapped), mappedFile.size());
+        }
+
+        try {
+            // the second step writes a smaller cache file, replacing the one from the first step
+            ConfigCache<CacheTest> cache(files.mid(0, 2 - step), u"cache-test"_s, { 'B','T','S','T' }, 1,
+                                         AbstractConfigCache::None);
+            cache.parse();
+            QVERIFY(cache.parseWroteToCache());
+            std::unique_ptr<CacheTest> ct1(cache.takeResult(0));
+            QVERIFY(ct1);
+            QCOMPARE(ct1->name, u"cache1"_s);
+        } catch (const Exception &e) {
+            QVERIFY2(false, e.what());
+        }
+    }
+
+    // the old mapping needs to stay intact: truncating the file in place would SIGBUS here
+    QCOMPARE(QByteArray(reinterpret_cast<const char *>(mapped), mappedContent.size()), mappedContent);
+    QVERIFY(QFileInfo(cacheFileName).size() < mappedContent.size());
+    mappedFile.unmap(const_cast<uchar *>(mapped));
+}
+
 class YamlRunnable : public QRunnable
 {
 public:
@@ -507,6 +708,39 @@ void tst_Yaml::generate()
     QCOMPARE(ba, baGen);
 }
 
+void tst_Yaml::cborMemfd()
+{
+#if !defined(Q_OS_LINUX)
+    QSKIP("memfds are only supported on Linux");
+#else
+    QFile f(u":/data/test.yaml"_s);
+    QVERIFY2(f.open(QFile::ReadOnly), qPrintable(f.errorString()));
+
+    QVector<QVariant> docs;
+    QVERIFY_THROWS_NO_EXCEPTION(docs = YamlParser::parseAllDocuments(f.readAll()));
+    QVERIFY(!docs.isEmpty());
+    const QVariantMap config = docs.constLast().toMap();
+    QVERIFY(!config.isEmpty());
+
+    int fd = -1;
+    QVERIFY_THROWS_NO_EXCEPTION(fd = createSealedMemfd("tst_yaml", QCborValue::fromVariant(config).toCbor()));
+    QVERIFY(fd >= 0);
+    auto closeFd = qScopeGuard([fd]() { ::close(fd); });
+
+    // sealed: neither writable nor resizable
+    QCOMPARE(::write(fd, "x", 1), -1);
+    QCOMPARE(::ftruncate(fd, 0), -1);
+
+    QVariantMap result;
+    QVERIFY_THROWS_NO_EXCEPTION(result = variantMapFromCborFileDescriptor(fd));
+    QCOMPARE(result, QCborValue::fromVariant(config).toVariant().toMap());
+
+    // reading twice via the same fd has to work, since the mapping is independent of the offset
+    QVERIFY_THROWS_NO_EXCEPTION(result = variantMapFromCborFileDescriptor(fd));
+    QCOMPARE(result.size(), config.size());
+#endif
+}
+
 QTEST_GUILESS_MAIN(tst_Yaml)
 
 #include "tst_yaml.moc"